@@ -10,6 +10,7 @@
 
 #include "ATEMDemo.h"
 #include "Logging.h"
+#include "ecatDemoAtomic.h"
 
 #ifdef ATEMRAS_SERVER 
 #include <AtEmRasSrv.h>
@@ -19,16 +20,49 @@
 #define LogMsg      S_poLog->LogMsg
 #define LogError    S_poLog->LogError
 
+/* handoff of the administrative and acyclic jobs to tEcAcycJobTask */
+#define ACYC_PASS_IDLE              0       /* tEcJobTask owns the jobs */
+#define ACYC_PASS_PENDING           1       /* handed off, not started yet, tEcJobTask may revoke it */
+#define ACYC_PASS_RUNNING           2       /* tEcAcycJobTask executes the jobs */
+#define ACYC_PASS_MAX_MISSED        10      /* cycles a pass may stay pending before tEcJobTask runs it inline */
+
+/*-TYPEDEFS------------------------------------------------------------------*/
+/* parameters of the application in ReplayCycle() */
+typedef struct _T_REPLAY_CONTEXT
+{
+    CAtEmLogging*       poLog;
+    EC_T_INT            nVerbose;
+} T_REPLAY_CONTEXT;
+
 /*-LOCAL VARIABLES-----------------------------------------------------------*/
 static EC_T_DWORD          S_dwClntId        = 0;
 static CAtEmLogging*       S_poLog           = EC_NULL;
 static T_DEMO_THREAD_PARAM S_DemoThreadParam = {0};
 static EC_T_PVOID          S_pvtJobThread    = EC_NULL;
+static T_DEMO_THREAD_PARAM S_AcycThreadParam = {0};
+static EC_T_PVOID          S_pvtAcycThread   = EC_NULL;
+static volatile EC_T_DWORD S_dwAcycPassState = ACYC_PASS_IDLE;  /* one pass of administrative and acyclic jobs in flight */
+static EC_T_DWORD          S_dwAcycPassesMissed = 0;            /* cycles ending with the previous pass not started yet */
+static EC_T_DWORD          S_dwAcycPassesDeferred = 0;          /* cycles ending with the previous pass still running */
+static EC_T_DWORD          S_dwAcycPassesInline = 0;            /* starved passes revoked and run by tEcJobTask */
 #ifdef ATEMRAS_SERVER 
 static EC_T_BOOL           S_bRasSrvStarted  = EC_FALSE;
 static EC_T_PVOID          S_pvRemoteApiSrvH = EC_NULL;
 #endif
 static EC_T_BOOL           S_bEnaPerfJobs    = EC_FALSE;
+static T_DEMO_CFG          S_DemoCfg         = {0};
+static T_DEADLINE_TIMER    S_oJobDeadlineTimer;
+static T_LATENCY_HISTO     S_aJobHisto[MAX_JOB_NUM];
+static T_OVERRUN_DESC      S_oOverrun;
+static T_APP_TASK_TABLE    S_oAppTaskTable;
+static T_INPUT_CHANGE      S_oInputChange;
+static T_PD_SNAPSHOT       S_oPdSnapshot;                   /* process data for non real-time readers */
+static EC_T_BYTE*          S_pbyDiagSnapshot = EC_NULL;     /* snapshot copy of myAppDiagnosis() */
+static T_PD_SHM            S_oPdShm;                        /* process data for other processes */
+static T_PD_REPLAY*        S_pReplay         = EC_NULL;     /* replay: recorded configuration instead of the master */
+static T_PD_FORCE          S_oPdForce;                      /* forced output bits */
+static T_SLAVE_REGISTRY    S_oSlaveRegistry;                /* all configured slaves, built in myAppPrepare() */
+static EC_T_UINT64         S_aqwJobStartTime[MAX_JOB_NUM];
 static EC_T_TSC_MEAS_DESC  S_TscMeasDesc;
 static EC_T_CHAR*          S_aszMeasInfo[MAX_JOB_NUM] =
 {
@@ -37,7 +71,13 @@ static EC_T_CHAR*          S_aszMeasInfo[MAX_JOB_NUM] =
     (EC_T_CHAR*)"JOB_MasterTimer       ",
     (EC_T_CHAR*)"JOB_SendAcycFrames    ",
     (EC_T_CHAR*)"Cycle Time            ",
-    (EC_T_CHAR*)"myAppWorkPd           "
+    (EC_T_CHAR*)"myAppWorkPd           ",
+    (EC_T_CHAR*)"Frame departure       ",
+    (EC_T_CHAR*)"App task 0            ",
+    (EC_T_CHAR*)"App task 1            ",
+    (EC_T_CHAR*)"App task 2            ",
+    (EC_T_CHAR*)"App task 3            ",
+    (EC_T_CHAR*)"Wake-up error         "
 };
 
 /*-FORWARD DECLARATIONS------------------------------------------------------*/
@@ -46,6 +86,22 @@ static EC_T_DWORD ecatNotifyCallback(EC_T_DWORD dwCode, EC_T_NOTIFYPARMS* pParms
 static EC_T_DWORD RasNotifyWrapper(EC_T_DWORD dwCode, EC_T_NOTIFYPARMS* pParms);
 #endif
 static EC_T_VOID  tEcJobTask(EC_T_VOID* pvThreadParamDesc);
+static EC_T_VOID  tEcAcycJobTask(EC_T_VOID* pvThreadParamDesc);
+static EC_T_VOID  PerfWakeUpErrorRecord(EC_T_UINT64 qwWake);
+static EC_T_BOOL  AcycPassRevoke(EC_T_VOID);
+static EC_T_DWORD JobSendAllCycFrames(EC_T_VOID);
+static EC_T_VOID  JobMasterTimer(EC_T_VOID);
+static EC_T_VOID  JobSendAcycFrames(EC_T_VOID);
+static EC_T_VOID  ShowJobStatistics(EC_T_VOID);
+static EC_T_VOID  ResetJobStatistics(EC_T_VOID);
+static EC_T_VOID  PerfJobHistoStart(EC_T_DWORD dwJobIndex);
+static EC_T_VOID  PerfJobHistoEnd(EC_T_DWORD dwJobIndex);
+static EC_T_VOID  CheckOverrun(T_OVERRUN_STATS* pLastStats);
+static EC_T_VOID  CheckPdForce(EC_T_DWORD* pdwLastRes);
+static EC_T_VOID  GetPdImageSizes(EC_T_DWORD* pdwInSize, EC_T_DWORD* pdwOutSize, EC_T_DWORD* pdwNumSlaves);
+static EC_T_DWORD PdShmExportInit(EC_T_DWORD dwBusCycleTimeUsec);
+static EC_T_VOID  RunAppTasks(CAtEmLogging* poLog, EC_T_INT nVerbose, EC_T_BYTE* pbyPDIn, EC_T_BYTE* pbyPDOut);
+static EC_T_DWORD ReplayCycle(EC_T_VOID* pvContext, const T_PD_REC_RECORD* pRecord, EC_T_BYTE* pbyPDIn, EC_T_BYTE* pbyPDOut);
 
 /*-MYAPP---------------------------------------------------------------------*/
 /* Demo code: Remove/change this in your application */
@@ -54,6 +110,8 @@ static EC_T_DWORD myAppPrepare  (CAtEmLogging*           poLog, EC_T_INT nVerbos
 static EC_T_DWORD myAppSetup    (CAtEmLogging*           poLog, EC_T_INT nVerbose, EC_T_DWORD dwClntId);
 static EC_T_DWORD myAppWorkpd   (CAtEmLogging*           poLog, EC_T_INT nVerbose, EC_T_BYTE* pbyPDIn, EC_T_BYTE* pbyPDOut);
 static EC_T_DWORD myAppDiagnosis(CAtEmLogging*           poLog, EC_T_INT nVerbose);
+static EC_T_DWORD myAppWorkDigOut(CAtEmLogging*          poLog, EC_T_INT nVerbose, EC_T_BYTE* pbyPDIn, EC_T_BYTE* pbyPDOut);
+static EC_T_DWORD myAppWorkAnalog(CAtEmLogging*          poLog, EC_T_INT nVerbose, EC_T_BYTE* pbyPDIn, EC_T_BYTE* pbyPDOut);
 static EC_T_DWORD myAppNotify   (EC_T_DWORD dwCode, EC_T_NOTIFYPARMS* pParms);
 /* Demo code: End */
 
@@ -82,6 +140,7 @@ EC_T_DWORD ATEMDemo(
    ,EC_T_WORD           wServerPort         /* [in]   Remote API Server Port */
 #endif
    ,EC_T_LINK_PARMS*    poLinkParmsRed      /* [in]  Redundancy Link Layer Parameter */
+   ,T_DEMO_CFG*         pDemoCfg            /* [in]  Demo options */
 )
 {
     EC_T_DWORD       dwRetVal = EC_E_NOERROR;
@@ -89,15 +148,19 @@ EC_T_DWORD ATEMDemo(
     EC_T_BOOL        bRes     = EC_FALSE;
     CEcTimer         oTimeout;
     CEmNotification* pNotification = EC_NULL;
+    T_OVERRUN_STATS  oOverrunStats;
+    CEcTimer         oPdForceReload;
+    EC_T_DWORD       dwPdForceRes  = EC_E_NOERROR;
 
     EC_T_CPUSET CpuSet;
     EC_CPUSET_ZERO(CpuSet);
-    EC_CPUSET_SET(CpuSet, dwCpuIndex);
+    EC_CPUSET_SET(CpuSet, pDemoCfg->oAffinity.dwMain);
 
     /* store parameters */
     S_poLog = poLog;
     S_bEnaPerfJobs = bEnaPerfJobs;
     S_DemoThreadParam.pvTimingEvent = pvTimingEvent;
+    S_DemoCfg = *pDemoCfg;
 
     /* check if interrupt mode is selected */
     if (poLinkParms->eLinkMode != EcLinkMode_POLLING)
@@ -112,7 +175,7 @@ EC_T_DWORD ATEMDemo(
         if (!bRes)
         {
             dwRetVal = EC_E_INVALIDPARM;
-            LogError("Error: Set thread affinity, invalid CPU index %d\n", dwCpuIndex);
+            LogError("Error: Set thread affinity, invalid CPU index %d\n", S_DemoCfg.oAffinity.dwMain);
             goto Exit;
         }
     }
@@ -127,6 +190,14 @@ EC_T_DWORD ATEMDemo(
 
     if (S_bEnaPerfJobs)
     {
+    EC_T_DWORD dwJobIndex = 0;
+
+        for (dwJobIndex = 0; dwJobIndex < MAX_JOB_NUM; dwJobIndex++)
+        {
+            LatencyHistoInit(&S_aJobHisto[dwJobIndex],
+                ((0 == S_DemoCfg.dwOutlierUsec) ? dwBusCycleTimeUsec : S_DemoCfg.dwOutlierUsec) * 1000);
+            S_aqwJobStartTime[dwJobIndex] = 0;
+        }
         PERF_MEASURE_JOBS_INIT(EC_NULL);
     }
     
@@ -155,6 +226,8 @@ EC_T_DWORD ATEMDemo(
         oRemoteApiConfig.dwReConTOLimit     = 6000;                 /* Reconnect Timeout after 6000*2msec + 10secs */
 
 #if (defined LINUX) || (defined XENOMAI)
+        EC_CPUSET_ZERO(CpuSet);
+        EC_CPUSET_SET(CpuSet, S_DemoCfg.oAffinity.dwRas);
         oRemoteApiConfig.dwMasterPrio       = (CpuSet << 16) | MAIN_THREAD_PRIO;
         oRemoteApiConfig.dwClientPrio       = (CpuSet << 16) | MAIN_THREAD_PRIO;
 #else
@@ -216,6 +289,59 @@ EC_T_DWORD ATEMDemo(
         }
     }
     
+    /* Start timeline trace */
+    if (S_DemoCfg.bTrace)
+    {
+        if (!TraceInit(S_DemoCfg.dwTraceCycles, LOG_THREAD_PRIO, LOG_THREAD_STACKSIZE))
+        {
+            dwRetVal = EC_E_NOMEMORY;
+            LogError("Cannot initialize timeline trace!");
+            goto Exit;
+        }
+    }
+
+    /* Create task for administrative and acyclic jobs */
+    /****************************************************/
+    if (S_DemoCfg.bAcycThread)
+    {
+#if !(defined DEMO_ATOMIC_CAS_SUPPORTED)
+        dwRetVal = EC_E_NOTSUPPORTED;
+        LogError("AcycJobTask needs DEMO_ATOMIC_CAS() on this platform");
+        goto Exit;
+#endif
+        S_dwAcycPassState     = ACYC_PASS_IDLE;
+        S_dwAcycPassesMissed   = 0;
+        S_dwAcycPassesDeferred = 0;
+        S_dwAcycPassesInline   = 0;
+        S_AcycThreadParam.pvTimingEvent = OsCreateEvent();
+        if (EC_NULL == S_AcycThreadParam.pvTimingEvent)
+        {
+            dwRetVal = EC_E_NOMEMORY;
+            goto Exit;
+        }
+        S_AcycThreadParam.bJobThreadRunning  = EC_FALSE;
+        S_AcycThreadParam.bJobThreadShutdown = EC_FALSE;
+        S_AcycThreadParam.pLogInst           = S_poLog;
+        S_AcycThreadParam.pNotInst           = pNotification;
+        S_AcycThreadParam.dwCpuIndex         = S_DemoCfg.dwAcycCpuIndex;
+        S_AcycThreadParam.dwBusCycleTimeUsec = dwBusCycleTimeUsec;
+        S_pvtAcycThread = OsCreateThread((EC_T_CHAR*)"tEcAcycJobTask", tEcAcycJobTask,
+                                         S_DemoCfg.dwAcycThreadPrio, ACYC_THREAD_STACKSIZE, (EC_T_VOID*)&S_AcycThreadParam);
+        /* wait until thread is running */
+        oTimeout.Start(2000);
+        while (!oTimeout.IsElapsed() && !S_AcycThreadParam.bJobThreadRunning)
+        {
+            OsSleep(10);
+        }
+        if (!S_AcycThreadParam.bJobThreadRunning)
+        {
+            dwRetVal = EC_E_TIMEOUT;
+            LogError("Timeout starting AcycJobTask");
+            goto Exit;
+        }
+        oTimeout.Stop();
+    }
+
     /* Create cyclic task to trigger master jobs */
     /*********************************************/
     S_DemoThreadParam.bJobThreadRunning  = EC_FALSE;
@@ -224,6 +350,7 @@ EC_T_DWORD ATEMDemo(
     S_DemoThreadParam.pNotInst           = pNotification;
     S_DemoThreadParam.dwCpuIndex         = dwCpuIndex;
     S_DemoThreadParam.dwBusCycleTimeUsec = dwBusCycleTimeUsec;
+    OverrunInit(&S_oOverrun, dwBusCycleTimeUsec);
     S_pvtJobThread = OsCreateThread((EC_T_CHAR*)"tEcJobTask", tEcJobTask,
 #if !(defined EC_VERSION_GO32)
                                     JOBS_THREAD_PRIO,
@@ -330,6 +457,62 @@ EC_T_DWORD ATEMDemo(
         dwRetVal = dwRes;
         goto Exit;
     }
+    /* export the process image to other processes */
+    if (S_DemoCfg.bPdShm)
+    {
+        dwRes = PdShmExportInit(dwBusCycleTimeUsec);
+        if (EC_E_NOERROR != dwRes)
+        {
+            LogError("Cannot export process data to shared memory %s! %s (0x%lx)", S_DemoCfg.szPdShmName, ecatGetText(dwRes), dwRes);
+        }
+    }
+    /* force output bits from file */
+    if (('\0' != S_DemoCfg.szPdForceFile[0]) && (EC_NULL != ecatGetProcessImageOutputPtr()))
+    {
+        EC_T_DWORD dwInSize  = 0;
+        EC_T_DWORD dwOutSize = 0;
+
+        GetPdImageSizes(&dwInSize, &dwOutSize, EC_NULL);
+        dwRes = PdForceInit(&S_oPdForce, dwOutSize);
+        if (EC_E_NOERROR != dwRes)
+        {
+            LogError("Cannot initialize output forcing! %s (0x%lx)", ecatGetText(dwRes), dwRes);
+        }
+        else
+        {
+            CheckPdForce(&dwPdForceRes);
+            oPdForceReload.Start(PD_FORCE_RELOAD_PERIOD);
+        }
+    }
+    /* record the process data of each cycle */
+    if (S_DemoCfg.bPdRec && (EC_NULL != ecatGetProcessImageInputPtr()) && (EC_NULL != ecatGetProcessImageOutputPtr()))
+    {
+        EC_T_DWORD          dwInSize        = 0;
+        EC_T_DWORD          dwOutSize       = 0;
+        EC_T_DWORD          dwSlaveIdx      = 0;
+
+        GetPdImageSizes(&dwInSize, &dwOutSize, EC_NULL);
+        dwRes = PdRecInit(S_DemoCfg.dwPdRecFileSizeMb, S_DemoCfg.dwPdRecNumFiles, dwInSize, dwOutSize, dwBusCycleTimeUsec,
+                          S_oSlaveRegistry.dwNumSlaves, S_oPdForce.bEnabled, LOG_THREAD_PRIO, LOG_THREAD_STACKSIZE);
+        if (EC_E_NOERROR != dwRes)
+        {
+            LogError("Cannot start process data recorder! %s (0x%lx)", ecatGetText(dwRes), dwRes);
+        }
+        else
+        {
+            /* slave table for the replay, a recording without it cannot be decoded */
+            for (dwSlaveIdx = 0; dwSlaveIdx < S_oSlaveRegistry.dwNumSlaves; dwSlaveIdx++)
+            {
+                dwRes = PdRecAddSlave(&S_oSlaveRegistry.pCfgSlaveInfo[dwSlaveIdx]);
+                if (EC_E_NOERROR != dwRes)
+                {
+                    LogError("Cannot add slave %d to process data recorder! %s (0x%lx)", dwSlaveIdx, ecatGetText(dwRes), dwRes);
+                    PdRecDeinit();
+                    break;
+                }
+            }
+        }
+    }
     /* set master and bus state to PREOP */
     dwRes = ecatSetMasterState(ETHERCAT_STATE_CHANGE_TIMEOUT, eEcatState_PREOP);
     pNotification->ProcessNotificationJobs();
@@ -382,7 +565,7 @@ EC_T_DWORD ATEMDemo(
         LogMsg("Job times during startup <INIT> to <%s>:", ecatStateToStr(ecatGetMasterState()));
         PERF_MEASURE_JOBS_SHOW();       /* show job times */
         LogMsg("");
-        ecatPerfMeasReset(&S_TscMeasDesc, 0xFFFFFFFF);        /* clear job times of startup phase */
+        PERF_MEASURE_JOBS_RESET();      /* clear job times of startup phase */
     }
 
 #if (defined DEBUG) && (defined XENOMAI)
@@ -400,6 +583,7 @@ EC_T_DWORD ATEMDemo(
     {
         oTimeout.Start(dwDuration);
     }
+    OsMemset(&oOverrunStats, 0, sizeof(T_OVERRUN_STATS));
     while (bRun && (!oTimeout.IsStarted() || !oTimeout.IsElapsed()))
     {
         if (nVerbose >= 2)
@@ -408,6 +592,16 @@ EC_T_DWORD ATEMDemo(
         }
         bRun = !OsTerminateAppRequest();/* check if demo shall terminate */
 
+        /* report deadline misses of tEcJobTask */
+        CheckOverrun(&oOverrunStats);
+
+        /* pick up changes of the force file */
+        if (oPdForceReload.IsStarted() && oPdForceReload.IsElapsed())
+        {
+            CheckPdForce(&dwPdForceRes);
+            oPdForceReload.Start(PD_FORCE_RELOAD_PERIOD);
+        }
+
         /*****************************************************************************************/
         /* Demo code: Remove/change this in your application: Do some diagnosis outside job task */
         /*****************************************************************************************/
@@ -423,7 +617,12 @@ EC_T_DWORD ATEMDemo(
     {
         LogMsg("");
         LogMsg("Job times before shutdown");
-        PERF_MEASURE_JOBS_SHOW();       /* show job times */
+        PERF_MEASURE_JOBS_SHOW();       /* show job times and overrun statistics */
+    }
+    else
+    {
+        OverrunGetSnapshot(&S_oOverrun, &oOverrunStats);
+        OverrunShow(&oOverrunStats, S_poLog);
     }
 
 Exit:
@@ -470,6 +669,33 @@ Exit:
         OsDeleteThreadHandle(S_pvtJobThread);
         S_pvtJobThread = EC_NULL;
     }
+    /* Shutdown tEcAcycJobTask */
+    S_AcycThreadParam.bJobThreadShutdown = EC_TRUE;
+    oTimeout.Start(2000);
+    while (S_AcycThreadParam.bJobThreadRunning && !oTimeout.IsElapsed())
+    {
+        OsSleep(10);
+    }
+    if (S_pvtAcycThread != EC_NULL)
+    {
+        OsDeleteThreadHandle(S_pvtAcycThread);
+        S_pvtAcycThread = EC_NULL;
+    }
+    if (EC_NULL != S_AcycThreadParam.pvTimingEvent)
+    {
+        OsDeleteEvent(S_AcycThreadParam.pvTimingEvent);
+        S_AcycThreadParam.pvTimingEvent = EC_NULL;
+    }
+    /* write the last cycles and stop timeline trace */
+    TraceDeinit(S_DemoCfg.bTrace);
+    InputChangeDeinit(&S_oInputChange);
+    PdSnapshotDeinit(&S_oPdSnapshot);
+    SafeOsFree(S_pbyDiagSnapshot);
+    PdShmDestroy(&S_oPdShm);
+    PdRecDeinit();
+    PdForceDeinit(&S_oPdForce);
+    SlaveRegistryDeinit(&S_oSlaveRegistry);
+    FreeBusSlaveSnapshot();
 
 #ifdef ATEMRAS_SERVER
     /* Stop RAS server */
@@ -501,6 +727,70 @@ Exit:
     return dwRetVal;
 }
 
+/********************************************************************************/
+/** \brief  Replay recorded process data through the demo application without EtherCAT master.
+*
+* The slaves of the application are searched in the slave table of the recording,
+* the recorded inputs are fed cycle by cycle into myAppWorkpd() and the application
+* tasks and the produced outputs are compared with the recorded outputs. Recorded
+* output forcing is applied like in tEcJobTask.
+*
+* \return  EC_E_NOERROR if the outputs match the recording, error code otherwise.
+*/
+EC_T_DWORD ATEMDemoReplay(
+    CAtEmLogging*       poLog
+   ,const EC_T_CHAR*    szFileName          /* [in]  recorder file, e.g. pdrec_0.bin */
+   ,EC_T_BOOL           bPaced              /* [in]  EC_TRUE: paced to the recorded bus cycle time */
+   ,EC_T_INT            nVerbose            /* [in]  verbosity level */
+)
+{
+    EC_T_DWORD       dwRetVal = EC_E_NOERROR;
+    EC_T_DWORD       dwRes    = EC_E_NOERROR;
+    T_PD_REPLAY      oReplay;
+    T_REPLAY_CONTEXT oContext;
+
+    S_poLog = poLog;
+    dwRes = PdReplayOpen(&oReplay, szFileName);
+    if (EC_E_NOERROR != dwRes)
+    {
+        LogError("Cannot open process data recording %s: %s (0x%lx)", szFileName, ecatGetText(dwRes), dwRes);
+        dwRetVal = dwRes;
+        goto Exit;
+    }
+    LogMsg("Replay %s: %d cycles, %d slaves, %d input bytes, %d output bytes, cycle time %d usec", szFileName,
+        (EC_T_DWORD)(oReplay.qwEndCycle - oReplay.qwFirstCycle), oReplay.pHeader->dwNumSlaves,
+        oReplay.pHeader->dwInSize, oReplay.pHeader->dwOutSize, oReplay.pHeader->dwCycleTimeUsec);
+    S_pReplay = &oReplay;
+
+    dwRes = myAppInit(poLog, nVerbose);
+    if (EC_E_NOERROR != dwRes)
+    {
+        LogError((EC_T_CHAR*)"myAppInit failed, error code: 0x%x", dwRes);
+        dwRetVal = dwRes;
+        goto Exit;
+    }
+    dwRes = myAppPrepare(poLog, nVerbose);
+    if (EC_E_NOERROR != dwRes)
+    {
+        LogError((EC_T_CHAR*)"myAppPrepare failed, error code: 0x%x", dwRes);
+        dwRetVal = dwRes;
+        goto Exit;
+    }
+    oContext.poLog    = poLog;
+    oContext.nVerbose = nVerbose;
+    dwRetVal = PdReplayRun(&oReplay, bPaced, ReplayCycle, &oContext, poLog);
+
+Exit:
+    S_pReplay = EC_NULL;
+    InputChangeDeinit(&S_oInputChange);
+    PdSnapshotDeinit(&S_oPdSnapshot);
+    SafeOsFree(S_pbyDiagSnapshot);
+    SlaveRegistryDeinit(&S_oSlaveRegistry);
+    PdReplayClose(&oReplay);
+
+    return dwRetVal;
+}
+
 
 /********************************************************************************/
 /** \brief  Trigger jobs to drive master, and update process data.
@@ -513,8 +803,14 @@ static EC_T_VOID tEcJobTask(EC_T_VOID* pvThreadParamDesc)
     T_DEMO_THREAD_PARAM* pDemoThreadParam  = (T_DEMO_THREAD_PARAM*)pvThreadParamDesc;
     EC_T_CPUSET          CpuSet;
     EC_T_BOOL            bPrevCycProcessed = EC_FALSE;
-    EC_T_INT             nOverloadCounter  = 0;               /* counter to check if cycle time is to short */
+    EC_T_UINT64          qwWake            = 0;
+    EC_T_DWORD           dwSendRes         = EC_E_NOERROR;
+    EC_T_DWORD           dwRecFlags        = 0;
+    EC_T_DWORD           dwAppTaskCycle    = 0;
+    EC_T_DWORD           dwAcycMissedInRow = 0;
+    const T_PD_FORCE_SET* pForceSet        = EC_NULL;
     EC_T_BOOL            bOk;
+    T_TRACE_CYCLE        oTraceCycle;
 
     EC_CPUSET_ZERO(CpuSet);
     EC_CPUSET_SET(CpuSet, pDemoThreadParam->dwCpuIndex);
@@ -524,6 +820,11 @@ static EC_T_VOID tEcJobTask(EC_T_VOID* pvThreadParamDesc)
         LogError("Error: Set job task affinity, invalid CPU index %d\n", pDemoThreadParam->dwCpuIndex);
         goto Exit;
     }
+    if (S_DemoCfg.bFusedTiming)
+    {
+        DeadlineTimerInit(&S_oJobDeadlineTimer, pDemoThreadParam->dwBusCycleTimeUsec, S_DemoCfg.dwWakeAheadUsec);
+        DeadlineTimerSetWaitPolicy(&S_oJobDeadlineTimer, S_DemoCfg.eWaitPolicy, S_DemoCfg.dwSpinUsec);
+    }
     /* demo loop */
     pDemoThreadParam->bJobThreadRunning = EC_TRUE;
     do
@@ -532,11 +833,23 @@ static EC_T_VOID tEcJobTask(EC_T_VOID* pvThreadParamDesc)
 #if (defined RTAI)
         OsSleepTillTick(); /* period is set after creating jobtask */
 #else
-        OsWaitForEvent(pDemoThreadParam->pvTimingEvent, EC_WAITINFINITE);
+        if (S_DemoCfg.bFusedTiming)
+        {
+            /* fused timing: sleep until the next period boundary without a thread handoff */
+            DeadlineTimerWait(&S_oJobDeadlineTimer);
+        }
+        else
+        {
+            OsWaitForEvent(pDemoThreadParam->pvTimingEvent, EC_WAITINFINITE);
+        }
 #endif
 
         PERF_JOB_END(PERF_CycleTime);
         PERF_JOB_START(PERF_CycleTime);
+        PERF_JOB_START(PERF_FrameDeparture);
+        qwWake = DeadlineTimerGetTime();
+        PerfWakeUpErrorRecord(qwWake);
+        oTraceCycle.qwWake = TraceGetTime();
 
         /* process all received frames (read new input values) */
         PERF_JOB_START(JOB_ProcessAllRxFrames);
@@ -547,26 +860,26 @@ static EC_T_VOID tEcJobTask(EC_T_VOID* pvThreadParamDesc)
         }
         PERF_JOB_END(JOB_ProcessAllRxFrames);
 
-        if (EC_E_NOERROR == dwRes)
+        dwRecFlags = bPrevCycProcessed ? 0 : PD_REC_FLAG_FRAME_LOSS;
+        if (EC_E_NOERROR != dwRes)
         {
-            if (!bPrevCycProcessed)
-            {
-                /* it is not reasonable, that more than 5 continuous frames are lost */
-                nOverloadCounter += 10;
-                if (nOverloadCounter >= 50)
-                {
-                    LogError( "Error: System overload: Cycle time too short or huge jitter!" );
-                }
-                else
-                {
-                    LogError( "eUsrJob_ProcessAllRxFrames - not all previously sent frames are received/processed (frame loss)!" );
-                }
-            }
-            else
-            {
-                /* everything o.k.? If yes, decrement overload counter */
-                if (nOverloadCounter > 0)    nOverloadCounter--;
-            }
+            /* no frame loss detection without processed frames, e.g. link disconnected */
+            bPrevCycProcessed = EC_TRUE;
+            dwRecFlags = PD_REC_FLAG_NO_RX;
+        }
+        else
+        {
+            /* find slaves with changed inputs */
+            InputChangeDetect(&S_oInputChange, ecatGetProcessImageInputPtr());
+        }
+        oTraceCycle.qwRxDone = TraceGetTime();
+
+        if (S_DemoCfg.bPipelined)
+        {
+            /* pipelined: send the output values of the previous cycle right after the inputs are read */
+            dwRecFlags |= PD_REC_FLAG_PIPELINED;
+            dwSendRes = JobSendAllCycFrames();
+            oTraceCycle.qwTxDone = TraceGetTime();
         }
 
         /*****************************************************/
@@ -583,39 +896,82 @@ static EC_T_VOID tEcJobTask(EC_T_VOID* pvThreadParamDesc)
 			}
 		}
         PERF_JOB_END(PERF_myAppWorkpd);
+        dwAppTaskCycle = S_oAppTaskTable.dwCycle;
+        RunAppTasks(pDemoThreadParam->pLogInst, pDemoThreadParam->pNotInst->Verbose(), ecatGetProcessImageInputPtr(), ecatGetProcessImageOutputPtr());
+        oTraceCycle.qwAppDone = TraceGetTime();
 
-        /* write output values of current cycle, by sending all cyclic frames */
-        PERF_JOB_START(JOB_SendAllCycFrames);
-        dwRes = ecatExecJob( eUsrJob_SendAllCycFrames, EC_NULL );
-        if (EC_E_NOERROR != dwRes && EC_E_INVALIDSTATE != dwRes && EC_E_LINK_DISCONNECTED != dwRes)
+        if (!S_DemoCfg.bPipelined)
         {
-            LogError("ecatExecJob( eUsrJob_SendAllCycFrames,    EC_NULL ): %s (0x%lx)", ecatGetText(dwRes), dwRes);
+            /* write output values of current cycle, by sending all cyclic frames */
+            dwSendRes = JobSendAllCycFrames();
+            oTraceCycle.qwTxDone = TraceGetTime();
         }
-        PERF_JOB_END(JOB_SendAllCycFrames);
 
         /* remove this code when using licensed version */
-        if (EC_E_EVAL_EXPIRED == dwRes )
+        if (EC_E_EVAL_EXPIRED == dwSendRes )
         {
             bRun = EC_FALSE;        /* set shutdown flag */
         }
 
-        /* Execute some administrative jobs. No bus traffic is performed by this function */
-        PERF_JOB_START(JOB_MasterTimer);
-        dwRes = ecatExecJob(eUsrJob_MasterTimer, EC_NULL);
-        if (EC_E_NOERROR != dwRes && EC_E_INVALIDSTATE != dwRes)
+        if (S_DemoCfg.bAcycThread)
+        {
+            /* never wait for the lower priority tEcAcycJobTask, at most one pass is in flight */
+            if (ACYC_PASS_RUNNING == S_dwAcycPassState)
+            {
+                S_dwAcycPassesDeferred++;
+                dwAcycMissedInRow = 0;
+            }
+            else if (ACYC_PASS_PENDING == S_dwAcycPassState)
+            {
+                S_dwAcycPassesMissed++;
+                dwAcycMissedInRow++;
+                if ((dwAcycMissedInRow >= ACYC_PASS_MAX_MISSED) && AcycPassRevoke())
+                {
+                    /* tEcAcycJobTask starved, keep the master state machine running */
+                    S_dwAcycPassesInline++;
+                    dwAcycMissedInRow = 0;
+                    JobMasterTimer();
+                    JobSendAcycFrames();
+                }
+            }
+            else
+            {
+                /* cyclic part done, let tEcAcycJobTask execute the administrative and acyclic jobs */
+                dwAcycMissedInRow = 0;
+                DEMO_MEMORY_BARRIER();
+                S_dwAcycPassState = ACYC_PASS_PENDING;
+                OsSetEvent(S_AcycThreadParam.pvTimingEvent);
+            }
+            oTraceCycle.qwTimerDone = TraceGetTime();
+        }
+        else
         {
-            LogError("ecatExecJob(eUsrJob_MasterTimer, EC_NULL): %s (0x%lx)", ecatGetText(dwRes), dwRes);
+            JobMasterTimer();
+            oTraceCycle.qwTimerDone = TraceGetTime();
+            JobSendAcycFrames();
         }
-        PERF_JOB_END(JOB_MasterTimer);
 
-        /* send queued acyclic EtherCAT frames */
-        PERF_JOB_START(JOB_SendAcycFrames);
-        dwRes = ecatExecJob(eUsrJob_SendAcycFrames, EC_NULL);
-        if (EC_E_NOERROR != dwRes && EC_E_INVALIDSTATE != dwRes && EC_E_LINK_DISCONNECTED != dwRes)
+        /* publish a consistent copy of the subscribed process data for the non real-time threads */
+        PdSnapshotPublish(&S_oPdSnapshot, ecatGetProcessImageInputPtr(), ecatGetProcessImageOutputPtr(), qwWake);
+        PdShmPublish(&S_oPdShm, ecatGetProcessImageInputPtr(), ecatGetProcessImageOutputPtr(), qwWake);
+        pForceSet = PdForceGetApplied(&S_oPdForce);
+        PdRecRecord(ecatGetProcessImageInputPtr(), ecatGetProcessImageOutputPtr(),
+                    (EC_NULL != pForceSet) ? pForceSet->pbyAnd : EC_NULL, (EC_NULL != pForceSet) ? pForceSet->pbyOr : EC_NULL,
+                    qwWake, dwRecFlags, pDemoThreadParam->pNotInst->ErrorCounter(EC_NOTIFY_CYCCMD_WKC_ERROR), dwAppTaskCycle);
+
+        /* account deadline misses, reported by the main thread */
+        OverrunCycleDone(&S_oOverrun, qwWake, DeadlineTimerGetTime(), bPrevCycProcessed);
+
+        /* store cycle in timeline trace, write trace if frames were lost or the deadline was missed */
+        oTraceCycle.qwAcycDone          = TraceGetTime();
+        oTraceCycle.dwConsecutiveMisses = S_oOverrun.oStats.dwConsecutiveMisses;
+        oTraceCycle.bPrevCycProcessed   = bPrevCycProcessed;
+        oTraceCycle.bPipelined          = S_DemoCfg.bPipelined;
+        TraceCycleAdd(&oTraceCycle);
+        if (!bPrevCycProcessed || (0 != oTraceCycle.dwConsecutiveMisses))
         {
-            LogError("ecatExecJob(eUsrJob_SendAcycFrames, EC_NULL): %s (0x%lx)", ecatGetText(dwRes), dwRes);
+            TraceRequestDump();
         }
-        PERF_JOB_END(JOB_SendAcycFrames);
 
 #if !(defined NO_OS)
     } while (!pDemoThreadParam->bJobThreadShutdown);
@@ -637,205 +993,990 @@ Exit:
 }
 
 /********************************************************************************/
-/** \brief  Handler for master notifications
+/** \brief  Execute administrative and acyclic jobs with lower priority.
 *
-* \return  Status value.
+* The task is triggered by tEcJobTask after the cyclic frames are sent. The pass
+* state keeps the order the master requires: the jobs never overlap with the
+* cyclic jobs of tEcJobTask. tEcJobTask never waits for this task, it revokes a
+* pass which did not start until the next cycle and skips a cycle while a pass
+* is running.
+*
+* \return N/A
 */
-static EC_T_DWORD ecatNotifyCallback(
-    EC_T_DWORD         dwCode,  /**< [in]   Notification code */
-    EC_T_NOTIFYPARMS*  pParms   /**< [in]   Notification parameters */
-                                         )
+static EC_T_VOID tEcAcycJobTask(EC_T_VOID* pvThreadParamDesc)
 {
-    EC_T_DWORD         dwRetVal                = EC_E_NOERROR;
-    CEmNotification*   pNotifyInstance;
+    T_DEMO_THREAD_PARAM* pAcycThreadParam = (T_DEMO_THREAD_PARAM*)pvThreadParamDesc;
+    EC_T_CPUSET          CpuSet;
+    EC_T_BOOL            bOk;
 
-    if ((EC_NULL == pParms)||(EC_NULL==pParms->pCallerData))
+    EC_CPUSET_ZERO(CpuSet);
+    EC_CPUSET_SET(CpuSet, pAcycThreadParam->dwCpuIndex);
+    bOk = OsSetThreadAffinity(EC_NULL, CpuSet);
+    if (!bOk)
     {
-        dwRetVal = EC_E_INVALIDPARM;
+        LogError("Error: Set acyclic job task affinity, invalid CPU index %d\n", pAcycThreadParam->dwCpuIndex);
         goto Exit;
     }
-
-    /* notification for application ? */
-    if ((dwCode >= EC_NOTIFY_APP) && (dwCode <= EC_NOTIFY_APP+EC_NOTIFY_APP_MAX_CODE))
-    {
-        /*****************************************************/
-        /* Demo code: Remove/change this in your application */
-        /* to get here the API ecatNotifyApp(dwCode, pParms) has to be called */
-        /*****************************************************/
-        dwRetVal = myAppNotify(dwCode-EC_NOTIFY_APP, pParms);
-    }
-    else
+    pAcycThreadParam->bJobThreadRunning = EC_TRUE;
+    while (!pAcycThreadParam->bJobThreadShutdown)
     {
-        pNotifyInstance = (CEmNotification*)pParms->pCallerData;
-
-        /* call the default handler */
-        dwRetVal = pNotifyInstance->ecatNotify(dwCode, pParms);
+        /* wait for the end of the cyclic part, timeout to check for shutdown */
+        if (EC_E_NOERROR != OsWaitForEvent(pAcycThreadParam->pvTimingEvent, 10))
+        {
+            continue;
+        }
+#if (defined DEMO_ATOMIC_CAS_SUPPORTED)
+        if (!DEMO_ATOMIC_CAS(&S_dwAcycPassState, ACYC_PASS_PENDING, ACYC_PASS_RUNNING))
+        {
+            /* revoked by tEcJobTask, the starved pass ran inline */
+            continue;
+        }
+#endif
+        JobMasterTimer();
+        JobSendAcycFrames();
+        DEMO_MEMORY_BARRIER();
+        S_dwAcycPassState = ACYC_PASS_IDLE;
     }
+    pAcycThreadParam->bJobThreadRunning = EC_FALSE;
 
 Exit:
-    return dwRetVal;
+#if (defined EC_VERSION_RTEMS)
+    rtems_task_delete(RTEMS_SELF);
+#endif
+    return;
 }
 
-
 /********************************************************************************/
-/** \brief  Handler for master RAS notifications
-*
+/** \brief  Take back a pass handed off to tEcAcycJobTask which did not start yet.
 *
-* \return  Status value.
+* \return EC_TRUE if tEcJobTask owns the jobs now, EC_FALSE if tEcAcycJobTask started the pass.
 */
-#ifdef ATEMRAS_SERVER 
-static EC_T_DWORD RasNotifyWrapper(
-                            EC_T_DWORD         dwCode, 
-                            EC_T_NOTIFYPARMS*  pParms
-                            )
+static EC_T_BOOL AcycPassRevoke(EC_T_VOID)
 {
-    EC_T_DWORD                      dwRetVal                = EC_E_NOERROR;
-    CEmNotification*                pNotInst                = EC_NULL;
-    
-    if ((EC_NULL == pParms)||(EC_NULL==pParms->pCallerData))
+#if (defined DEMO_ATOMIC_CAS_SUPPORTED)
+    if (DEMO_ATOMIC_CAS(&S_dwAcycPassState, ACYC_PASS_PENDING, ACYC_PASS_IDLE))
     {
-        dwRetVal = EC_E_INVALIDPARM;
-        goto Exit;
+        return EC_TRUE;
     }
-    
-    pNotInst = (CEmNotification*)(pParms->pCallerData);
-    dwRetVal = pNotInst->emRasNotify(dwCode, pParms);
-Exit:
-    
-    return dwRetVal;
-}
 #endif
+    return (ACYC_PASS_IDLE == S_dwAcycPassState) ? EC_TRUE : EC_FALSE;
+}
 
-/*-MYAPP---------------------------------------------------------------------*/
-#define MBX_TIMEOUT                         5000
+/********************************************************************************/
+/** \brief  Execute some administrative jobs. No bus traffic is performed by this function.
+*
+* \return N/A
+*/
+static EC_T_VOID JobMasterTimer(EC_T_VOID)
+{
+    EC_T_DWORD dwRes = EC_E_ERROR;
 
-#define EL4132_INDEX_USER_SCALE             0x40A2
-#define EL4132_SUBINDEX_USRSCL_NUMELEM         0
-#define EL4132_SUBINDEX_USRSCL_OFFSET          1
-#define EL4132_SUBINDEX_USRSCL_GAIN            2
+    PERF_JOB_START(JOB_MasterTimer);
+    dwRes = ecatExecJob(eUsrJob_MasterTimer, EC_NULL);
+    if (EC_E_NOERROR != dwRes && EC_E_INVALIDSTATE != dwRes)
+    {
+        LogError("ecatExecJob(eUsrJob_MasterTimer, EC_NULL): %s (0x%lx)", ecatGetText(dwRes), dwRes);
+    }
+    PERF_JOB_END(JOB_MasterTimer);
+}
 
-#define DEMO_MAX_NUM_OF_SLAVES  5
-#define SLAVE_NOT_FOUND         0xFFFF
-static EC_T_DWORD               S_dwAppFoundSlaves = 0;
-static EC_T_CFG_SLAVE_INFO      S_aSlaveList[DEMO_MAX_NUM_OF_SLAVES];
-static EC_T_DWORD               S_dwSlaveIdx14        = SLAVE_NOT_FOUND;
-static EC_T_DWORD               S_dwSlaveIdx24        = SLAVE_NOT_FOUND;
-static EC_T_DWORD               S_dwSlaveIdx4132      = SLAVE_NOT_FOUND;
-static EC_T_DWORD               S_dwSlaveIdxETCio100  = SLAVE_NOT_FOUND;
+/********************************************************************************/
+/** \brief  Send queued acyclic EtherCAT frames.
+*
+* \return N/A
+*/
+static EC_T_VOID JobSendAcycFrames(EC_T_VOID)
+{
+    EC_T_DWORD dwRes = EC_E_ERROR;
 
-/***************************************************************************************************/
-/**
-\brief  Initialize Application
+    PERF_JOB_START(JOB_SendAcycFrames);
+    dwRes = ecatExecJob(eUsrJob_SendAcycFrames, EC_NULL);
+    if (EC_E_NOERROR != dwRes && EC_E_INVALIDSTATE != dwRes && EC_E_LINK_DISCONNECTED != dwRes)
+    {
+        LogError("ecatExecJob(eUsrJob_SendAcycFrames, EC_NULL): %s (0x%lx)", ecatGetText(dwRes), dwRes);
+    }
+    PERF_JOB_END(JOB_SendAcycFrames);
+}
 
-\return EC_E_NOERROR on success, error code otherwise.
+/********************************************************************************/
+/** \brief  Write output values by sending all cyclic frames.
+*
+* \return  Status value.
 */
-static EC_T_DWORD myAppInit(
-    CAtEmLogging*       poLog,          /* [in]  Logging instance */ 
-    EC_T_INT            nVerbose        /* [in]  Verbosity level */
-    )
+static EC_T_DWORD JobSendAllCycFrames(EC_T_VOID)
 {
-    EC_UNREFPARM(poLog);
-    EC_UNREFPARM(nVerbose);
+    EC_T_DWORD dwRes = EC_E_ERROR;
 
-    S_dwAppFoundSlaves = 0;
-    OsMemset(S_aSlaveList, 0, DEMO_MAX_NUM_OF_SLAVES*sizeof(EC_T_CFG_SLAVE_INFO));
-    S_dwSlaveIdx14       = SLAVE_NOT_FOUND;
-    S_dwSlaveIdx24       = SLAVE_NOT_FOUND;
-    S_dwSlaveIdx4132     = SLAVE_NOT_FOUND;
-    S_dwSlaveIdxETCio100 = SLAVE_NOT_FOUND;
+    /* forced output bits overrule the application */
+    PdForceApply(&S_oPdForce, ecatGetProcessImageOutputPtr());
 
-    return EC_E_NOERROR;
+    PERF_JOB_START(JOB_SendAllCycFrames);
+    dwRes = ecatExecJob( eUsrJob_SendAllCycFrames, EC_NULL );
+    if (EC_E_NOERROR != dwRes && EC_E_INVALIDSTATE != dwRes && EC_E_LINK_DISCONNECTED != dwRes)
+    {
+        LogError("ecatExecJob( eUsrJob_SendAllCycFrames,    EC_NULL ): %s (0x%lx)", ecatGetText(dwRes), dwRes);
+    }
+    PERF_JOB_END(JOB_SendAllCycFrames);
+    PERF_JOB_END(PERF_FrameDeparture);
+
+    return dwRes;
 }
 
-/***************************************************************************************************/
+/********************************************************************************/
+/** \brief  Show job time percentiles and wake-up error next to the job times.
+*
+* The wake-up statistics of the timer are only shown if the job task waits for its
+* own deadline, tEcTimingTask shows them on exit.
+*
+* \return N/A
+*/
+static EC_T_VOID ShowJobStatistics(EC_T_VOID)
+{
+    EC_T_DWORD       dwJobIndex = 0;
+    T_OVERRUN_STATS  oOverrunStats;
+
+    if (!S_bEnaPerfJobs)
+    {
+        return;
+    }
+    LogMsg("Job time percentiles [usec], outliers:");
+    for (dwJobIndex = 0; dwJobIndex < MAX_JOB_NUM; dwJobIndex++)
+    {
+        if ((dwJobIndex >= PERF_AppTask0) && (dwJobIndex < PERF_WakeUpError) && ((dwJobIndex - PERF_AppTask0) >= S_oAppTaskTable.dwNumTasks))
+        {
+            /* unused application task slot */
+            continue;
+        }
+        LatencyHistoShow(&S_aJobHisto[dwJobIndex], S_poLog, S_aszMeasInfo[dwJobIndex], 1000);
+    }
+    if (S_DemoCfg.bFusedTiming)
+    {
+        DeadlineTimerShow(&S_oJobDeadlineTimer, S_poLog, "Wake-up error         ");
+    }
+    if (S_DemoCfg.bAcycThread)
+    {
+        LogMsg("tEcAcycJobTask: %d cycles with the pass not started, %d with the pass running, %d passes run inline",
+            S_dwAcycPassesMissed, S_dwAcycPassesDeferred, S_dwAcycPassesInline);
+    }
+    OverrunGetSnapshot(&S_oOverrun, &oOverrunStats);
+    OverrunShow(&oOverrunStats, S_poLog);
+}
+
+/********************************************************************************/
+/** \brief  Clear job time histograms and wake-up error, e.g. after the startup phase.
+*
+* \return N/A
+*/
+static EC_T_VOID ResetJobStatistics(EC_T_VOID)
+{
+    EC_T_DWORD dwJobIndex = 0;
+
+    for (dwJobIndex = 0; dwJobIndex < MAX_JOB_NUM; dwJobIndex++)
+    {
+        LatencyHistoReset(&S_aJobHisto[dwJobIndex]);
+    }
+    DeadlineTimerResetStats(&S_oJobDeadlineTimer);
+    OverrunReset(&S_oOverrun);
+    S_dwAcycPassesMissed   = 0;
+    S_dwAcycPassesDeferred = 0;
+    S_dwAcycPassesInline   = 0;
+}
+
+/********************************************************************************/
+/** \brief  One cycle of ATEMDemoReplay(), same application calls as tEcJobTask.
+*
+* \return EC_E_NOERROR
+*/
+static EC_T_DWORD ReplayCycle(EC_T_VOID* pvContext, const T_PD_REC_RECORD* pRecord, EC_T_BYTE* pbyPDIn, EC_T_BYTE* pbyPDOut)
+{
+    T_REPLAY_CONTEXT* pContext = (T_REPLAY_CONTEXT*)pvContext;
+
+    /* the recording may start at any cycle, run the application tasks in the recorded phase */
+    S_oAppTaskTable.dwCycle = pRecord->dwAppTaskCycle % S_oAppTaskTable.dwCycleWrap;
+
+    /* the job task does not detect input changes without received frames */
+    if (0 == (pRecord->dwFlags & PD_REC_FLAG_NO_RX))
+    {
+        InputChangeDetect(&S_oInputChange, pbyPDIn);
+    }
+    myAppWorkpd(pContext->poLog, pContext->nVerbose, pbyPDIn, pbyPDOut);
+    RunAppTasks(pContext->poLog, pContext->nVerbose, pbyPDIn, pbyPDOut);
+
+    return EC_E_NOERROR;
+}
+
+/********************************************************************************/
+/** \brief  Run the application tasks due in this cycle, each in its own PERF slot.
+*
+* \return N/A
+*/
+static EC_T_VOID RunAppTasks(CAtEmLogging* poLog, EC_T_INT nVerbose, EC_T_BYTE* pbyPDIn, EC_T_BYTE* pbyPDOut)
+{
+    EC_T_DWORD dwTaskIndex = 0;
+
+    if ((EC_NULL != pbyPDIn) && (EC_NULL != pbyPDOut))
+    {
+        for (dwTaskIndex = 0; dwTaskIndex < S_oAppTaskTable.dwNumTasks; dwTaskIndex++)
+        {
+            if (AppTaskIsDue(&S_oAppTaskTable, dwTaskIndex))
+            {
+                PERF_JOB_START(PERF_AppTask0 + dwTaskIndex);
+                S_oAppTaskTable.aTask[dwTaskIndex].pfnTask(poLog, nVerbose, pbyPDIn, pbyPDOut);
+                PERF_JOB_END(PERF_AppTask0 + dwTaskIndex);
+            }
+        }
+    }
+    AppTaskNextCycle(&S_oAppTaskTable);
+}
+
+/********************************************************************************/
+/** \brief  Report new deadline misses of tEcJobTask.
+*
+* Called by the main thread, the job task only counts the misses.
+*
+* \return N/A
+*/
+static EC_T_VOID CheckOverrun(T_OVERRUN_STATS* pLastStats)
+{
+    T_OVERRUN_STATS oStats;
+
+    OverrunGetSnapshot(&S_oOverrun, &oStats);
+    if (oStats.dwNumCycles < pLastStats->dwNumCycles)
+    {
+        /* statistics were reset */
+        OsMemset(pLastStats, 0, sizeof(T_OVERRUN_STATS));
+    }
+    if (oStats.dwNumMisses != pLastStats->dwNumMisses)
+    {
+        if (oStats.dwConsecutiveMisses >= OVERRUN_OVERLOAD_LIMIT)
+        {
+            LogError("Error: System overload: Cycle time too short or huge jitter! %d consecutive deadline misses", oStats.dwConsecutiveMisses);
+        }
+        if (oStats.dwNumLostFrames != pLastStats->dwNumLostFrames)
+        {
+            LogError("eUsrJob_ProcessAllRxFrames - not all previously sent frames are received/processed (frame loss)! %d cycles",
+                oStats.dwNumLostFrames - pLastStats->dwNumLostFrames);
+        }
+        if (oStats.dwNumLateWakeUps != pLastStats->dwNumLateWakeUps)
+        {
+            LogError("Deadline miss: job task woke up late, %d cycles", oStats.dwNumLateWakeUps - pLastStats->dwNumLateWakeUps);
+        }
+        if (oStats.dwNumLongApp != pLastStats->dwNumLongApp)
+        {
+            LogError("Deadline miss: job task cycle too long, %d cycles", oStats.dwNumLongApp - pLastStats->dwNumLongApp);
+        }
+    }
+    OsMemcpy(pLastStats, &oStats, sizeof(T_OVERRUN_STATS));
+}
+
+/********************************************************************************/
+/** \brief  Re-read the force file and hand changes over to tEcJobTask.
+*
+* Called by the main thread, the job task only applies the committed set.
+*
+* \return N/A
+*/
+static EC_T_VOID CheckPdForce(EC_T_DWORD* pdwLastRes)
+{
+    EC_T_DWORD dwNumCommits = S_oPdForce.dwNumCommits;
+    EC_T_DWORD dwRes        = EC_E_NOERROR;
+
+    dwRes = PdForceLoadFile(&S_oPdForce, S_DemoCfg.szPdForceFile);
+    if (EC_E_NOERROR == dwRes)
+    {
+        dwRes = PdForceCommit(&S_oPdForce, PD_FORCE_COMMIT_TIMEOUT);
+    }
+    if ((EC_E_NOERROR != dwRes) && (*pdwLastRes != dwRes))
+    {
+        LogError("Cannot force outputs from %s! %s (0x%lx)", S_DemoCfg.szPdForceFile, ecatGetText(dwRes), dwRes);
+    }
+    *pdwLastRes = dwRes;
+    if (dwNumCommits != S_oPdForce.dwNumCommits)
+    {
+        LogMsg("Output forcing: %d bits forced", S_oPdForce.aSet[S_oPdForce.dwNumCommits % PD_FORCE_NUM_SETS].dwNumForcedBits);
+    }
+}
+
+/********************************************************************************/
+/** \brief  Get the size of the process images covered by the configured slaves.
+*
+* Valid after myAppPrepare() built the slave registry.
+*
+* \return N/A
+*/
+static EC_T_VOID GetPdImageSizes(EC_T_DWORD* pdwInSize, EC_T_DWORD* pdwOutSize, EC_T_DWORD* pdwNumSlaves)
+{
+    T_SLAVE_REGISTRY* pRegistry  = &S_oSlaveRegistry;
+    EC_T_DWORD        dwSlaveIdx = 0;
+
+    *pdwInSize  = 0;
+    *pdwOutSize = 0;
+    for (dwSlaveIdx = 0; dwSlaveIdx < pRegistry->dwNumSlaves; dwSlaveIdx++)
+    {
+        if ((0 != pRegistry->pdwPdSizeIn[dwSlaveIdx]) && (((EC_T_DWORD)-1) != pRegistry->pdwPdOffsIn[dwSlaveIdx]))
+        {
+            *pdwInSize = EC_MAX(*pdwInSize, (pRegistry->pdwPdOffsIn[dwSlaveIdx] + pRegistry->pdwPdSizeIn[dwSlaveIdx] + 7) / 8);
+        }
+        if ((0 != pRegistry->pdwPdSizeOut[dwSlaveIdx]) && (((EC_T_DWORD)-1) != pRegistry->pdwPdOffsOut[dwSlaveIdx]))
+        {
+            *pdwOutSize = EC_MAX(*pdwOutSize, (pRegistry->pdwPdOffsOut[dwSlaveIdx] + pRegistry->pdwPdSizeOut[dwSlaveIdx] + 7) / 8);
+        }
+    }
+    if (EC_NULL != pdwNumSlaves)
+    {
+        *pdwNumSlaves = pRegistry->dwNumSlaves;
+    }
+}
+
+/********************************************************************************/
+/** \brief  Create the process data shared memory with the layout of all configured slaves.
+*
+* \return  EC_E_NOERROR on success, error code otherwise.
+*/
+static EC_T_DWORD PdShmExportInit(EC_T_DWORD dwBusCycleTimeUsec)
+{
+    EC_T_DWORD          dwRes           = EC_E_ERROR;
+    EC_T_DWORD          dwSlaveIdx      = 0;
+    EC_T_DWORD          dwNumSlaves     = 0;
+    EC_T_DWORD          dwInSize        = 0;
+    EC_T_DWORD          dwOutSize       = 0;
+
+    if ((EC_NULL == ecatGetProcessImageInputPtr()) || (EC_NULL == ecatGetProcessImageOutputPtr()))
+    {
+        /* no process data if ENI was generated with GenPreopENI */
+        return EC_E_NOERROR;
+    }
+    GetPdImageSizes(&dwInSize, &dwOutSize, &dwNumSlaves);
+    dwRes = PdShmCreate(&S_oPdShm, S_DemoCfg.szPdShmName, dwInSize, dwOutSize, dwNumSlaves, dwBusCycleTimeUsec);
+    if (EC_E_NOERROR != dwRes)
+    {
+        return dwRes;
+    }
+    for (dwSlaveIdx = 0; dwSlaveIdx < dwNumSlaves; dwSlaveIdx++)
+    {
+        PdShmAddSlave(&S_oPdShm, &S_oSlaveRegistry.pCfgSlaveInfo[dwSlaveIdx]);
+    }
+    PdShmEnable(&S_oPdShm);
+    LogMsg("Process data exported to shared memory %s: %d slaves, %d input bytes, %d output bytes",
+        S_DemoCfg.szPdShmName, S_oPdShm.pHeader->dwNumSlaves, dwInSize, dwOutSize);
+
+    return EC_E_NOERROR;
+}
+
+/********************************************************************************/
+/** \brief  Store start time of a job for the job time histogram.
+*
+* \return N/A
+*/
+static EC_T_VOID PerfJobHistoStart(EC_T_DWORD dwJobIndex)
+{
+    if (S_bEnaPerfJobs)
+    {
+        S_aqwJobStartTime[dwJobIndex] = DeadlineTimerGetTime();
+    }
+}
+
+/********************************************************************************/
+/** \brief  Add job time to the job time histogram. Nothing is allocated here.
+*
+* \return N/A
+*/
+static EC_T_VOID PerfJobHistoEnd(EC_T_DWORD dwJobIndex)
+{
+    EC_T_UINT64 qwStartTime = S_aqwJobStartTime[dwJobIndex];
+
+    /* PERF_CycleTime ends before it is started the first time */
+    if (S_bEnaPerfJobs && (0 != qwStartTime))
+    {
+        LatencyHistoRecord(&S_aJobHisto[dwJobIndex],
+            (EC_T_DWORD)EC_MIN(DeadlineTimerGetTime() - qwStartTime, (EC_T_UINT64)0xFFFFFFFF));
+    }
+}
+
+/********************************************************************************/
+/** \brief  Add the delay from the scheduled wake-up to the start of the cycle to the
+*          PERF_WakeUpError histogram.
+*
+* The scheduled wake-up is taken from the deadline timer of the job task (-fused) or
+* of tEcTimingTask (-deadline). The TSC measurement has no slot for it, because it
+* starts at the deadline when no thread is running.
+*
+* \return N/A
+*/
+static EC_T_VOID PerfWakeUpErrorRecord(EC_T_UINT64 qwWake)
+{
+    T_DEADLINE_TIMER* pTimer   = S_DemoCfg.bFusedTiming ? &S_oJobDeadlineTimer : S_DemoCfg.pTimingDeadlineTimer;
+    EC_T_UINT64       qwWakeUp = 0;
+
+    if (!S_bEnaPerfJobs || (EC_NULL == pTimer))
+    {
+        return;
+    }
+    qwWakeUp = pTimer->qwLastWakeUp;
+    if (0 != qwWakeUp)
+    {
+        /* early wake-ups (hybrid or spin wait) count as 0 */
+        LatencyHistoRecord(&S_aJobHisto[PERF_WakeUpError],
+            (EC_T_DWORD)EC_MIN(((qwWake > qwWakeUp) ? (qwWake - qwWakeUp) : 0), (EC_T_UINT64)0xFFFFFFFF));
+    }
+}
+
+/********************************************************************************/
+/** \brief  Handler for master notifications
+*
+* \return  Status value.
+*/
+static EC_T_DWORD ecatNotifyCallback(
+    EC_T_DWORD         dwCode,  /**< [in]   Notification code */
+    EC_T_NOTIFYPARMS*  pParms   /**< [in]   Notification parameters */
+                                         )
+{
+    EC_T_DWORD         dwRetVal                = EC_E_NOERROR;
+    CEmNotification*   pNotifyInstance;
+
+    if ((EC_NULL == pParms)||(EC_NULL==pParms->pCallerData))
+    {
+        dwRetVal = EC_E_INVALIDPARM;
+        goto Exit;
+    }
+
+    /* notification for application ? */
+    if ((dwCode >= EC_NOTIFY_APP) && (dwCode <= EC_NOTIFY_APP+EC_NOTIFY_APP_MAX_CODE))
+    {
+        /*****************************************************/
+        /* Demo code: Remove/change this in your application */
+        /* to get here the API ecatNotifyApp(dwCode, pParms) has to be called */
+        /*****************************************************/
+        dwRetVal = myAppNotify(dwCode-EC_NOTIFY_APP, pParms);
+    }
+    else
+    {
+        pNotifyInstance = (CEmNotification*)pParms->pCallerData;
+
+        /* call the default handler */
+        dwRetVal = pNotifyInstance->ecatNotify(dwCode, pParms);
+    }
+
+Exit:
+    return dwRetVal;
+}
+
+
+/********************************************************************************/
+/** \brief  Handler for master RAS notifications
+*
+*
+* \return  Status value.
+*/
+#ifdef ATEMRAS_SERVER 
+static EC_T_DWORD RasNotifyWrapper(
+                            EC_T_DWORD         dwCode, 
+                            EC_T_NOTIFYPARMS*  pParms
+                            )
+{
+    EC_T_DWORD                      dwRetVal                = EC_E_NOERROR;
+    CEmNotification*                pNotInst                = EC_NULL;
+    
+    if ((EC_NULL == pParms)||(EC_NULL==pParms->pCallerData))
+    {
+        dwRetVal = EC_E_INVALIDPARM;
+        goto Exit;
+    }
+    
+    pNotInst = (CEmNotification*)(pParms->pCallerData);
+    dwRetVal = pNotInst->emRasNotify(dwCode, pParms);
+Exit:
+    
+    return dwRetVal;
+}
+#endif
+
+/*-MYAPP---------------------------------------------------------------------*/
+#define MBX_TIMEOUT                         5000
+
+#define EL4132_INDEX_USER_SCALE             0x40A2
+#define EL4132_SUBINDEX_USRSCL_NUMELEM         0
+#define EL4132_SUBINDEX_USRSCL_OFFSET          1
+#define EL4132_SUBINDEX_USRSCL_GAIN            2
+
+#define SLAVE_NOT_FOUND         SLAVE_REGISTRY_NOT_FOUND
+/* demo slaves, index in S_oSlaveRegistry */
+static EC_T_DWORD               S_dwSlaveIdx14        = SLAVE_NOT_FOUND;
+static EC_T_DWORD               S_dwSlaveIdx24        = SLAVE_NOT_FOUND;
+static EC_T_DWORD               S_dwSlaveIdx4132      = SLAVE_NOT_FOUND;
+static EC_T_DWORD               S_dwSlaveIdxETCio100  = SLAVE_NOT_FOUND;
+
+/* process data variables, resolved in myAppPrepare() */
+static CPdVar<EC_T_BYTE, ePdVarLayout_Bit>  S_oDigInput;        /* EL1004, EL1012, EL1014 */
+static CPdVar<EC_T_BYTE, ePdVarLayout_Bit>  S_oDigOutput;       /* EL2002, EL2004, EL2008 */
+static CPdVar<EC_T_WORD, ePdVarLayout_Byte> S_oEL4132Ch1;
+static CPdVar<EC_T_WORD, ePdVarLayout_Byte> S_oEL4132Ch2;
+static CPdVar<EC_T_BYTE, ePdVarLayout_Byte> S_oETCio100DigOut;
+static CPdVar<EC_T_WORD, ePdVarLayout_Byte> S_oETCio100Ao1;
+static CPdVar<EC_T_WORD, ePdVarLayout_Byte> S_oETCio100Ao2;
+static CPdVar<EC_T_BYTE, ePdVarLayout_Bit>  S_oDiagDigInput;    /* S_oDigInput in the snapshot copy of myAppDiagnosis() */
+static EC_T_DWORD               S_dwDigInputChangeIdx = SLAVE_NOT_FOUND;   /* digital input slave in S_oInputChange */
+static EC_T_DWORD               S_dwDigInputSnapshotIdx = SLAVE_NOT_FOUND; /* digital input range in S_oPdSnapshot */
+
+/***************************************************************************************************/
+/**
+\brief  Get the input process image, the replay image if ATEMDemoReplay() is running.
+
+\return pointer to the input process image, EC_NULL if not available.
+*/
+static EC_T_BYTE* myAppGetPdIn(EC_T_VOID)
+{
+    return (EC_NULL != S_pReplay) ? S_pReplay->pbyPDIn : ecatGetProcessImageInputPtr();
+}
+
+/***************************************************************************************************/
+/**
+\brief  Get the output process image, the replay image if ATEMDemoReplay() is running.
+
+\return pointer to the output process image, EC_NULL if not available.
+*/
+static EC_T_BYTE* myAppGetPdOut(EC_T_VOID)
+{
+    return (EC_NULL != S_pReplay) ? S_pReplay->pbyPDOut : ecatGetProcessImageOutputPtr();
+}
+
+/***************************************************************************************************/
+/**
+\brief  Get a configured slave by its position, from the recorded slave table if ATEMDemoReplay() is running.
+
+\return EC_E_NOERROR on success, error code otherwise.
+*/
+static EC_T_DWORD myAppGetCfgSlaveInfo(
+    EC_T_DWORD           dwSlavePos,      /* [in]  0: first slave in the configuration, 1: second, ... */
+    EC_T_CFG_SLAVE_INFO* pSlaveInfo       /* [out] slave information */
+    )
+{
+    if (EC_NULL == S_pReplay)
+    {
+        return ecatGetCfgSlaveInfo(EC_FALSE, (EC_T_WORD)(0 - dwSlavePos), pSlaveInfo);
+    }
+    return PdReplayGetSlave(S_pReplay, dwSlavePos, pSlaveInfo);
+}
+
+/***************************************************************************************************/
+/**
+\brief  Fill S_oSlaveRegistry with all configured slaves.
+
+\return EC_E_NOERROR on success, error code otherwise.
+*/
+static EC_T_DWORD myAppBuildSlaveRegistry(
+    CAtEmLogging*       poLog,          /* [in]  Logging instance */
+    EC_T_INT            nVerbose        /* [in]  Verbosity level */
+    )
+{
+    EC_T_DWORD          dwRes       = EC_E_ERROR;
+    EC_T_DWORD          dwNumSlaves = 0;
+    EC_T_CFG_SLAVE_INFO oCfgSlaveInfo;
+
+    EC_UNREFPARM(poLog);
+
+    for (dwNumSlaves = 0; dwNumSlaves < 0xFFFF; dwNumSlaves++)
+    {
+        if (EC_E_NOERROR != myAppGetCfgSlaveInfo(dwNumSlaves, &oCfgSlaveInfo))
+        {
+            break;
+        }
+    }
+    dwRes = SlaveRegistryInit(&S_oSlaveRegistry, dwNumSlaves);
+    if (EC_E_NOERROR != dwRes)
+    {
+        goto Exit;
+    }
+    for (dwNumSlaves = 0; dwNumSlaves < S_oSlaveRegistry.dwMaxSlaves; dwNumSlaves++)
+    {
+        if (EC_E_NOERROR != myAppGetCfgSlaveInfo(dwNumSlaves, &oCfgSlaveInfo))
+        {
+            break;
+        }
+        dwRes = SlaveRegistryAdd(&S_oSlaveRegistry, &oCfgSlaveInfo, EC_NULL);
+        if (EC_E_NOERROR != dwRes)
+        {
+            LogError("ERROR: cannot add slave %d (station address %d) to the slave registry: %s (0x%lx)",
+                oCfgSlaveInfo.dwSlaveId, oCfgSlaveInfo.wStationAddress, ecatGetText(dwRes), dwRes);
+        }
+    }
+    if (nVerbose >= 2)
+    {
+        LogMsg("Slave registry: %d configured slaves", S_oSlaveRegistry.dwNumSlaves);
+    }
+    dwRes = EC_E_NOERROR;
+Exit:
+    return dwRes;
+}
+
+/***************************************************************************************************/
 /**
-\brief  Initialize Slave Instance.
+\brief  Get the registry index of a slave found at the bus.
+
+\return index in S_oSlaveRegistry, SLAVE_NOT_FOUND if the slave is not configured.
+*/
+static EC_T_DWORD myAppGetSlaveIdx(
+    EC_T_WORD           wFixedAddress   /* [in]  station address */
+    )
+{
+    EC_T_DWORD dwSlaveIdx = SlaveRegistryFindByStation(&S_oSlaveRegistry, wFixedAddress);
+
+    if (SLAVE_NOT_FOUND == dwSlaveIdx)
+    {
+        LogError("ERROR: slave with station address %d is not configured.", wFixedAddress);
+    }
+    return dwSlaveIdx;
+}
+
+/***************************************************************************************************/
+/**
+\brief  FindSlaveGetFixedAddr(), from the recorded slave table if ATEMDemoReplay() is running.
+
+\return EC_TRUE if the slave was found.
+*/
+static EC_T_BOOL myAppFindSlave(
+    CAtEmLogging*       poLog,          /* [in]  Logging instance */
+    EC_T_DWORD          dwVendorId,     /* [in]  vendor id of the slave */
+    EC_T_DWORD          dwProductCode,  /* [in]  product code of the slave */
+    EC_T_WORD*          pwFixedAddress  /* [out] station address of the first matching slave */
+    )
+{
+    EC_T_DWORD dwSlaveIdx = 0;
+
+    if (EC_NULL == S_pReplay)
+    {
+        return FindSlaveGetFixedAddr(INSTANCE_MASTER_DEFAULT, poLog, 0, dwVendorId, dwProductCode, pwFixedAddress);
+    }
+    dwSlaveIdx = SlaveRegistryFindByType(&S_oSlaveRegistry, dwVendorId, dwProductCode, 0);
+    if (SLAVE_NOT_FOUND == dwSlaveIdx)
+    {
+        return EC_FALSE;
+    }
+    *pwFixedAddress = S_oSlaveRegistry.pwStationAddress[dwSlaveIdx];
+    return EC_TRUE;
+}
+
+/***************************************************************************************************/
+/**
+\brief  Setup input change detection for all configured slaves with inputs.
 
-Find slave parameters.
 \return EC_E_NOERROR on success, error code otherwise.
 */
-static EC_T_DWORD myAppPrepare(
+static EC_T_DWORD myAppInitInputChange(
     CAtEmLogging*       poLog,          /* [in]  Logging instance */ 
     EC_T_INT            nVerbose        /* [in]  Verbosity level */
     )
 {
-EC_T_WORD wFixedAddress = 0;
+    EC_T_DWORD          dwRes           = EC_E_ERROR;
+    T_SLAVE_REGISTRY*   pRegistry       = &S_oSlaveRegistry;
+    EC_T_DWORD          dwNumSlaves     = 0;
+    EC_T_DWORD          dwImageSize     = 0;
+    EC_T_DWORD          dwRegistryIdx   = 0;
+    EC_T_DWORD          dwSlaveIdx      = 0;
 
-    EC_UNREFPARM(nVerbose);
+    EC_UNREFPARM(poLog);
 
-    /* Searching for: EL1004, EL1012, EL1014                                       */
-    /* search for the first device at the bus and return its fixed (EtherCAT) address */
-    if (FindSlaveGetFixedAddr(INSTANCE_MASTER_DEFAULT, poLog, 0, ecvendor_beckhoff, ecprodcode_beck_EL1004, &wFixedAddress))
+    /* size of the input image covered by slaves */
+    for (dwRegistryIdx = 0; dwRegistryIdx < pRegistry->dwNumSlaves; dwRegistryIdx++)
     {
-        S_dwSlaveIdx14 = S_dwAppFoundSlaves;
+        if ((0 != pRegistry->pdwPdSizeIn[dwRegistryIdx]) && (((EC_T_DWORD)-1) != pRegistry->pdwPdOffsIn[dwRegistryIdx]))
+        {
+            dwImageSize = EC_MAX(dwImageSize, (pRegistry->pdwPdOffsIn[dwRegistryIdx] + pRegistry->pdwPdSizeIn[dwRegistryIdx] + 7) / 8);
+            dwNumSlaves++;
+        }
+    }
+    if ((0 == dwNumSlaves) || (EC_NULL == myAppGetPdIn()))
+    {
+        /* no process data if ENI was generated with GenPreopENI */
+        dwRes = EC_E_NOERROR;
+        goto Exit;
     }
-    else if (FindSlaveGetFixedAddr(INSTANCE_MASTER_DEFAULT, poLog, 0, ecvendor_beckhoff, ecprodcode_beck_EL1012, &wFixedAddress))
+    dwRes = InputChangeInit(&S_oInputChange, dwImageSize, dwNumSlaves);
+    if (EC_E_NOERROR != dwRes)
     {
-        S_dwSlaveIdx14 = S_dwAppFoundSlaves;
+        goto Exit;
     }
-    else if (FindSlaveGetFixedAddr(INSTANCE_MASTER_DEFAULT, poLog, 0, ecvendor_beckhoff, ecprodcode_beck_EL1014, &wFixedAddress))
+    for (dwRegistryIdx = 0; dwRegistryIdx < pRegistry->dwNumSlaves; dwRegistryIdx++)
     {
-        S_dwSlaveIdx14 = S_dwAppFoundSlaves;
+        if (EC_E_NOERROR != InputChangeAddSlave(&S_oInputChange, pRegistry->pdwPdOffsIn[dwRegistryIdx], pRegistry->pdwPdSizeIn[dwRegistryIdx], &dwSlaveIdx))
+        {
+            continue;
+        }
+        if (dwRegistryIdx == S_dwSlaveIdx14)
+        {
+            S_dwDigInputChangeIdx = dwSlaveIdx;
+        }
     }
-    if (S_dwSlaveIdx14 != SLAVE_NOT_FOUND)
+    InputChangeEnable(&S_oInputChange);
+    if (nVerbose >= 2)
     {
-        S_dwAppFoundSlaves++;
+        LogMsg("Input change detection: %d slaves, %d bytes", S_oInputChange.dwNumSlaves, dwImageSize);
+    }
+Exit:
+    return dwRes;
+}
+
+/***************************************************************************************************/
+/**
+\brief  Subscribe the process data of the demo slaves for the diagnosis outside the job task.
+
+\return EC_E_NOERROR on success, error code otherwise.
+*/
+static EC_T_DWORD myAppInitPdSnapshot(
+    CAtEmLogging*       poLog,          /* [in]  Logging instance */ 
+    EC_T_INT            nVerbose        /* [in]  Verbosity level */
+    )
+{
+    EC_T_DWORD           dwRes      = EC_E_NOERROR;
+    T_SLAVE_REGISTRY*    pRegistry  = &S_oSlaveRegistry;
+    EC_T_DWORD           adwSlaveIdx[] = { S_dwSlaveIdx14, S_dwSlaveIdx24, S_dwSlaveIdx4132, S_dwSlaveIdxETCio100 };
+    EC_T_DWORD           dwDemoSlave = 0;
+    EC_T_DWORD           dwSlaveIdx = 0;
+    EC_T_DWORD           dwRangeIdx = 0;
+    T_PD_VAR_LOCATION    oLocation;
+
+    EC_UNREFPARM(poLog);
 
-        /* now get the offset of this device in the process data buffer and some other infos */
-        if (ecatGetCfgSlaveInfo(EC_TRUE, wFixedAddress, &S_aSlaveList[S_dwSlaveIdx14]) != EC_E_NOERROR)
+    S_oDiagDigInput.Unbind();
+    PdSnapshotInit(&S_oPdSnapshot);
+    if ((EC_NULL == myAppGetPdIn()) || (EC_NULL == myAppGetPdOut()))
+    {
+        /* no process data if ENI was generated with GenPreopENI */
+        goto Exit;
+    }
+    /* only the ranges of the demo slaves are copied each cycle */
+    for (dwDemoSlave = 0; dwDemoSlave < (sizeof(adwSlaveIdx) / sizeof(adwSlaveIdx[0])); dwDemoSlave++)
+    {
+        dwSlaveIdx = adwSlaveIdx[dwDemoSlave];
+        if (SLAVE_NOT_FOUND == dwSlaveIdx)
+        {
+            continue;
+        }
+        if ((EC_E_NOERROR == PdSnapshotAddRange(&S_oPdSnapshot, EC_FALSE, pRegistry->pdwPdOffsIn[dwSlaveIdx], pRegistry->pdwPdSizeIn[dwSlaveIdx], &dwRangeIdx))
+         && (dwSlaveIdx == S_dwSlaveIdx14))
         {
-            LogError("ERROR: ecatGetCfgSlaveInfo() returns with error.");
+            S_dwDigInputSnapshotIdx = dwRangeIdx;
         }
+        PdSnapshotAddRange(&S_oPdSnapshot, EC_TRUE, pRegistry->pdwPdOffsOut[dwSlaveIdx], pRegistry->pdwPdSizeOut[dwSlaveIdx], &dwRangeIdx);
     }
-    /* Searching for: EL2002, EL2004, EL2008                                       */
-    /* search for the first device at the bus and return its fixed (EtherCAT) address */
-    if (FindSlaveGetFixedAddr(INSTANCE_MASTER_DEFAULT, poLog, 0, ecvendor_beckhoff, ecprodcode_beck_EL2008, &wFixedAddress))
+    if (0 == PdSnapshotGetSize(&S_oPdSnapshot))
+    {
+        goto Exit;
+    }
+    S_pbyDiagSnapshot = (EC_T_BYTE*)OsMalloc(PdSnapshotGetSize(&S_oPdSnapshot));
+    if (EC_NULL == S_pbyDiagSnapshot)
     {
-        S_dwSlaveIdx24 = S_dwAppFoundSlaves;
+        dwRes = EC_E_NOMEMORY;
+        goto Exit;
     }
-    else if (FindSlaveGetFixedAddr(INSTANCE_MASTER_DEFAULT, poLog, 0, ecvendor_beckhoff, ecprodcode_beck_EL2004, &wFixedAddress))
+    /* the range starts at the byte of the slave, keep its bit offset */
+    if ((SLAVE_NOT_FOUND != S_dwDigInputSnapshotIdx)
+     && (EC_E_NOERROR == PdVarLocate(S_pbyDiagSnapshot,
+            PdSnapshotRangeOffset(&S_oPdSnapshot, S_dwDigInputSnapshotIdx) * 8 + (pRegistry->pdwPdOffsIn[S_dwSlaveIdx14] % 8),
+            pRegistry->pdwPdSizeIn[S_dwSlaveIdx14], 0, pRegistry->pdwPdSizeIn[S_dwSlaveIdx14], &oLocation)))
     {
-        S_dwSlaveIdx24 = S_dwAppFoundSlaves;
+        S_oDiagDigInput.Bind(&oLocation);
     }
-    else if (FindSlaveGetFixedAddr(INSTANCE_MASTER_DEFAULT, poLog, 0, ecvendor_beckhoff, ecprodcode_beck_EL2002, &wFixedAddress))
+    dwRes = PdSnapshotStart(&S_oPdSnapshot);
+    if (EC_E_NOERROR != dwRes)
     {
-        S_dwSlaveIdx24 = S_dwAppFoundSlaves;
+        goto Exit;
     }
-    if (S_dwSlaveIdx24 != SLAVE_NOT_FOUND)
+    if (nVerbose >= 2)
     {
-        S_dwAppFoundSlaves++;
+        LogMsg("Process data snapshot: %d ranges, %d bytes", S_oPdSnapshot.dwNumRanges, PdSnapshotGetSize(&S_oPdSnapshot));
+    }
+Exit:
+    return dwRes;
+}
 
-        /* now get the offset of this device in the process data buffer and some other infos */
-        if (ecatGetCfgSlaveInfo(EC_TRUE, wFixedAddress, &S_aSlaveList[S_dwSlaveIdx24]) != EC_E_NOERROR)
-        {
-            LogError("ERROR: ecatGetCfgSlaveInfo() returns with error.");
-        }
+/***************************************************************************************************/
+/**
+\brief  Resolve a slave variable in the process image once.
+
+  If the slave or its process data is missing the variable stays unbound and
+  accesses a scratch buffer. A variable of a slave on the bus must bind.
+\return EC_E_NOERROR on success or if the slave is missing, error code otherwise.
+*/
+template <typename T, T_PD_VAR_LAYOUT eLayout>
+static EC_T_DWORD myAppBindVar(
+    CPdVar<T, eLayout>* poVar,          /* [out] variable */
+    EC_T_BOOL           bInput,         /* [in]  input or output process data */
+    EC_T_DWORD          dwSlaveIdx,     /* [in]  index in S_oSlaveRegistry */
+    EC_T_DWORD          dwBitOffs,      /* [in]  offset in bits relative to the slave process data */
+    EC_T_DWORD          dwBitSize,      /* [in]  size in bits, 0: complete slave process data */
+    const EC_T_CHAR*    szName          /* [in]  variable name for error messages */
+    )
+{
+    EC_T_DWORD           dwRes     = EC_E_NOERROR;
+    T_SLAVE_REGISTRY*    pRegistry = &S_oSlaveRegistry;
+    T_PD_VAR_LOCATION    oLocation;
+
+    poVar->Unbind();
+    if (SLAVE_NOT_FOUND == dwSlaveIdx)
+    {
+        goto Exit;
+    }
+    if (bInput)
+    {
+        dwRes = PdVarLocate(myAppGetPdIn(), pRegistry->pdwPdOffsIn[dwSlaveIdx], pRegistry->pdwPdSizeIn[dwSlaveIdx],
+            dwBitOffs, ((0 == dwBitSize) ? pRegistry->pdwPdSizeIn[dwSlaveIdx] : dwBitSize), &oLocation);
+    }
+    else
+    {
+        dwRes = PdVarLocate(myAppGetPdOut(), pRegistry->pdwPdOffsOut[dwSlaveIdx], pRegistry->pdwPdSizeOut[dwSlaveIdx],
+            dwBitOffs, ((0 == dwBitSize) ? pRegistry->pdwPdSizeOut[dwSlaveIdx] : dwBitSize), &oLocation);
+    }
+    if (EC_E_NOERROR == dwRes)
+    {
+        dwRes = poVar->Bind(&oLocation);
+    }
+    /* no process data if ENI was generated with GenPreopENI */
+    if (EC_E_NOTFOUND == dwRes)
+    {
+        dwRes = EC_E_NOERROR;
+    }
+    if (EC_E_NOERROR != dwRes)
+    {
+        LogError("ERROR: cannot bind process data variable %s: %s (0x%lx)", szName, ecatGetText(dwRes), dwRes);
+    }
+Exit:
+    return dwRes;
+}
+
+/***************************************************************************************************/
+/**
+\brief  Register a cycle divided application task and name its PERF slot.
+
+\return EC_E_NOERROR on success, error code otherwise.
+*/
+static EC_T_DWORD myAppRegisterTask(
+    EC_T_CHAR*          szName,         /* [in]  name shown with the job times */
+    PF_APP_TASK         pfnTask,        /* [in]  task function */
+    EC_T_DWORD          dwDivider,      /* [in]  run every dwDivider cycles */
+    EC_T_DWORD          dwPhase         /* [in]  cycle offset or APP_TASK_PHASE_AUTO */
+    )
+{
+    EC_T_DWORD dwTaskIndex = 0;
+    EC_T_DWORD dwRes       = AppTaskRegister(&S_oAppTaskTable, szName, pfnTask, dwDivider, dwPhase, &dwTaskIndex);
+
+    if (EC_E_NOERROR != dwRes)
+    {
+        LogError("ERROR: cannot register application task %s (divider %d): %s (0x%lx)", szName, dwDivider, ecatGetText(dwRes), dwRes);
+    }
+    else
+    {
+        S_aszMeasInfo[PERF_AppTask0 + dwTaskIndex] = szName;
+    }
+    return dwRes;
+}
+
+/***************************************************************************************************/
+/**
+\brief  Initialize Application
+
+\return EC_E_NOERROR on success, error code otherwise.
+*/
+static EC_T_DWORD myAppInit(
+    CAtEmLogging*       poLog,          /* [in]  Logging instance */ 
+    EC_T_INT            nVerbose        /* [in]  Verbosity level */
+    )
+{
+    S_dwSlaveIdx14       = SLAVE_NOT_FOUND;
+    S_dwSlaveIdx24       = SLAVE_NOT_FOUND;
+    S_dwSlaveIdx4132     = SLAVE_NOT_FOUND;
+    S_dwSlaveIdxETCio100 = SLAVE_NOT_FOUND;
+    S_dwDigInputChangeIdx = SLAVE_NOT_FOUND;
+    S_dwDigInputSnapshotIdx = SLAVE_NOT_FOUND;
+
+    /* process data are not modified every cycle, spread the slow tasks over different cycles */
+    AppTaskTableInit(&S_oAppTaskTable);
+    myAppRegisterTask((EC_T_CHAR*)"myAppWorkDigOut       ", myAppWorkDigOut,  100, APP_TASK_PHASE_AUTO);
+    myAppRegisterTask((EC_T_CHAR*)"myAppWorkAnalog       ", myAppWorkAnalog, 100, APP_TASK_PHASE_AUTO);
+    if (nVerbose >= 2)
+    {
+        AppTaskTableShow(&S_oAppTaskTable, poLog);
+    }
+    return EC_E_NOERROR;
+}
+
+/***************************************************************************************************/
+/**
+\brief  Initialize Slave Instance.
+
+Find slave parameters.
+\return EC_E_NOERROR on success, error code otherwise.
+*/
+static EC_T_DWORD myAppPrepare(
+    CAtEmLogging*       poLog,          /* [in]  Logging instance */ 
+    EC_T_INT            nVerbose        /* [in]  Verbosity level */
+    )
+{
+EC_T_WORD  wFixedAddress = 0;
+EC_T_DWORD dwRes         = EC_E_ERROR;
+
+    /* configuration of all slaves, the demo slaves below are indices in the registry */
+    dwRes = myAppBuildSlaveRegistry(poLog, nVerbose);
+    if (EC_E_NOERROR != dwRes)
+    {
+        LogError("ERROR: cannot build slave registry: %s (0x%lx)", ecatGetText(dwRes), dwRes);
+        return dwRes;
     }
 
+    /* Searching for: EL1004, EL1012, EL1014                                       */
+    /* search for the first device at the bus and return its fixed (EtherCAT) address */
+    if (myAppFindSlave(poLog, ecvendor_beckhoff, ecprodcode_beck_EL1004, &wFixedAddress)
+     || myAppFindSlave(poLog, ecvendor_beckhoff, ecprodcode_beck_EL1012, &wFixedAddress)
+     || myAppFindSlave(poLog, ecvendor_beckhoff, ecprodcode_beck_EL1014, &wFixedAddress))
+    {
+        S_dwSlaveIdx14 = myAppGetSlaveIdx(wFixedAddress);
+    }
+    /* Searching for: EL2002, EL2004, EL2008                                       */
+    /* search for the first device at the bus and return its fixed (EtherCAT) address */
+    if (myAppFindSlave(poLog, ecvendor_beckhoff, ecprodcode_beck_EL2008, &wFixedAddress)
+     || myAppFindSlave(poLog, ecvendor_beckhoff, ecprodcode_beck_EL2004, &wFixedAddress)
+     || myAppFindSlave(poLog, ecvendor_beckhoff, ecprodcode_beck_EL2002, &wFixedAddress))
+    {
+        S_dwSlaveIdx24 = myAppGetSlaveIdx(wFixedAddress);
+    }
     /* Searching for: EL4132                                                       */
     /* search for the first device at the bus and return its fixed (EtherCAT) address */
-    if (FindSlaveGetFixedAddr(INSTANCE_MASTER_DEFAULT, poLog, 0, ecvendor_beckhoff, ecprodcode_beck_EL4132, &wFixedAddress))
+    if (myAppFindSlave(poLog, ecvendor_beckhoff, ecprodcode_beck_EL4132, &wFixedAddress))
     {
-        S_dwSlaveIdx4132 = S_dwAppFoundSlaves;
-        S_dwAppFoundSlaves++;
-        /* now get the offset of this device in the process data buffer and some other infos */
-        if (ecatGetCfgSlaveInfo(EC_TRUE, wFixedAddress, &S_aSlaveList[S_dwSlaveIdx4132]) != EC_E_NOERROR)
-        {
-            LogError("ERROR: ecatGetCfgSlaveInfo() returns with error.");
-        }
+        S_dwSlaveIdx4132 = myAppGetSlaveIdx(wFixedAddress);
     }
     /* Searching for: IXXAT ETCio100                                                    */
     /* search for the first device at the bus and return its fixed (EtherCAT) address */
-    if (FindSlaveGetFixedAddr(INSTANCE_MASTER_DEFAULT, poLog, 0, ecvendor_ixxat, ecprodcode_ixx_ETCio100, &wFixedAddress))
+    if (myAppFindSlave(poLog, ecvendor_ixxat, ecprodcode_ixx_ETCio100, &wFixedAddress))
     {
-        S_dwSlaveIdxETCio100 = S_dwAppFoundSlaves;
-        S_dwAppFoundSlaves++;
-        /* now get the offset of this device in the process data buffer and some other infos */
-        if (ecatGetCfgSlaveInfo(EC_TRUE, wFixedAddress, &S_aSlaveList[S_dwSlaveIdxETCio100]) != EC_E_NOERROR)
-        {
-            LogError("ERROR: ecatGetCfgSlaveInfo() returns with error.");
-        }
+        S_dwSlaveIdxETCio100 = myAppGetSlaveIdx(wFixedAddress);
+    }
+
+    /* resolve process data variables once instead of computing the offsets every cycle */
+    if ((EC_E_NOERROR != myAppBindVar(&S_oDigInput,       EC_TRUE,  S_dwSlaveIdx14,       0,  0,  "DigInput"))
+     || (EC_E_NOERROR != myAppBindVar(&S_oDigOutput,      EC_FALSE, S_dwSlaveIdx24,       0,  0,  "DigOutput"))
+     || (EC_E_NOERROR != myAppBindVar(&S_oEL4132Ch1,      EC_FALSE, S_dwSlaveIdx4132,     0,  16, "EL4132.Ch1"))
+     || (EC_E_NOERROR != myAppBindVar(&S_oEL4132Ch2,      EC_FALSE, S_dwSlaveIdx4132,     16, 16, "EL4132.Ch2"))
+     || (EC_E_NOERROR != myAppBindVar(&S_oETCio100DigOut, EC_FALSE, S_dwSlaveIdxETCio100, 0,  8,  "ETCio100.DigOut"))
+     || (EC_E_NOERROR != myAppBindVar(&S_oETCio100Ao1,    EC_FALSE, S_dwSlaveIdxETCio100, 8,  16, "ETCio100.Ao1"))
+     || (EC_E_NOERROR != myAppBindVar(&S_oETCio100Ao2,    EC_FALSE, S_dwSlaveIdxETCio100, 24, 16, "ETCio100.Ao2")))
+    {
+        /* reported by myAppBindVar(), the application would silently use the scratch buffer */
+        return EC_E_INVALIDPARM;
+    }
+
+    /* react only on slaves with changed inputs */
+    if (EC_E_NOERROR != myAppInitInputChange(poLog, nVerbose))
+    {
+        LogError("ERROR: cannot setup input change detection");
+    }
+
+    /* consistent process data for the diagnosis in the main thread */
+    if (EC_E_NOERROR != myAppInitPdSnapshot(poLog, nVerbose))
+    {
+        LogError("ERROR: cannot setup process data snapshot");
     }
+
     return EC_E_NOERROR;
 }
 
@@ -855,7 +1996,7 @@ static EC_T_DWORD myAppSetup(
     )
 {
     EC_T_DWORD           dwRes    = EC_E_ERROR;
-    EC_T_CFG_SLAVE_INFO* pMySlave = EC_NULL;
+    const EC_T_CFG_SLAVE_INFO* pMySlave = EC_NULL;
 
     if (S_dwSlaveIdx4132 != SLAVE_NOT_FOUND)
     {
@@ -867,7 +2008,7 @@ static EC_T_DWORD myAppSetup(
         EC_T_WORD  wOffset;
         EC_T_DWORD dwGain;
 
-        pMySlave = &S_aSlaveList[S_dwSlaveIdx4132];    
+        pMySlave = SlaveRegistryGetCfgSlaveInfo(&S_oSlaveRegistry, S_dwSlaveIdx4132);
 
         /* demo: simple CoE SDO upload                              */
         /*       - synchronous: block until upload has finished     */
@@ -951,6 +2092,7 @@ static EC_T_DWORD myAppSetup(
 \brief  demo application working process data function.
 
   This function is called in every cycle after the the master stack is started.
+  Work which is not needed every cycle is registered as application task in myAppInit().
   
 */
 static EC_T_DWORD myAppWorkpd(
@@ -960,124 +2102,94 @@ static EC_T_DWORD myAppWorkpd(
     EC_T_BYTE*          pbyPDOut        /* [in]  pointer to process data output buffer */
     )
 {
-    EC_T_CFG_SLAVE_INFO* pMySlave      = EC_NULL;
-
-    static EC_T_DWORD    s_dwWorkpdCnt = 0;
-    EC_T_BYTE            byVal         = 0;
-    EC_T_BYTE*           pbyVal        = EC_NULL;
-    EC_T_WORD*           pwVal         = EC_NULL;
-    EC_T_WORD            wValue        = 0;
-
     EC_UNREFPARM(poLog);
-    EC_UNREFPARM(nVerbose);
+    EC_UNREFPARM(pbyPDIn);
+    EC_UNREFPARM(pbyPDOut);
 
-    /* process data are not modified not every cycle */
-    s_dwWorkpdCnt++;
-    if ((s_dwWorkpdCnt % 100) != 0)
-    {
-        goto Exit;
-    }
-    /* Digital input slave available ? */
-    if ((S_dwSlaveIdx14 != SLAVE_NOT_FOUND) && (pbyPDIn != EC_NULL))
+    /* monitor digital inputs, only read if they changed in this cycle */
+    if (InputChangeIsSlaveChanged(&S_oInputChange, S_dwDigInputChangeIdx) && (nVerbose >= EC_LOG_LEVEL_INFO))
     {
     static EC_T_BYTE s_byDigInputLastVal = 0;
+    EC_T_BYTE        byVal               = S_oDigInput.Get();
 
-        /* get slave information */
-        pMySlave = &S_aSlaveList[S_dwSlaveIdx14];
-
-        /* monitor input change if ENI was NOT generated with GenPreopENI */
-        if (((EC_T_DWORD)-1) != pMySlave->dwPdOffsIn)
+        if (byVal != s_byDigInputLastVal)
         {
-            EC_GETBITS(pbyPDIn, &byVal, pMySlave->dwPdOffsIn, pMySlave->dwPdSizeIn);
-            if (byVal != s_byDigInputLastVal)
-            {
-                if (nVerbose >= EC_LOG_LEVEL_INFO)
-                {
-                    LogMsg("Input Value updated : Old : 0x%x -> New : 0x%x", s_byDigInputLastVal, byVal);
-                    s_byDigInputLastVal = byVal;
-                }
-            }
+            LogMsg("Input Value updated : Old : 0x%x -> New : 0x%x", s_byDigInputLastVal, byVal);
+            s_byDigInputLastVal = byVal;
         }
     }
-    /* Digital output device */
-    if ((S_dwSlaveIdx24 != SLAVE_NOT_FOUND) && (pbyPDOut != EC_NULL))
-    {
-        /* get slave information */
-        pMySlave = &S_aSlaveList[S_dwSlaveIdx24];
+    return EC_E_NOERROR;
+}
 
-        /* flash output if ENI was NOT generated with GenPreopENI */
-        if (((EC_T_DWORD)-1) != pMySlave->dwPdOffsOut)
-        {
-            EC_GETBITS(pbyPDOut, &byVal, pMySlave->dwPdOffsOut, pMySlave->dwPdSizeOut);
-            byVal++;
-            EC_SETBITS(pbyPDOut, &byVal, pMySlave->dwPdOffsOut, pMySlave->dwPdSizeOut);
-        }
-    }
+/***************************************************************************************************/
+/**
+\brief  demo application task: flash digital outputs.
 
-    /* EL4132 */
-    if ((S_dwSlaveIdx4132 != SLAVE_NOT_FOUND) && (pbyPDOut != EC_NULL))
-    {
-        /* get slave information */
-        pMySlave = &S_aSlaveList[S_dwSlaveIdx4132];    
+  This function is called every 100 cycles, see myAppInit().
+  
+*/
+static EC_T_DWORD myAppWorkDigOut(
+    CAtEmLogging*       poLog,          /* [in]  Logging instance */ 
+    EC_T_INT            nVerbose,       /* [in]  Verbosity level */
+    EC_T_BYTE*          pbyPDIn,        /* [in]  pointer to process data input buffer */
+    EC_T_BYTE*          pbyPDOut        /* [in]  pointer to process data output buffer */
+    )
+{
+    EC_UNREFPARM(poLog);
+    EC_UNREFPARM(nVerbose);
+    EC_UNREFPARM(pbyPDIn);
+    EC_UNREFPARM(pbyPDOut);
 
-        /* do some upcounting on channel 1 */
-        if (((EC_T_DWORD)-1) != pMySlave->dwPdOffsOut)
-        {
-            pwVal = (EC_T_WORD*)&pbyPDOut[pMySlave->dwPdOffsOut/8];
-            wValue = EC_GET_FRM_WORD(pwVal); /* for big endian systems we have to swap */
-            wValue++;
-            EC_SET_FRM_WORD(pwVal, wValue);
+    /* flash digital output, unbound variables don't access the process image */
+    S_oDigOutput.Set((EC_T_BYTE)(S_oDigOutput.Get() + 1));
 
-            /* do some downcounting on channel 2 */
-            pwVal = (EC_T_WORD*)&pbyPDOut[(pMySlave->dwPdOffsOut+16)/8];
-            wValue = EC_GET_FRM_WORD(pwVal); /* for big endian systems we have to swap */
-            wValue--;
-            EC_SET_FRM_WORD(pwVal, wValue);
-        }
-    }
-    /* IXXAT ETCio100 */
-    if ((S_dwSlaveIdxETCio100 != SLAVE_NOT_FOUND) && (pbyPDOut != EC_NULL))
-    {
-        /* get slave information */
-        pMySlave = &S_aSlaveList[S_dwSlaveIdxETCio100];    
+    return EC_E_NOERROR;
+}
 
-        /* flash digital output if ENI was NOT generated with GenPreopENI */
-        if (((EC_T_DWORD)-1) != pMySlave->dwPdOffsOut)
-        {
-            pbyVal = (EC_T_BYTE*)&pbyPDOut[pMySlave->dwPdOffsOut/8];
-            *pbyVal = (EC_T_BYTE)((*pbyVal) + 1);
-        }
+/***************************************************************************************************/
+/**
+\brief  demo application task: count analog outputs.
 
-        /* increase analog output 1 if ENI was NOT generated with GenPreopENI */
-        /* analog outputs are 12 Bit values at the ETCio 100 */
-        if (((EC_T_DWORD)-1) != pMySlave->dwPdOffsOut)
-        {
-            pwVal = (EC_T_WORD*)&pbyPDOut[(pMySlave->dwPdOffsOut+8)/8];
-            wValue = EC_GET_FRM_WORD(pwVal);  /* for big endian systems we have to swap */
-            wValue = (EC_T_WORD)(wValue + 0x100);  /* to get a well measurable value difference modify last value by 0x100 */
-            if(wValue & 0xF000)  /* 12 Bit value. The 4 highest bits are not relevant for the analog value */
-            {
-                wValue = 0;
-            }
-            EC_SET_FRM_WORD(pwVal, wValue);
-        }
+  This function is called every 100 cycles, see myAppInit().
+  
+*/
+static EC_T_DWORD myAppWorkAnalog(
+    CAtEmLogging*       poLog,          /* [in]  Logging instance */ 
+    EC_T_INT            nVerbose,       /* [in]  Verbosity level */
+    EC_T_BYTE*          pbyPDIn,        /* [in]  pointer to process data input buffer */
+    EC_T_BYTE*          pbyPDOut        /* [in]  pointer to process data output buffer */
+    )
+{
+    EC_T_WORD            wValue        = 0;
 
-        /* decrease analog output 2 if ENI was NOT generated with GenPreopENI */
-        /* analog outputs are 12 Bit values at the ETCio 100 */
-        if (((EC_T_DWORD)-1) != pMySlave->dwPdOffsOut)
-        {
-            pwVal = (EC_T_WORD*)&pbyPDOut[(pMySlave->dwPdOffsOut+24)/8];
-            wValue = EC_GET_FRM_WORD(pwVal); /* for big endian systems we have to swap */
-            wValue = (EC_T_WORD)(wValue - 0x100);  /* to get a well measurable value difference modify last value by 0x100 */
-            if(wValue & 0xF000)  /* 12 Bit value. The 4 highest bits are not relevant for the analog value */
-            {
-                wValue = 0x0F00;
-            }
-            EC_SET_FRM_WORD(pwVal, wValue);
-        }
+    EC_UNREFPARM(poLog);
+    EC_UNREFPARM(nVerbose);
+    EC_UNREFPARM(pbyPDIn);
+    EC_UNREFPARM(pbyPDOut);
+
+    /* EL4132: do some upcounting on channel 1 and downcounting on channel 2 */
+    S_oEL4132Ch1.Set((EC_T_WORD)(S_oEL4132Ch1.Get() + 1));
+    S_oEL4132Ch2.Set((EC_T_WORD)(S_oEL4132Ch2.Get() - 1));
+
+    /* IXXAT ETCio100: flash digital output */
+    S_oETCio100DigOut.Set((EC_T_BYTE)(S_oETCio100DigOut.Get() + 1));
+
+    /* increase analog output 1, analog outputs are 12 Bit values at the ETCio 100 */
+    wValue = (EC_T_WORD)(S_oETCio100Ao1.Get() + 0x100);  /* to get a well measurable value difference modify last value by 0x100 */
+    if (wValue & 0xF000)  /* 12 Bit value. The 4 highest bits are not relevant for the analog value */
+    {
+        wValue = 0;
     }
+    S_oETCio100Ao1.Set(wValue);
+
+    /* decrease analog output 2 */
+    wValue = (EC_T_WORD)(S_oETCio100Ao2.Get() - 0x100);
+    if (wValue & 0xF000)
+    {
+        wValue = 0x0F00;
+    }
+    S_oETCio100Ao2.Set(wValue);
 
-Exit:
     return EC_E_NOERROR;
 }
 
@@ -1093,17 +2205,36 @@ static EC_T_DWORD myAppDiagnosis(
     )
 {
     EC_T_DWORD           dwRes    = EC_E_ERROR;
-    EC_T_CFG_SLAVE_INFO* pMySlave = EC_NULL;
+    const EC_T_CFG_SLAVE_INFO* pMySlave = EC_NULL;
 
     EC_UNREFPARM(poLog);
     EC_UNREFPARM(nVerbose);
 
+    /* the snapshot is consistent, the job task is not blocked while it is read */
+    if ((S_dwDigInputSnapshotIdx != SLAVE_NOT_FOUND) && (nVerbose >= 3))
+    {
+        static EC_T_BYTE s_byLastDigInput = 0;
+        EC_T_DWORD       dwCycle          = 0;
+        EC_T_BYTE        byDigInput       = 0;
+
+        dwRes = PdSnapshotRead(&S_oPdSnapshot, S_pbyDiagSnapshot, PdSnapshotGetSize(&S_oPdSnapshot), &dwCycle, EC_NULL);
+        if (EC_E_NOERROR == dwRes)
+        {
+            byDigInput = S_oDiagDigInput.Get();
+            if (byDigInput != s_byLastDigInput)
+            {
+                LogMsg("myAppDiagnosis: snapshot %d digital input 0x%02X", dwCycle, byDigInput);
+                s_byLastDigInput = byDigInput;
+            }
+        }
+    }
+
     if (S_dwSlaveIdx4132 != SLAVE_NOT_FOUND)
     {
         EC_T_DWORD dwSize  = 0;
         EC_T_DWORD dwValue = 0;
 
-        pMySlave = &S_aSlaveList[S_dwSlaveIdx4132];    
+        pMySlave = SlaveRegistryGetCfgSlaveInfo(&S_oSlaveRegistry, S_dwSlaveIdx4132);
 
         dwRes = ecatCoeSdoUpload(pMySlave->dwSlaveId, 0x1018, 1,
             (EC_T_BYTE*)&dwValue, sizeof(EC_T_DWORD), &dwSize, MBX_TIMEOUT, 0);
@@ -9,6 +9,19 @@
 #include "ATEMDemoConfig.h"
 #include "ecatNotification.h"
 #include "ecatDemoCommon.h"
+#include "ecatDemoTiming.h"
+#include "ecatDemoHistogram.h"
+#include "ecatDemoTrace.h"
+#include "ecatDemoOverrun.h"
+#include "ecatDemoAppTask.h"
+#include "ecatDemoPdVar.h"
+#include "ecatDemoInputChange.h"
+#include "ecatDemoPdSnapshot.h"
+#include "ecatDemoPdShm.h"
+#include "ecatDemoPdRec.h"
+#include "ecatDemoPdReplay.h"
+#include "ecatDemoPdForce.h"
+#include "ecatDemoSlaveRegistry.h"
 #ifdef VXWORKS
 #include "wvLib.h"
 #endif
@@ -25,6 +38,43 @@
 #define REMOTE_WD_TO_LIMIT          10000
 #define REMOTE_CYCLE_TIME           2
 
+/*-TYPEDEFS------------------------------------------------------------------*/
+#define DEMO_AFFINITY_UNSET     ((EC_T_DWORD)0xFFFFFFFF)
+
+/* SMP systems: CPU index per thread */
+typedef struct _T_DEMO_AFFINITY
+{
+    EC_T_DWORD          dwJob;                  /**< [in]   tEcJobTask */
+    EC_T_DWORD          dwTimer;                /**< [in]   tEcTimingTask and auxiliary clock */
+    EC_T_DWORD          dwIst;                  /**< [in]   link layer receive thread (tLOsaL_IST) */
+    EC_T_DWORD          dwLog;                  /**< [in]   tAtEmLog */
+    EC_T_DWORD          dwMain;                 /**< [in]   main thread (diagnosis, notifications) */
+    EC_T_DWORD          dwRas;                  /**< [in]   RAS server threads */
+} T_DEMO_AFFINITY;
+
+typedef struct _T_DEMO_CFG
+{
+    EC_T_BOOL           bFusedTiming;           /**< [in]   job task sleeps on its own deadline, no timing event */
+    EC_T_DWORD          dwWakeAheadUsec;        /**< [in]   fused timing: wake up this time before the period boundary */
+    T_DEADLINE_WAIT_POLICY eWaitPolicy;         /**< [in]   fused timing: sleep, hybrid or spin */
+    EC_T_DWORD          dwSpinUsec;             /**< [in]   hybrid wait: busy-poll time before the deadline */
+    T_DEADLINE_TIMER*   pTimingDeadlineTimer;   /**< [in]   -deadline: timer of tEcTimingTask, for the wake-up error */
+    EC_T_DWORD          dwOutlierUsec;          /**< [in]   job histograms: outlier threshold (0 = bus cycle time) */
+    EC_T_BOOL           bTrace;                 /**< [in]   record per cycle timeline trace */
+    EC_T_DWORD          dwTraceCycles;          /**< [in]   trace: number of cycles kept (0 = default) */
+    EC_T_BOOL           bPipelined;             /**< [in]   send outputs of the previous cycle before myAppWorkpd */
+    EC_T_BOOL           bAcycThread;            /**< [in]   run MasterTimer and SendAcycFrames in tEcAcycJobTask */
+    EC_T_DWORD          dwAcycThreadPrio;       /**< [in]   priority of tEcAcycJobTask */
+    EC_T_DWORD          dwAcycCpuIndex;         /**< [in]   SMP systems: CPU index of tEcAcycJobTask */
+    T_DEMO_AFFINITY     oAffinity;              /**< [in]   SMP systems: CPU index per thread */
+    EC_T_BOOL           bPdShm;                 /**< [in]   export the process image to shared memory */
+    EC_T_CHAR           szPdShmName[PD_SHM_MAX_NAME_LEN]; /**< [in]   name of the shared memory */
+    EC_T_BOOL           bPdRec;                 /**< [in]   record the process data of each cycle */
+    EC_T_DWORD          dwPdRecFileSizeMb;      /**< [in]   recorder: size of each ring file in MByte */
+    EC_T_DWORD          dwPdRecNumFiles;        /**< [in]   recorder: number of ring files */
+    EC_T_CHAR           szPdForceFile[PD_FORCE_MAX_FILE_NAME_LEN]; /**< [in]   output forcing file, empty = no forcing */
+} T_DEMO_CFG;
+
 /*-FORWARD DECLARATIONS------------------------------------------------------*/
 EC_T_DWORD ATEMDemo(
      CAtEmLogging*       poLog
@@ -42,6 +92,14 @@ EC_T_DWORD ATEMDemo(
     ,EC_T_WORD           wServerPort
 #endif
     ,EC_T_LINK_PARMS* poLinkParmsRed
+    ,T_DEMO_CFG*         pDemoCfg
+    );
+EC_T_DWORD ATEMDemoReplay(
+     CAtEmLogging*       poLog
+    ,const
+     EC_T_CHAR*          szFileName
+    ,EC_T_BOOL           bPaced
+    ,EC_T_INT            nVerbose
     );
 
 /*--------------------------------------------------------------------------*/
@@ -55,12 +113,17 @@ EC_T_DWORD ATEMDemo(
 #define JOB_SendAcycFrames      3
 #define PERF_CycleTime          4
 #define PERF_myAppWorkpd        5
-#define MAX_JOB_NUM             6
+#define PERF_FrameDeparture     6
+#define PERF_AppTask0           7       /* one slot per application task */
+#define PERF_WakeUpError        (PERF_AppTask0 + APP_TASK_MAX_NUM)  /* deadline to job task, histogram only */
+#define MAX_JOB_NUM             (PERF_WakeUpError + 1)
+#define MAX_TSC_JOB_NUM         PERF_WakeUpError                    /* slots measured by TSC start and end */
 
-#define PERF_MEASURE_JOBS_INIT(msgcb)   ecatPerfMeasInit(&S_TscMeasDesc,0,MAX_JOB_NUM,msgcb);ecatPerfMeasEnable(&S_TscMeasDesc)
+#define PERF_MEASURE_JOBS_INIT(msgcb)   do { ecatPerfMeasInit(&S_TscMeasDesc,0,MAX_TSC_JOB_NUM,msgcb);ecatPerfMeasEnable(&S_TscMeasDesc); } while (0)
 #define PERF_MEASURE_JOBS_DEINIT()      ecatPerfMeasDeinit(&S_TscMeasDesc)
-#define PERF_MEASURE_JOBS_SHOW()        ecatPerfMeasShow(&S_TscMeasDesc,0xFFFFFFFF,S_aszMeasInfo)
-#define PERF_JOB_START(nJobIndex)       ecatPerfMeasStart(&S_TscMeasDesc,(EC_T_DWORD)(nJobIndex))
-#define PERF_JOB_END(nJobIndex)         ecatPerfMeasEnd(&S_TscMeasDesc,(EC_T_DWORD)(nJobIndex))
+#define PERF_MEASURE_JOBS_SHOW()        do { ecatPerfMeasShow(&S_TscMeasDesc,0xFFFFFFFF,S_aszMeasInfo);ShowJobStatistics(); } while (0)
+#define PERF_MEASURE_JOBS_RESET()       do { ecatPerfMeasReset(&S_TscMeasDesc,0xFFFFFFFF);ResetJobStatistics(); } while (0)
+#define PERF_JOB_START(nJobIndex)       do { ecatPerfMeasStart(&S_TscMeasDesc,(EC_T_DWORD)(nJobIndex));PerfJobHistoStart(nJobIndex); } while (0)
+#define PERF_JOB_END(nJobIndex)         do { ecatPerfMeasEnd(&S_TscMeasDesc,(EC_T_DWORD)(nJobIndex));PerfJobHistoEnd(nJobIndex); } while (0)
 
 /*-END OF SOURCE FILE--------------------------------------------------------*/
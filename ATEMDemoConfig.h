@@ -65,6 +65,7 @@
  #define RECV_THREAD_PRIO            ((EC_T_DWORD)97)   /* EtherCAT master packet receive thread priority (tLOsaL_IST) */
  #define LOG_THREAD_PRIO             ((EC_T_DWORD)29)   /* EtherCAT message logging thread priority (tAtEmLog) */
  #define MAIN_THREAD_PRIO            ((EC_T_DWORD)39)   /* Main thread */
+ #define ACYC_THREAD_PRIO            ((EC_T_DWORD)90)   /* EtherCAT master administrative and acyclic job thread priority (tEcAcycJobTask) */
 #elif (defined __INTEGRITY)
  #define TIMER_THREAD_PRIO           ((EC_T_DWORD)200)   /* EtherCAT master timer task (tEcTimingTask) */
  #define JOBS_THREAD_PRIO            ((EC_T_DWORD)199)   /* EtherCAT master job thread priority */
@@ -225,6 +226,12 @@
 #ifndef LOG_THREAD_STACKSIZE
 #define LOG_THREAD_STACKSIZE         0x4000
 #endif
+#ifndef ACYC_THREAD_PRIO
+#define ACYC_THREAD_PRIO             JOBS_THREAD_PRIO
+#endif
+#ifndef ACYC_THREAD_STACKSIZE
+#define ACYC_THREAD_STACKSIZE        JOBS_THREAD_STACKSIZE
+#endif
 
 /******************/
 /* timer settings */
@@ -12,6 +12,10 @@
 #include "ATEMDemo.h"
 #include "selectLinkLayer.h"
 #include "Logging.h"
+#include "ecatDemoTiming.h"
+#include "ecatDemoDio.h"
+#include "ecatDemoLogBench.h"
+#include "ecatDemoLogBin.h"
 
 #if (defined ATEMRAS_SERVER)
 #include <AtEmRasSrv.h>
@@ -222,6 +226,13 @@ typedef struct _EC_T_TIMING_DESC
     EC_T_VOID*          pvAuxClkEvent;      /* event handle */
 #endif
     EC_T_DWORD          dwCpuIndex;         /* SMP systems: CPU index */
+#if (defined DEADLINE_TIMER_SUPPORTED)
+    EC_T_BOOL           bUseDeadline;       /* Sleep until absolute period boundaries */
+    EC_T_DWORD          dwWakeAheadUsec;    /* Set event this time before the period boundary */
+    T_DEADLINE_WAIT_POLICY eWaitPolicy;     /* sleep, hybrid or spin */
+    EC_T_DWORD          dwSpinUsec;         /* hybrid wait: busy-poll time before the deadline */
+    T_DEADLINE_TIMER    oDeadlineTimer;     /* absolute deadline timer and statistics */
+#endif
 #if ((defined UNDER_CE) && (_WIN32_WCE >= 0x600))
     HANDLE              hVirtualDrv;        /* virtual IO driver handle */
     VI_T_INTERRUPTDESC  oIrqDesc;           /* Irq descriptor for virtual IO driver */
@@ -666,10 +677,13 @@ void rtemsSyncBDBuffers(){
 static EC_T_VOID ShowSyntax(EC_T_VOID)
 {
     OsDbgMsg("Syntax:\n");
-    OsDbgMsg("EcMasterDemo [-f ENI-FileName] [-t time] [-b time] [-a affinity] [-v lvl] [-perf] [-log Prefix]");
+    OsDbgMsg("EcMasterDemo [-f ENI-FileName] [-t time] [-b time] [-a affinity] [-v lvl] [-perf [outlier]] [-trace [cycles]] [-pipelined] [-acycthread cpu [prio]] [-shm [name]] [-rec [size [files]]] [-force file] [-log Prefix] [-logdefer] [-logcoalesce msec] [-logbin]");
 #if (defined AUXCLOCK_SUPPORTED)
     OsDbgMsg(" [-auxclk period]");
 #endif
+#if (defined DEADLINE_TIMER_SUPPORTED)
+    OsDbgMsg(" [-deadline [wakeahead]] [-fused [wakeahead]] [-wait policy [spin]]");
+#endif
 #if (defined ATEMRAS_SERVER)
     OsDbgMsg(" [-sp [port]]");
 #endif
@@ -682,15 +696,50 @@ static EC_T_VOID ShowSyntax(EC_T_VOID)
     OsDbgMsg("     cycle time      Cycle time in usec\n");
     OsDbgMsg("   -a                CPU affinity\n");
     OsDbgMsg("     affinity        0 = first CPU, 1 = second, ...\n");
+    OsDbgMsg("                     or map per thread, e.g. job=2,timer=2,ist=3,log=0,main=0,ras=1\n");
     OsDbgMsg("   -v                Set verbosity level\n");
     OsDbgMsg("     lvl             Level: 0=off, 1(default) ...n=more messages\n");
     OsDbgMsg("   -perf             Enable job measurement\n");
+    OsDbgMsg("     outlier         count job times above this limit in usec as outliers (default = cycle time)\n");
+    OsDbgMsg("   -trace            Record timeline of the job task, written to ectrace_N.json on frame loss, deadline miss and at shutdown\n");
+    OsDbgMsg("     cycles          number of cycles kept (default = %d)\n", TRACE_DEFAULT_NUM_CYCLES);
+    OsDbgMsg("   -pipelined        send outputs before myAppWorkpd (outputs are delayed by one cycle)\n");
+    OsDbgMsg("   -diobench         compare bulk digital I/O pack/unpack with EC_GETBITS/EC_SETBITS and exit\n");
+    OsDbgMsg("     channels        number of digital channels (default = %d)\n", DIO_BENCH_DEFAULT_CHANNELS);
+    OsDbgMsg("   -logbench         measure logging with %d concurrent producer threads, log file throughput and exit\n", LOG_BENCH_NUM_THREADS);
+    OsDbgMsg("     messages        number of messages per thread (default = %d)\n", LOG_BENCH_DEFAULT_MSGS);
+    OsDbgMsg("   -replay           feed recorded inputs into myAppWorkpd without EtherCAT master, compare the outputs and exit\n");
+    OsDbgMsg("     file            recorder file, e.g. %s_0.bin\n", PD_REC_FILE_NAME);
+    OsDbgMsg("     paced           one cycle per recorded bus cycle time (default = as fast as possible)\n");
+    OsDbgMsg("   -acycthread       run MasterTimer and SendAcycFrames in a separate thread\n");
+    OsDbgMsg("     cpu             CPU index of the thread\n");
+    OsDbgMsg("     prio            thread priority (default = %d)\n", ACYC_THREAD_PRIO);
+    OsDbgMsg("   -shm              export the process image to POSIX shared memory, see ecatDemoPdShmReader.h\n");
+    OsDbgMsg("     name            shared memory name (default = %s)\n", PD_SHM_DEFAULT_NAME);
+    OsDbgMsg("   -rec              record the process data of each cycle into memory mapped ring files %s_N.bin\n", PD_REC_FILE_NAME);
+    OsDbgMsg("     size            size of each file in MByte (default = %d)\n", PD_REC_DEFAULT_FILE_SIZE_MB);
+    OsDbgMsg("     files           number of files used round robin, 1 = single ring file (default = %d)\n", PD_REC_DEFAULT_NUM_FILES);
+    OsDbgMsg("   -force            force output bits, applied right before the cyclic frames are sent\n");
+    OsDbgMsg("     file            lines of \"bitoffset bitsize value\", re-read every %d msec\n", PD_FORCE_RELOAD_PERIOD);
     OsDbgMsg("   -log              Use given file name prefix for log files\n");
     OsDbgMsg("     Prefix          prefix\n");
+    OsDbgMsg("   -logdefer         format log messages in the log task instead of the calling thread\n");
+    OsDbgMsg("   -logcoalesce      wake up the log task at most once per period under load\n");
+    OsDbgMsg("     msec            period in msec (default = 0, wake up on every message)\n");
+    OsDbgMsg("   -logbin           write binary log files *.%s, see ecatDemoLogDecode.c\n", LOG_BIN_FILE_EXT);
 #if (defined AUXCLOCK_SUPPORTED)
     OsDbgMsg("   -auxclk           use auxiliary clock\n");
     OsDbgMsg("     period          clock period in usec\n" );
 #endif
+#if (defined DEADLINE_TIMER_SUPPORTED)
+    OsDbgMsg("   -deadline         use absolute deadline timing (cycles below 1 msec)\n");
+    OsDbgMsg("     wakeahead       set timing event this time in usec before the period boundary (default = 0)\n");
+    OsDbgMsg("   -fused            job task sleeps on its own absolute deadline (no timing task)\n");
+    OsDbgMsg("     wakeahead       wake up this time in usec before the period boundary (default = 0)\n");
+    OsDbgMsg("   -wait             wait policy for -deadline and -fused\n");
+    OsDbgMsg("     policy          sleep (default), hybrid = sleep then busy-poll, spin = busy-poll (isolated core only)\n");
+    OsDbgMsg("     spin            hybrid: busy-poll time in usec before the deadline (default = %d)\n", DEADLINE_DEFAULT_SPIN_USEC);
+#endif
 #if (defined ATEMRAS_SERVER)
     OsDbgMsg("   -sp               Server port binding\n");
     OsDbgMsg("     port            port (default = %d)\n", ATEMRAS_DEFAULT_PORT);
@@ -762,6 +811,13 @@ EC_T_CPUSET       CpuSet;
 #elif (defined __INTIME__)
     hTimingAlarm = CreateRtAlarm(KN_REPEATER, pTimingDesc->dwBusCycleTimeUsec);
 #endif
+#if (defined DEADLINE_TIMER_SUPPORTED)
+    if (pTimingDesc->bUseDeadline)
+    {
+        DeadlineTimerInit(&pTimingDesc->oDeadlineTimer, pTimingDesc->dwBusCycleTimeUsec, pTimingDesc->dwWakeAheadUsec);
+        DeadlineTimerSetWaitPolicy(&pTimingDesc->oDeadlineTimer, pTimingDesc->eWaitPolicy, pTimingDesc->dwSpinUsec);
+    }
+#endif
 
     /* timing task started */
     pTimingDesc->bIsRunning = EC_TRUE;
@@ -834,6 +890,14 @@ EC_T_CPUSET       CpuSet;
             OsSleep(EC_MAX(pTimingDesc->dwBusCycleTimeUsec/dwUsFactor, 1));
         }
 #else
+#if (defined DEADLINE_TIMER_SUPPORTED)
+        if (pTimingDesc->bUseDeadline)
+        {
+            /* wait for next period boundary (absolute deadline, cycles below 1ms possible) */
+            DeadlineTimerWait(&pTimingDesc->oDeadlineTimer);
+        }
+        else
+#endif
         {
             /* wait for next cycle (no cycle below 1ms) */
             OsSleep(EC_MAX(pTimingDesc->dwBusCycleTimeUsec / 1000, 1));
@@ -860,6 +924,125 @@ Exit:
 }
 #endif /* !RTAI && !XENOMAI */
 
+/********************************************************************************/
+/** \brief  Parse CPU affinity map, e.g. "job=2,timer=2,ist=3,log=0,main=0,ras=1".
+*
+* \return  EC_TRUE on success, EC_FALSE on syntax error.
+*/
+static EC_T_BOOL ParseAffinityMap(const EC_T_CHAR* szMap, T_DEMO_AFFINITY* pAffinity)
+{
+struct
+{
+    const EC_T_CHAR* szName;
+    EC_T_DWORD*      pdwCpuIndex;
+} aEntry[] =
+{
+    { "job",   &pAffinity->dwJob   },
+    { "timer", &pAffinity->dwTimer },
+    { "ist",   &pAffinity->dwIst   },
+    { "log",   &pAffinity->dwLog   },
+    { "main",  &pAffinity->dwMain  },
+    { "ras",   &pAffinity->dwRas   }
+};
+const EC_T_CHAR* pcName   = szMap;
+EC_T_CHAR*       pcEnd    = EC_NULL;
+EC_T_DWORD       dwLen    = 0;
+EC_T_DWORD       dwIdx    = 0;
+EC_T_DWORD       dwNumEntries = sizeof(aEntry) / sizeof(aEntry[0]);
+
+    while ('\0' != *pcName)
+    {
+        /* thread name */
+        for (dwLen = 0; ('\0' != pcName[dwLen]) && ('=' != pcName[dwLen]); dwLen++)
+        {
+        }
+        if ('=' != pcName[dwLen])
+        {
+            return EC_FALSE;
+        }
+        for (dwIdx = 0; dwIdx < dwNumEntries; dwIdx++)
+        {
+            if ((OsStrlen(aEntry[dwIdx].szName) == dwLen) && (0 == OsStrncmp(pcName, aEntry[dwIdx].szName, dwLen)))
+            {
+                break;
+            }
+        }
+        if (dwIdx == dwNumEntries)
+        {
+            OsDbgMsg("Unknown thread name in affinity map: %s\n", pcName);
+            return EC_FALSE;
+        }
+        /* CPU index */
+        *aEntry[dwIdx].pdwCpuIndex = (EC_T_DWORD)OsStrtol(&pcName[dwLen + 1], &pcEnd, 0);
+        if ((pcEnd == &pcName[dwLen + 1]) || (('\0' != *pcEnd) && (',' != *pcEnd)))
+        {
+            return EC_FALSE;
+        }
+        pcName = ('\0' == *pcEnd) ? pcEnd : (pcEnd + 1);
+    }
+    return EC_TRUE;
+}
+
+/********************************************************************************/
+/** \brief  Use the common CPU index for all threads not given in the affinity map.
+*
+* \return  N/A
+*/
+static EC_T_VOID ApplyDefaultAffinity(T_DEMO_AFFINITY* pAffinity, EC_T_DWORD dwCpuIndex)
+{
+    if (DEMO_AFFINITY_UNSET == pAffinity->dwJob)   pAffinity->dwJob   = dwCpuIndex;
+    if (DEMO_AFFINITY_UNSET == pAffinity->dwTimer) pAffinity->dwTimer = dwCpuIndex;
+    if (DEMO_AFFINITY_UNSET == pAffinity->dwIst)   pAffinity->dwIst   = dwCpuIndex;
+    if (DEMO_AFFINITY_UNSET == pAffinity->dwLog)   pAffinity->dwLog   = dwCpuIndex;
+    if (DEMO_AFFINITY_UNSET == pAffinity->dwMain)  pAffinity->dwMain  = dwCpuIndex;
+    if (DEMO_AFFINITY_UNSET == pAffinity->dwRas)   pAffinity->dwRas   = dwCpuIndex;
+}
+
+/********************************************************************************/
+/** \brief  Warn if realtime threads share a CPU with non-realtime threads.
+*
+* \return  N/A
+*/
+static EC_T_VOID CheckAffinityMap(T_DEMO_CFG* pDemoCfg)
+{
+struct
+{
+    const EC_T_CHAR* szName;
+    EC_T_DWORD       dwCpuIndex;
+} aRtThread[] =
+{
+    { "job",   pDemoCfg->oAffinity.dwJob   },
+    { "timer", pDemoCfg->oAffinity.dwTimer },
+    { "ist",   pDemoCfg->oAffinity.dwIst   },
+    { "acyc",  pDemoCfg->dwAcycCpuIndex    }
+},
+aNonRtThread[] =
+{
+    { "log",   pDemoCfg->oAffinity.dwLog   },
+    { "main",  pDemoCfg->oAffinity.dwMain  },
+    { "ras",   pDemoCfg->oAffinity.dwRas   }
+};
+EC_T_DWORD dwNumRtThreads = sizeof(aRtThread) / sizeof(aRtThread[0]);
+EC_T_DWORD dwRtIdx        = 0;
+EC_T_DWORD dwNonRtIdx     = 0;
+
+    if (!pDemoCfg->bAcycThread)
+    {
+        dwNumRtThreads--;
+    }
+    for (dwRtIdx = 0; dwRtIdx < dwNumRtThreads; dwRtIdx++)
+    {
+        for (dwNonRtIdx = 0; dwNonRtIdx < sizeof(aNonRtThread) / sizeof(aNonRtThread[0]); dwNonRtIdx++)
+        {
+            if (aRtThread[dwRtIdx].dwCpuIndex == aNonRtThread[dwNonRtIdx].dwCpuIndex)
+            {
+                OsDbgMsg("WARNING: realtime thread '%s' shares CPU %d with non-realtime thread '%s'\n",
+                    aRtThread[dwRtIdx].szName, aRtThread[dwRtIdx].dwCpuIndex, aNonRtThread[dwNonRtIdx].szName);
+            }
+        }
+    }
+}
+
 /********************************************************************************/
 /** \brief  Demo Application entry point.
 *
@@ -912,6 +1095,9 @@ int main(int nArgc, char* ppArgv[])
     EC_T_CHAR               tcStorage           = '\0';
 
     EC_T_CHAR               szLogFileprefix[256] = {'\0'};
+    EC_T_BOOL               bLogDeferred        = EC_FALSE;
+    EC_T_DWORD              dwLogCoalesceMsec   = 0;
+    EC_T_BOOL               bLogBinary          = EC_FALSE;
     EC_T_CNF_TYPE           eCnfType            = eCnfType_Unknown;
     EC_T_PBYTE              pbyCnfData          = 0;
     EC_T_DWORD              dwCnfDataLen        = 0;
@@ -928,7 +1114,15 @@ int main(int nArgc, char* ppArgv[])
     EC_T_BOOL               bEnaPerfJobs        = EC_FALSE;  /* enable job measurements */
     EC_T_TIMING_DESC        TimingDesc;
     EC_T_BOOL               bStartTimingTask    = EC_FALSE;
+    T_DEMO_CFG              DemoCfg;
+#if (defined DEADLINE_TIMER_SUPPORTED)
+    EC_T_BOOL               bWaitPolicySet      = EC_FALSE;  /* -wait given, needs -deadline or -fused */
+#endif
     EC_T_INT                nVerbose            = 1;
+    EC_T_DWORD              dwDioBenchChannels  = 0;         /* run digital I/O benchmark instead of the demo */
+    EC_T_DWORD              dwLogBenchMsgs      = 0;         /* run logging benchmark instead of the demo */
+    EC_T_CHAR               szReplayFileName[256] = {'\0'}; /* replay recorded process data instead of the demo */
+    EC_T_BOOL               bReplayPaced        = EC_FALSE;  /* replay paced to the recorded bus cycle time */
 #if (defined UNDER_CE) && (_WIN32_WCE >= 0x600)
     BOOL                    bRes                = FALSE;
     DWORD                   dwAuxClkSysIntr     = 0;
@@ -944,6 +1138,13 @@ int main(int nArgc, char* ppArgv[])
 #endif /* EC_VERSION_RTEMS */
     OsMemset(apLinkParms, 0, sizeof(apLinkParms));
     OsMemset(&TimingDesc, 0, sizeof(TimingDesc));
+    OsMemset(&DemoCfg, 0, sizeof(DemoCfg));
+    DemoCfg.oAffinity.dwJob   = DEMO_AFFINITY_UNSET;
+    DemoCfg.oAffinity.dwTimer = DEMO_AFFINITY_UNSET;
+    DemoCfg.oAffinity.dwIst   = DEMO_AFFINITY_UNSET;
+    DemoCfg.oAffinity.dwLog   = DEMO_AFFINITY_UNSET;
+    DemoCfg.oAffinity.dwMain  = DEMO_AFFINITY_UNSET;
+    DemoCfg.oAffinity.dwRas   = DEMO_AFFINITY_UNSET;
 
     szCommandLine[0] = '\0';
 
@@ -1280,6 +1481,24 @@ int main(int nArgc, char* ppArgv[])
             }
             OsSnprintf(szLogFileprefix, sizeof(szLogFileprefix) - 1, "%s", ptcWord);
         }
+        else if (OsStricmp( ptcWord, "-logdefer") == 0)
+        {
+            bLogDeferred = EC_TRUE;
+        }
+        else if (OsStricmp( ptcWord, "-logcoalesce") == 0)
+        {
+            ptcWord = GetNextWord((EC_T_CHAR**)&szCommandLine, &tcStorage);
+            if ((ptcWord == EC_NULL) || (OsStrncmp(ptcWord, "-", 1) == 0))
+            {
+                nRetVal = SYNTAX_ERROR;
+                goto Exit;
+            }
+            dwLogCoalesceMsec = OsStrtol(ptcWord, EC_NULL, 0);
+        }
+        else if (OsStricmp( ptcWord, "-logbin") == 0)
+        {
+            bLogBinary = EC_TRUE;
+        }
         else if (OsStricmp( ptcWord, "-t") == 0)
         {
             ptcWord = GetNextWord((EC_T_CHAR**)&szCommandLine, &tcStorage );
@@ -1333,6 +1552,12 @@ int main(int nArgc, char* ppArgv[])
                     goto Exit;
                 }
                 TimingDesc.dwBusCycleTimeUsec = OsStrtol(ptcWord, EC_NULL, 0);
+                if ((0 == TimingDesc.dwBusCycleTimeUsec) || (TimingDesc.dwBusCycleTimeUsec > DEADLINE_MAX_CYCLE_TIME_USEC))
+                {
+                    OsDbgMsg("Syntax error: -b cycle time must be 1..%d usec\n", DEADLINE_MAX_CYCLE_TIME_USEC);
+                    nRetVal = SYNTAX_ERROR;
+                    goto Exit;
+                }
             }
         }
         else if (OsStricmp( ptcWord, "-a") == 0)
@@ -1343,7 +1568,19 @@ int main(int nArgc, char* ppArgv[])
                 nRetVal = SYNTAX_ERROR;
                 goto Exit;
             }
-            dwCpuIndex = OsStrtol(ptcWord, EC_NULL, 0);
+            if ((ptcWord[0] < '0') || (ptcWord[0] > '9'))
+            {
+                /* affinity map, e.g. job=2,timer=2,ist=3,log=0,main=0,ras=1 */
+                if (!ParseAffinityMap(ptcWord, &DemoCfg.oAffinity))
+                {
+                    nRetVal = SYNTAX_ERROR;
+                    goto Exit;
+                }
+            }
+            else
+            {
+                dwCpuIndex = OsStrtol(ptcWord, EC_NULL, 0);
+            }
         }
         else if (OsStricmp( ptcWord, "-v") == 0)
         {
@@ -1355,10 +1592,248 @@ int main(int nArgc, char* ppArgv[])
             }
             nVerbose = OsStrtol(ptcWord, EC_NULL, 10);
         }
+        else if (OsStricmp( ptcWord, "-diobench") == 0)
+        {
+            ptcWord = GetNextWord((EC_T_CHAR**)&szCommandLine, &tcStorage);
+            if ((ptcWord == EC_NULL) || (OsStrncmp(ptcWord, "-", 1) == 0))
+            {
+                dwDioBenchChannels = DIO_BENCH_DEFAULT_CHANNELS;
+
+                /* optional sub parameter not found, use the current word for the next parameter */
+                bGetNextWord = EC_FALSE;
+            }
+            else
+            {
+                dwDioBenchChannels = OsStrtol(ptcWord, EC_NULL, 0);
+            }
+        }
+        else if (OsStricmp( ptcWord, "-logbench") == 0)
+        {
+            ptcWord = GetNextWord((EC_T_CHAR**)&szCommandLine, &tcStorage);
+            if ((ptcWord == EC_NULL) || (OsStrncmp(ptcWord, "-", 1) == 0))
+            {
+                dwLogBenchMsgs = LOG_BENCH_DEFAULT_MSGS;
+
+                /* optional sub parameter not found, use the current word for the next parameter */
+                bGetNextWord = EC_FALSE;
+            }
+            else
+            {
+                dwLogBenchMsgs = OsStrtol(ptcWord, EC_NULL, 0);
+            }
+        }
+        else if (OsStricmp( ptcWord, "-replay") == 0)
+        {
+            ptcWord = GetNextWord((EC_T_CHAR**)&szCommandLine, &tcStorage);
+            if ((ptcWord == EC_NULL) || (OsStrncmp(ptcWord, "-", 1) == 0))
+            {
+                nRetVal = SYNTAX_ERROR;
+                goto Exit;
+            }
+            OsSnprintf(szReplayFileName, sizeof(szReplayFileName) - 1, "%s", ptcWord);
+            ptcWord = GetNextWord((EC_T_CHAR**)&szCommandLine, &tcStorage);
+            if ((ptcWord != EC_NULL) && (OsStricmp(ptcWord, "paced") == 0))
+            {
+                bReplayPaced = EC_TRUE;
+            }
+            else
+            {
+                /* optional sub parameter not found, use the current word for the next parameter */
+                bGetNextWord = EC_FALSE;
+            }
+        }
+        else if (OsStricmp( ptcWord, "-pipelined") == 0)
+        {
+            DemoCfg.bPipelined = EC_TRUE;
+        }
+        else if (OsStricmp( ptcWord, "-acycthread") == 0)
+        {
+            DemoCfg.bAcycThread = EC_TRUE;
+            ptcWord = GetNextWord((EC_T_CHAR**)&szCommandLine, &tcStorage);
+            if ((ptcWord == EC_NULL) || (OsStrncmp( ptcWord, "-", 1) == 0))
+            {
+                nRetVal = SYNTAX_ERROR;
+                goto Exit;
+            }
+            DemoCfg.dwAcycCpuIndex = OsStrtol(ptcWord, EC_NULL, 0);
+            ptcWord = GetNextWord((EC_T_CHAR**)&szCommandLine, &tcStorage);
+            if ((ptcWord == EC_NULL) || (OsStrncmp(ptcWord, "-", 1) == 0))
+            {
+                DemoCfg.dwAcycThreadPrio = ACYC_THREAD_PRIO;
+
+                /* optional sub parameter not found, use the current word for the next parameter */
+                bGetNextWord = EC_FALSE;
+            }
+            else
+            {
+                DemoCfg.dwAcycThreadPrio = OsStrtol(ptcWord, EC_NULL, 0);
+            }
+        }
+        else if (OsStricmp( ptcWord, "-shm") == 0)
+        {
+            DemoCfg.bPdShm = EC_TRUE;
+            ptcWord = GetNextWord((EC_T_CHAR**)&szCommandLine, &tcStorage);
+            if ((ptcWord == EC_NULL) || (OsStrncmp(ptcWord, "-", 1) == 0))
+            {
+                OsSnprintf(DemoCfg.szPdShmName, sizeof(DemoCfg.szPdShmName) - 1, "%s", PD_SHM_DEFAULT_NAME);
+
+                /* optional sub parameter not found, use the current word for the next parameter */
+                bGetNextWord = EC_FALSE;
+            }
+            else
+            {
+                OsSnprintf(DemoCfg.szPdShmName, sizeof(DemoCfg.szPdShmName) - 1, "%s", ptcWord);
+            }
+        }
+        else if (OsStricmp( ptcWord, "-rec") == 0)
+        {
+            DemoCfg.bPdRec            = EC_TRUE;
+            DemoCfg.dwPdRecFileSizeMb = PD_REC_DEFAULT_FILE_SIZE_MB;
+            DemoCfg.dwPdRecNumFiles   = PD_REC_DEFAULT_NUM_FILES;
+            ptcWord = GetNextWord((EC_T_CHAR**)&szCommandLine, &tcStorage);
+            if ((ptcWord == EC_NULL) || (OsStrncmp(ptcWord, "-", 1) == 0))
+            {
+                /* optional sub parameter not found, use the current word for the next parameter */
+                bGetNextWord = EC_FALSE;
+            }
+            else
+            {
+                DemoCfg.dwPdRecFileSizeMb = OsStrtol(ptcWord, EC_NULL, 0);
+                if ((0 == DemoCfg.dwPdRecFileSizeMb) || (DemoCfg.dwPdRecFileSizeMb > PD_REC_MAX_FILE_SIZE_MB))
+                {
+                    OsDbgMsg("Syntax error: -rec size must be 1..%d MByte\n", PD_REC_MAX_FILE_SIZE_MB);
+                    nRetVal = SYNTAX_ERROR;
+                    goto Exit;
+                }
+                ptcWord = GetNextWord((EC_T_CHAR**)&szCommandLine, &tcStorage);
+                if ((ptcWord == EC_NULL) || (OsStrncmp(ptcWord, "-", 1) == 0))
+                {
+                    /* optional sub parameter not found, use the current word for the next parameter */
+                    bGetNextWord = EC_FALSE;
+                }
+                else
+                {
+                    DemoCfg.dwPdRecNumFiles = OsStrtol(ptcWord, EC_NULL, 0);
+                }
+            }
+        }
+        else if (OsStricmp( ptcWord, "-force") == 0)
+        {
+            ptcWord = GetNextWord((EC_T_CHAR**)&szCommandLine, &tcStorage);
+            if ((ptcWord == EC_NULL) || (OsStrncmp(ptcWord, "-", 1) == 0))
+            {
+                nRetVal = SYNTAX_ERROR;
+                goto Exit;
+            }
+            OsSnprintf(DemoCfg.szPdForceFile, sizeof(DemoCfg.szPdForceFile) - 1, "%s", ptcWord);
+        }
+        else if (OsStricmp( ptcWord, "-trace") == 0)
+        {
+            DemoCfg.bTrace = EC_TRUE;
+            ptcWord = GetNextWord((EC_T_CHAR**)&szCommandLine, &tcStorage);
+            if ((ptcWord == EC_NULL) || (OsStrncmp(ptcWord, "-", 1) == 0))
+            {
+                DemoCfg.dwTraceCycles = TRACE_DEFAULT_NUM_CYCLES;
+
+                /* optional sub parameter not found, use the current word for the next parameter */
+                bGetNextWord = EC_FALSE;
+            }
+            else
+            {
+                DemoCfg.dwTraceCycles = OsStrtol(ptcWord, EC_NULL, 0);
+            }
+        }
         else if (OsStricmp( ptcWord, "-perf") == 0)
         {
             bEnaPerfJobs = EC_TRUE;
+            ptcWord = GetNextWord((EC_T_CHAR**)&szCommandLine, &tcStorage);
+            if ((ptcWord == EC_NULL) || (OsStrncmp(ptcWord, "-", 1) == 0))
+            {
+                DemoCfg.dwOutlierUsec = 0;
+
+                /* optional sub parameter not found, use the current word for the next parameter */
+                bGetNextWord = EC_FALSE;
+            }
+            else
+            {
+                DemoCfg.dwOutlierUsec = OsStrtol(ptcWord, EC_NULL, 0);
+            }
+        }
+#if (defined DEADLINE_TIMER_SUPPORTED)
+        else if (OsStricmp( ptcWord, "-deadline") == 0)
+        {
+            TimingDesc.bUseDeadline = EC_TRUE;
+            ptcWord = GetNextWord((EC_T_CHAR**)&szCommandLine, &tcStorage);
+            if ((ptcWord == EC_NULL) || (OsStrncmp(ptcWord, "-", 1) == 0))
+            {
+                TimingDesc.dwWakeAheadUsec = 0;
+
+                /* optional sub parameter not found, use the current word for the next parameter */
+                bGetNextWord = EC_FALSE;
+            }
+            else
+            {
+                TimingDesc.dwWakeAheadUsec = OsStrtol(ptcWord, EC_NULL, 0);
+            }
         }
+        else if (OsStricmp( ptcWord, "-fused") == 0)
+        {
+            DemoCfg.bFusedTiming = EC_TRUE;
+            ptcWord = GetNextWord((EC_T_CHAR**)&szCommandLine, &tcStorage);
+            if ((ptcWord == EC_NULL) || (OsStrncmp(ptcWord, "-", 1) == 0))
+            {
+                DemoCfg.dwWakeAheadUsec = 0;
+
+                /* optional sub parameter not found, use the current word for the next parameter */
+                bGetNextWord = EC_FALSE;
+            }
+            else
+            {
+                DemoCfg.dwWakeAheadUsec = OsStrtol(ptcWord, EC_NULL, 0);
+            }
+        }
+        else if (OsStricmp( ptcWord, "-wait") == 0)
+        {
+            ptcWord = GetNextWord((EC_T_CHAR**)&szCommandLine, &tcStorage);
+            if (ptcWord == EC_NULL)
+            {
+                nRetVal = SYNTAX_ERROR;
+                goto Exit;
+            }
+            else if (OsStricmp(ptcWord, "sleep") == 0)
+            {
+                DemoCfg.eWaitPolicy = eDeadlineWait_Sleep;
+            }
+            else if (OsStricmp(ptcWord, "hybrid") == 0)
+            {
+                DemoCfg.eWaitPolicy = eDeadlineWait_Hybrid;
+            }
+            else if (OsStricmp(ptcWord, "spin") == 0)
+            {
+                DemoCfg.eWaitPolicy = eDeadlineWait_Spin;
+            }
+            else
+            {
+                nRetVal = SYNTAX_ERROR;
+                goto Exit;
+            }
+            ptcWord = GetNextWord((EC_T_CHAR**)&szCommandLine, &tcStorage);
+            if ((ptcWord == EC_NULL) || (OsStrncmp(ptcWord, "-", 1) == 0))
+            {
+                DemoCfg.dwSpinUsec = DEADLINE_DEFAULT_SPIN_USEC;
+
+                /* optional sub parameter not found, use the current word for the next parameter */
+                bGetNextWord = EC_FALSE;
+            }
+            else
+            {
+                DemoCfg.dwSpinUsec = OsStrtol(ptcWord, EC_NULL, 0);
+            }
+            TimingDesc.eWaitPolicy = DemoCfg.eWaitPolicy;
+            TimingDesc.dwSpinUsec  = DemoCfg.dwSpinUsec;
+            bWaitPolicySet = EC_TRUE;
+        }
+#endif
 #if (defined ATEMRAS_SERVER)
         else if( OsStricmp(ptcWord, "-sp") == 0 )
         {
@@ -1391,13 +1866,8 @@ int main(int nArgc, char* ppArgv[])
            }
            else
            {
-#ifdef LINUX
-               EC_CPUSET_ZERO(CpuSet);
-               EC_CPUSET_SET(CpuSet, dwCpuIndex);
-               apLinkParms[dwNumLinkLayer]->dwIstPriority = (CpuSet << 16) | RECV_THREAD_PRIO;
-#else
+               /* CPU set of the receive thread is added after all parameters are known */
                apLinkParms[dwNumLinkLayer]->dwIstPriority = RECV_THREAD_PRIO;
-#endif
                dwNumLinkLayer++;
            }
         }
@@ -1408,14 +1878,54 @@ int main(int nArgc, char* ppArgv[])
         }
         bGetNextWord = EC_TRUE;
     }
+    /* threads not given in the affinity map use the CPU index given by -a */
+    ApplyDefaultAffinity(&DemoCfg.oAffinity, dwCpuIndex);
+#ifdef LINUX
+    {
+    EC_T_DWORD dwLinkLayerIdx = 0;
+
+        EC_CPUSET_ZERO(CpuSet);
+        EC_CPUSET_SET(CpuSet, DemoCfg.oAffinity.dwIst);
+        for (dwLinkLayerIdx = 0; dwLinkLayerIdx < dwNumLinkLayer; dwLinkLayerIdx++)
+        {
+            apLinkParms[dwLinkLayerIdx]->dwIstPriority = (CpuSet << 16) | RECV_THREAD_PRIO;
+        }
+    }
+#endif
     /* initialize master logging */
-    oLogging.InitLogging(0, LOG_ROLLOVER, LOG_THREAD_PRIO, dwCpuIndex, szLogFileprefix, LOG_THREAD_STACKSIZE);
+    oLogging.SetBinaryFormat(bLogBinary);
+    oLogging.InitLogging(0, LOG_ROLLOVER, LOG_THREAD_PRIO, DemoCfg.oAffinity.dwLog, szLogFileprefix, LOG_THREAD_STACKSIZE);
     bLogInitialized = EC_TRUE;
+    oLogging.SetDeferredFormat(bLogDeferred);
+    oLogging.SetWakeUpCoalescing(dwLogCoalesceMsec);
 #if !(defined XENOMAI) || (defined CONFIG_XENO_COBALT) || (defined CONFIG_XENO_MERCURY) 
-    oLogging.SetLogThreadAffinity(dwCpuIndex);
+    oLogging.SetLogThreadAffinity(DemoCfg.oAffinity.dwLog);
 #endif /* !XENOMAI || CONFIG_XENO_COBALT || CONFIG_XENO_MERCURY */
     OsAddDbgMsgHook(CAtEmLogging::OsDbgMsgHookWrapper);
     LogMsg("Full command line: %s\n", szFullCommandLine);
+    CheckAffinityMap(&DemoCfg);
+
+    /* compare bulk digital I/O pack/unpack with EC_GETBITS/EC_SETBITS, no EtherCAT master needed */
+    if (0 != dwDioBenchChannels)
+    {
+        dwRes = DioBenchmark(&oLogging, dwDioBenchChannels);
+        nRetVal = (EC_E_NOERROR == dwRes) ? APP_NOERROR : APP_ERROR;
+        goto Exit;
+    }
+    /* log concurrently from several threads, no EtherCAT master needed */
+    if (0 != dwLogBenchMsgs)
+    {
+        dwRes = LogBenchmark(&oLogging, dwLogBenchMsgs, MAIN_THREAD_PRIO);
+        nRetVal = (EC_E_NOERROR == dwRes) ? APP_NOERROR : APP_ERROR;
+        goto Exit;
+    }
+    /* replay recorded process data through the application, no EtherCAT master needed */
+    if ('\0' != szReplayFileName[0])
+    {
+        dwRes = ATEMDemoReplay(&oLogging, szReplayFileName, bReplayPaced, nVerbose);
+        nRetVal = (EC_E_NOERROR == dwRes) ? APP_NOERROR : APP_ERROR;
+        goto Exit;
+    }
 
     /* determine master configuration type */
 #if (defined __RCX__)
@@ -1446,17 +1956,30 @@ int main(int nArgc, char* ppArgv[])
         nRetVal = SYNTAX_ERROR;
         goto Exit;
     }
+#if (defined DEADLINE_TIMER_SUPPORTED)
+    if (bWaitPolicySet && !(TimingDesc.bUseDeadline || DemoCfg.bFusedTiming))
+    {
+        OsDbgMsg("Syntax error: -wait needs -deadline or -fused\n");
+        nRetVal = SYNTAX_ERROR;
+        goto Exit;
+    }
+    if (TimingDesc.bUseDeadline)
+    {
+        /* the job task measures its wake-up error against the deadline of tEcTimingTask */
+        DemoCfg.pTimingDeadlineTimer = &TimingDesc.oDeadlineTimer;
+    }
+#endif
 #if !(defined RTAI)
     /* for multi core cpus: select cpu number for this thread */
     EC_CPUSET_ZERO( CpuSet );
-    EC_CPUSET_SET( CpuSet, dwCpuIndex );
+    EC_CPUSET_SET( CpuSet, DemoCfg.oAffinity.dwMain );
     if( ! OsSetThreadAffinity(EC_NULL, CpuSet) )
     {
        OsDbgMsg("ERROR: Set Affinity Failed!\n");
     }
 #endif
 #if !(defined RTAI)
-    TimingDesc.dwCpuIndex = dwCpuIndex;
+    TimingDesc.dwCpuIndex = DemoCfg.oAffinity.dwTimer;
 
     /* create timing event to trigger the job task */
     TimingDesc.pvTimingEvent = OsCreateEvent();
@@ -1467,7 +1990,12 @@ int main(int nArgc, char* ppArgv[])
     }
 
 #if ((defined LINUX) && (defined AUXCLOCK_SUPPORTED))
+#if (defined DEADLINE_TIMER_SUPPORTED)
+    /* deadline timing is done by the timing task or by the job task itself */
+    TimingDesc.bUseAuxClock = !(TimingDesc.bUseDeadline || DemoCfg.bFusedTiming);
+#else
     TimingDesc.bUseAuxClock = EC_TRUE;
+#endif
 #endif /* LINUX && AUXCLOCK_SUPPORTED */
 
 #if (defined AUXCLOCK_SUPPORTED)
@@ -1536,7 +2064,7 @@ int main(int nArgc, char* ppArgv[])
         liTimer.QuadPart = (LONGLONG)10*TimingDesc.dwBusCycleTimeUsec;
         RtSetTimerRelative(hTimer, &liTimer, &liTimer);
 #else
-        dwRes = OsAuxClkInit( dwCpuIndex, 1000000 / TimingDesc.dwBusCycleTimeUsec, TimingDesc.pvTimingEvent );
+        dwRes = OsAuxClkInit( DemoCfg.oAffinity.dwTimer, 1000000 / TimingDesc.dwBusCycleTimeUsec, TimingDesc.pvTimingEvent );
         if( EC_E_NOERROR != dwRes )
         {
             OsDbgMsg( "ERROR at auxiliary clock initialization!\n" );
@@ -1588,6 +2116,13 @@ int main(int nArgc, char* ppArgv[])
         bStartTimingTask = EC_FALSE; //No timing task needed
 #endif /* EC_VERSION_RTEMS */
     }
+#if (defined DEADLINE_TIMER_SUPPORTED)
+    if (DemoCfg.bFusedTiming)
+    {
+        /* the job task waits for the period boundary itself */
+        bStartTimingTask = EC_FALSE;
+    }
+#endif
     /* create timing task if needed */
     if (bStartTimingTask)
     {
@@ -1602,17 +2137,28 @@ int main(int nArgc, char* ppArgv[])
 #if (defined AUXCLOCK_SUPPORTED)
     OsDbgMsg("Using %s\n",
           (TimingDesc.bUseAuxClock ? "AuxClock" : "Sleep"));
+#endif
+#if (defined DEADLINE_TIMER_SUPPORTED)
+    if (TimingDesc.bUseDeadline)
+    {
+        OsDbgMsg("Using absolute deadline, wake-ahead %d usec, wait %s\n", TimingDesc.dwWakeAheadUsec, DeadlineWaitPolicyText(TimingDesc.eWaitPolicy));
+    }
+    if (DemoCfg.bFusedTiming)
+    {
+        OsDbgMsg("Using fused timer/job task, wake-ahead %d usec, wait %s\n", DemoCfg.dwWakeAheadUsec, DeadlineWaitPolicyText(DemoCfg.eWaitPolicy));
+    }
 #endif
     dwRes = ATEMDemo( &oLogging,
                       eCnfType, pbyCnfData, dwCnfDataLen,
                       TimingDesc.dwBusCycleTimeUsec, nVerbose, dwDuration,
                       apLinkParms[0],
-                      TimingDesc.pvTimingEvent, dwCpuIndex,
+                      TimingDesc.pvTimingEvent, DemoCfg.oAffinity.dwJob,
                       bEnaPerfJobs
 #if (defined ATEMRAS_SERVER)
                       ,wServerPort
 #endif
                       ,((2 == dwNumLinkLayer)?apLinkParms[1]:EC_NULL)
+                      ,&DemoCfg
                     );
     if (EC_E_NOERROR != dwRes)
     {
@@ -1646,6 +2192,12 @@ Exit:
         }
     }
 #endif
+#if (defined DEADLINE_TIMER_SUPPORTED)
+    if (TimingDesc.bUseDeadline && bLogInitialized)
+    {
+        DeadlineTimerShow(&TimingDesc.oDeadlineTimer, &oLogging, "tEcTimingTask");
+    }
+#endif
 #if (defined AUXCLOCK_SUPPORTED)
     /* clean up auxclk */
     if( TimingDesc.bUseAuxClock )
@@ -7,10 +7,19 @@
 
 /*-INCLUDES------------------------------------------------------------------*/
 #include "Logging.h"
+#include "ecatDemoTrace.h"
+#include "ecatDemoAtomic.h"
+#include "ecatDemoTiming.h"
+#include "ecatDemoLogBin.h"
 #include "EcError.h"
 #include <string.h>
 #include <stdlib.h>
 
+#if (defined LINUX)
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
 #ifdef VXWORKS
 #include "vxWorks.h"
 #include "sysLib.h"
@@ -28,6 +37,9 @@
 /*-MACROS--------------------------------------------------------------------*/
 /*#define NOPRINTF    1*/
 
+/* signed number as varint, see ecatDemoLogBin.h */
+#define LOG_BIN_ZIGZAG(nVal)    ((((EC_T_UINT64)(nVal)) << 1) ^ (EC_T_UINT64)(((EC_T_INT64)(nVal)) >> 63))
+
 /*-DEFINES-------------------------------------------------------------------*/
 #if !(defined EC_DEMO_TINY)
 
@@ -35,6 +47,8 @@
 #define DEFAULT_ERR_MSG_BUFFER_SIZE  500 /* number of buffered messages */
 #define DEFAULT_LOG_MSG_BUFFER_SIZE 1000 /* number of buffered messages */
 #define DEFAULT_DCM_MSG_BUFFER_SIZE 1000 /* number of buffered messages */
+#define LOG_FILE_BUF_SIZE        0x10000 /* text collected before it is written to the log file */
+#define LOG_BIN_MAX_FORMATS         1024 /* format ids per binary log file */
 
 #else
 
@@ -42,9 +56,25 @@
 #define DEFAULT_ERR_MSG_BUFFER_SIZE    0 /* number of buffered messages */
 #define DEFAULT_LOG_MSG_BUFFER_SIZE   30 /* number of buffered messages */
 #define DEFAULT_DCM_MSG_BUFFER_SIZE    4 /* number of buffered messages */
+#define LOG_FILE_BUF_SIZE          0x400 /* text collected before it is written to the log file */
+#define LOG_BIN_MAX_FORMATS           32 /* format ids per binary log file */
 
 #endif /* !(defined EC_DEMO_TINY) */
 
+#define LOG_DEFER_MAX_SPEC_LEN        32 /* maximum length of a conversion of a deferred message, e.g. "%-08.3lx" */
+
+#define LOG_FILE_BUF_ALIGN          4096 /* alignment of the file buffer */
+#define LOG_FILE_MSG_RESERVE   (3*MAX_MESSAGE_SIZE) /* room for a message, its timestamp and a skip message or their binary records */
+#define LOG_FILE_FLUSH_SIZE    (LOG_FILE_BUF_SIZE/2) /* write the file buffer after a pass if it holds this many bytes */
+#define LOG_FILE_FLUSH_MSEC          100 /* or if its oldest text is this old */
+#define LOG_MIN_MSGS_PER_PASS         20 /* messages per buffer and pass, more if more are queued */
+#define LOG_BIN_NO_MSG       ((EC_T_DWORD)0xFFFFFFFF) /* MSG_BUFFER_DESC::dwBinLastMsgLen before the first message */
+
+/* CAtEmLogging::m_dwLogTaskWait */
+#define LOG_TASK_WAIT_NONE             0 /* log task is processing messages, producers don't wake it up */
+#define LOG_TASK_WAIT_IDLE             1 /* log task waits for the next message */
+#define LOG_TASK_WAIT_COALESCE         2 /* log task waits for the coalescing time or a half full buffer */
+
 #if (defined UNDER_RTSS) || (defined __INTIME__)
     #define ABSOLUTE_LOG_FILE_PATH       "C:\\"
 #else
@@ -80,6 +110,28 @@
 #endif
 
 
+/*-TYPEDEFS------------------------------------------------------------------*/
+/* argument of a conversion of a deferred message */
+typedef enum _T_LOG_ARG_TYPE
+{
+    eLogArg_None = 0,                   /* "%%" */
+    eLogArg_Int,                        /* d, i, o, u, x, X, c without length or with hh, h */
+    eLogArg_Long,                       /* l */
+    eLogArg_LongLong,                   /* ll */
+    eLogArg_Size,                       /* z */
+    eLogArg_Double,                     /* f, F, e, E, g, G, a, A */
+    eLogArg_Ptr,                        /* p */
+    eLogArg_String                      /* s, copied into the message buffer */
+} T_LOG_ARG_TYPE;
+
+/* argument of a deferred message as stored in the message buffer, followed by the characters for eLogArg_String */
+typedef union _T_LOG_ARG
+{
+    EC_T_UINT64 qwVal;
+    EC_T_LREAL  fVal;
+    EC_T_VOID*  pvVal;
+} T_LOG_ARG;
+
 /*-GLOBAL VARIABLES-----------------------------------------------------------*/
 #if (defined VXWORKS) || (defined __TKERNEL) || (defined RTAI)\
     || (defined EC_VERSION_SYSBIOS) || (defined EC_VERSION_RIN32M3) || (defined EC_VERSION_XILINX_STANDALONE)\
@@ -98,6 +150,655 @@ CAtEmLogging* G_pOsDbgMsgLoggingInst = EC_NULL;
 /*-FORWARD DECLARATIONS------------------------------------------------------*/
 
 
+/********************************************************************************/
+/** \brief Parse the conversion at pszSpec[0] == '%'
+*
+* \return length of the conversion including '%', 0 if not supported by deferred messages
+*/
+static EC_T_DWORD LogParseConversion
+(const
+ EC_T_CHAR*         pszSpec             /* [in]  conversion */
+,T_LOG_ARG_TYPE*    peType              /* [out] type of the argument */
+,EC_T_DWORD*        pdwNumStars         /* [out] number of width and precision arguments */
+)
+{
+    const EC_T_CHAR* pch = &pszSpec[1];
+    EC_T_CHAR   chLength = '\0';         /* '\0', 'h', 'l', 'L' (ll) or 'z' */
+    EC_T_BOOL   bPrecision = EC_FALSE;
+    EC_T_DWORD  dwSpecLen = 0;
+
+    *peType = eLogArg_None;
+    *pdwNumStars = 0;
+    if ('%' == *pch)
+    {
+        return 2;
+    }
+    /* flags, width, precision */
+    while (('-' == *pch) || ('+' == *pch) || (' ' == *pch) || ('#' == *pch) || ('0' == *pch))
+    {
+        pch++;
+    }
+    if ('*' == *pch)
+    {
+        (*pdwNumStars)++;
+        pch++;
+    }
+    while (('0' <= *pch) && (*pch <= '9'))
+    {
+        pch++;
+    }
+    if ('.' == *pch)
+    {
+        bPrecision = EC_TRUE;
+        pch++;
+        if ('*' == *pch)
+        {
+            (*pdwNumStars)++;
+            pch++;
+        }
+        while (('0' <= *pch) && (*pch <= '9'))
+        {
+            pch++;
+        }
+    }
+    /* length */
+    if ('h' == *pch)
+    {
+        chLength = 'h';
+        pch++;
+        if ('h' == *pch)
+        {
+            pch++;
+        }
+    }
+    else if ('l' == *pch)
+    {
+        chLength = 'l';
+        pch++;
+        if ('l' == *pch)
+        {
+            chLength = 'L';
+            pch++;
+        }
+    }
+    else if ('z' == *pch)
+    {
+        chLength = 'z';
+        pch++;
+    }
+    /* conversion, e.g. %n, %ls, %.*s, %Lf or positional arguments are not supported */
+    switch (*pch)
+    {
+    case 'd': case 'i': case 'o': case 'u': case 'x': case 'X':
+        switch (chLength)
+        {
+        case 'l': *peType = eLogArg_Long;     break;
+        case 'L': *peType = eLogArg_LongLong; break;
+        case 'z': *peType = eLogArg_Size;     break;
+        default:  *peType = eLogArg_Int;      break;
+        }
+        break;
+    case 'c':
+        if ('\0' != chLength)
+        {
+            return 0;
+        }
+        *peType = eLogArg_Int;
+        break;
+    case 's':
+        /* a string with precision need not be NUL terminated, it cannot be copied */
+        if (('\0' != chLength) || bPrecision)
+        {
+            return 0;
+        }
+        *peType = eLogArg_String;
+        break;
+    case 'p':
+        if ('\0' != chLength)
+        {
+            return 0;
+        }
+        *peType = eLogArg_Ptr;
+        break;
+    case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+        if (('\0' != chLength) && ('l' != chLength))
+        {
+            return 0;
+        }
+        *peType = eLogArg_Double;
+        break;
+    default:
+        return 0;
+    }
+    dwSpecLen = (EC_T_DWORD)(pch + 1 - pszSpec);
+    if (dwSpecLen >= LOG_DEFER_MAX_SPEC_LEN)
+    {
+        return 0;
+    }
+    return dwSpecLen;
+}
+
+/********************************************************************************/
+/** \brief Append an argument to a deferred message
+*
+* \return EC_FALSE if the message buffer is full
+*/
+static EC_T_BOOL LogDeferPut
+(EC_T_CHAR*         pchArgs             /* [in]  message buffer */
+,EC_T_DWORD         dwSize              /* [in]  size of the message buffer */
+,EC_T_DWORD*        pdwOffs             /* [in/out] next free byte */
+,const
+ EC_T_VOID*         pvArg               /* [in]  argument */
+,EC_T_DWORD         dwArgSize           /* [in]  size of the argument */
+)
+{
+    if ((*pdwOffs + dwArgSize) > dwSize)
+    {
+        return EC_FALSE;
+    }
+    OsMemcpy(&pchArgs[*pdwOffs], pvArg, dwArgSize);
+    *pdwOffs += dwArgSize;
+    return EC_TRUE;
+}
+
+/********************************************************************************/
+/** \brief Store the arguments of a message instead of formatting it
+*
+* Only the format is parsed, vaArgs is not changed. Strings are copied.
+* The format must not be longer than the message buffer.
+*
+* \return EC_FALSE if the message has to be formatted immediately
+*/
+static EC_T_BOOL LogDeferArgs
+(EC_T_CHAR*         pchArgs             /* [out] message buffer */
+,EC_T_DWORD         dwSize              /* [in]  size of the message buffer */
+,const
+ EC_T_CHAR*         szFormat            /* [in]  format */
+,EC_T_VALIST        vaArgs              /* [in]  arguments */
+,EC_T_DWORD*        pdwArgsLen          /* [out] bytes stored in pchArgs */
+)
+{
+#if (defined va_copy)
+    EC_T_VALIST     vaCopy;
+    const EC_T_CHAR* pch = EC_NULL;
+    EC_T_DWORD      dwOffs = 0;
+    EC_T_BOOL       bOk = EC_TRUE;
+
+    va_copy(vaCopy, vaArgs);
+    for (pch = szFormat; bOk && ('\0' != *pch); pch++)
+    {
+        T_LOG_ARG_TYPE  eType = eLogArg_None;
+        EC_T_DWORD      dwNumStars = 0;
+        EC_T_DWORD      dwSpecLen = 0;
+        T_LOG_ARG       oArg;
+        const EC_T_CHAR* szArg = EC_NULL;
+
+        if ('%' != *pch)
+        {
+            continue;
+        }
+        dwSpecLen = LogParseConversion(pch, &eType, &dwNumStars);
+        if (0 == dwSpecLen)
+        {
+            bOk = EC_FALSE;
+            break;
+        }
+        pch += dwSpecLen - 1;
+
+        oArg.qwVal = 0;
+        for (; bOk && (dwNumStars > 0); dwNumStars--)
+        {
+            oArg.qwVal = (EC_T_UINT64)(EC_T_INT64)EC_VAARG(vaCopy, EC_T_INT);
+            bOk = LogDeferPut(pchArgs, dwSize, &dwOffs, &oArg, sizeof(oArg));
+        }
+        switch (eType)
+        {
+        case eLogArg_None:
+            continue;
+        case eLogArg_Int:      oArg.qwVal = (EC_T_UINT64)(EC_T_INT64)EC_VAARG(vaCopy, EC_T_INT); break;
+        case eLogArg_Long:     oArg.qwVal = (EC_T_UINT64)(EC_T_INT64)EC_VAARG(vaCopy, long);     break;
+        case eLogArg_LongLong: oArg.qwVal = (EC_T_UINT64)EC_VAARG(vaCopy, long long);            break;
+        case eLogArg_Size:     oArg.qwVal = (EC_T_UINT64)EC_VAARG(vaCopy, size_t);               break;
+        case eLogArg_Double:   oArg.fVal  = EC_VAARG(vaCopy, EC_T_LREAL);                        break;
+        case eLogArg_Ptr:      oArg.pvVal = EC_VAARG(vaCopy, EC_T_VOID*);                        break;
+        case eLogArg_String:
+            /* "(null)" is platform specific, leave it to EcVsnprintf */
+            szArg = EC_VAARG(vaCopy, const EC_T_CHAR*);
+            bOk = (EC_NULL != szArg) && LogDeferPut(pchArgs, dwSize, &dwOffs, szArg, (EC_T_DWORD)OsStrlen(szArg) + 1);
+            continue;
+        }
+        bOk = bOk && LogDeferPut(pchArgs, dwSize, &dwOffs, &oArg, sizeof(oArg));
+    }
+    va_end(vaCopy);
+
+    /* the binary log files store the format in a record of the message size */
+    bOk = bOk && ((EC_T_DWORD)(pch - szFormat) < dwSize);
+    *pdwArgsLen = dwOffs;
+
+    return bOk;
+#else
+    EC_UNREFPARM(pchArgs);
+    EC_UNREFPARM(dwSize);
+    EC_UNREFPARM(szFormat);
+    EC_UNREFPARM(vaArgs);
+    EC_UNREFPARM(pdwArgsLen);
+    return EC_FALSE;
+#endif /* va_copy */
+}
+
+/********************************************************************************/
+/** \brief Format a deferred message, conversion by conversion
+*
+* \return length of the message like EcVsnprintf(), also if pchOut was too small
+*/
+static EC_T_DWORD LogFormatDeferred
+(EC_T_CHAR*         pchOut              /* [out] message */
+,EC_T_DWORD         dwOutSize           /* [in]  size of pchOut */
+,const
+ EC_T_CHAR*         szFormat            /* [in]  format */
+,const
+ EC_T_CHAR*         pchArgs             /* [in]  arguments stored by LogDeferArgs() */
+)
+{
+    const EC_T_CHAR* pch = EC_NULL;
+    EC_T_DWORD  dwLen = 0;
+    EC_T_DWORD  dwOffs = 0;
+
+    for (pch = szFormat; '\0' != *pch; pch++)
+    {
+        T_LOG_ARG_TYPE  eType = eLogArg_None;
+        EC_T_DWORD      dwNumStars = 0;
+        EC_T_DWORD      dwSpecLen = 0;
+        EC_T_DWORD      dwIdx = 0;
+        EC_T_DWORD      dwSpecPos = 0;
+        EC_T_DWORD      dwPos = 0;
+        EC_T_INT        nRes = 0;
+        EC_T_CHAR       szSpec[LOG_DEFER_MAX_SPEC_LEN + 24];
+        T_LOG_ARG       oArg;
+
+        if ('%' != *pch)
+        {
+            if ((dwLen + 1) < dwOutSize)
+            {
+                pchOut[dwLen] = *pch;
+            }
+            dwLen++;
+            continue;
+        }
+        dwSpecLen = LogParseConversion(pch, &eType, &dwNumStars);
+
+        /* copy conversion, width and precision arguments are written into it */
+        for (dwIdx = 0; dwIdx < dwSpecLen; dwIdx++)
+        {
+            if ('*' == pch[dwIdx])
+            {
+                OsMemcpy(&oArg, &pchArgs[dwOffs], sizeof(oArg));
+                dwOffs += sizeof(oArg);
+                if (('.' == pch[dwIdx - 1]) && ((EC_T_INT)oArg.qwVal < 0))
+                {
+                    /* negative precision: as if omitted */
+                    dwSpecPos--;
+                }
+                else
+                {
+                    dwSpecPos += OsSnprintf(&szSpec[dwSpecPos], sizeof(szSpec) - dwSpecPos, "%d", (EC_T_INT)oArg.qwVal);
+                }
+            }
+            else
+            {
+                szSpec[dwSpecPos++] = pch[dwIdx];
+            }
+        }
+        szSpec[dwSpecPos] = '\0';
+        pch += dwSpecLen - 1;
+
+        dwPos = EC_MIN(dwLen, dwOutSize - 1);
+        if ((eType != eLogArg_None) && (eType != eLogArg_String))
+        {
+            OsMemcpy(&oArg, &pchArgs[dwOffs], sizeof(oArg));
+            dwOffs += sizeof(oArg);
+        }
+        switch (eType)
+        {
+        case eLogArg_None:     nRes = OsSnprintf(&pchOut[dwPos], dwOutSize - dwPos, szSpec);                                  break;
+        case eLogArg_Int:      nRes = OsSnprintf(&pchOut[dwPos], dwOutSize - dwPos, szSpec, (EC_T_INT)oArg.qwVal);            break;
+        case eLogArg_Long:     nRes = OsSnprintf(&pchOut[dwPos], dwOutSize - dwPos, szSpec, (long)oArg.qwVal);                break;
+        case eLogArg_LongLong: nRes = OsSnprintf(&pchOut[dwPos], dwOutSize - dwPos, szSpec, (long long)oArg.qwVal);           break;
+        case eLogArg_Size:     nRes = OsSnprintf(&pchOut[dwPos], dwOutSize - dwPos, szSpec, (size_t)oArg.qwVal);              break;
+        case eLogArg_Double:   nRes = OsSnprintf(&pchOut[dwPos], dwOutSize - dwPos, szSpec, oArg.fVal);                       break;
+        case eLogArg_Ptr:      nRes = OsSnprintf(&pchOut[dwPos], dwOutSize - dwPos, szSpec, oArg.pvVal);                      break;
+        case eLogArg_String:
+            nRes = OsSnprintf(&pchOut[dwPos], dwOutSize - dwPos, szSpec, &pchArgs[dwOffs]);
+            dwOffs += (EC_T_DWORD)OsStrlen(&pchArgs[dwOffs]) + 1;
+            break;
+        }
+        if (nRes > 0)
+        {
+            dwLen += (EC_T_DWORD)nRes;
+        }
+    }
+    pchOut[EC_MIN(dwLen, dwOutSize - 1)] = '\0';
+
+    return dwLen;
+}
+
+/********************************************************************************/
+/** \brief Get the id of the calling thread
+*
+* \return thread id, 0 if not available
+*/
+static EC_T_DWORD LogGetThreadId(EC_T_VOID)
+{
+#if (defined LINUX) && (defined SYS_gettid)
+    /* one system call per thread */
+    static __thread EC_T_DWORD S_dwThreadId = 0;
+
+    if (0 == S_dwThreadId)
+    {
+        S_dwThreadId = (EC_T_DWORD)syscall(SYS_gettid);
+    }
+    return S_dwThreadId;
+#elif (defined WIN32) && !(defined UNDER_CE) && !(defined RTOS_32)
+    return (EC_T_DWORD)GetCurrentThreadId();
+#else
+    return 0;
+#endif
+}
+
+/********************************************************************************/
+/** \brief Append a number to a binary record as LEB128 varint
+*
+* \return number of bytes appended, at most LOG_BIN_MAX_VARINT_LEN
+*/
+static EC_T_DWORD LogBinPutVarint
+(EC_T_BYTE*         pbyOut              /* [out] record */
+,EC_T_UINT64        qwVal               /* [in]  number */
+)
+{
+    EC_T_DWORD  dwLen = 0;
+
+    while (qwVal >= 0x80)
+    {
+        pbyOut[dwLen++] = (EC_T_BYTE)(qwVal | 0x80);
+        qwVal >>= 7;
+    }
+    pbyOut[dwLen++] = (EC_T_BYTE)qwVal;
+
+    return dwLen;
+}
+
+/********************************************************************************/
+/** \brief Append the arguments of a deferred message to a binary record
+*
+* \return number of bytes appended
+*/
+static EC_T_DWORD LogBinPutArgs
+(EC_T_BYTE*         pbyOut              /* [out] record */
+,const
+ EC_T_CHAR*         szFormat            /* [in]  format */
+,const
+ EC_T_CHAR*         pchArgs             /* [in]  arguments stored by LogDeferArgs() */
+)
+{
+    const EC_T_CHAR* pch = EC_NULL;
+    EC_T_DWORD  dwLen = 0;
+    EC_T_DWORD  dwOffs = 0;
+
+    for (pch = szFormat; '\0' != *pch; pch++)
+    {
+        T_LOG_ARG_TYPE  eType = eLogArg_None;
+        EC_T_DWORD      dwNumStars = 0;
+        EC_T_DWORD      dwStrLen = 0;
+        T_LOG_ARG       oArg;
+
+        if ('%' != *pch)
+        {
+            continue;
+        }
+        pch += LogParseConversion(pch, &eType, &dwNumStars) - 1;
+
+        for (; dwNumStars > 0; dwNumStars--)
+        {
+            OsMemcpy(&oArg, &pchArgs[dwOffs], sizeof(oArg));
+            dwOffs += sizeof(oArg);
+            dwLen += LogBinPutVarint(&pbyOut[dwLen], LOG_BIN_ZIGZAG(oArg.qwVal));
+        }
+        switch (eType)
+        {
+        case eLogArg_None:
+            break;
+        case eLogArg_String:
+            dwStrLen = (EC_T_DWORD)OsStrlen(&pchArgs[dwOffs]);
+            dwLen += LogBinPutVarint(&pbyOut[dwLen], dwStrLen);
+            OsMemcpy(&pbyOut[dwLen], &pchArgs[dwOffs], dwStrLen);
+            dwLen  += dwStrLen;
+            dwOffs += dwStrLen + 1;
+            break;
+        case eLogArg_Double:
+            OsMemcpy(&oArg, &pchArgs[dwOffs], sizeof(oArg));
+            dwOffs += sizeof(oArg);
+            OsMemcpy(&pbyOut[dwLen], &oArg.fVal, sizeof(oArg.fVal));
+            dwLen += sizeof(oArg.fVal);
+            break;
+        case eLogArg_Ptr:
+            OsMemcpy(&oArg, &pchArgs[dwOffs], sizeof(oArg));
+            dwOffs += sizeof(oArg);
+            dwLen += LogBinPutVarint(&pbyOut[dwLen], LOG_BIN_ZIGZAG((EC_T_UINT64)(size_t)oArg.pvVal));
+            break;
+        default:
+            OsMemcpy(&oArg, &pchArgs[dwOffs], sizeof(oArg));
+            dwOffs += sizeof(oArg);
+            dwLen += LogBinPutVarint(&pbyOut[dwLen], LOG_BIN_ZIGZAG(oArg.qwVal));
+            break;
+        }
+    }
+    return dwLen;
+}
+
+/********************************************************************************/
+/** \brief Append type, flags, time and thread of a message record
+*
+* \return number of bytes appended
+*/
+static EC_T_DWORD LogBinPutMsgHeader
+(MSG_BUFFER_DESC*   pMsgBufferDesc
+,EC_T_BYTE*         pbyOut              /* [out] record */
+,EC_T_BYTE          byType              /* [in]  LOG_BIN_REC_... | LOG_BIN_FLAG_... */
+,const
+ LOG_MSG_DESC*      pMsg                /* [in]  message */
+)
+{
+    EC_T_DWORD  dwLen = 1;
+
+    if (pMsg->dwMsgThreadId != pMsgBufferDesc->dwBinLastThreadId)
+    {
+        byType |= LOG_BIN_FLAG_THREAD;
+    }
+    pbyOut[0] = byType;
+    dwLen += LogBinPutVarint(&pbyOut[dwLen], LOG_BIN_ZIGZAG(pMsg->qwMsgTimestampNsec - pMsgBufferDesc->qwBinLastNsec));
+    dwLen += LogBinPutVarint(&pbyOut[dwLen], LOG_BIN_ZIGZAG((EC_T_INT)(pMsg->dwMsgTimestamp - pMsgBufferDesc->dwBinLastMsec)));
+    if (byType & LOG_BIN_FLAG_THREAD)
+    {
+        dwLen += LogBinPutVarint(&pbyOut[dwLen], pMsg->dwMsgThreadId);
+        pMsgBufferDesc->dwBinLastThreadId = pMsg->dwMsgThreadId;
+    }
+    pMsgBufferDesc->qwBinLastNsec = pMsg->qwMsgTimestampNsec;
+    pMsgBufferDesc->dwBinLastMsec = pMsg->dwMsgTimestamp;
+
+    return dwLen;
+}
+
+/********************************************************************************/
+/** \brief Get the id of a format in the current binary log file
+*
+* A new format gets the next id, its LOG_BIN_REC_FORMAT record is appended
+* to the file buffer. If all ids are used, they are assigned again from 0.
+*
+* \return format id
+*/
+static EC_T_DWORD LogBinFormatId
+(MSG_BUFFER_DESC*   pMsgBufferDesc
+,const
+ EC_T_CHAR*         szFormat            /* [in]  format of a deferred message */
+)
+{
+    EC_T_UINT64 qwAddr = (EC_T_UINT64)(size_t)szFormat;
+    EC_T_BYTE*  pbyOut = (EC_T_BYTE*)pMsgBufferDesc->pchFileBuf;
+    EC_T_DWORD  dwUsed = pMsgBufferDesc->dwFileBufUsed;
+    EC_T_DWORD  dwPos  = 0;
+    EC_T_DWORD  dwId   = 0;
+    EC_T_DWORD  dwLen  = 0;
+
+    dwPos = ((((EC_T_DWORD)qwAddr ^ (EC_T_DWORD)(qwAddr >> 32)) * 0x9E3779B1) >> 16) & pMsgBufferDesc->dwBinFormatHashMask;
+    for (; EC_NULL != pMsgBufferDesc->ppszBinFormatHash[dwPos]; dwPos = (dwPos + 1) & pMsgBufferDesc->dwBinFormatHashMask)
+    {
+        if (pMsgBufferDesc->ppszBinFormatHash[dwPos] == szFormat)
+        {
+            return pMsgBufferDesc->pdwBinFormatIdHash[dwPos];
+        }
+    }
+    if (pMsgBufferDesc->dwNumBinFormats >= LOG_BIN_MAX_FORMATS)
+    {
+        OsMemset(pMsgBufferDesc->ppszBinFormatHash, 0, (pMsgBufferDesc->dwBinFormatHashMask + 1) * sizeof(EC_T_CHAR*));
+        pMsgBufferDesc->dwNumBinFormats = 0;
+        return LogBinFormatId(pMsgBufferDesc, szFormat);
+    }
+    dwId = pMsgBufferDesc->dwNumBinFormats++;
+    pMsgBufferDesc->ppszBinFormatHash[dwPos]  = szFormat;
+    pMsgBufferDesc->pdwBinFormatIdHash[dwPos] = dwId;
+
+    /* shorter than the message size, see LogDeferArgs() */
+    dwLen = (EC_T_DWORD)OsStrlen(szFormat);
+    pbyOut[dwUsed++] = LOG_BIN_REC_FORMAT;
+    dwUsed += LogBinPutVarint(&pbyOut[dwUsed], dwId);
+    dwUsed += LogBinPutVarint(&pbyOut[dwUsed], dwLen);
+    OsMemcpy(&pbyOut[dwUsed], szFormat, dwLen);
+    pMsgBufferDesc->dwFileBufUsed = dwUsed + dwLen;
+
+    return dwId;
+}
+
+/********************************************************************************/
+/** \brief Append the records of a message to the file buffer of a binary log file
+*
+* The file buffer must have room for LOG_FILE_MSG_RESERVE bytes.
+*
+* \return N/A
+*/
+static EC_T_VOID LogBinPutMsg
+(MSG_BUFFER_DESC*   pMsgBufferDesc
+,const
+ LOG_MSG_DESC*      pMsg                /* [in]  message, deferred or formatted */
+,EC_T_DWORD         dwNumSkipped        /* [in]  identical messages skipped before */
+)
+{
+    EC_T_BYTE*  pbyOut   = (EC_T_BYTE*)pMsgBufferDesc->pchFileBuf;
+    EC_T_DWORD  dwFormatId = 0;
+    EC_T_DWORD  dwLen    = 0;
+    EC_T_BYTE   byFlags  = 0;
+
+    if (dwNumSkipped > 0)
+    {
+        byFlags = (EC_T_BYTE)(pMsgBufferDesc->bPrintTimestamp ? LOG_BIN_FLAG_TIMESTAMP : 0);
+        pMsgBufferDesc->dwFileBufUsed += LogBinPutMsgHeader(pMsgBufferDesc, &pbyOut[pMsgBufferDesc->dwFileBufUsed], LOG_BIN_REC_SKIP | byFlags, pMsg);
+        pMsgBufferDesc->dwFileBufUsed += LogBinPutVarint(&pbyOut[pMsgBufferDesc->dwFileBufUsed], dwNumSkipped);
+    }
+    byFlags = 0;
+    if (pMsgBufferDesc->bPrintTimestamp && pMsgBufferDesc->bNewLine)
+    {
+        byFlags |= LOG_BIN_FLAG_TIMESTAMP;
+    }
+    if (pMsg->bMsgCrLf)
+    {
+        byFlags |= LOG_BIN_FLAG_CRLF;
+    }
+    if (EC_NULL != pMsg->szFormat)
+    {
+        /* may append the format record */
+        dwFormatId = LogBinFormatId(pMsgBufferDesc, pMsg->szFormat);
+        pMsgBufferDesc->dwFileBufUsed += LogBinPutMsgHeader(pMsgBufferDesc, &pbyOut[pMsgBufferDesc->dwFileBufUsed], LOG_BIN_REC_MSG | byFlags, pMsg);
+        pMsgBufferDesc->dwFileBufUsed += LogBinPutVarint(&pbyOut[pMsgBufferDesc->dwFileBufUsed], dwFormatId);
+        pMsgBufferDesc->dwFileBufUsed += LogBinPutArgs(&pbyOut[pMsgBufferDesc->dwFileBufUsed], pMsg->szFormat, pMsg->szMsgBuffer);
+    }
+    else
+    {
+        dwLen = (EC_T_DWORD)OsStrlen(pMsg->szMsgBuffer);
+        pMsgBufferDesc->dwFileBufUsed += LogBinPutMsgHeader(pMsgBufferDesc, &pbyOut[pMsgBufferDesc->dwFileBufUsed], LOG_BIN_REC_TEXT | byFlags, pMsg);
+        pMsgBufferDesc->dwFileBufUsed += LogBinPutVarint(&pbyOut[pMsgBufferDesc->dwFileBufUsed], dwLen);
+        OsMemcpy(&pbyOut[pMsgBufferDesc->dwFileBufUsed], pMsg->szMsgBuffer, dwLen);
+        pMsgBufferDesc->dwFileBufUsed += dwLen;
+    }
+}
+
+/********************************************************************************/
+/** \brief Check for a message identical to the previous one of a binary log file
+*
+* Deferred messages are compared by format and arguments, they are not formatted.
+*
+* \return EC_TRUE if the message is a duplicate
+*/
+static EC_T_BOOL LogBinIsDuplicate
+(MSG_BUFFER_DESC*   pMsgBufferDesc
+,const
+ LOG_MSG_DESC*      pMsg                /* [in]  message, deferred or formatted */
+)
+{
+    EC_T_DWORD  dwLen = pMsg->dwLen;
+
+    if (EC_NULL == pMsg->szFormat)
+    {
+        dwLen = (EC_T_DWORD)OsStrlen(pMsg->szMsgBuffer);
+    }
+    if ((pMsgBufferDesc->dwBinLastMsgLen == dwLen) && (pMsgBufferDesc->pszBinLastFormat == pMsg->szFormat)
+     && (0 == OsMemcmp(pMsgBufferDesc->pchBinLastMsg, pMsg->szMsgBuffer, dwLen)))
+    {
+        return EC_TRUE;
+    }
+    pMsgBufferDesc->pszBinLastFormat = pMsg->szFormat;
+    pMsgBufferDesc->dwBinLastMsgLen  = dwLen;
+    OsMemcpy(pMsgBufferDesc->pchBinLastMsg, pMsg->szMsgBuffer, dwLen);
+
+    return EC_FALSE;
+}
+
+/********************************************************************************/
+/** \brief Put the header of a new binary log file into the empty file buffer
+*
+* Each file starts without format ids and can be decoded on its own.
+*
+* \return N/A
+*/
+static EC_T_VOID LogBinStartFile
+(MSG_BUFFER_DESC*   pMsgBufferDesc
+)
+{
+    T_LOG_BIN_FILE_HEADER oHeader;
+
+    OsMemset(&oHeader, 0, sizeof(oHeader));
+    oHeader.dwMagic      = LOG_BIN_MAGIC;
+    oHeader.dwVersion    = LOG_BIN_VERSION;
+    oHeader.dwHeaderSize = sizeof(oHeader);
+    oHeader.dwFileIndex  = pMsgBufferDesc->wLogFileIndex;
+    oHeader.qwStartNsec  = DeadlineTimerGetTime();
+    oHeader.dwStartMsec  = OsQueryMsecCount();
+    oHeader.byIntSize    = (EC_T_BYTE)sizeof(int);
+    oHeader.byLongSize   = (EC_T_BYTE)sizeof(long);
+    oHeader.bySizeSize   = (EC_T_BYTE)sizeof(size_t);
+    oHeader.byPtrSize    = (EC_T_BYTE)sizeof(void*);
+    OsStrncpy(oHeader.szLogName, pMsgBufferDesc->szLogName, sizeof(oHeader.szLogName) - 1);
+    OsStrncpy(oHeader.szTextExt, pMsgBufferDesc->szMsgLogFileExt, sizeof(oHeader.szTextExt) - 1);
+
+    OsMemcpy(pMsgBufferDesc->pchFileBuf, &oHeader, sizeof(oHeader));
+    pMsgBufferDesc->dwFileBufUsed = sizeof(oHeader);
+    pMsgBufferDesc->dwFileBufMsec = oHeader.dwStartMsec;
+
+    OsMemset(pMsgBufferDesc->ppszBinFormatHash, 0, (pMsgBufferDesc->dwBinFormatHashMask + 1) * sizeof(EC_T_CHAR*));
+    pMsgBufferDesc->dwNumBinFormats   = 0;
+    pMsgBufferDesc->qwBinLastNsec     = oHeader.qwStartNsec;
+    pMsgBufferDesc->dwBinLastThreadId = 0;
+    pMsgBufferDesc->dwBinLastMsec     = oHeader.dwStartMsec;
+}
+
 /***************************************************************************************************/
 /**
 \brief  Create CAtEmLogging instance
@@ -109,7 +810,14 @@ CAtEmLogging::CAtEmLogging(EC_T_VOID)
     m_pvLogThreadObj    = EC_NULL;
     m_bLogTaskRunning = EC_FALSE;
     m_bShutdownLogTask = EC_FALSE;
+    m_pvLogEvent = EC_NULL;
+    m_pvLogTaskDoneEvent = EC_NULL;
+    m_dwLogTaskWait = LOG_TASK_WAIT_NONE;
+    m_dwCoalesceMsec = 0;
+    m_dwNumPasses = 0;
     m_bDbgMsgHookEnable = EC_TRUE;
+    m_bDeferredFormat = EC_FALSE;
+    m_bBinaryFormat = EC_FALSE;
     m_bSettling = EC_FALSE;
     m_dwNumMsgsSinceMsrmt = 0;
     m_poInsertMsgLock = EC_NULL;
@@ -149,7 +857,9 @@ EC_T_VOID CAtEmLogging::InitLogging(
     {
         G_pOsDbgMsgLoggingInst = this;
     }
+#if !(defined DEMO_ATOMIC_CAS_SUPPORTED)
     m_poInsertMsgLock = OsCreateLockTyped(eLockType_SPIN);
+#endif
     m_poProcessMsgLock = OsCreateLock();
     m_pchTempbuffer = (EC_T_CHAR*)OsMalloc(2*MAX_MESSAGE_SIZE);
     if (EC_NULL == m_pchTempbuffer)
@@ -234,6 +944,9 @@ EC_T_VOID CAtEmLogging::InitLogging(
 
     OsDbgAssert(!m_bLogTaskRunning);
     m_bShutdownLogTask = EC_FALSE;
+    m_dwLogTaskWait = LOG_TASK_WAIT_NONE;
+    m_pvLogEvent = OsCreateEvent();
+    m_pvLogTaskDoneEvent = OsCreateEvent();
     EC_CPUSET_ZERO(CpuSet);
     EC_CPUSET_SET(CpuSet, dwCpuIndex);
 #ifndef NO_OS
@@ -309,7 +1022,8 @@ struct _MSG_BUFFER_DESC* CAtEmLogging::AddLogBuffer(
                          szLogFileNameTmp,
                          szLogFileExt,
                          wRollOver,
-                         szLogName
+                         szLogName,
+                         m_bBinaryFormat
                         );
     if (!bOk)
     {
@@ -345,6 +1059,81 @@ Exit:
     return pNewMsgBufferDesc;
 }
 
+/********************************************************************************/
+/** \brief Remove a message buffer added by AddLogBuffer()
+*
+* The producers must not use the buffer anymore. Pending messages are written,
+* the descriptor is freed after the log task finished the pass that may still
+* walk over it.
+*
+* \return N/A
+*/
+EC_T_VOID CAtEmLogging::RemoveLogBuffer(
+    MSG_BUFFER_DESC* pMsgBufferDesc     /* [in]  message buffer descriptor from AddLogBuffer() */
+    )
+{
+    MSG_BUFFER_DESC* pPrevMsgBuf = EC_NULL;
+    MSG_BUFFER_DESC* pNextMsgBuf = EC_NULL;
+    EC_T_DWORD       dwNumPasses = 0;
+
+    if (EC_NULL == pMsgBufferDesc)
+    {
+        return;
+    }
+    OsLock( m_poProcessMsgLock );
+    for (pNextMsgBuf = m_pFirstMsgBufferDesc; (EC_NULL != pNextMsgBuf) && (pNextMsgBuf != pMsgBufferDesc); pNextMsgBuf = pNextMsgBuf->pNextMsgBuf)
+    {
+        pPrevMsgBuf = pNextMsgBuf;
+    }
+    if (EC_NULL != pNextMsgBuf)
+    {
+        /* unlink, pNextMsgBuf of the removed buffer stays valid for the log task */
+        if (EC_NULL == pPrevMsgBuf)
+        {
+            m_pFirstMsgBufferDesc = pMsgBufferDesc->pNextMsgBuf;
+        }
+        else
+        {
+            pPrevMsgBuf->pNextMsgBuf = pMsgBufferDesc->pNextMsgBuf;
+        }
+        if (m_pLastMsgBufferDesc == pMsgBufferDesc)
+        {
+            m_pLastMsgBufferDesc = pPrevMsgBuf;
+        }
+    }
+    dwNumPasses = m_dwNumPasses;
+    OsUnlock( m_poProcessMsgLock );
+
+    if (EC_NULL == pNextMsgBuf)
+    {
+        return;
+    }
+    /* the next pass of the log task starts with the buffer unlinked */
+    while (m_bLogTaskRunning && (dwNumPasses == m_dwNumPasses))
+    {
+        OsSetEvent(m_pvLogEvent);
+        OsSleep(1);
+    }
+    DeinitMsgBuffer(pMsgBufferDesc);
+    OsFree(pMsgBufferDesc);
+}
+
+/********************************************************************************/
+/** \brief Write the text collected by the log task into the log file now
+*
+* Waits for a pass of ProcessMsgs() in progress, see LOG_FILE_FLUSH_MSEC.
+*
+* \return N/A
+*/
+EC_T_VOID CAtEmLogging::FlushLogBuffer(
+    MSG_BUFFER_DESC* pMsgBufferDesc     /* [in]  message buffer descriptor from AddLogBuffer() */
+    )
+{
+    OsLock( m_poProcessMsgLock );
+    WriteFileBuf(pMsgBufferDesc);
+    OsUnlock( m_poProcessMsgLock );
+}
+
 
 /********************************************************************************/
 /** \brief set log message buffer
@@ -392,10 +1181,16 @@ MSG_BUFFER_DESC* pNextMsgBuf;
     }
 
     m_bShutdownLogTask = EC_TRUE;
+    if (EC_NULL != m_pvLogEvent)
+    {
+        OsSetEvent(m_pvLogEvent);
+    }
+    while (m_bLogTaskRunning)
+    {
+        OsWaitForEvent(m_pvLogTaskDoneEvent, EC_WAITINFINITE);
+    }
 
-    while (m_bLogTaskRunning) OsSleep(1);
-
-    /* shutdown all message buffers */
+    /* print out messages left by the log task, shutdown all message buffers */
     pNextMsgBuf = m_pFirstMsgBufferDesc;
     while (EC_NULL != pNextMsgBuf)
     {
@@ -426,8 +1221,22 @@ MSG_BUFFER_DESC* pNextMsgBuf;
     m_pErrorMsgBufferDesc = EC_NULL;
     m_pDcmMsgBufferDesc = EC_NULL;
 
-    OsDeleteLock(m_poInsertMsgLock);
+    if (EC_NULL != m_poInsertMsgLock)
+    {
+        OsDeleteLock(m_poInsertMsgLock);
+        m_poInsertMsgLock = EC_NULL;
+    }
     OsDeleteLock(m_poProcessMsgLock);
+    if (EC_NULL != m_pvLogEvent)
+    {
+        OsDeleteEvent(m_pvLogEvent);
+        m_pvLogEvent = EC_NULL;
+    }
+    if (EC_NULL != m_pvLogTaskDoneEvent)
+    {
+        OsDeleteEvent(m_pvLogTaskDoneEvent);
+        m_pvLogTaskDoneEvent = EC_NULL;
+    }
     SafeOsFree(m_pchTempbuffer);
     m_pchTempbuffer = EC_NULL;
 }
@@ -451,7 +1260,12 @@ EC_T_VOID CAtEmLogging::tAtEmLogWrapper(EC_T_VOID* pvParm)
 
 
 /********************************************************************************/
-/** \brief cyclically process all messages
+/** \brief process all messages, wait for new ones
+*
+* The log task waits on m_pvLogEvent, set by the first producer after it
+* announced the wait in m_dwLogTaskWait. With wake-up coalescing it waits
+* the coalescing time after each pass that printed messages, producers
+* then only wake it up early if a buffer is half full.
 *
 * \return N/A
 */
@@ -462,26 +1276,146 @@ EC_T_VOID CAtEmLogging::tAtEmLog(EC_T_VOID* pvParm)
     m_bLogTaskRunning = EC_TRUE;
     while (!m_bShutdownLogTask)
     {
-        ProcessAllMsgs();
-        OsSleep(1);
+    EC_T_UINT64 qwTraceStart = TraceGetTime();
+    EC_T_DWORD  dwNumMsgs    = 0;
+    EC_T_DWORD  dwWait       = LOG_TASK_WAIT_NONE;
+    EC_T_DWORD  dwTimeout    = EC_WAITINFINITE;
+
+        m_dwNumPasses++;
+        dwNumMsgs = ProcessAllMsgs();
+        TraceSpanAdd(eTraceTrack_Log, "ProcessAllMsgs", qwTraceStart);
+
+        if ((0 != dwNumMsgs) && (0 != m_dwCoalesceMsec))
+        {
+            dwWait    = LOG_TASK_WAIT_COALESCE;
+            dwTimeout = m_dwCoalesceMsec;
+        }
+        else if (MsgsPending())
+        {
+            if (0 != dwNumMsgs)
+            {
+                /* more messages than processed per pass */
+                continue;
+            }
+            /* message still written by a producer */
+            dwTimeout = 1;
+        }
+        else
+        {
+            dwWait = LOG_TASK_WAIT_IDLE;
+
+            /* write collected file text in time */
+            if (FileBufsPending())
+            {
+                dwTimeout = LOG_FILE_FLUSH_MSEC;
+            }
+        }
+        m_dwLogTaskWait = dwWait;
+        DEMO_MEMORY_BARRIER();
+
+        /* message inserted before the producer could see m_dwLogTaskWait */
+        if ((LOG_TASK_WAIT_IDLE != dwWait) || !(MsgsPending() || m_bShutdownLogTask))
+        {
+            OsWaitForEvent(m_pvLogEvent, dwTimeout);
+        }
+        m_dwLogTaskWait = LOG_TASK_WAIT_NONE;
     }
     ProcessAllMsgs();
     m_bLogTaskRunning = EC_FALSE;
+    OsSetEvent(m_pvLogTaskDoneEvent);
 #if (defined EC_VERSION_RTEMS)
     rtems_task_delete(RTEMS_SELF);
 #endif
 }
 
-EC_T_VOID CAtEmLogging::ProcessAllMsgs(EC_T_VOID)
+/********************************************************************************/
+/** \brief process messages of all message buffers, see ProcessMsgs()
+*
+* \return number of messages processed
+*/
+EC_T_DWORD CAtEmLogging::ProcessAllMsgs(EC_T_VOID)
 {
 MSG_BUFFER_DESC* pNextMsgBuf;
+EC_T_DWORD       dwNumMsgs = 0;
 
     pNextMsgBuf = m_pFirstMsgBufferDesc;
     while (EC_NULL != pNextMsgBuf)
     {
-        ProcessMsgs(pNextMsgBuf);
+        dwNumMsgs += ProcessMsgs(pNextMsgBuf);
         pNextMsgBuf = pNextMsgBuf->pNextMsgBuf;
     }
+    return dwNumMsgs;
+}
+
+/********************************************************************************/
+/** \brief check for messages not processed yet
+*
+* \return EC_TRUE if at least one message buffer is not empty
+*/
+EC_T_BOOL CAtEmLogging::MsgsPending(EC_T_VOID)
+{
+MSG_BUFFER_DESC* pNextMsgBuf;
+
+    for (pNextMsgBuf = m_pFirstMsgBufferDesc; EC_NULL != pNextMsgBuf; pNextMsgBuf = pNextMsgBuf->pNextMsgBuf)
+    {
+        if (pNextMsgBuf->bIsInitialized && (pNextMsgBuf->dwNextPrintMsgIndex != pNextMsgBuf->dwNextEmptyMsgIndex))
+        {
+            return EC_TRUE;
+        }
+    }
+    return EC_FALSE;
+}
+
+/********************************************************************************/
+/** \brief check for text not written to the log files yet
+*
+* \return EC_TRUE if at least one file buffer is not empty
+*/
+EC_T_BOOL CAtEmLogging::FileBufsPending(EC_T_VOID)
+{
+MSG_BUFFER_DESC* pNextMsgBuf;
+
+    for (pNextMsgBuf = m_pFirstMsgBufferDesc; EC_NULL != pNextMsgBuf; pNextMsgBuf = pNextMsgBuf->pNextMsgBuf)
+    {
+        if (0 != pNextMsgBuf->dwFileBufUsed)
+        {
+            return EC_TRUE;
+        }
+    }
+    return EC_FALSE;
+}
+
+/********************************************************************************/
+/** \brief wake up the log task after the message at dwPos was inserted
+*
+* Only the producer that changes m_dwLogTaskWait sets the event.
+*
+* \return N/A
+*/
+EC_T_VOID CAtEmLogging::WakeUpLogTask
+(MSG_BUFFER_DESC*   pMsgBufferDesc
+,EC_T_DWORD         dwPos               /* [in]  position of the inserted message */
+)
+{
+    EC_T_DWORD  dwWait = m_dwLogTaskWait;
+
+    if (LOG_TASK_WAIT_NONE == dwWait)
+    {
+        return;
+    }
+    if ((LOG_TASK_WAIT_COALESCE == dwWait) && ((dwPos + 1 - pMsgBufferDesc->dwNextPrintMsgIndex) < (pMsgBufferDesc->dwNumMsgs / 2)))
+    {
+        return;
+    }
+#if (defined DEMO_ATOMIC_CAS_SUPPORTED)
+    if (!DEMO_ATOMIC_CAS(&m_dwLogTaskWait, dwWait, LOG_TASK_WAIT_NONE))
+    {
+        return;
+    }
+#else
+    m_dwLogTaskWait = LOG_TASK_WAIT_NONE;
+#endif
+    OsSetEvent(m_pvLogEvent);
 }
 
 /********************************************************************************/
@@ -500,18 +1434,29 @@ EC_T_BOOL CAtEmLogging::InitMsgBuffer
 ,EC_T_CHAR*         szMsgLogFileExt     /* [in]  message log file name */
 ,EC_T_WORD          wRollOver           /* [in]  roll over counter */
 ,EC_T_CHAR*         szBufferName        /* [in]  name of the logging buffer */
+,EC_T_BOOL          bBinaryFile         /* [in]  write the log file in the binary format? */
 )
 {
     EC_T_BOOL  bOk = EC_FALSE;
     EC_T_CHAR* pchMsgBuffer = EC_NULL;
     EC_T_DWORD dwBufSiz;
     EC_T_DWORD dwCnt;
+    EC_T_DWORD dwNumMsgsPow2 = 1;
 #if (!(defined __RCX__) || (defined __MET__)) && !(defined RTAI)
     EC_T_CHAR  szfileNameTemp[MAX_PATH_LEN] = {0};
+    const EC_T_CHAR* szFileExt = bBinaryFile ? LOG_BIN_FILE_EXT : szMsgLogFileExt;
 #endif
 
+    /* the positions wrap around at 2^32, the number of messages must divide it */
+    while (dwNumMsgsPow2 < dwNumMsgs)
+    {
+        dwNumMsgsPow2 <<= 1;
+    }
+    dwNumMsgs = dwNumMsgsPow2;
+
     pMsgBufferDesc->dwMsgSize = dwMsgSize;
     pMsgBufferDesc->dwNumMsgs = dwNumMsgs;
+    pMsgBufferDesc->dwMsgIndexMask = dwNumMsgs - 1;
     pMsgBufferDesc->bPrintTimestamp = bPrintTimestamp;
     pMsgBufferDesc->bPrintConsole = bPrintConsole;
     pMsgBufferDesc->dwNextEmptyMsgIndex = 0;
@@ -549,6 +1494,7 @@ EC_T_BOOL CAtEmLogging::InitMsgBuffer
     {
         pMsgBufferDesc->paMsg[dwCnt].szMsgBuffer = &pchMsgBuffer[dwCnt*(dwMsgSize+1)];
         pMsgBufferDesc->paMsg[dwCnt].bMsgCrLf = EC_TRUE;
+        pMsgBufferDesc->paMsg[dwCnt].dwSeq = dwCnt;
     }
 
 #if (defined __RCX__) || (defined __MET__) || (defined RTAI)
@@ -562,14 +1508,14 @@ EC_T_BOOL CAtEmLogging::InitMsgBuffer
     if (0 != pMsgBufferDesc->wEntryCounterLimit )
     {
 #ifdef FILESYS_8_3
-        OsSnprintf(szfileNameTemp, sizeof(szfileNameTemp) - 1, "%s_%x.%s", pMsgBufferDesc->szMsgLogFileName, pMsgBufferDesc->wLogFileIndex, pMsgBufferDesc->szMsgLogFileExt);
+        OsSnprintf(szfileNameTemp, sizeof(szfileNameTemp) - 1, "%s_%x.%s", pMsgBufferDesc->szMsgLogFileName, pMsgBufferDesc->wLogFileIndex, szFileExt);
 #else
-        OsSnprintf(szfileNameTemp, sizeof(szfileNameTemp) - 1, "%s.%x.%s", pMsgBufferDesc->szMsgLogFileName, pMsgBufferDesc->wLogFileIndex, pMsgBufferDesc->szMsgLogFileExt);
+        OsSnprintf(szfileNameTemp, sizeof(szfileNameTemp) - 1, "%s.%x.%s", pMsgBufferDesc->szMsgLogFileName, pMsgBufferDesc->wLogFileIndex, szFileExt);
 #endif
     }
     else
     {
-        OsSnprintf(szfileNameTemp, sizeof(szfileNameTemp) - 1, "%s.%s", pMsgBufferDesc->szMsgLogFileName, pMsgBufferDesc->szMsgLogFileExt);
+        OsSnprintf(szfileNameTemp, sizeof(szfileNameTemp) - 1, "%s.%s", pMsgBufferDesc->szMsgLogFileName, szFileExt);
     }
 
     if (bLogFileEnb)
@@ -582,6 +1528,20 @@ EC_T_BOOL CAtEmLogging::InitMsgBuffer
 #endif
             OsSleep(3000);
         }
+        else
+        {
+            pMsgBufferDesc->pbyFileBufAlloc = (EC_T_BYTE*)OsMalloc(LOG_FILE_BUF_SIZE + LOG_FILE_BUF_ALIGN);
+            if (pMsgBufferDesc->pbyFileBufAlloc == EC_NULL)
+            {
+                OsPrintf("CAtEmLogging::InitMsgBuffer: cannot get memory for file buffer '%s'\n", szBufferName);
+                OsFclose(pMsgBufferDesc->pfMsgFile);
+                pMsgBufferDesc->pfMsgFile = EC_NULL;
+                goto Exit;
+            }
+            pMsgBufferDesc->pchFileBuf = (EC_T_CHAR*)(pMsgBufferDesc->pbyFileBufAlloc
+                + ((LOG_FILE_BUF_ALIGN - ((size_t)pMsgBufferDesc->pbyFileBufAlloc & (LOG_FILE_BUF_ALIGN - 1))) & (LOG_FILE_BUF_ALIGN - 1)));
+            pMsgBufferDesc->dwFileBufUsed = 0;
+        }
     }
     else
     {
@@ -590,6 +1550,29 @@ EC_T_BOOL CAtEmLogging::InitMsgBuffer
     }
     OsStrncpy(pMsgBufferDesc->szLogName, szBufferName, MAX_PATH_LEN - 1);
 
+    if (bBinaryFile && (EC_NULL != pMsgBufferDesc->pfMsgFile))
+    {
+        pMsgBufferDesc->dwBinFormatHashMask = 2 * LOG_BIN_MAX_FORMATS - 1;
+        pMsgBufferDesc->ppszBinFormatHash  = (const EC_T_CHAR**)OsMalloc(2 * LOG_BIN_MAX_FORMATS * sizeof(EC_T_CHAR*));
+        pMsgBufferDesc->pdwBinFormatIdHash = (EC_T_DWORD*)OsMalloc(2 * LOG_BIN_MAX_FORMATS * sizeof(EC_T_DWORD));
+        pMsgBufferDesc->pchBinLastMsg      = (EC_T_CHAR*)OsMalloc(dwMsgSize);
+        if ((EC_NULL == pMsgBufferDesc->ppszBinFormatHash) || (EC_NULL == pMsgBufferDesc->pdwBinFormatIdHash) || (EC_NULL == pMsgBufferDesc->pchBinLastMsg))
+        {
+            OsPrintf("CAtEmLogging::InitMsgBuffer: cannot get memory for binary log file '%s'\n", szBufferName);
+            SafeOsFree(pMsgBufferDesc->ppszBinFormatHash);
+            SafeOsFree(pMsgBufferDesc->pdwBinFormatIdHash);
+            SafeOsFree(pMsgBufferDesc->pchBinLastMsg);
+            SafeOsFree(pMsgBufferDesc->pbyFileBufAlloc);
+            pMsgBufferDesc->pchFileBuf = EC_NULL;
+            OsFclose(pMsgBufferDesc->pfMsgFile);
+            pMsgBufferDesc->pfMsgFile = EC_NULL;
+            goto Exit;
+        }
+        pMsgBufferDesc->dwBinLastMsgLen = LOG_BIN_NO_MSG;
+        pMsgBufferDesc->bBinaryFile = EC_TRUE;
+        LogBinStartFile(pMsgBufferDesc);
+    }
+
 #endif
     pMsgBufferDesc->bIsInitialized = EC_TRUE;
     bOk = EC_TRUE;
@@ -619,27 +1602,20 @@ EC_T_VOID CAtEmLogging::DeinitMsgBuffer
 (MSG_BUFFER_DESC*   pMsgBufferDesc
 )
 {
-CEcTimer oTimeout;
-
     if (pMsgBufferDesc->bIsInitialized)
     {
-        /* let the log task print out all messages */
+        /* print out all messages, the log task is stopped */
         if (pMsgBufferDesc->dwNextPrintMsgIndex != pMsgBufferDesc->dwNextEmptyMsgIndex)
         {
 #if !(defined NOPRINTF)
             OsPrintf("Store unsaved messages in '%s' message/logging buffer...", pMsgBufferDesc->szLogName);
 #endif
-            oTimeout.Start(3000);
             while (pMsgBufferDesc->dwNextPrintMsgIndex != pMsgBufferDesc->dwNextEmptyMsgIndex)
             {
-                ProcessAllMsgs();
-                OsSleep(10);
-                if (oTimeout.IsElapsed())
+                if (0 == ProcessMsgs(pMsgBufferDesc))
                 {
-#if !(defined NOPRINTF)
-                    OsPrintf(".");
-#endif
-                    oTimeout.Start(3000);
+                    /* message still written by a producer */
+                    OsSleep(1);
                 }
             }
 #if !(defined NOPRINTF)
@@ -652,8 +1628,15 @@ CEcTimer oTimeout;
 
         if (EC_NULL != pMsgBufferDesc->pfMsgFile)
         {
+            WriteFileBuf(pMsgBufferDesc);
             OsFclose(pMsgBufferDesc->pfMsgFile);
         }
+        SafeOsFree(pMsgBufferDesc->pbyFileBufAlloc);
+        pMsgBufferDesc->pchFileBuf = EC_NULL;
+        SafeOsFree(pMsgBufferDesc->ppszBinFormatHash);
+        SafeOsFree(pMsgBufferDesc->pdwBinFormatIdHash);
+        SafeOsFree(pMsgBufferDesc->pchBinLastMsg);
+        pMsgBufferDesc->bBinaryFile = EC_FALSE;
 
         pMsgBufferDesc->pfMsgFile = EC_NULL;
         pMsgBufferDesc->dwNextEmptyMsgIndex = 0;
@@ -670,7 +1653,15 @@ CEcTimer oTimeout;
 /********************************************************************************/
 /** \brief Insert a new message into message buffer
 *
-* \return N/A
+* Bounded multi-producer queue (D. Vyukov): a producer owns the message at
+* position dwPos once it advanced dwNextEmptyMsgIndex from dwPos to dwPos + 1.
+* This is only tried if the message is free for dwPos (dwSeq == dwPos), so a
+* full buffer is detected without reserving anything. The message is handed
+* to the log task by dwSeq = dwPos + 1. Producers never wait for each other
+* or for the log task, a failed compare and swap means another producer
+* made progress.
+*
+* \return EC_E_NOERROR, EC_E_NOMEMORY if the buffer is full
 */
 EC_T_DWORD CAtEmLogging::InsertNewMsg
 (MSG_BUFFER_DESC*   pMsgBufferDesc
@@ -682,8 +1673,9 @@ EC_T_DWORD CAtEmLogging::InsertNewMsg
 )
 {
     EC_T_DWORD      dwRes = EC_E_NOERROR;
-    EC_T_BOOL       bBufferFull = EC_FALSE;
     EC_T_DWORD      dwTimeStamp     = 0;
+    EC_T_DWORD      dwPos           = 0;
+    EC_T_DWORD      dwArgsLen       = 0;
     LOG_MSG_DESC*   pNewMsg = EC_NULL;
 
     if (pMsgBufferDesc == EC_NULL )
@@ -697,51 +1689,84 @@ EC_T_DWORD CAtEmLogging::InsertNewMsg
     if (m_bShutdownLogTask )
         goto Exit;
 
-    OsLock(m_poInsertMsgLock);
+#if (defined DEMO_ATOMIC_CAS_SUPPORTED)
+    dwPos = pMsgBufferDesc->dwNextEmptyMsgIndex;
+    for (;;)
     {
-        EC_T_DWORD  dwNewNextEmpty  = 0;
-
-        pNewMsg = &pMsgBufferDesc->paMsg[pMsgBufferDesc->dwNextEmptyMsgIndex];
+    EC_T_INT nDiff = 0;
 
-        dwNewNextEmpty = pMsgBufferDesc->dwNextEmptyMsgIndex + 1;
-        if (dwNewNextEmpty >= pMsgBufferDesc->dwNumMsgs )
+        pNewMsg = &pMsgBufferDesc->paMsg[dwPos & pMsgBufferDesc->dwMsgIndexMask];
+        nDiff = (EC_T_INT)(pNewMsg->dwSeq - dwPos);
+        if (0 == nDiff)
         {
-            dwNewNextEmpty = 0;
-        }
-
-        /* check if message buffer is full ? */
-        if (dwNewNextEmpty == pMsgBufferDesc->dwNextPrintMsgIndex )
-        {
-            bBufferFull = EC_TRUE;
+            if (DEMO_ATOMIC_CAS(&pMsgBufferDesc->dwNextEmptyMsgIndex, dwPos, dwPos + 1))
+            {
+                break;
+            }
         }
-        else
+        else if (nDiff < 0)
         {
-            pMsgBufferDesc->dwNextEmptyMsgIndex = dwNewNextEmpty;
+            /* message of the previous round not printed yet, buffer is full */
+            dwRes = EC_E_NOMEMORY;
+            goto Exit;
         }
+        /* another producer got dwPos */
+        dwPos = pMsgBufferDesc->dwNextEmptyMsgIndex;
     }
-    OsUnlock(m_poInsertMsgLock);
-
-
-    if (bBufferFull)
+#else
+    OsLock(m_poInsertMsgLock);
+    dwPos = pMsgBufferDesc->dwNextEmptyMsgIndex;
+    pNewMsg = &pMsgBufferDesc->paMsg[dwPos & pMsgBufferDesc->dwMsgIndexMask];
+    if (pNewMsg->dwSeq == dwPos)
+    {
+        pMsgBufferDesc->dwNextEmptyMsgIndex = dwPos + 1;
+    }
+    else
     {
         dwRes = EC_E_NOMEMORY;
+    }
+    OsUnlock(m_poInsertMsgLock);
+    if (EC_E_NOERROR != dwRes)
+    {
         goto Exit;
     }
-
+#endif
 
     if (pMsgBufferDesc->bPrintTimestamp )
     {
         dwTimeStamp = OsQueryMsecCount();
     }
     pNewMsg->dwMsgTimestamp  = dwTimeStamp;
+    pNewMsg->dwMsgThreadId   = LogGetThreadId();
     pNewMsg->bOsDbgMsg       = bOsDbgMsg;
     pNewMsg->bMsgCrLf        = bDoCrLf;
+    if (pMsgBufferDesc->bBinaryFile)
+    {
+        pNewMsg->qwMsgTimestampNsec = DeadlineTimerGetTime();
+    }
+
+    pNewMsg->szFormat        = EC_NULL;
 
-    pNewMsg->dwLen = EcVsnprintf(pNewMsg->szMsgBuffer, pMsgBufferDesc->dwMsgSize, szFormat,vaArgs);
+    /* OsDbgMsg() formats may be built at run time, format them immediately */
+    if ((m_bDeferredFormat || pMsgBufferDesc->bBinaryFile) && !bOsDbgMsg
+     && LogDeferArgs(pNewMsg->szMsgBuffer, pMsgBufferDesc->dwMsgSize, szFormat, vaArgs, &dwArgsLen))
+    {
+        /* formatted by ProcessMsgs() or written to the binary log file as they are */
+        pNewMsg->szFormat = szFormat;
+        pNewMsg->dwLen    = dwArgsLen;
+    }
+    else
+    {
+        pNewMsg->dwLen = EcVsnprintf(pNewMsg->szMsgBuffer, pMsgBufferDesc->dwMsgSize, szFormat,vaArgs);
+    }
 
     /* mark entry as complete */
-    OsMemoryBarrier();
-    pNewMsg->bValid = EC_TRUE;
+    DEMO_MEMORY_BARRIER();
+    pNewMsg->dwSeq = dwPos + 1;
+
+    /* read m_dwLogTaskWait after dwSeq, see tAtEmLog() */
+    DEMO_MEMORY_BARRIER();
+    WakeUpLogTask(pMsgBufferDesc, dwPos);
 
 Exit:
     return dwRes;
@@ -770,14 +1795,37 @@ EC_T_VOID CAtEmLogging::SelectNextLogMemBuffer
 }
 
 /********************************************************************************/
-/** \brief Process all messages of a message buffer
+/** \brief Write the collected text with one OsFwrite() and flush the log file
 *
 * \return N/A
 */
-EC_T_VOID CAtEmLogging::ProcessMsgs
+EC_T_VOID CAtEmLogging::WriteFileBuf
 (MSG_BUFFER_DESC*   pMsgBufferDesc )
 {
-    EC_T_DWORD  dwNewNextPrint=0;
+    if ((0 != pMsgBufferDesc->dwFileBufUsed) && (EC_NULL != pMsgBufferDesc->pfMsgFile))
+    {
+        OsFwrite(pMsgBufferDesc->pchFileBuf, pMsgBufferDesc->dwFileBufUsed, 1, pMsgBufferDesc->pfMsgFile);
+        OsFflush(pMsgBufferDesc->pfMsgFile);
+    }
+    pMsgBufferDesc->dwFileBufUsed = 0;
+}
+
+/********************************************************************************/
+/** \brief Process all messages of a message buffer
+*
+* At least LOG_MIN_MSGS_PER_PASS messages or all messages queued at the
+* start are processed. The file text is collected in pchFileBuf and written
+* if LOG_FILE_FLUSH_SIZE bytes are collected or the oldest text is
+* LOG_FILE_FLUSH_MSEC old. Binary log files get the records of the messages
+* instead of the text, deferred messages are only formatted for the console.
+*
+* \return number of messages processed
+*/
+EC_T_DWORD CAtEmLogging::ProcessMsgs
+(MSG_BUFFER_DESC*   pMsgBufferDesc )
+{
+    EC_T_DWORD  dwNumProcessed = 0;
+    EC_T_DWORD  dwPos = 0;
     LOG_MSG_DESC*   pCurrMsg = EC_NULL;
     EC_T_BOOL bLocked = EC_FALSE;
 #if (!(defined __RCX__) || (defined __MET__)) && !(defined RTAI)
@@ -785,9 +1833,11 @@ EC_T_VOID CAtEmLogging::ProcessMsgs
     EC_T_BOOL   bRollOver       = EC_FALSE;
     EC_T_CHAR  szfileNameTemp[MAX_PATH_LEN];
 #endif
-    EC_T_DWORD  dwNumMsgLeft = 20;
+    EC_T_DWORD  dwNumMsgLeft = 0;
     EC_T_BOOL   bSkipDuplicate;
     EC_T_DWORD  dwNumDuplicatesBeforeNewMsg;
+    EC_T_BOOL   bBinaryFile = EC_FALSE;
+    const EC_T_CHAR* pszMsg = EC_NULL;
 
     szfileNameTemp[0] = '\0';
 
@@ -795,6 +1845,12 @@ EC_T_VOID CAtEmLogging::ProcessMsgs
     {
         OsLock(m_poProcessMsgLock);
         bLocked = EC_TRUE;
+
+        /* memory logging is written as text */
+        bBinaryFile = pMsgBufferDesc->bBinaryFile && (EC_NULL == pMsgBufferDesc->pbyLogMemory);
+
+        /* under load all messages queued now, so the buffer does not overflow */
+        dwNumMsgLeft = EC_MAX(LOG_MIN_MSGS_PER_PASS, pMsgBufferDesc->dwNextEmptyMsgIndex - pMsgBufferDesc->dwNextPrintMsgIndex);
         while( pMsgBufferDesc->dwNextPrintMsgIndex != pMsgBufferDesc->dwNextEmptyMsgIndex )
         {
             OsDbgAssert(pMsgBufferDesc->bIsInitialized);
@@ -803,12 +1859,30 @@ EC_T_VOID CAtEmLogging::ProcessMsgs
             if (dwNumMsgLeft == 0 )
                 break;
 
-            pCurrMsg = &pMsgBufferDesc->paMsg[pMsgBufferDesc->dwNextPrintMsgIndex];
+            dwPos = pMsgBufferDesc->dwNextPrintMsgIndex;
+            pCurrMsg = &pMsgBufferDesc->paMsg[dwPos & pMsgBufferDesc->dwMsgIndexMask];
             /* wait til message is complete */
-            if (!pCurrMsg->bValid)
+            if (pCurrMsg->dwSeq != (dwPos + 1))
             {
                 break;
             }
+            /* read the message after dwSeq */
+            DEMO_MEMORY_BARRIER();
+
+            /* deferred message: replace the arguments by the text */
+            pszMsg = pCurrMsg->szMsgBuffer;
+            if ((EC_NULL != pCurrMsg->szFormat) && !bBinaryFile)
+            {
+                pCurrMsg->dwLen = LogFormatDeferred(m_pchTempbuffer, pMsgBufferDesc->dwMsgSize, pCurrMsg->szFormat, pCurrMsg->szMsgBuffer);
+                OsMemcpy(pCurrMsg->szMsgBuffer, m_pchTempbuffer, EC_MIN(pCurrMsg->dwLen, pMsgBufferDesc->dwMsgSize - 1) + 1);
+                pCurrMsg->szFormat = EC_NULL;
+            }
+            else if ((EC_NULL != pCurrMsg->szFormat) && pMsgBufferDesc->bPrintConsole)
+            {
+                /* binary log file: keep the arguments for LogBinPutMsg() */
+                LogFormatDeferred(m_pchTempbuffer, pMsgBufferDesc->dwMsgSize, pCurrMsg->szFormat, pCurrMsg->szMsgBuffer);
+                pszMsg = m_pchTempbuffer;
+            }
 
 #if (!(defined __RCX__) || (defined __MET__)) && !(defined RTAI)
             if (bLogFileEnb && (pMsgBufferDesc->pfMsgFile != EC_NULL) )
@@ -825,9 +1899,11 @@ EC_T_VOID CAtEmLogging::ProcessMsgs
                         pMsgBufferDesc->wLogFileIndex++;
 
 #ifdef FILESYS_8_3
-                        OsSnprintf(szfileNameTemp, sizeof(szfileNameTemp) - 1, "%s_%x.%s", pMsgBufferDesc->szMsgLogFileName, pMsgBufferDesc->wLogFileIndex, pMsgBufferDesc->szMsgLogFileExt);
+                        OsSnprintf(szfileNameTemp, sizeof(szfileNameTemp) - 1, "%s_%x.%s", pMsgBufferDesc->szMsgLogFileName, pMsgBufferDesc->wLogFileIndex,
+                                   pMsgBufferDesc->bBinaryFile ? LOG_BIN_FILE_EXT : pMsgBufferDesc->szMsgLogFileExt);
 #else
-                        OsSnprintf(szfileNameTemp, sizeof(szfileNameTemp) - 1, "%s.%x.%s", pMsgBufferDesc->szMsgLogFileName, pMsgBufferDesc->wLogFileIndex, pMsgBufferDesc->szMsgLogFileExt);
+                        OsSnprintf(szfileNameTemp, sizeof(szfileNameTemp) - 1, "%s.%x.%s", pMsgBufferDesc->szMsgLogFileName, pMsgBufferDesc->wLogFileIndex,
+                                   pMsgBufferDesc->bBinaryFile ? LOG_BIN_FILE_EXT : pMsgBufferDesc->szMsgLogFileExt);
 #endif
                     }
                     else
@@ -842,7 +1918,20 @@ EC_T_VOID CAtEmLogging::ProcessMsgs
             /* handle skipping duplicates */
             bSkipDuplicate = EC_FALSE;
             dwNumDuplicatesBeforeNewMsg = 0;
-            if (pMsgBufferDesc->bSkipDuplicateMessages )
+            if (pMsgBufferDesc->bSkipDuplicateMessages && bBinaryFile)
+            {
+                if (LogBinIsDuplicate(pMsgBufferDesc, pCurrMsg))
+                {
+                    pMsgBufferDesc->dwNumDuplicates++;
+                    bSkipDuplicate = EC_TRUE;
+                }
+                else
+                {
+                    dwNumDuplicatesBeforeNewMsg = pMsgBufferDesc->dwNumDuplicates;
+                    pMsgBufferDesc->dwNumDuplicates = 0;
+                }
+            }
+            else if (pMsgBufferDesc->bSkipDuplicateMessages )
             {
                 if (pMsgBufferDesc->pszLastMsg == EC_NULL )
                 {
@@ -891,11 +1980,11 @@ EC_T_VOID CAtEmLogging::ProcessMsgs
                 if (pCurrMsg->bMsgCrLf)
                 {
                     /* e.g. RTX64 requires terminating new-line directly appended to the message */
-                    OsPrintf("%s\n", pCurrMsg->szMsgBuffer);
+                    OsPrintf("%s\n", pszMsg);
                 }
                 else
                 {
-                    OsPrintf("%s", pCurrMsg->szMsgBuffer);
+                    OsPrintf("%s", pszMsg);
                 }
 #endif
             }
@@ -938,40 +2027,60 @@ EC_T_VOID CAtEmLogging::ProcessMsgs
                     }
                 }
             }
-            else if (EC_NULL != pFileHandle)
+            else if ((EC_NULL != pFileHandle) && (EC_NULL != pMsgBufferDesc->pchFileBuf))
             {
                 /* don't use fprintf, some platforms don't support it! */
 
                 if (!bSkipDuplicate)
                 {
-                    /* print skipped messages */
-                    if (dwNumDuplicatesBeforeNewMsg > 0)
+                EC_T_CHAR*  pchFileBuf = EC_NULL;
+                EC_T_DWORD  dwUsed     = 0;
+                EC_T_DWORD  dwLen      = 0;
+
+                    /* collect the text, see WriteFileBuf() */
+                    if ((LOG_FILE_BUF_SIZE - pMsgBufferDesc->dwFileBufUsed) < LOG_FILE_MSG_RESERVE)
                     {
-                        if (pMsgBufferDesc->bPrintTimestamp)
-                        {
-                            OsSnprintf(m_pchTempbuffer, 2*MAX_MESSAGE_SIZE - 1, "%06d : ", (EC_T_INT) pCurrMsg->dwMsgTimestamp);
-                            OsFwrite(m_pchTempbuffer, OsStrlen(m_pchTempbuffer), 1, pFileHandle);
-                        }
-                        OsSnprintf(m_pchTempbuffer, 2*MAX_MESSAGE_SIZE - 1, "%d identical messages skipped\n", dwNumDuplicatesBeforeNewMsg);
-                        OsFwrite(m_pchTempbuffer, OsStrlen(m_pchTempbuffer), 1, pFileHandle);
+                        WriteFileBuf(pMsgBufferDesc);
                     }
-                    /* now fprintf, OsFflush, OsFclose etc. */
-                    if ((pMsgBufferDesc->bPrintTimestamp) && (pMsgBufferDesc->bNewLine))
+                    if (0 == pMsgBufferDesc->dwFileBufUsed)
                     {
-                        OsSnprintf(m_pchTempbuffer, 2*MAX_MESSAGE_SIZE - 1, "%06d : ", (EC_T_INT) pCurrMsg->dwMsgTimestamp);
-                        OsFwrite(m_pchTempbuffer, OsStrlen(m_pchTempbuffer), 1, pFileHandle);
+                        pMsgBufferDesc->dwFileBufMsec = OsQueryMsecCount();
                     }
-                    /* print message */
-                    OsSnprintf(m_pchTempbuffer, 2*MAX_MESSAGE_SIZE - 1, "%s", pCurrMsg->szMsgBuffer);
-                    OsFwrite(m_pchTempbuffer, OsStrlen(m_pchTempbuffer), 1, pFileHandle);
-
-                    /* add new line */
-                    if (pCurrMsg->bMsgCrLf)
+                    if (bBinaryFile)
+                    {
+                        /* records instead of text, see ecatDemoLogBin.h */
+                        LogBinPutMsg(pMsgBufferDesc, pCurrMsg, dwNumDuplicatesBeforeNewMsg);
+                    }
+                    else
                     {
-                        OsSnprintf(m_pchTempbuffer, 2*MAX_MESSAGE_SIZE - 1, "\n");
-                        OsFwrite(m_pchTempbuffer, OsStrlen(m_pchTempbuffer), 1, pFileHandle);
+                        pchFileBuf = pMsgBufferDesc->pchFileBuf;
+                        dwUsed     = pMsgBufferDesc->dwFileBufUsed;
+
+                        /* print skipped messages */
+                        if (dwNumDuplicatesBeforeNewMsg > 0)
+                        {
+                            if (pMsgBufferDesc->bPrintTimestamp)
+                            {
+                                dwUsed += OsSnprintf(&pchFileBuf[dwUsed], LOG_FILE_BUF_SIZE - dwUsed, "%06d : ", (EC_T_INT) pCurrMsg->dwMsgTimestamp);
+                            }
+                            dwUsed += OsSnprintf(&pchFileBuf[dwUsed], LOG_FILE_BUF_SIZE - dwUsed, "%d identical messages skipped\n", dwNumDuplicatesBeforeNewMsg);
+                        }
+                        if ((pMsgBufferDesc->bPrintTimestamp) && (pMsgBufferDesc->bNewLine))
+                        {
+                            dwUsed += OsSnprintf(&pchFileBuf[dwUsed], LOG_FILE_BUF_SIZE - dwUsed, "%06d : ", (EC_T_INT) pCurrMsg->dwMsgTimestamp);
+                        }
+                        /* print message */
+                        dwLen = (EC_T_DWORD)OsStrlen(pCurrMsg->szMsgBuffer);
+                        OsMemcpy(&pchFileBuf[dwUsed], pCurrMsg->szMsgBuffer, dwLen);
+                        dwUsed += dwLen;
+
+                        /* add new line */
+                        if (pCurrMsg->bMsgCrLf)
+                        {
+                            pchFileBuf[dwUsed++] = '\n';
+                        }
+                        pMsgBufferDesc->dwFileBufUsed = dwUsed;
                     }
-                    OsFflush(pFileHandle);
                 }
             }
 #endif
@@ -993,19 +2102,17 @@ EC_T_VOID CAtEmLogging::ProcessMsgs
                     pMsgBufferDesc->bNewLine = EC_TRUE;
                 }
             }
-            pCurrMsg->bValid = EC_FALSE;
-            OsMemoryBarrier();
-            dwNewNextPrint = pMsgBufferDesc->dwNextPrintMsgIndex + 1;
-            if (dwNewNextPrint >= pMsgBufferDesc->dwNumMsgs )
-            {
-                dwNewNextPrint = 0;
-            }
-            pMsgBufferDesc->dwNextPrintMsgIndex = dwNewNextPrint;
+            /* free the entry for the producer of the next round */
+            DEMO_MEMORY_BARRIER();
+            pCurrMsg->dwSeq = dwPos + pMsgBufferDesc->dwNumMsgs;
+            pMsgBufferDesc->dwNextPrintMsgIndex = dwPos + 1;
+            dwNumProcessed++;
 
 #if !(defined __RCX__) && !(defined __MET__) && !(defined RTAI)
             if (bRollOver)
             {
                 /* do roll over */
+                WriteFileBuf(pMsgBufferDesc);
                 OsFclose(pFileHandle);
 
                 pFileHandle = OsFopen( szfileNameTemp, "w+" );
@@ -1021,17 +2128,27 @@ EC_T_VOID CAtEmLogging::ProcessMsgs
                 else
                 {
                     pMsgBufferDesc->pfMsgFile = pFileHandle;
+                    if (pMsgBufferDesc->bBinaryFile)
+                    {
+                        LogBinStartFile(pMsgBufferDesc);
+                    }
                 }
 
                 bRollOver = EC_FALSE;
             }
 #endif
         }
+        /* write the collected text if enough or old enough */
+        if ((0 != pMsgBufferDesc->dwFileBufUsed)
+         && ((pMsgBufferDesc->dwFileBufUsed >= LOG_FILE_FLUSH_SIZE) || ((OsQueryMsecCount() - pMsgBufferDesc->dwFileBufMsec) >= LOG_FILE_FLUSH_MSEC)))
+        {
+            WriteFileBuf(pMsgBufferDesc);
+        }
     }
     if (bLocked )
         OsUnlock(m_poProcessMsgLock);
 
-    return;
+    return dwNumProcessed;
 }
 
 
@@ -1270,4 +2387,50 @@ EC_T_DWORD CAtEmLogging::SetLogDir(EC_T_CHAR* szLogDir)
     return EC_E_NOERROR;
 }
 
+/********************************************************************************/
+/** \brief Format messages in the log task instead of the calling thread
+*
+* The caller only stores the format pointer and the arguments, strings are
+* copied. The format must stay valid until the message is printed, which is
+* the case for string literals. Messages with conversions not supported here
+* and OsDbgMsg() messages are still formatted by the caller.
+*
+* \return N/A
+*/
+EC_T_VOID CAtEmLogging::SetDeferredFormat(EC_T_BOOL bEnable)
+{
+    m_bDeferredFormat = bEnable;
+}
+
+/********************************************************************************/
+/** \brief Limit the wake-ups of the log task under load
+*
+* After printing messages the log task waits dwMsec before the next pass,
+* unless a message buffer gets half full. An idle log task is woken up by
+* the next message.
+*
+* \return N/A
+*/
+EC_T_VOID CAtEmLogging::SetWakeUpCoalescing(EC_T_DWORD dwMsec)
+{
+    m_dwCoalesceMsec = dwMsec;
+}
+
+/********************************************************************************/
+/** \brief Write the log files in the binary format of ecatDemoLogBin.h
+*
+* Must be called before InitLogging() and AddLogBuffer(), the files are
+* created there. Messages are stored like with SetDeferredFormat(), the log
+* task writes the format once per file and the arguments of each message
+* as varints instead of the text, see ecatDemoLogDecode.c. The text is only
+* formatted for the console. Messages that cannot be deferred are written
+* as text records.
+*
+* \return N/A
+*/
+EC_T_VOID CAtEmLogging::SetBinaryFormat(EC_T_BOOL bEnable)
+{
+    m_bBinaryFormat = bEnable;
+}
+
 /*-END OF SOURCE FILE--------------------------------------------------------*/
@@ -48,11 +48,15 @@ extern EC_T_BOOL bLogFileEnb;
 
 typedef struct _LOG_MSG_DESC
 {
-    EC_T_BOOL  bValid;                /* entry is valid */
+    volatile
+    EC_T_DWORD dwSeq;                 /* position + 1: entry is valid, position: entry is free for the producer of this position */
     EC_T_CHAR* szMsgBuffer;           /* buffers */
-    EC_T_DWORD dwLen;                 /* message size */
+    const
+    EC_T_CHAR* szFormat;              /* != EC_NULL: deferred message, szMsgBuffer holds the arguments until formatted by the log task */
+    EC_T_DWORD dwLen;                 /* message size, size of the arguments for deferred messages */
     EC_T_DWORD dwMsgTimestamp;        /* timestamp values */
     EC_T_DWORD dwMsgThreadId;         /* threadId values */
+    EC_T_UINT64 qwMsgTimestampNsec;   /* timestamp in nsec, only for binary log files */
     EC_T_BOOL  bMsgCrLf;              /* CR/LF do/don't */
     EC_T_BOOL  bOsDbgMsg;             /* OsDbgMsg values */
 } LOG_MSG_DESC;
@@ -64,9 +68,12 @@ typedef struct _MSG_BUFFER_DESC
     struct _MSG_BUFFER_DESC* pNextMsgBuf;           /* link to next message buffer */
     LOG_MSG_DESC*   paMsg;              /* array of messages */
     EC_T_DWORD  dwMsgSize;              /* message size */
-    EC_T_DWORD  dwNumMsgs;              /* number of messages */
-    EC_T_DWORD  dwNextEmptyMsgIndex;    /* index of next empty message buffer */
-    EC_T_DWORD  dwNextPrintMsgIndex;    /* index of next message buffer to print */
+    EC_T_DWORD  dwNumMsgs;              /* number of messages, power of 2 */
+    EC_T_DWORD  dwMsgIndexMask;         /* dwNumMsgs - 1, message index = position & dwMsgIndexMask */
+    volatile
+    EC_T_DWORD  dwNextEmptyMsgIndex;    /* position of next empty message buffer, advanced by the producers */
+    volatile
+    EC_T_DWORD  dwNextPrintMsgIndex;    /* position of next message buffer to print, advanced by the log task */
     EC_T_CHAR   szMsgLogFileName[MAX_PATH_LEN]; /* message log file name */
     EC_T_CHAR   szMsgLogFileExt[4];             /* message log file extension */
     FILE*       pfMsgFile;              /* file pointer for message log file */
@@ -88,6 +95,25 @@ typedef struct _MSG_BUFFER_DESC
     EC_T_DWORD	dwNumDuplicates;        /* if 0, the new message is not duplicated */
     EC_T_CHAR*  pszLastMsg;             /* pointer to last message (points into message buffer) */
     EC_T_BOOL   bNewLine;               /* EC_TRUE if last message printed with CrLf */
+    /* batched file output */
+    EC_T_CHAR*  pchFileBuf;             /* text not written to pfMsgFile yet, aligned */
+    EC_T_BYTE*  pbyFileBufAlloc;        /* allocated memory of pchFileBuf */
+    EC_T_DWORD  dwFileBufUsed;          /* bytes in pchFileBuf */
+    EC_T_DWORD  dwFileBufMsec;          /* OsQueryMsecCount() when the first byte was put into pchFileBuf */
+    /* binary log file, see ecatDemoLogBin.h */
+    EC_T_BOOL   bBinaryFile;            /* EC_TRUE if pfMsgFile is written in the binary format */
+    const
+    EC_T_CHAR** ppszBinFormatHash;      /* formats with an id in the current file, EC_NULL = empty */
+    EC_T_DWORD* pdwBinFormatIdHash;     /* id of ppszBinFormatHash[] */
+    EC_T_DWORD  dwBinFormatHashMask;    /* number of hash entries - 1 */
+    EC_T_DWORD  dwNumBinFormats;        /* ids used in the current file */
+    EC_T_UINT64 qwBinLastNsec;          /* time of the previous record */
+    EC_T_DWORD  dwBinLastThreadId;      /* thread of the previous record */
+    EC_T_DWORD  dwBinLastMsec;          /* msec stamp of the previous record */
+    const
+    EC_T_CHAR*  pszBinLastFormat;       /* format of the previous message, EC_NULL: text */
+    EC_T_CHAR*  pchBinLastMsg;          /* arguments or text of the previous message to skip duplicates */
+    EC_T_DWORD  dwBinLastMsgLen;        /* bytes in pchBinLastMsg */
 } MSG_BUFFER_DESC;
 
 
@@ -139,7 +165,7 @@ public:
                                                 EC_T_CHAR*              szFormat, 
                                                 EC_T_VALIST             vaArgs                      );
     EC_T_VOID   tAtEmLog(                       EC_T_VOID*              pvParms                     );
-    EC_T_VOID   ProcessAllMsgs(                 EC_T_VOID                                           );
+    EC_T_DWORD  ProcessAllMsgs(                 EC_T_VOID                                           );
 
     struct _MSG_BUFFER_DESC*  AddLogBuffer(     EC_T_DWORD              dwMasterID,
                                                 EC_T_WORD               wRollOver,
@@ -150,6 +176,8 @@ public:
                                                 EC_T_CHAR*              szLogFileExt,
                                                 EC_T_BOOL               bPrintConsole,
                                                 EC_T_BOOL               bPrintTimestamp             );
+    EC_T_VOID   RemoveLogBuffer(                MSG_BUFFER_DESC*        pMsgBufferDesc              );
+    EC_T_VOID   FlushLogBuffer(                 MSG_BUFFER_DESC*        pMsgBufferDesc              );
 
     static
     EC_T_VOID   SetMsgBuf(                      MSG_BUFFER_DESC*        pMsgBufferDesc,
@@ -164,6 +192,9 @@ public:
                                                 EC_T_BOOL               bOsDbgMsg=EC_FALSE          );
 
     EC_T_DWORD  SetLogDir(                      EC_T_CHAR*              szLogDir                    );
+    EC_T_VOID   SetDeferredFormat(              EC_T_BOOL               bEnable                     );
+    EC_T_VOID   SetWakeUpCoalescing(            EC_T_DWORD              dwMsec                      );
+    EC_T_VOID   SetBinaryFormat(                EC_T_BOOL               bEnable                     );
 
 
 private:
@@ -177,13 +208,20 @@ private:
                                                 EC_T_CHAR*              szMsgLogFileName,
                                                 EC_T_CHAR*              szMsgLogFileExt,
                                                 EC_T_WORD               wRollOver,
-                                                EC_T_CHAR*              szLogName                   );
+                                                EC_T_CHAR*              szLogName,
+                                                EC_T_BOOL               bBinaryFile                 );
   
     EC_T_VOID   DeinitMsgBuffer(                MSG_BUFFER_DESC*        pMsgBufferDesc              );
-    EC_T_VOID   ProcessMsgs(                    MSG_BUFFER_DESC*        pMsgBufferDesc              );
+    EC_T_DWORD  ProcessMsgs(                    MSG_BUFFER_DESC*        pMsgBufferDesc              );
+    EC_T_BOOL   MsgsPending(                    EC_T_VOID                                           );
+    EC_T_BOOL   FileBufsPending(                EC_T_VOID                                           );
+    EC_T_VOID   WakeUpLogTask(                  MSG_BUFFER_DESC*        pMsgBufferDesc,
+                                                EC_T_DWORD              dwPos                       );
     
     static
     EC_T_VOID   SelectNextLogMemBuffer(         MSG_BUFFER_DESC*        pMsgBufferDesc              );
+    static
+    EC_T_VOID   WriteFileBuf(                   MSG_BUFFER_DESC*        pMsgBufferDesc              );
 
     static 
     EC_T_VOID   tAtEmLogWrapper(                EC_T_VOID*              pvParms                     );
@@ -191,6 +229,13 @@ private:
     EC_T_PVOID              m_pvLogThreadObj;
     EC_T_BOOL               m_bLogTaskRunning;
     EC_T_BOOL               m_bShutdownLogTask;
+    EC_T_VOID*              m_pvLogEvent;                   /* set by the producers if the log task waits */
+    EC_T_VOID*              m_pvLogTaskDoneEvent;           /* set by the log task when it stops */
+    volatile
+    EC_T_DWORD              m_dwLogTaskWait;                /* LOG_TASK_WAIT_..., written by the log task before it waits */
+    EC_T_DWORD              m_dwCoalesceMsec;               /* see SetWakeUpCoalescing() */
+    volatile
+    EC_T_DWORD              m_dwNumPasses;                  /* passes of the log task, see RemoveLogBuffer() */
 
     MSG_BUFFER_DESC*        m_pFirstMsgBufferDesc;          /* pointer to first message buffer */
     MSG_BUFFER_DESC*        m_pLastMsgBufferDesc;           /* link to last message buffer */
@@ -198,9 +243,11 @@ private:
     MSG_BUFFER_DESC*        m_pErrorMsgBufferDesc;          /* buffer for application error messages */
     MSG_BUFFER_DESC*        m_pDcmMsgBufferDesc;            /* DCM buffer */
     EC_T_CHAR*              m_pchTempbuffer;
-    EC_T_VOID*              m_poInsertMsgLock;              /* lock object for inserting new messages */
+    EC_T_VOID*              m_poInsertMsgLock;              /* lock object for inserting new messages, only used without DEMO_ATOMIC_CAS() */
     EC_T_VOID*              m_poProcessMsgLock;             /* lock object for processing messages */
     EC_T_BOOL               m_bDbgMsgHookEnable;
+    EC_T_BOOL               m_bDeferredFormat;              /* format messages in the log task, see SetDeferredFormat() */
+    EC_T_BOOL               m_bBinaryFormat;                /* write binary log files, see SetBinaryFormat() */
 
     CEcTimer                m_oMsgTimeout;
     CEcTimer                m_oSettlingTimeout;
@@ -0,0 +1,177 @@
+/*-----------------------------------------------------------------------------
+ * ecatDemoAppTask.cpp
+ * Copyright                acontis technologies GmbH, Weingarten, Germany
+ * Response                 Stefan Zintgraf
+ * Description              cycle divided application tasks of the job task
+ *---------------------------------------------------------------------------*/
+
+/*-INCLUDES------------------------------------------------------------------*/
+#include "ecatDemoAppTask.h"
+
+/*-DEFINES-------------------------------------------------------------------*/
+#define APP_TASK_MAX_CYCLE_WRAP     ((EC_T_DWORD)0x7FFFFFFF)
+
+/*-FUNCTION-DEFINITIONS------------------------------------------------------*/
+
+/********************************************************************************/
+/** \brief  Greatest common divisor.
+*
+* \return  gcd of both values.
+*/
+static EC_T_DWORD AppTaskGcd(EC_T_DWORD dwA, EC_T_DWORD dwB)
+{
+    while (0 != dwB)
+    {
+    EC_T_DWORD dwTmp = dwA % dwB;
+
+        dwA = dwB;
+        dwB = dwTmp;
+    }
+    return dwA;
+}
+
+/********************************************************************************/
+/** \brief  Initialize empty task table.
+*
+* \return  N/A.
+*/
+EC_T_VOID AppTaskTableInit(T_APP_TASK_TABLE* pTable)
+{
+    OsMemset(pTable, 0, sizeof(T_APP_TASK_TABLE));
+    pTable->dwCycleWrap = 1;
+}
+
+/********************************************************************************/
+/** \brief  Register an application task. Must be called before the job task runs.
+*
+* Two tasks with dividers d1, d2 and phases p1, p2 run in the same cycle if
+* (p1 - p2) is a multiple of gcd(d1, d2). With APP_TASK_PHASE_AUTO the phase
+* with the least colliding tasks is selected, so slow tasks are spread over
+* the cycles instead of all running in cycle 0.
+*
+* The cycle counter wraps at the least common multiple of all dividers. A task
+* is rejected with EC_E_INVALIDPARM if it would exceed APP_TASK_MAX_CYCLE_WRAP,
+* because the phases of the tasks would shift at the wrap.
+*
+* \return  EC_E_NOERROR on success, error code otherwise.
+*/
+EC_T_DWORD AppTaskRegister
+    (T_APP_TASK_TABLE* pTable
+    ,const EC_T_CHAR*  szName               /**< [in]   name shown with the job times */
+    ,PF_APP_TASK       pfnTask              /**< [in]   task function */
+    ,EC_T_DWORD        dwDivider            /**< [in]   run every dwDivider cycles */
+    ,EC_T_DWORD        dwPhase              /**< [in]   cycle offset or APP_TASK_PHASE_AUTO */
+    ,EC_T_DWORD*       pdwTaskIndex)        /**< [out]  index of the task in the table */
+{
+EC_T_DWORD  dwRetVal     = EC_E_ERROR;
+T_APP_TASK* pTask        = EC_NULL;
+EC_T_DWORD  dwIdx        = 0;
+EC_T_DWORD  dwGcd        = 0;
+EC_T_DWORD  dwCycleWrap  = 0;
+
+    if ((EC_NULL == pfnTask) || (0 == dwDivider) || ((APP_TASK_PHASE_AUTO != dwPhase) && (dwPhase >= dwDivider)))
+    {
+        dwRetVal = EC_E_INVALIDPARM;
+        goto Exit;
+    }
+    if (pTable->dwNumTasks >= APP_TASK_MAX_NUM)
+    {
+        dwRetVal = EC_E_NOMEMORY;
+        goto Exit;
+    }
+    /* cycle counter wraps at the least common multiple to keep the phases */
+    dwGcd = AppTaskGcd(pTable->dwCycleWrap, dwDivider);
+    if ((pTable->dwCycleWrap / dwGcd) > (APP_TASK_MAX_CYCLE_WRAP / dwDivider))
+    {
+        dwRetVal = EC_E_INVALIDPARM;
+        goto Exit;
+    }
+    dwCycleWrap = (pTable->dwCycleWrap / dwGcd) * dwDivider;
+
+    if (APP_TASK_PHASE_AUTO == dwPhase)
+    {
+    EC_T_DWORD dwCandidate   = 0;
+    EC_T_DWORD dwNumCollide  = 0;
+    EC_T_DWORD dwMinCollide  = 0xFFFFFFFF;
+
+        /* colliding tasks only depend on the phase modulo gcd, so checking the first 1000 phases is sufficient in practice */
+        for (dwCandidate = 0; (dwCandidate < dwDivider) && (dwCandidate < 1000) && (0 != dwMinCollide); dwCandidate++)
+        {
+            dwNumCollide = 0;
+            for (dwIdx = 0; dwIdx < pTable->dwNumTasks; dwIdx++)
+            {
+                dwGcd = AppTaskGcd(dwDivider, pTable->aTask[dwIdx].dwDivider);
+                if ((dwCandidate % dwGcd) == (pTable->aTask[dwIdx].dwPhase % dwGcd))
+                {
+                    dwNumCollide++;
+                }
+            }
+            if (dwNumCollide < dwMinCollide)
+            {
+                dwMinCollide = dwNumCollide;
+                dwPhase      = dwCandidate;
+            }
+        }
+    }
+    pTask = &pTable->aTask[pTable->dwNumTasks];
+    pTask->szName    = szName;
+    pTask->pfnTask   = pfnTask;
+    pTask->dwDivider = dwDivider;
+    pTask->dwPhase   = dwPhase;
+    pTable->dwCycleWrap = dwCycleWrap;
+    if (EC_NULL != pdwTaskIndex)
+    {
+        *pdwTaskIndex = pTable->dwNumTasks;
+    }
+    pTable->dwNumTasks++;
+
+    dwRetVal = EC_E_NOERROR;
+Exit:
+    return dwRetVal;
+}
+
+/********************************************************************************/
+/** \brief  Check if a task runs in the current cycle.
+*
+* \return  EC_TRUE if the task is due.
+*/
+EC_T_BOOL AppTaskIsDue
+    (T_APP_TASK_TABLE* pTable
+    ,EC_T_DWORD        dwTaskIndex)         /**< [in]   index of the task in the table */
+{
+    return (pTable->aTask[dwTaskIndex].dwPhase == (pTable->dwCycle % pTable->aTask[dwTaskIndex].dwDivider));
+}
+
+/********************************************************************************/
+/** \brief  Advance to the next cycle.
+*
+* \return  N/A.
+*/
+EC_T_VOID AppTaskNextCycle(T_APP_TASK_TABLE* pTable)
+{
+    pTable->dwCycle++;
+    if (pTable->dwCycle >= pTable->dwCycleWrap)
+    {
+        pTable->dwCycle = 0;
+    }
+}
+
+/********************************************************************************/
+/** \brief  Show registered tasks.
+*
+* \return  N/A.
+*/
+EC_T_VOID AppTaskTableShow
+    (T_APP_TASK_TABLE* pTable
+    ,CAtEmLogging*     poLog)
+{
+EC_T_DWORD dwIdx = 0;
+
+    for (dwIdx = 0; dwIdx < pTable->dwNumTasks; dwIdx++)
+    {
+        poLog->LogMsg("App task %d: %s, every %d cycles, phase %d", dwIdx,
+            pTable->aTask[dwIdx].szName, pTable->aTask[dwIdx].dwDivider, pTable->aTask[dwIdx].dwPhase);
+    }
+}
+
+/*-END OF SOURCE FILE--------------------------------------------------------*/
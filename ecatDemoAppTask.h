@@ -0,0 +1,69 @@
+/*-----------------------------------------------------------------------------
+ * ecatDemoAppTask.h
+ * Copyright                acontis technologies GmbH, Weingarten, Germany
+ * Response                 Stefan Zintgraf
+ * Description              cycle divided application tasks of the job task
+ *---------------------------------------------------------------------------*/
+
+#ifndef __ECATDEMOAPPTASK_H__
+#define __ECATDEMOAPPTASK_H__  1
+
+/*-INCLUDES------------------------------------------------------------------*/
+#include "Logging.h"
+
+/*-DEFINES-------------------------------------------------------------------*/
+#define APP_TASK_MAX_NUM        4           /* tasks per table, each has its own PERF slot */
+#define APP_TASK_PHASE_AUTO     ((EC_T_DWORD)0xFFFFFFFF)    /* select phase with the least colliding tasks */
+
+/*-TYPEDEFS------------------------------------------------------------------*/
+typedef EC_T_DWORD (*PF_APP_TASK)(
+    CAtEmLogging*       poLog,              /* [in]  Logging instance */
+    EC_T_INT            nVerbose,           /* [in]  Verbosity level */
+    EC_T_BYTE*          pbyPDIn,            /* [in]  pointer to process data input buffer */
+    EC_T_BYTE*          pbyPDOut            /* [in]  pointer to process data output buffer */
+    );
+
+typedef struct _T_APP_TASK
+{
+    const EC_T_CHAR*    szName;             /* name shown with the job times */
+    PF_APP_TASK         pfnTask;            /* called on cycles where (cycle % dwDivider) == dwPhase */
+    EC_T_DWORD          dwDivider;          /* run every dwDivider cycles */
+    EC_T_DWORD          dwPhase;            /* cycle offset within the divider */
+} T_APP_TASK;
+
+typedef struct _T_APP_TASK_TABLE
+{
+    T_APP_TASK          aTask[APP_TASK_MAX_NUM];
+    EC_T_DWORD          dwNumTasks;
+    EC_T_DWORD          dwCycle;            /* cycle counter of the job task */
+    EC_T_DWORD          dwCycleWrap;        /* common multiple of all dividers, dwCycle wraps here */
+} T_APP_TASK_TABLE;
+
+/*-FUNCTION DECLARATION------------------------------------------------------*/
+EC_T_VOID AppTaskTableInit(
+    T_APP_TASK_TABLE* pTable
+   );
+EC_T_DWORD AppTaskRegister(
+    T_APP_TASK_TABLE* pTable
+   ,const
+    EC_T_CHAR*    szName                /**< [in]   name shown with the job times */
+   ,PF_APP_TASK   pfnTask               /**< [in]   task function */
+   ,EC_T_DWORD    dwDivider             /**< [in]   run every dwDivider cycles */
+   ,EC_T_DWORD    dwPhase               /**< [in]   cycle offset or APP_TASK_PHASE_AUTO */
+   ,EC_T_DWORD*   pdwTaskIndex          /**< [out]  index of the task in the table */
+   );
+EC_T_BOOL AppTaskIsDue(
+    T_APP_TASK_TABLE* pTable
+   ,EC_T_DWORD    dwTaskIndex           /**< [in]   index of the task in the table */
+   );
+EC_T_VOID AppTaskNextCycle(
+    T_APP_TASK_TABLE* pTable
+   );
+EC_T_VOID AppTaskTableShow(
+    T_APP_TASK_TABLE* pTable
+   ,CAtEmLogging* poLog
+   );
+
+#endif /*__ECATDEMOAPPTASK_H__*/
+
+/*-END OF SOURCE FILE--------------------------------------------------------*/
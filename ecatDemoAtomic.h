@@ -0,0 +1,43 @@
+/*-----------------------------------------------------------------------------
+ * ecatDemoAtomic.h
+ * Copyright                acontis technologies GmbH, Weingarten, Germany
+ * Response                 Stefan Zintgraf
+ * Description              memory barrier and atomic helpers for the demos
+ *---------------------------------------------------------------------------*/
+
+#ifndef __ECATDEMOATOMIC_H__
+#define __ECATDEMOATOMIC_H__  1
+
+/*-INCLUDES------------------------------------------------------------------*/
+#ifndef INC_ECOS
+#include "EcOs.h"
+#endif
+#if (defined _MSC_VER)
+#include <intrin.h>
+#endif
+
+/*-MACROS--------------------------------------------------------------------*/
+
+/* full memory barrier: all stores before are visible before all stores after */
+#if (defined __GNUC__)
+#define DEMO_MEMORY_BARRIER()       __sync_synchronize()
+#elif (defined _MSC_VER)
+#define DEMO_MEMORY_BARRIER()       _ReadWriteBarrier(); MemoryBarrier()
+#else
+#define DEMO_MEMORY_BARRIER()       OsMemoryBarrier()
+#endif
+
+/* compare and swap of an aligned EC_T_DWORD, full barrier, EC_TRUE if *pdwDest was dwOld and is dwNew now */
+#if (defined __GNUC__)
+#define DEMO_ATOMIC_CAS_SUPPORTED   1
+#define DEMO_ATOMIC_CAS(pdwDest, dwOld, dwNew) \
+    (__sync_bool_compare_and_swap((pdwDest), (dwOld), (dwNew)) ? EC_TRUE : EC_FALSE)
+#elif (defined _MSC_VER)
+#define DEMO_ATOMIC_CAS_SUPPORTED   1
+#define DEMO_ATOMIC_CAS(pdwDest, dwOld, dwNew) \
+    ((InterlockedCompareExchange((volatile LONG*)(pdwDest), (LONG)(dwNew), (LONG)(dwOld)) == (LONG)(dwOld)) ? EC_TRUE : EC_FALSE)
+#endif
+
+#endif /*__ECATDEMOATOMIC_H__*/
+
+/*-END OF SOURCE FILE--------------------------------------------------------*/
@@ -20,11 +20,30 @@
 #define LogMsgAdd   poLog->LogMsgAdd
 #define LogMsg      poLog->LogMsg
 
+#define BUS_SNAPSHOT_MIN_HASH_SIZE  16
+
 /*-TYPEDEFS------------------------------------------------------------------*/
+/* bus slaves in auto increment order, taken once for all FindSlaveGetFixedAddr() calls */
+typedef struct _T_BUS_SLAVE_SNAPSHOT
+{
+    EC_T_BOOL           bValid;
+    EC_T_DWORD          dwInstanceID;
+    EC_T_DWORD          dwGeneration;       /* S_dwBusSnapshotGeneration when the snapshot was taken */
+    EC_T_DWORD          dwMaxSlaves;        /* allocated entries */
+    EC_T_DWORD          dwNumSlaves;
+    EC_T_DWORD*         pdwVendorId;
+    EC_T_DWORD*         pdwProductCode;
+    EC_T_WORD*          pwStationAddress;
+    EC_T_DWORD*         pdwNextOfType;      /* next slave + 1 with the same vendor and product, 0 = last */
+    EC_T_DWORD          dwHashMask;         /* number of hash entries - 1 */
+    EC_T_DWORD*         pdwTypeHash;        /* first slave + 1 by vendor and product, 0 = empty */
+} T_BUS_SLAVE_SNAPSHOT;
 
 /*-GLOBAL VARIABLES----------------------------------------------------------*/
 
 /*-LOCAL VARIABLES-----------------------------------------------------------*/
+static T_BUS_SLAVE_SNAPSHOT S_oBusSnapshot;
+static volatile EC_T_DWORD  S_dwBusSnapshotGeneration = 0;  /* incremented on topology changes */
 
 /*-FORWARD DECLARATIONS------------------------------------------------------*/
 
@@ -332,9 +351,136 @@ EC_T_WORD  wAutoIncAddress = 0;
     return;
 }
 
+/***************************************************************************************************/
+/**
+\brief  Hash of vendor id and product code.
+\return start position in the hash table.
+*/
+static EC_T_DWORD BusSnapshotHashType(EC_T_DWORD dwVendorId, EC_T_DWORD dwProductCode)
+{
+EC_T_DWORD dwHash = (dwVendorId * 0x9E3779B1) ^ (dwProductCode * 0x85EBCA77);
+
+    dwHash ^= dwHash >> 15;
+    dwHash *= 0x2C1B3C6D;
+    dwHash ^= dwHash >> 16;
+    return dwHash & S_oBusSnapshot.dwHashMask;
+}
+
+/***************************************************************************************************/
+/**
+\brief  Read the information of all bus slaves once and index them by vendor id and product code.
+\return EC_E_NOERROR on success, error code otherwise.
+*/
+static EC_T_DWORD BusSnapshotTake
+    (EC_T_DWORD     dwInstanceID
+    ,CAtEmLogging*  poLog)
+{
+T_BUS_SLAVE_SNAPSHOT* pSnapshot    = &S_oBusSnapshot;
+EC_T_DWORD            dwRes        = EC_E_ERROR;
+EC_T_DWORD            dwGeneration = S_dwBusSnapshotGeneration;
+EC_T_DWORD            dwNumSlaves  = emGetNumConnectedSlaves(dwInstanceID);
+EC_T_DWORD            dwHashSize   = BUS_SNAPSHOT_MIN_HASH_SIZE;
+EC_T_DWORD            dwSlaveIdx   = 0;
+EC_T_DWORD            dwPos        = 0;
+EC_T_BUS_SLAVE_INFO   oBusSlaveInfo;
+
+    pSnapshot->bValid = EC_FALSE;
+    if ((dwNumSlaves > pSnapshot->dwMaxSlaves) || (EC_NULL == pSnapshot->pdwTypeHash))
+    {
+        FreeBusSlaveSnapshot();
+
+        /* at most half of the hash entries are used */
+        while (dwHashSize < (2 * dwNumSlaves))
+        {
+            dwHashSize *= 2;
+        }
+        pSnapshot->dwHashMask       = dwHashSize - 1;
+        pSnapshot->pdwVendorId      = (EC_T_DWORD*)OsMalloc(dwNumSlaves * sizeof(EC_T_DWORD) + 1);
+        pSnapshot->pdwProductCode   = (EC_T_DWORD*)OsMalloc(dwNumSlaves * sizeof(EC_T_DWORD) + 1);
+        pSnapshot->pwStationAddress = (EC_T_WORD*)OsMalloc(dwNumSlaves * sizeof(EC_T_WORD) + 1);
+        pSnapshot->pdwNextOfType    = (EC_T_DWORD*)OsMalloc(dwNumSlaves * sizeof(EC_T_DWORD) + 1);
+        pSnapshot->pdwTypeHash      = (EC_T_DWORD*)OsMalloc(dwHashSize * sizeof(EC_T_DWORD));
+        if ((EC_NULL == pSnapshot->pdwVendorId) || (EC_NULL == pSnapshot->pdwProductCode) || (EC_NULL == pSnapshot->pwStationAddress)
+         || (EC_NULL == pSnapshot->pdwNextOfType) || (EC_NULL == pSnapshot->pdwTypeHash))
+        {
+            FreeBusSlaveSnapshot();
+            return EC_E_NOMEMORY;
+        }
+        pSnapshot->dwMaxSlaves = dwNumSlaves;
+    }
+    /* one emGetBusSlaveInfo() call per slave */
+    pSnapshot->dwNumSlaves = 0;
+    for (dwSlaveIdx = 0; dwSlaveIdx < dwNumSlaves; dwSlaveIdx++)
+    {
+        dwRes = emGetBusSlaveInfo(dwInstanceID, EC_FALSE, (EC_T_WORD)(0-dwSlaveIdx), &oBusSlaveInfo);
+        if (EC_E_NOERROR != dwRes)
+        {
+            LogErr("FindSlaveGetFixedAddr() emGetBusSlaveInfo return with error 0x%x", dwRes);
+            continue;
+        }
+        pSnapshot->pdwVendorId[pSnapshot->dwNumSlaves]      = oBusSlaveInfo.dwVendorId;
+        pSnapshot->pdwProductCode[pSnapshot->dwNumSlaves]   = oBusSlaveInfo.dwProductCode;
+        pSnapshot->pwStationAddress[pSnapshot->dwNumSlaves] = oBusSlaveInfo.wStationAddress;
+        pSnapshot->dwNumSlaves++;
+    }
+    /* insert from the end of the bus, each list ends up in auto increment order */
+    OsMemset(pSnapshot->pdwTypeHash, 0, (pSnapshot->dwHashMask + 1) * sizeof(EC_T_DWORD));
+    for (dwSlaveIdx = pSnapshot->dwNumSlaves; dwSlaveIdx > 0; dwSlaveIdx--)
+    {
+        for (dwPos = BusSnapshotHashType(pSnapshot->pdwVendorId[dwSlaveIdx - 1], pSnapshot->pdwProductCode[dwSlaveIdx - 1]);
+             0 != pSnapshot->pdwTypeHash[dwPos];
+             dwPos = (dwPos + 1) & pSnapshot->dwHashMask)
+        {
+            if ((pSnapshot->pdwVendorId[pSnapshot->pdwTypeHash[dwPos] - 1] == pSnapshot->pdwVendorId[dwSlaveIdx - 1])
+             && (pSnapshot->pdwProductCode[pSnapshot->pdwTypeHash[dwPos] - 1] == pSnapshot->pdwProductCode[dwSlaveIdx - 1]))
+            {
+                break;
+            }
+        }
+        pSnapshot->pdwNextOfType[dwSlaveIdx - 1] = pSnapshot->pdwTypeHash[dwPos];
+        pSnapshot->pdwTypeHash[dwPos]            = dwSlaveIdx;
+    }
+    pSnapshot->dwInstanceID = dwInstanceID;
+    pSnapshot->dwGeneration = dwGeneration;
+    pSnapshot->bValid       = EC_TRUE;
+
+    return EC_E_NOERROR;
+}
+
+/***************************************************************************************************/
+/**
+\brief  Take a new bus slave snapshot at the next FindSlaveGetFixedAddr() call.
+
+Called on topology changes, e.g. from the notification callback.
+\return N/A.
+*/
+EC_T_VOID InvalidateBusSlaveSnapshot(EC_T_VOID)
+{
+    S_dwBusSnapshotGeneration++;
+}
+
+/***************************************************************************************************/
+/**
+\brief  Free the bus slave snapshot.
+\return N/A.
+*/
+EC_T_VOID FreeBusSlaveSnapshot(EC_T_VOID)
+{
+    SafeOsFree(S_oBusSnapshot.pdwVendorId);
+    SafeOsFree(S_oBusSnapshot.pdwProductCode);
+    SafeOsFree(S_oBusSnapshot.pwStationAddress);
+    SafeOsFree(S_oBusSnapshot.pdwNextOfType);
+    SafeOsFree(S_oBusSnapshot.pdwTypeHash);
+    S_oBusSnapshot.bValid      = EC_FALSE;
+    S_oBusSnapshot.dwMaxSlaves = 0;
+    S_oBusSnapshot.dwNumSlaves = 0;
+}
+
 /***************************************************************************************************/
 /**
 \brief  Find a specific slave and return its fixed (ethercat) address
+
+The bus slaves are read once, the snapshot is reused until InvalidateBusSlaveSnapshot() is called.
 \return EC_TRUE on success, EC_FALSE otherwise.
 */
 EC_T_BOOL FindSlaveGetFixedAddr
@@ -345,32 +491,39 @@ EC_T_BOOL FindSlaveGetFixedAddr
     ,EC_T_DWORD     dwProductCode       /**< [in]   Product Code of slave to search */
     ,EC_T_WORD*     pwPhysAddr)         /**< [out]  Physical Address of slave */
 {
-EC_T_DWORD dwRes              = EC_E_ERROR;
-EC_T_DWORD dwSlaveIdx         = 0;
-EC_T_DWORD dwSlaveInstanceCnt = 0;
+T_BUS_SLAVE_SNAPSHOT* pSnapshot  = &S_oBusSnapshot;
+EC_T_DWORD            dwRes      = EC_E_ERROR;
+EC_T_DWORD            dwPos      = 0;
+EC_T_DWORD            dwSlaveIdx = 0;
 
-    for (dwSlaveIdx = 0; dwSlaveIdx < emGetNumConnectedSlaves(dwInstanceID); dwSlaveIdx++)
+    if (!pSnapshot->bValid || (pSnapshot->dwInstanceID != dwInstanceID) || (pSnapshot->dwGeneration != S_dwBusSnapshotGeneration))
     {
-    EC_T_WORD           wAutoIncAddress = (EC_T_WORD)(0-dwSlaveIdx);
-    EC_T_BUS_SLAVE_INFO oBusSlaveInfo;
-
-        /* get information about bus slave */
-        dwRes = emGetBusSlaveInfo(dwInstanceID, EC_FALSE, wAutoIncAddress, &oBusSlaveInfo);
+        dwRes = BusSnapshotTake(dwInstanceID, poLog);
         if (EC_E_NOERROR != dwRes)
         {
-            LogErr("PrintSlaveInfos() emGetBusSlaveInfo return with error 0x%x", dwRes);
+            LogErr("FindSlaveGetFixedAddr() cannot read bus slaves: %s (0x%x)", ecatGetText(dwRes), dwRes);
+            return EC_FALSE;
+        }
+    }
+    for (dwPos = BusSnapshotHashType(dwVendorId, dwProductCode); 0 != pSnapshot->pdwTypeHash[dwPos]; dwPos = (dwPos + 1) & pSnapshot->dwHashMask)
+    {
+        dwSlaveIdx = pSnapshot->pdwTypeHash[dwPos] - 1;
+        if ((pSnapshot->pdwVendorId[dwSlaveIdx] != dwVendorId) || (pSnapshot->pdwProductCode[dwSlaveIdx] != dwProductCode))
+        {
             continue;
         }
-        if ((oBusSlaveInfo.dwVendorId == dwVendorId) && (oBusSlaveInfo.dwProductCode == dwProductCode))
+        /* walk the slaves of this type in auto increment order */
+        for (; 0 != dwSlaveInstance; dwSlaveInstance--)
         {
-            if (dwSlaveInstanceCnt == dwSlaveInstance)
+            if (0 == pSnapshot->pdwNextOfType[dwSlaveIdx])
             {
-                /* slave found */
-                *pwPhysAddr = oBusSlaveInfo.wStationAddress;
-                return EC_TRUE;
+                return EC_FALSE;
             }
-            dwSlaveInstanceCnt++;
+            dwSlaveIdx = pSnapshot->pdwNextOfType[dwSlaveIdx] - 1;
         }
+        /* slave found */
+        *pwPhysAddr = pSnapshot->pwStationAddress[dwSlaveIdx];
+        return EC_TRUE;
     }
     return EC_FALSE;
 }
@@ -114,6 +114,8 @@ EC_T_BOOL FindSlaveGetFixedAddr(
    ,EC_T_DWORD    dwProductCode         /**< [in]   Product Code of slave to search */
    ,EC_T_WORD*    pwPhysAddr            /**< [out]  Station address of slave */
    );
+EC_T_VOID InvalidateBusSlaveSnapshot(EC_T_VOID);
+EC_T_VOID FreeBusSlaveSnapshot(EC_T_VOID);
 EC_T_DWORD DoBusScan(
     EC_T_DWORD    dwInstanceID
    ,CAtEmLogging* poLog
@@ -0,0 +1,410 @@
+/*-----------------------------------------------------------------------------
+ * ecatDemoDio.cpp
+ * Copyright                acontis technologies GmbH, Weingarten, Germany
+ * Response                 Stefan Zintgraf
+ * Description              bulk pack/unpack of bit-packed digital channels
+ *---------------------------------------------------------------------------*/
+
+/*-INCLUDES------------------------------------------------------------------*/
+#include "ecatDemoDio.h"
+#include "ecatDemoTiming.h"
+#include "ecatDemoSimd.h"
+
+/*-DEFINES-------------------------------------------------------------------*/
+#define DIO_BENCH_LOOPS     10000
+
+/*-LOCAL VARIABLES-----------------------------------------------------------*/
+#if (defined DEMO_SIMD_NEON)
+static const EC_T_BYTE S_abyBitMask16[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+#endif
+
+/*-FUNCTION-DEFINITIONS------------------------------------------------------*/
+
+/********************************************************************************/
+/** \brief  Read up to 32 bits at any bit offset. Only the bytes spanned are read.
+*
+* \return  bits, first bit in bit 0.
+*/
+static EC_T_DWORD DioReadBits(const EC_T_BYTE* pbyImage, EC_T_DWORD dwBitOffs, EC_T_DWORD dwNumBits)
+{
+const EC_T_BYTE* pbyByte  = &pbyImage[dwBitOffs / 8];
+EC_T_DWORD       dwShift  = dwBitOffs % 8;
+EC_T_DWORD       dwNumBytes = (dwShift + dwNumBits + 7) / 8;
+EC_T_UINT64      qwBits   = 0;
+EC_T_DWORD       dwIdx    = 0;
+
+    for (dwIdx = 0; dwIdx < dwNumBytes; dwIdx++)
+    {
+        qwBits |= ((EC_T_UINT64)pbyByte[dwIdx]) << (8 * dwIdx);
+    }
+    return (EC_T_DWORD)((qwBits >> dwShift) & ((((EC_T_UINT64)1) << dwNumBits) - 1));
+}
+
+/********************************************************************************/
+/** \brief  Write up to 32 bits at any bit offset, the other bits are kept.
+*
+* \return  N/A.
+*/
+static EC_T_VOID DioWriteBits(EC_T_BYTE* pbyImage, EC_T_DWORD dwBitOffs, EC_T_DWORD dwNumBits, EC_T_DWORD dwBits)
+{
+EC_T_BYTE*  pbyByte    = &pbyImage[dwBitOffs / 8];
+EC_T_DWORD  dwShift    = dwBitOffs % 8;
+EC_T_DWORD  dwNumBytes = (dwShift + dwNumBits + 7) / 8;
+EC_T_UINT64 qwMask     = ((((EC_T_UINT64)1) << dwNumBits) - 1) << dwShift;
+EC_T_UINT64 qwBits     = ((EC_T_UINT64)dwBits) << dwShift;
+EC_T_DWORD  dwIdx      = 0;
+
+    for (dwIdx = 0; dwIdx < dwNumBytes; dwIdx++)
+    {
+    EC_T_BYTE byMask = (EC_T_BYTE)(qwMask >> (8 * dwIdx));
+
+        pbyByte[dwIdx] = (EC_T_BYTE)((pbyByte[dwIdx] & ~byMask) | ((EC_T_BYTE)(qwBits >> (8 * dwIdx)) & byMask));
+    }
+}
+
+#if (defined DEMO_SIMD_AVX2)
+#define DIO_KERNEL_BITS     32
+/* 32 bits -> 32 bytes of 0/1 */
+static EC_T_VOID DioExpand(EC_T_DWORD dwBits, EC_T_BYTE* pbyChannels)
+{
+__m256i oVal  = _mm256_set1_epi32((int)dwBits);
+__m256i oMask = _mm256_set1_epi64x((long long)0x8040201008040201LL);
+
+    oVal = _mm256_shuffle_epi8(oVal, _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+                                                      2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3));
+    oVal = _mm256_cmpeq_epi8(_mm256_and_si256(oVal, oMask), oMask);
+    _mm256_storeu_si256((__m256i*)pbyChannels, _mm256_and_si256(oVal, _mm256_set1_epi8(1)));
+}
+/* 32 bytes -> 32 bits, any value != 0 is a set bit */
+static EC_T_DWORD DioCompress(const EC_T_BYTE* pbyChannels)
+{
+__m256i oZero = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)pbyChannels), _mm256_setzero_si256());
+
+    return ~(EC_T_DWORD)_mm256_movemask_epi8(oZero);
+}
+#elif (defined DEMO_SIMD_SSE2)
+#define DIO_KERNEL_BITS     16
+/* 16 bits -> 16 bytes of 0/1 */
+static EC_T_VOID DioExpand(EC_T_DWORD dwBits, EC_T_BYTE* pbyChannels)
+{
+__m128i oVal  = _mm_cvtsi32_si128((int)dwBits);
+__m128i oMask = _mm_set_epi8((char)0x80, 0x40, 0x20, 0x10, 8, 4, 2, 1, (char)0x80, 0x40, 0x20, 0x10, 8, 4, 2, 1);
+
+    /* replicate byte 0 to bytes 0..7 and byte 1 to bytes 8..15 */
+    oVal = _mm_unpacklo_epi8(oVal, oVal);
+    oVal = _mm_unpacklo_epi16(oVal, oVal);
+    oVal = _mm_unpacklo_epi32(oVal, oVal);
+    oVal = _mm_cmpeq_epi8(_mm_and_si128(oVal, oMask), oMask);
+    _mm_storeu_si128((__m128i*)pbyChannels, _mm_and_si128(oVal, _mm_set1_epi8(1)));
+}
+/* 16 bytes -> 16 bits, any value != 0 is a set bit */
+static EC_T_DWORD DioCompress(const EC_T_BYTE* pbyChannels)
+{
+__m128i oZero = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)pbyChannels), _mm_setzero_si128());
+
+    return (~(EC_T_DWORD)_mm_movemask_epi8(oZero)) & 0xFFFF;
+}
+#elif (defined DEMO_SIMD_NEON)
+#define DIO_KERNEL_BITS     16
+/* 16 bits -> 16 bytes of 0/1 */
+static EC_T_VOID DioExpand(EC_T_DWORD dwBits, EC_T_BYTE* pbyChannels)
+{
+uint8x16_t oVal  = vcombine_u8(vdup_n_u8((uint8_t)dwBits), vdup_n_u8((uint8_t)(dwBits >> 8)));
+uint8x16_t oMask = vld1q_u8(S_abyBitMask16);
+
+    vst1q_u8(pbyChannels, vandq_u8(vtstq_u8(oVal, oMask), vdupq_n_u8(1)));
+}
+/* 16 bytes -> 16 bits, any value != 0 is a set bit */
+static EC_T_DWORD DioCompress(const EC_T_BYTE* pbyChannels)
+{
+uint8x16_t oVal = vld1q_u8(pbyChannels);
+
+    oVal = vandq_u8(vtstq_u8(oVal, oVal), vld1q_u8(S_abyBitMask16));
+    return ((EC_T_DWORD)vaddv_u8(vget_low_u8(oVal))) | (((EC_T_DWORD)vaddv_u8(vget_high_u8(oVal))) << 8);
+}
+#endif
+
+/********************************************************************************/
+/** \brief  Initialize empty map.
+*
+* \return  N/A.
+*/
+EC_T_VOID DioMapInit(T_DIO_MAP* pMap)
+{
+    OsMemset(pMap, 0, sizeof(T_DIO_MAP));
+}
+
+/********************************************************************************/
+/** \brief  Add digital channels of a slave. Channels adjacent to the previous
+*           slave extend its segment, so long runs are processed in one pass.
+*
+* \return  EC_E_NOERROR on success, EC_E_NOMEMORY if the map is full.
+*/
+EC_T_DWORD DioMapAdd
+    (T_DIO_MAP* pMap
+    ,EC_T_DWORD dwImageBitOffs          /**< [in]   bit offset of the channels in the process image */
+    ,EC_T_DWORD dwNumBits)              /**< [in]   number of channels */
+{
+T_DIO_SEGMENT* pSegment = EC_NULL;
+
+    if (0 != pMap->dwNumSegments)
+    {
+        pSegment = &pMap->aSegment[pMap->dwNumSegments - 1];
+        if ((pSegment->dwImageBitOffs + pSegment->dwNumBits) == dwImageBitOffs)
+        {
+            pSegment->dwNumBits += dwNumBits;
+            pMap->dwNumChannels += dwNumBits;
+            return EC_E_NOERROR;
+        }
+    }
+    if (pMap->dwNumSegments >= DIO_MAX_SEGMENTS)
+    {
+        return EC_E_NOMEMORY;
+    }
+    pSegment = &pMap->aSegment[pMap->dwNumSegments];
+    pSegment->dwImageBitOffs = dwImageBitOffs;
+    pSegment->dwNumBits      = dwNumBits;
+    pSegment->dwChannel      = pMap->dwNumChannels;
+    pMap->dwNumSegments++;
+    pMap->dwNumChannels += dwNumBits;
+
+    return EC_E_NOERROR;
+}
+
+/********************************************************************************/
+/** \brief  Gather all digital channels of the map from the process image.
+*
+* \return  N/A.
+*/
+EC_T_VOID DioUnpack
+    (T_DIO_MAP*       pMap
+    ,const EC_T_BYTE* pbyImage          /**< [in]   process image */
+    ,EC_T_BYTE*       pbyChannels)      /**< [out]  one byte (0 or 1) per channel */
+{
+EC_T_DWORD dwSegIdx = 0;
+
+    for (dwSegIdx = 0; dwSegIdx < pMap->dwNumSegments; dwSegIdx++)
+    {
+    T_DIO_SEGMENT* pSegment = &pMap->aSegment[dwSegIdx];
+    EC_T_BYTE*     pbyDst   = &pbyChannels[pSegment->dwChannel];
+    EC_T_DWORD     dwBit    = 0;
+
+#if (defined DIO_KERNEL_BITS)
+        for (; (dwBit + DIO_KERNEL_BITS) <= pSegment->dwNumBits; dwBit += DIO_KERNEL_BITS)
+        {
+            DioExpand(DioReadBits(pbyImage, pSegment->dwImageBitOffs + dwBit, DIO_KERNEL_BITS), &pbyDst[dwBit]);
+        }
+#endif
+        while (dwBit < pSegment->dwNumBits)
+        {
+        EC_T_DWORD dwNumBits = EC_MIN(pSegment->dwNumBits - dwBit, 8);
+        EC_T_DWORD dwBits    = DioReadBits(pbyImage, pSegment->dwImageBitOffs + dwBit, dwNumBits);
+        EC_T_DWORD dwIdx     = 0;
+
+            for (dwIdx = 0; dwIdx < dwNumBits; dwIdx++)
+            {
+                pbyDst[dwBit + dwIdx] = (EC_T_BYTE)((dwBits >> dwIdx) & 1);
+            }
+            dwBit += dwNumBits;
+        }
+    }
+}
+
+/********************************************************************************/
+/** \brief  Scatter all digital channels of the map to the process image.
+*
+* Bits outside of the map are not changed.
+*
+* \return  N/A.
+*/
+EC_T_VOID DioPack
+    (T_DIO_MAP*       pMap
+    ,const EC_T_BYTE* pbyChannels       /**< [in]   one byte (0 = off) per channel */
+    ,EC_T_BYTE*       pbyImage)         /**< [out]  process image */
+{
+EC_T_DWORD dwSegIdx = 0;
+
+    for (dwSegIdx = 0; dwSegIdx < pMap->dwNumSegments; dwSegIdx++)
+    {
+    T_DIO_SEGMENT*   pSegment = &pMap->aSegment[dwSegIdx];
+    const EC_T_BYTE* pbySrc   = &pbyChannels[pSegment->dwChannel];
+    EC_T_DWORD       dwBit    = 0;
+
+#if (defined DIO_KERNEL_BITS)
+        for (; (dwBit + DIO_KERNEL_BITS) <= pSegment->dwNumBits; dwBit += DIO_KERNEL_BITS)
+        {
+            DioWriteBits(pbyImage, pSegment->dwImageBitOffs + dwBit, DIO_KERNEL_BITS, DioCompress(&pbySrc[dwBit]));
+        }
+#endif
+        while (dwBit < pSegment->dwNumBits)
+        {
+        EC_T_DWORD dwNumBits = EC_MIN(pSegment->dwNumBits - dwBit, 8);
+        EC_T_DWORD dwBits    = 0;
+        EC_T_DWORD dwIdx     = 0;
+
+            for (dwIdx = 0; dwIdx < dwNumBits; dwIdx++)
+            {
+                dwBits |= ((0 != pbySrc[dwBit + dwIdx]) ? 1 : 0) << dwIdx;
+            }
+            DioWriteBits(pbyImage, pSegment->dwImageBitOffs + dwBit, dwNumBits, dwBits);
+            dwBit += dwNumBits;
+        }
+    }
+}
+
+/********************************************************************************/
+/** \brief  Get the name of the compiled kernel.
+*
+* \return  kernel name.
+*/
+const EC_T_CHAR* DioKernelName(EC_T_VOID)
+{
+    return DEMO_SIMD_NAME;
+}
+
+/********************************************************************************/
+/** \brief  Compare DioUnpack()/DioPack() with EC_GETBITS/EC_SETBITS per channel.
+*
+* The channels are laid out like a rack of 4, 8 and 16 channel terminals with
+* an analog terminal after every 10th digital terminal.
+*
+* \return  EC_E_NOERROR if both give the same result, error code otherwise.
+*/
+EC_T_DWORD DioBenchmark
+    (CAtEmLogging* poLog
+    ,EC_T_DWORD    dwNumChannels)       /**< [in]   number of digital channels */
+{
+static const EC_T_DWORD s_adwTerminalBits[] = { 4, 8, 16 };
+EC_T_DWORD  dwRetVal      = EC_E_ERROR;
+T_DIO_MAP*  pMap          = EC_NULL;
+EC_T_BYTE*  pbyImage      = EC_NULL;
+EC_T_BYTE*  pbyImageRef   = EC_NULL;
+EC_T_BYTE*  pbyChannels   = EC_NULL;
+EC_T_BYTE*  pbyChannelsRef = EC_NULL;
+EC_T_DWORD  dwImageSize   = 0;
+EC_T_DWORD  dwBitOffs     = 3;
+EC_T_DWORD  dwTerminal    = 0;
+EC_T_DWORD  dwIdx         = 0;
+EC_T_DWORD  dwLoop        = 0;
+EC_T_DWORD  dwRandom      = 0x12345678;
+EC_T_UINT64 qwStart       = 0;
+EC_T_DWORD  adwNsec[4]    = { 0 };
+
+    /* image size: channels plus one 16 bit gap per 10 terminals of at least 4 channels */
+    dwImageSize = (dwBitOffs + dwNumChannels + ((dwNumChannels / 40) + 1) * 16 + 7) / 8 + 8;
+    pMap           = (T_DIO_MAP*)OsMalloc(sizeof(T_DIO_MAP));
+    pbyImage       = (EC_T_BYTE*)OsMalloc(dwImageSize);
+    pbyImageRef    = (EC_T_BYTE*)OsMalloc(dwImageSize);
+    pbyChannels    = (EC_T_BYTE*)OsMalloc(dwNumChannels + 32);
+    pbyChannelsRef = (EC_T_BYTE*)OsMalloc(dwNumChannels + 32);
+    if ((EC_NULL == pMap) || (EC_NULL == pbyImage) || (EC_NULL == pbyImageRef) || (EC_NULL == pbyChannels) || (EC_NULL == pbyChannelsRef))
+    {
+        dwRetVal = EC_E_NOMEMORY;
+        goto Exit;
+    }
+    /* build rack */
+    DioMapInit(pMap);
+    for (dwTerminal = 0; pMap->dwNumChannels < dwNumChannels; dwTerminal++)
+    {
+    EC_T_DWORD dwNumBits = EC_MIN(s_adwTerminalBits[dwTerminal % 3], dwNumChannels - pMap->dwNumChannels);
+
+        if ((0 != dwTerminal) && (0 == (dwTerminal % 10)))
+        {
+            dwBitOffs += 16;
+        }
+        dwRetVal = DioMapAdd(pMap, dwBitOffs, dwNumBits);
+        if (EC_E_NOERROR != dwRetVal)
+        {
+            goto Exit;
+        }
+        dwBitOffs += dwNumBits;
+    }
+    for (dwIdx = 0; dwIdx < dwImageSize; dwIdx++)
+    {
+        dwRandom = dwRandom * 1103515245 + 12345;
+        pbyImage[dwIdx] = (EC_T_BYTE)(dwRandom >> 16);
+    }
+
+    /* unpack: EC_GETBITS per channel, it only writes bit 0 of each channel byte */
+    OsMemset(pbyChannelsRef, 0, dwNumChannels + 32);
+    qwStart = DeadlineTimerGetTime();
+    for (dwLoop = 0; dwLoop < DIO_BENCH_LOOPS; dwLoop++)
+    {
+    EC_T_DWORD dwSegIdx = 0;
+
+        for (dwSegIdx = 0; dwSegIdx < pMap->dwNumSegments; dwSegIdx++)
+        {
+            for (dwIdx = 0; dwIdx < pMap->aSegment[dwSegIdx].dwNumBits; dwIdx++)
+            {
+                EC_GETBITS(pbyImage, &pbyChannelsRef[pMap->aSegment[dwSegIdx].dwChannel + dwIdx], pMap->aSegment[dwSegIdx].dwImageBitOffs + dwIdx, 1);
+            }
+        }
+    }
+    adwNsec[0] = (EC_T_DWORD)((DeadlineTimerGetTime() - qwStart) / DIO_BENCH_LOOPS);
+
+    /* unpack: kernel */
+    qwStart = DeadlineTimerGetTime();
+    for (dwLoop = 0; dwLoop < DIO_BENCH_LOOPS; dwLoop++)
+    {
+        DioUnpack(pMap, pbyImage, pbyChannels);
+    }
+    adwNsec[1] = (EC_T_DWORD)((DeadlineTimerGetTime() - qwStart) / DIO_BENCH_LOOPS);
+    if (0 != OsMemcmp(pbyChannels, pbyChannelsRef, pMap->dwNumChannels))
+    {
+        poLog->LogError("Digital I/O benchmark: unpack result differs from EC_GETBITS");
+        dwRetVal = EC_E_ERROR;
+        goto Exit;
+    }
+
+    /* pack: EC_SETBITS per channel */
+    for (dwIdx = 0; dwIdx < pMap->dwNumChannels; dwIdx++)
+    {
+        pbyChannels[dwIdx] = (EC_T_BYTE)(pbyChannels[dwIdx] ^ 1);
+    }
+    OsMemcpy(pbyImageRef, pbyImage, dwImageSize);
+    qwStart = DeadlineTimerGetTime();
+    for (dwLoop = 0; dwLoop < DIO_BENCH_LOOPS; dwLoop++)
+    {
+    EC_T_DWORD dwSegIdx = 0;
+
+        for (dwSegIdx = 0; dwSegIdx < pMap->dwNumSegments; dwSegIdx++)
+        {
+            for (dwIdx = 0; dwIdx < pMap->aSegment[dwSegIdx].dwNumBits; dwIdx++)
+            {
+                EC_SETBITS(pbyImageRef, &pbyChannels[pMap->aSegment[dwSegIdx].dwChannel + dwIdx], pMap->aSegment[dwSegIdx].dwImageBitOffs + dwIdx, 1);
+            }
+        }
+    }
+    adwNsec[2] = (EC_T_DWORD)((DeadlineTimerGetTime() - qwStart) / DIO_BENCH_LOOPS);
+
+    /* pack: kernel */
+    qwStart = DeadlineTimerGetTime();
+    for (dwLoop = 0; dwLoop < DIO_BENCH_LOOPS; dwLoop++)
+    {
+        DioPack(pMap, pbyChannels, pbyImage);
+    }
+    adwNsec[3] = (EC_T_DWORD)((DeadlineTimerGetTime() - qwStart) / DIO_BENCH_LOOPS);
+    if (0 != OsMemcmp(pbyImage, pbyImageRef, dwImageSize))
+    {
+        poLog->LogError("Digital I/O benchmark: pack result differs from EC_SETBITS");
+        dwRetVal = EC_E_ERROR;
+        goto Exit;
+    }
+
+    poLog->LogMsg("Digital I/O benchmark: %d channels in %d segments, kernel %s, %d loops",
+        pMap->dwNumChannels, pMap->dwNumSegments, DioKernelName(), DIO_BENCH_LOOPS);
+    poLog->LogMsg("  unpack: EC_GETBITS %6d nsec, DioUnpack %6d nsec", adwNsec[0], adwNsec[1]);
+    poLog->LogMsg("  pack:   EC_SETBITS %6d nsec, DioPack   %6d nsec", adwNsec[2], adwNsec[3]);
+
+    dwRetVal = EC_E_NOERROR;
+Exit:
+    SafeOsFree(pMap);
+    SafeOsFree(pbyImage);
+    SafeOsFree(pbyImageRef);
+    SafeOsFree(pbyChannels);
+    SafeOsFree(pbyChannelsRef);
+
+    return dwRetVal;
+}
+
+/*-END OF SOURCE FILE--------------------------------------------------------*/
@@ -0,0 +1,66 @@
+/*-----------------------------------------------------------------------------
+ * ecatDemoDio.h
+ * Copyright                acontis technologies GmbH, Weingarten, Germany
+ * Response                 Stefan Zintgraf
+ * Description              bulk pack/unpack of bit-packed digital channels
+ *---------------------------------------------------------------------------*/
+
+#ifndef __ECATDEMODIO_H__
+#define __ECATDEMODIO_H__  1
+
+/*-INCLUDES------------------------------------------------------------------*/
+#include "Logging.h"
+
+/*-DEFINES-------------------------------------------------------------------*/
+#define DIO_MAX_SEGMENTS        128         /* contiguous bit ranges per map */
+#define DIO_BENCH_DEFAULT_CHANNELS  320     /* -diobench: default number of channels */
+
+/*-TYPEDEFS------------------------------------------------------------------*/
+/* contiguous bit range of digital channels in the process image */
+typedef struct _T_DIO_SEGMENT
+{
+    EC_T_DWORD          dwImageBitOffs;     /* bit offset in the process image */
+    EC_T_DWORD          dwNumBits;          /* number of channels */
+    EC_T_DWORD          dwChannel;          /* index of the first channel in the dense array */
+} T_DIO_SEGMENT;
+
+/* digital channels of several slaves, adjacent slaves are merged to one segment */
+typedef struct _T_DIO_MAP
+{
+    T_DIO_SEGMENT       aSegment[DIO_MAX_SEGMENTS];
+    EC_T_DWORD          dwNumSegments;
+    EC_T_DWORD          dwNumChannels;      /* size of the dense array in bytes */
+} T_DIO_MAP;
+
+/*-FUNCTION DECLARATION------------------------------------------------------*/
+EC_T_VOID DioMapInit(
+    T_DIO_MAP*    pMap
+   );
+EC_T_DWORD DioMapAdd(
+    T_DIO_MAP*    pMap
+   ,EC_T_DWORD    dwImageBitOffs        /**< [in]   bit offset of the channels in the process image */
+   ,EC_T_DWORD    dwNumBits             /**< [in]   number of channels */
+   );
+EC_T_VOID DioUnpack(
+    T_DIO_MAP*    pMap
+   ,const
+    EC_T_BYTE*    pbyImage              /**< [in]   process image */
+   ,EC_T_BYTE*    pbyChannels           /**< [out]  one byte (0 or 1) per channel */
+   );
+EC_T_VOID DioPack(
+    T_DIO_MAP*    pMap
+   ,const
+    EC_T_BYTE*    pbyChannels           /**< [in]   one byte (0 = off) per channel */
+   ,EC_T_BYTE*    pbyImage              /**< [out]  process image */
+   );
+const EC_T_CHAR* DioKernelName(
+    EC_T_VOID
+   );
+EC_T_DWORD DioBenchmark(
+    CAtEmLogging* poLog
+   ,EC_T_DWORD    dwNumChannels         /**< [in]   number of digital channels */
+   );
+
+#endif /*__ECATDEMODIO_H__*/
+
+/*-END OF SOURCE FILE--------------------------------------------------------*/
@@ -0,0 +1,181 @@
+/*-----------------------------------------------------------------------------
+ * ecatDemoHistogram.cpp
+ * Copyright                acontis technologies GmbH, Weingarten, Germany
+ * Response                 Stefan Zintgraf
+ * Description              fixed memory latency histograms for the demos
+ *---------------------------------------------------------------------------*/
+
+/*-INCLUDES------------------------------------------------------------------*/
+#include "ecatDemoHistogram.h"
+
+/*-FUNCTION-DEFINITIONS------------------------------------------------------*/
+
+/********************************************************************************/
+/** \brief  Get bucket index of a value.
+*
+* \return  bucket index.
+*/
+static EC_T_DWORD LatencyHistoBucket(EC_T_DWORD dwValue)
+{
+EC_T_DWORD dwMsb = 0;
+
+    if (dwValue < HISTO_SUB_BUCKET_COUNT)
+    {
+        return dwValue;
+    }
+#if (defined __GNUC__)
+    dwMsb = 31 - (EC_T_DWORD)__builtin_clz(dwValue);
+#else
+    for (dwMsb = 31; 0 == (dwValue & (1UL << dwMsb)); dwMsb--)
+    {
+    }
+#endif
+    return ((dwMsb - HISTO_SUB_BUCKET_BITS + 1) << HISTO_SUB_BUCKET_BITS)
+         + ((dwValue >> (dwMsb - HISTO_SUB_BUCKET_BITS)) & (HISTO_SUB_BUCKET_COUNT - 1));
+}
+
+/********************************************************************************/
+/** \brief  Get largest value of a bucket.
+*
+* \return  upper bucket limit.
+*/
+static EC_T_DWORD LatencyHistoBucketLimit(EC_T_DWORD dwBucket)
+{
+EC_T_DWORD dwShift = 0;
+EC_T_DWORD dwSub   = 0;
+
+    if (dwBucket < HISTO_SUB_BUCKET_COUNT)
+    {
+        return dwBucket;
+    }
+    dwShift = (dwBucket >> HISTO_SUB_BUCKET_BITS) - 1;
+    dwSub   = dwBucket & (HISTO_SUB_BUCKET_COUNT - 1);
+
+    return (EC_T_DWORD)((((EC_T_UINT64)(HISTO_SUB_BUCKET_COUNT + dwSub + 1)) << dwShift) - 1);
+}
+
+/********************************************************************************/
+/** \brief  Initialize histogram.
+*
+* \return  N/A.
+*/
+EC_T_VOID LatencyHistoInit
+    (T_LATENCY_HISTO* pHisto
+    ,EC_T_DWORD       dwOutlierThreshold)   /**< [in]   values above are counted as outliers */
+{
+    OsMemset(pHisto, 0, sizeof(T_LATENCY_HISTO));
+    pHisto->dwOutlierThreshold = dwOutlierThreshold;
+}
+
+/********************************************************************************/
+/** \brief  Add a value. Called by a single writer, e.g. the job task.
+*
+* No memory is allocated and no lock is taken. Readers may call
+* LatencyHistoGetPercentile() or LatencyHistoShow() concurrently.
+*
+* \return  N/A.
+*/
+EC_T_VOID LatencyHistoRecord
+    (T_LATENCY_HISTO* pHisto
+    ,EC_T_DWORD       dwValue)              /**< [in]   value to add */
+{
+    if (pHisto->bResetRequest)
+    {
+        OsMemset(pHisto->adwBucket, 0, sizeof(pHisto->adwBucket));
+        pHisto->dwCount       = 0;
+        pHisto->dwMax         = 0;
+        pHisto->dwNumOutliers = 0;
+        pHisto->bResetRequest = EC_FALSE;
+    }
+    pHisto->adwBucket[LatencyHistoBucket(dwValue)]++;
+    pHisto->dwCount++;
+    if (dwValue > pHisto->dwMax)
+    {
+        pHisto->dwMax = dwValue;
+    }
+    if (dwValue > pHisto->dwOutlierThreshold)
+    {
+        pHisto->dwNumOutliers++;
+    }
+}
+
+/********************************************************************************/
+/** \brief  Request to clear the histogram. It is cleared with the next value.
+*
+* \return  N/A.
+*/
+EC_T_VOID LatencyHistoReset(T_LATENCY_HISTO* pHisto)
+{
+    pHisto->bResetRequest = EC_TRUE;
+}
+
+/********************************************************************************/
+/** \brief  Get percentile.
+*
+* \return  upper limit of the bucket containing the percentile, 0 if empty.
+*/
+EC_T_DWORD LatencyHistoGetPercentile
+    (T_LATENCY_HISTO* pHisto
+    ,EC_T_DWORD       dwPerTenThousand)     /**< [in]   percentile * 100, e.g. 9990 = p99.9 */
+{
+EC_T_DWORD  dwBucket = 0;
+EC_T_UINT64 qwSum    = 0;
+EC_T_UINT64 qwLimit  = 0;
+
+    if (0 == pHisto->dwCount)
+    {
+        return 0;
+    }
+    qwLimit = (((EC_T_UINT64)pHisto->dwCount * dwPerTenThousand) + 9999) / 10000;
+    for (dwBucket = 0; dwBucket < HISTO_NUM_BUCKETS; dwBucket++)
+    {
+        qwSum += pHisto->adwBucket[dwBucket];
+        if ((qwSum >= qwLimit) && (0 != qwSum))
+        {
+            return EC_MIN(LatencyHistoBucketLimit(dwBucket), pHisto->dwMax);
+        }
+    }
+    return pHisto->dwMax;
+}
+
+/********************************************************************************/
+/** \brief  Show percentiles of a histogram.
+*
+* The histogram is copied first, so the values are consistent to each other even
+* if the writer continues to record.
+*
+* \return  N/A.
+*/
+EC_T_VOID LatencyHistoShow
+    (T_LATENCY_HISTO* pHisto
+    ,CAtEmLogging*    poLog
+    ,const EC_T_CHAR* szName                /**< [in]   name printed in front of the statistics */
+    ,EC_T_DWORD       dwDivider)            /**< [in]   unit divider, e.g. 1000 to show nsec values in usec */
+{
+T_LATENCY_HISTO oSnapshot;
+EC_T_DWORD      dwCount = 0;
+EC_T_DWORD      dwIdx   = 0;
+
+    OsMemcpy(&oSnapshot, pHisto, sizeof(T_LATENCY_HISTO));
+
+    /* recount, the writer may have changed buckets while copying */
+    for (dwIdx = 0; dwIdx < HISTO_NUM_BUCKETS; dwIdx++)
+    {
+        dwCount += oSnapshot.adwBucket[dwIdx];
+    }
+    oSnapshot.dwCount = dwCount;
+    if (0 == dwDivider)
+    {
+        dwDivider = 1;
+    }
+    poLog->LogMsg("%s p50 %5d p90 %5d p99 %5d p99.9 %5d max %5d, %d of %d > %d",
+        szName,
+        LatencyHistoGetPercentile(&oSnapshot, 5000) / dwDivider,
+        LatencyHistoGetPercentile(&oSnapshot, 9000) / dwDivider,
+        LatencyHistoGetPercentile(&oSnapshot, 9900) / dwDivider,
+        LatencyHistoGetPercentile(&oSnapshot, 9990) / dwDivider,
+        oSnapshot.dwMax / dwDivider,
+        oSnapshot.dwNumOutliers, oSnapshot.dwCount, oSnapshot.dwOutlierThreshold / dwDivider);
+}
+
+/*-END OF SOURCE FILE--------------------------------------------------------*/
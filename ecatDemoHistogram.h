@@ -0,0 +1,58 @@
+/*-----------------------------------------------------------------------------
+ * ecatDemoHistogram.h
+ * Copyright                acontis technologies GmbH, Weingarten, Germany
+ * Response                 Stefan Zintgraf
+ * Description              fixed memory latency histograms for the demos
+ *---------------------------------------------------------------------------*/
+
+#ifndef __ECATDEMOHISTOGRAM_H__
+#define __ECATDEMOHISTOGRAM_H__  1
+
+/*-INCLUDES------------------------------------------------------------------*/
+#include "Logging.h"
+
+/*-DEFINES-------------------------------------------------------------------*/
+/* log-linear buckets: values below 2^HISTO_SUB_BUCKET_BITS are exact, above that
+   every power of two is split into 2^HISTO_SUB_BUCKET_BITS linear sub buckets (< 7% error) */
+#define HISTO_SUB_BUCKET_BITS       4
+#define HISTO_SUB_BUCKET_COUNT      (1 << HISTO_SUB_BUCKET_BITS)
+#define HISTO_NUM_BUCKETS           ((32 - HISTO_SUB_BUCKET_BITS + 1) * HISTO_SUB_BUCKET_COUNT)
+
+/*-TYPEDEFS------------------------------------------------------------------*/
+typedef struct _T_LATENCY_HISTO
+{
+    EC_T_DWORD          adwBucket[HISTO_NUM_BUCKETS];   /* number of values per bucket */
+    EC_T_DWORD          dwCount;                        /* number of values */
+    EC_T_DWORD          dwMax;                          /* largest value */
+    EC_T_DWORD          dwNumOutliers;                  /* values above dwOutlierThreshold */
+    EC_T_DWORD          dwOutlierThreshold;             /* outlier limit */
+    volatile EC_T_BOOL  bResetRequest;                  /* set by reader, histogram is cleared by the writer */
+} T_LATENCY_HISTO;
+
+/*-FUNCTION DECLARATION------------------------------------------------------*/
+EC_T_VOID LatencyHistoInit(
+    T_LATENCY_HISTO* pHisto
+   ,EC_T_DWORD    dwOutlierThreshold    /**< [in]   values above are counted as outliers */
+   );
+EC_T_VOID LatencyHistoRecord(
+    T_LATENCY_HISTO* pHisto
+   ,EC_T_DWORD    dwValue               /**< [in]   value to add */
+   );
+EC_T_VOID LatencyHistoReset(
+    T_LATENCY_HISTO* pHisto
+   );
+EC_T_DWORD LatencyHistoGetPercentile(
+    T_LATENCY_HISTO* pHisto
+   ,EC_T_DWORD    dwPerTenThousand      /**< [in]   percentile * 100, e.g. 9990 = p99.9 */
+   );
+EC_T_VOID LatencyHistoShow(
+    T_LATENCY_HISTO* pHisto
+   ,CAtEmLogging* poLog
+   ,const
+    EC_T_CHAR*    szName                /**< [in]   name printed in front of the statistics */
+   ,EC_T_DWORD    dwDivider             /**< [in]   unit divider, e.g. 1000 to show nsec values in usec */
+   );
+
+#endif /*__ECATDEMOHISTOGRAM_H__*/
+
+/*-END OF SOURCE FILE--------------------------------------------------------*/
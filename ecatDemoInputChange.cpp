@@ -0,0 +1,271 @@
+/*-----------------------------------------------------------------------------
+ * ecatDemoInputChange.cpp
+ * Copyright                acontis technologies GmbH, Weingarten, Germany
+ * Response                 Stefan Zintgraf
+ * Description              detection of changed slave inputs per cycle
+ *---------------------------------------------------------------------------*/
+
+/*-INCLUDES------------------------------------------------------------------*/
+#include "ecatDemoInputChange.h"
+#include "ecatDemoAtomic.h"
+#include "ecatDemoSimd.h"
+
+/*-LOCAL VARIABLES-----------------------------------------------------------*/
+#if (defined DEMO_SIMD_NEON)
+static const EC_T_BYTE S_abyBitMask16[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+#endif
+
+/*-FUNCTION-DEFINITIONS------------------------------------------------------*/
+
+/********************************************************************************/
+/** \brief  Compare one block with the previous image and take over the new values.
+*
+* \return  bit n set if byte n of the block changed.
+*/
+static EC_T_WORD InputChangeCompareBlock(const EC_T_BYTE* pbyImage, EC_T_BYTE* pbyPrev)
+{
+#if (defined DEMO_SIMD_SSE2)
+__m128i    oNew   = _mm_loadu_si128((const __m128i*)pbyImage);
+__m128i    oEqual = _mm_cmpeq_epi8(oNew, _mm_loadu_si128((const __m128i*)pbyPrev));
+
+    _mm_storeu_si128((__m128i*)pbyPrev, oNew);
+    return (EC_T_WORD)~_mm_movemask_epi8(oEqual);
+#elif (defined DEMO_SIMD_NEON)
+uint8x16_t oNew  = vld1q_u8(pbyImage);
+uint8x16_t oDiff = vandq_u8(vmvnq_u8(vceqq_u8(oNew, vld1q_u8(pbyPrev))), vld1q_u8(S_abyBitMask16));
+
+    vst1q_u8(pbyPrev, oNew);
+    return (EC_T_WORD)(((EC_T_DWORD)vaddv_u8(vget_low_u8(oDiff))) | (((EC_T_DWORD)vaddv_u8(vget_high_u8(oDiff))) << 8));
+#else
+EC_T_WORD  wMask = 0;
+EC_T_DWORD dwIdx = 0;
+
+    for (dwIdx = 0; dwIdx < INPUT_CHANGE_BLOCK_SIZE; dwIdx++)
+    {
+        if (pbyImage[dwIdx] != pbyPrev[dwIdx])
+        {
+            wMask = (EC_T_WORD)(wMask | (1 << dwIdx));
+            pbyPrev[dwIdx] = pbyImage[dwIdx];
+        }
+    }
+    return wMask;
+#endif
+}
+
+/********************************************************************************/
+/** \brief  Allocate the previous image and the bitmaps.
+*
+* \return  EC_E_NOERROR on success, error code otherwise.
+*/
+EC_T_DWORD InputChangeInit
+    (T_INPUT_CHANGE* pDesc
+    ,EC_T_DWORD      dwImageSize            /**< [in]   size of the input process image in bytes */
+    ,EC_T_DWORD      dwMaxSlaves)           /**< [in]   maximum number of slaves */
+{
+EC_T_DWORD dwRetVal = EC_E_ERROR;
+
+    OsMemset(pDesc, 0, sizeof(T_INPUT_CHANGE));
+    pDesc->dwImageSize = dwImageSize;
+    pDesc->dwNumBlocks = (dwImageSize + INPUT_CHANGE_BLOCK_SIZE - 1) / INPUT_CHANGE_BLOCK_SIZE;
+    pDesc->dwMaxSlaves = dwMaxSlaves;
+    pDesc->bFirstCycle = EC_TRUE;
+
+    /* previous image is padded to full blocks, the padding is never compared */
+    pDesc->pbyPrevImage    = (EC_T_BYTE*)OsMalloc(pDesc->dwNumBlocks * INPUT_CHANGE_BLOCK_SIZE + 1);
+    pDesc->pwBlockMask     = (EC_T_WORD*)OsMalloc(pDesc->dwNumBlocks * sizeof(EC_T_WORD) + 1);
+    pDesc->pdwBlockChanged = (EC_T_DWORD*)OsMalloc(((pDesc->dwNumBlocks + 31) / 32) * sizeof(EC_T_DWORD) + 1);
+    pDesc->pSlave          = (T_INPUT_CHANGE_SLAVE*)OsMalloc(dwMaxSlaves * sizeof(T_INPUT_CHANGE_SLAVE) + 1);
+    pDesc->pdwSlaveChanged = (EC_T_DWORD*)OsMalloc(((dwMaxSlaves + 31) / 32) * sizeof(EC_T_DWORD) + 1);
+    if ((EC_NULL == pDesc->pbyPrevImage) || (EC_NULL == pDesc->pwBlockMask) || (EC_NULL == pDesc->pdwBlockChanged)
+     || (EC_NULL == pDesc->pSlave) || (EC_NULL == pDesc->pdwSlaveChanged))
+    {
+        InputChangeDeinit(pDesc);
+        dwRetVal = EC_E_NOMEMORY;
+        goto Exit;
+    }
+    OsMemset(pDesc->pbyPrevImage, 0, pDesc->dwNumBlocks * INPUT_CHANGE_BLOCK_SIZE);
+    OsMemset(pDesc->pwBlockMask, 0, pDesc->dwNumBlocks * sizeof(EC_T_WORD));
+    OsMemset(pDesc->pdwBlockChanged, 0, ((pDesc->dwNumBlocks + 31) / 32) * sizeof(EC_T_DWORD));
+    OsMemset(pDesc->pdwSlaveChanged, 0, ((dwMaxSlaves + 31) / 32) * sizeof(EC_T_DWORD));
+
+    dwRetVal = EC_E_NOERROR;
+Exit:
+    return dwRetVal;
+}
+
+/********************************************************************************/
+/** \brief  Free the previous image and the bitmaps. The job task must not run InputChangeDetect() anymore.
+*
+* \return  N/A.
+*/
+EC_T_VOID InputChangeDeinit(T_INPUT_CHANGE* pDesc)
+{
+    pDesc->bEnabled = EC_FALSE;
+    DEMO_MEMORY_BARRIER();
+    SafeOsFree(pDesc->pbyPrevImage);
+    SafeOsFree(pDesc->pwBlockMask);
+    SafeOsFree(pDesc->pdwBlockChanged);
+    SafeOsFree(pDesc->pSlave);
+    SafeOsFree(pDesc->pdwSlaveChanged);
+    pDesc->dwNumSlaves = 0;
+}
+
+/********************************************************************************/
+/** \brief  Add the input range of a slave.
+*
+* \return  EC_E_NOERROR on success, error code otherwise.
+*/
+EC_T_DWORD InputChangeAddSlave
+    (T_INPUT_CHANGE* pDesc
+    ,EC_T_DWORD      dwPdOffsIn             /**< [in]   bit offset, EC_T_CFG_SLAVE_INFO::dwPdOffsIn */
+    ,EC_T_DWORD      dwPdSizeIn             /**< [in]   size in bits, EC_T_CFG_SLAVE_INFO::dwPdSizeIn */
+    ,EC_T_DWORD*     pdwSlaveIdx)           /**< [out]  index in the changed slave bitmap */
+{
+T_INPUT_CHANGE_SLAVE* pSlave = EC_NULL;
+
+    if ((0 == dwPdSizeIn) || (((EC_T_DWORD)-1) == dwPdOffsIn) || (((dwPdOffsIn + dwPdSizeIn + 7) / 8) > pDesc->dwImageSize))
+    {
+        return EC_E_INVALIDPARM;
+    }
+    if (pDesc->dwNumSlaves >= pDesc->dwMaxSlaves)
+    {
+        return EC_E_NOMEMORY;
+    }
+    pSlave = &pDesc->pSlave[pDesc->dwNumSlaves];
+    pSlave->dwFirstByte = dwPdOffsIn / 8;
+    pSlave->dwLastByte  = (dwPdOffsIn + dwPdSizeIn - 1) / 8;
+    *pdwSlaveIdx = pDesc->dwNumSlaves;
+    pDesc->dwNumSlaves++;
+
+    return EC_E_NOERROR;
+}
+
+/********************************************************************************/
+/** \brief  Start change detection after all slaves are added.
+*
+* \return  N/A.
+*/
+EC_T_VOID InputChangeEnable(T_INPUT_CHANGE* pDesc)
+{
+    DEMO_MEMORY_BARRIER();
+    pDesc->bEnabled = EC_TRUE;
+}
+
+/********************************************************************************/
+/** \brief  Compare the input image with the previous cycle. Called by the job
+*           task after eUsrJob_ProcessAllRxFrames. Nothing is allocated here.
+*
+* First all blocks of the image are compared, then only slaves overlapping a
+* changed block are checked byte-wise.
+*
+* \return  number of slaves with changed inputs.
+*/
+EC_T_DWORD InputChangeDetect
+    (T_INPUT_CHANGE*  pDesc
+    ,const EC_T_BYTE* pbyImage)             /**< [in]   input process image */
+{
+EC_T_DWORD dwNumFullBlocks = pDesc->dwImageSize / INPUT_CHANGE_BLOCK_SIZE;
+EC_T_DWORD dwBlock         = 0;
+EC_T_DWORD dwSlaveIdx      = 0;
+EC_T_BOOL  bAnyChange      = EC_FALSE;
+
+    if (!pDesc->bEnabled || (EC_NULL == pbyImage))
+    {
+        return 0;
+    }
+    /* compare whole image */
+    OsMemset(pDesc->pdwBlockChanged, 0, ((pDesc->dwNumBlocks + 31) / 32) * sizeof(EC_T_DWORD));
+    for (dwBlock = 0; dwBlock < dwNumFullBlocks; dwBlock++)
+    {
+    EC_T_WORD wMask = InputChangeCompareBlock(&pbyImage[dwBlock * INPUT_CHANGE_BLOCK_SIZE], &pDesc->pbyPrevImage[dwBlock * INPUT_CHANGE_BLOCK_SIZE]);
+
+        pDesc->pwBlockMask[dwBlock] = wMask;
+        if (0 != wMask)
+        {
+            pDesc->pdwBlockChanged[dwBlock / 32] |= (((EC_T_DWORD)1) << (dwBlock % 32));
+            bAnyChange = EC_TRUE;
+        }
+    }
+    if (dwNumFullBlocks < pDesc->dwNumBlocks)
+    {
+    EC_T_DWORD dwOffs = dwNumFullBlocks * INPUT_CHANGE_BLOCK_SIZE;
+    EC_T_WORD  wMask  = 0;
+    EC_T_DWORD dwIdx  = 0;
+
+        /* partial last block */
+        for (dwIdx = 0; (dwOffs + dwIdx) < pDesc->dwImageSize; dwIdx++)
+        {
+            if (pbyImage[dwOffs + dwIdx] != pDesc->pbyPrevImage[dwOffs + dwIdx])
+            {
+                wMask = (EC_T_WORD)(wMask | (1 << dwIdx));
+                pDesc->pbyPrevImage[dwOffs + dwIdx] = pbyImage[dwOffs + dwIdx];
+            }
+        }
+        pDesc->pwBlockMask[dwNumFullBlocks] = wMask;
+        if (0 != wMask)
+        {
+            pDesc->pdwBlockChanged[dwNumFullBlocks / 32] |= (((EC_T_DWORD)1) << (dwNumFullBlocks % 32));
+            bAnyChange = EC_TRUE;
+        }
+    }
+
+    /* map changed bytes to slaves */
+    OsMemset(pDesc->pdwSlaveChanged, 0, ((pDesc->dwNumSlaves + 31) / 32) * sizeof(EC_T_DWORD));
+    pDesc->dwNumChangedSlaves = 0;
+    if (!bAnyChange && !pDesc->bFirstCycle)
+    {
+        return 0;
+    }
+    for (dwSlaveIdx = 0; dwSlaveIdx < pDesc->dwNumSlaves; dwSlaveIdx++)
+    {
+    T_INPUT_CHANGE_SLAVE* pSlave  = &pDesc->pSlave[dwSlaveIdx];
+    EC_T_BOOL             bChanged = pDesc->bFirstCycle;
+
+        for (dwBlock = pSlave->dwFirstByte / INPUT_CHANGE_BLOCK_SIZE; !bChanged && (dwBlock <= pSlave->dwLastByte / INPUT_CHANGE_BLOCK_SIZE); dwBlock++)
+        {
+        EC_T_DWORD dwFirst = 0;
+        EC_T_DWORD dwLast  = INPUT_CHANGE_BLOCK_SIZE - 1;
+
+            if (0 == (pDesc->pdwBlockChanged[dwBlock / 32] & (((EC_T_DWORD)1) << (dwBlock % 32))))
+            {
+                continue;
+            }
+            /* bytes of the slave inside this block */
+            if (dwBlock == pSlave->dwFirstByte / INPUT_CHANGE_BLOCK_SIZE)
+            {
+                dwFirst = pSlave->dwFirstByte % INPUT_CHANGE_BLOCK_SIZE;
+            }
+            if (dwBlock == pSlave->dwLastByte / INPUT_CHANGE_BLOCK_SIZE)
+            {
+                dwLast = pSlave->dwLastByte % INPUT_CHANGE_BLOCK_SIZE;
+            }
+            bChanged = (0 != (pDesc->pwBlockMask[dwBlock] & (((2 << dwLast) - 1) & ~((1 << dwFirst) - 1))));
+        }
+        if (bChanged)
+        {
+            pDesc->pdwSlaveChanged[dwSlaveIdx / 32] |= (((EC_T_DWORD)1) << (dwSlaveIdx % 32));
+            pDesc->dwNumChangedSlaves++;
+        }
+    }
+    pDesc->bFirstCycle = EC_FALSE;
+
+    return pDesc->dwNumChangedSlaves;
+}
+
+/********************************************************************************/
+/** \brief  Check if the inputs of a slave changed in the last cycle.
+*
+* \return  EC_TRUE if changed.
+*/
+EC_T_BOOL InputChangeIsSlaveChanged
+    (T_INPUT_CHANGE* pDesc
+    ,EC_T_DWORD      dwSlaveIdx)            /**< [in]   index returned by InputChangeAddSlave() */
+{
+    if (!pDesc->bEnabled || (dwSlaveIdx >= pDesc->dwNumSlaves))
+    {
+        return EC_FALSE;
+    }
+    return (0 != (pDesc->pdwSlaveChanged[dwSlaveIdx / 32] & (((EC_T_DWORD)1) << (dwSlaveIdx % 32))));
+}
+
+/*-END OF SOURCE FILE--------------------------------------------------------*/
@@ -0,0 +1,71 @@
+/*-----------------------------------------------------------------------------
+ * ecatDemoInputChange.h
+ * Copyright                acontis technologies GmbH, Weingarten, Germany
+ * Response                 Stefan Zintgraf
+ * Description              detection of changed slave inputs per cycle
+ *---------------------------------------------------------------------------*/
+
+#ifndef __ECATDEMOINPUTCHANGE_H__
+#define __ECATDEMOINPUTCHANGE_H__  1
+
+/*-INCLUDES------------------------------------------------------------------*/
+#include "Logging.h"
+
+/*-DEFINES-------------------------------------------------------------------*/
+#define INPUT_CHANGE_BLOCK_SIZE     16      /* bytes compared per step, one bit per byte in the block mask */
+
+/*-TYPEDEFS------------------------------------------------------------------*/
+/* input range of a slave in the process image */
+typedef struct _T_INPUT_CHANGE_SLAVE
+{
+    EC_T_DWORD          dwFirstByte;        /* first byte of the slave inputs */
+    EC_T_DWORD          dwLastByte;         /* last byte of the slave inputs */
+} T_INPUT_CHANGE_SLAVE;
+
+typedef struct _T_INPUT_CHANGE
+{
+    volatile EC_T_BOOL  bEnabled;           /* set after all slaves are added */
+    EC_T_BOOL           bFirstCycle;        /* report all slaves as changed in the first cycle */
+    EC_T_DWORD          dwImageSize;        /* compared size of the input process image in bytes */
+    EC_T_DWORD          dwNumBlocks;
+    EC_T_BYTE*          pbyPrevImage;       /* input image of the previous cycle */
+    EC_T_WORD*          pwBlockMask;        /* per block: bit n set if byte n changed */
+    EC_T_DWORD*         pdwBlockChanged;    /* bitmap of changed blocks */
+    T_INPUT_CHANGE_SLAVE* pSlave;
+    EC_T_DWORD          dwMaxSlaves;
+    EC_T_DWORD          dwNumSlaves;
+    EC_T_DWORD*         pdwSlaveChanged;    /* bitmap of slaves with changed inputs in the last cycle */
+    EC_T_DWORD          dwNumChangedSlaves; /* number of bits set in pdwSlaveChanged */
+} T_INPUT_CHANGE;
+
+/*-FUNCTION DECLARATION------------------------------------------------------*/
+EC_T_DWORD InputChangeInit(
+    T_INPUT_CHANGE* pDesc
+   ,EC_T_DWORD    dwImageSize           /**< [in]   size of the input process image in bytes */
+   ,EC_T_DWORD    dwMaxSlaves           /**< [in]   maximum number of slaves */
+   );
+EC_T_VOID InputChangeDeinit(
+    T_INPUT_CHANGE* pDesc
+   );
+EC_T_DWORD InputChangeAddSlave(
+    T_INPUT_CHANGE* pDesc
+   ,EC_T_DWORD    dwPdOffsIn            /**< [in]   bit offset, EC_T_CFG_SLAVE_INFO::dwPdOffsIn */
+   ,EC_T_DWORD    dwPdSizeIn            /**< [in]   size in bits, EC_T_CFG_SLAVE_INFO::dwPdSizeIn */
+   ,EC_T_DWORD*   pdwSlaveIdx           /**< [out]  index in the changed slave bitmap */
+   );
+EC_T_VOID InputChangeEnable(
+    T_INPUT_CHANGE* pDesc
+   );
+EC_T_DWORD InputChangeDetect(
+    T_INPUT_CHANGE* pDesc
+   ,const
+    EC_T_BYTE*    pbyImage              /**< [in]   input process image */
+   );
+EC_T_BOOL InputChangeIsSlaveChanged(
+    T_INPUT_CHANGE* pDesc
+   ,EC_T_DWORD    dwSlaveIdx            /**< [in]   index returned by InputChangeAddSlave() */
+   );
+
+#endif /*__ECATDEMOINPUTCHANGE_H__*/
+
+/*-END OF SOURCE FILE--------------------------------------------------------*/
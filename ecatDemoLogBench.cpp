@@ -0,0 +1,235 @@
+/*-----------------------------------------------------------------------------
+ * ecatDemoLogBench.cpp
+ * Copyright                acontis technologies GmbH, Weingarten, Germany
+ * Response                 Stefan Zintgraf
+ * Description              contention and throughput benchmark of the message logging
+ *---------------------------------------------------------------------------*/
+
+/*-INCLUDES------------------------------------------------------------------*/
+#include "ecatDemoLogBench.h"
+#include "ecatDemoTiming.h"
+#include "EcError.h"
+
+/*-DEFINES-------------------------------------------------------------------*/
+#define LOG_BENCH_BUFFER_SIZE       1024        /* messages buffered in the benchmark log buffer */
+#define LOG_BENCH_BURST             16          /* messages per thread between two OsSleep(1) */
+#define LOG_BENCH_STACKSIZE         0x4000
+
+/*-TYPEDEFS------------------------------------------------------------------*/
+typedef struct _T_LOG_BENCH_THREAD
+{
+    CAtEmLogging*       poLog;
+    MSG_BUFFER_DESC*    pMsgBuf;
+    EC_T_DWORD          dwThreadIdx;
+    EC_T_DWORD          dwNumMsgs;
+    volatile EC_T_BOOL* pbStart;            /* set by LogBenchmark() when all threads are running */
+    volatile EC_T_BOOL  bRunning;
+    volatile EC_T_BOOL  bDone;
+    EC_T_DWORD          dwNumInserted;
+    EC_T_DWORD          dwNumFull;          /* EC_E_NOMEMORY, message dropped */
+    EC_T_UINT64         qwSumNsec;
+    EC_T_DWORD          dwMaxNsec;
+    EC_T_VOID*          pvThread;
+} T_LOG_BENCH_THREAD;
+
+/*-FUNCTION-DEFINITIONS------------------------------------------------------*/
+
+/********************************************************************************/
+/** \brief  Insert one message like LogMsg() into the benchmark buffer.
+*
+* \return  result of CAtEmLogging::InsertNewMsg().
+*/
+static EC_T_DWORD LogBenchInsert(CAtEmLogging* poLog, MSG_BUFFER_DESC* pMsgBuf, const EC_T_CHAR* szFormat, ...)
+{
+EC_T_VALIST vaArgs;
+EC_T_DWORD  dwRes = EC_E_NOERROR;
+
+    EC_VASTART(vaArgs, szFormat);
+    dwRes = poLog->InsertNewMsg(pMsgBuf, szFormat, vaArgs);
+    EC_VAEND(vaArgs);
+    return dwRes;
+}
+
+/********************************************************************************/
+/** \brief  Producer thread: log bursts of messages and measure every call.
+*
+* \return  N/A.
+*/
+static EC_T_VOID tEcLogBench(EC_T_VOID* pvParms)
+{
+T_LOG_BENCH_THREAD* pThread = (T_LOG_BENCH_THREAD*)pvParms;
+EC_T_DWORD          dwMsg   = 0;
+
+    pThread->bRunning = EC_TRUE;
+    while (!*pThread->pbStart)
+    {
+        OsSleep(1);
+    }
+    for (dwMsg = 0; dwMsg < pThread->dwNumMsgs; dwMsg++)
+    {
+    EC_T_UINT64 qwStart = DeadlineTimerGetTime();
+    EC_T_DWORD  dwRes   = LogBenchInsert(pThread->poLog, pThread->pMsgBuf, "thread %d message %d", pThread->dwThreadIdx, dwMsg);
+    EC_T_DWORD  dwNsec  = (EC_T_DWORD)(DeadlineTimerGetTime() - qwStart);
+
+        pThread->qwSumNsec += dwNsec;
+        if (dwNsec > pThread->dwMaxNsec)
+        {
+            pThread->dwMaxNsec = dwNsec;
+        }
+        if (EC_E_NOERROR == dwRes)
+        {
+            pThread->dwNumInserted++;
+        }
+        else
+        {
+            pThread->dwNumFull++;
+        }
+        if (0 == ((dwMsg + 1) % LOG_BENCH_BURST))
+        {
+            OsSleep(1);
+        }
+    }
+    pThread->bDone = EC_TRUE;
+}
+
+/********************************************************************************/
+/** \brief  Let LOG_BENCH_NUM_THREADS threads log concurrently into one buffer.
+*
+* Reports the average and worst cost of a call and the number of messages
+* dropped because the log task did not keep up. Then measures how many
+* messages per second the log task writes into the log file.
+*
+* \return  EC_E_NOERROR on success, error code otherwise.
+*/
+EC_T_DWORD LogBenchmark
+    (CAtEmLogging* poLog
+    ,EC_T_DWORD    dwNumMsgs            /**< [in]   number of messages per producer thread */
+    ,EC_T_DWORD    dwPrio)              /**< [in]   producer thread priority */
+{
+EC_T_DWORD          dwRetVal    = EC_E_ERROR;
+T_LOG_BENCH_THREAD* aThread     = EC_NULL;
+MSG_BUFFER_DESC*    pMsgBuf     = EC_NULL;
+volatile EC_T_BOOL  bStart      = EC_FALSE;
+EC_T_DWORD          dwIdx       = 0;
+EC_T_UINT64         qwStart     = 0;
+EC_T_UINT64         qwSumNsec   = 0;
+EC_T_DWORD          dwMaxNsec   = 0;
+EC_T_DWORD          dwNumInserted = 0;
+EC_T_DWORD          dwNumFull   = 0;
+EC_T_DWORD          dwMsec      = 0;
+EC_T_DWORD          dwNumTotal  = LOG_BENCH_NUM_THREADS * dwNumMsgs;
+EC_T_UINT64         qwNsec      = 0;
+CEcTimer            oTimeout;
+
+    aThread = (T_LOG_BENCH_THREAD*)OsMalloc(LOG_BENCH_NUM_THREADS * sizeof(T_LOG_BENCH_THREAD));
+    if (EC_NULL == aThread)
+    {
+        dwRetVal = EC_E_NOMEMORY;
+        goto Exit;
+    }
+    OsMemset(aThread, 0, LOG_BENCH_NUM_THREADS * sizeof(T_LOG_BENCH_THREAD));
+    pMsgBuf = poLog->AddLogBuffer(0, 0, LOG_BENCH_BUFFER_SIZE, EC_FALSE, (EC_T_CHAR*)"Bench", (EC_T_CHAR*)"logbench", (EC_T_CHAR*)"log", EC_FALSE, EC_TRUE);
+    if (EC_NULL == pMsgBuf)
+    {
+        dwRetVal = EC_E_NOMEMORY;
+        goto Exit;
+    }
+
+    /* start producers, all wait for bStart */
+    for (dwIdx = 0; dwIdx < LOG_BENCH_NUM_THREADS; dwIdx++)
+    {
+    T_LOG_BENCH_THREAD* pThread = &aThread[dwIdx];
+
+        pThread->poLog       = poLog;
+        pThread->pMsgBuf     = pMsgBuf;
+        pThread->dwThreadIdx = dwIdx;
+        pThread->dwNumMsgs   = dwNumMsgs;
+        pThread->pbStart     = &bStart;
+        pThread->pvThread    = OsCreateThread((EC_T_CHAR*)"tEcLogBench", tEcLogBench, dwPrio, LOG_BENCH_STACKSIZE, pThread);
+    }
+    oTimeout.Start(2000);
+    for (dwIdx = 0; dwIdx < LOG_BENCH_NUM_THREADS; dwIdx++)
+    {
+        while (!aThread[dwIdx].bRunning && !oTimeout.IsElapsed())
+        {
+            OsSleep(10);
+        }
+        if (!aThread[dwIdx].bRunning)
+        {
+            poLog->LogError("Log benchmark: producer thread %d not started", dwIdx);
+            dwRetVal = EC_E_TIMEOUT;
+            goto Exit;
+        }
+    }
+    qwStart = DeadlineTimerGetTime();
+    bStart = EC_TRUE;
+    for (dwIdx = 0; dwIdx < LOG_BENCH_NUM_THREADS; dwIdx++)
+    {
+        while (!aThread[dwIdx].bDone)
+        {
+            OsSleep(10);
+        }
+    }
+    dwMsec = (EC_T_DWORD)((DeadlineTimerGetTime() - qwStart) / 1000000);
+
+    poLog->LogMsg("Log benchmark: %d threads, %d messages each, bursts of %d, buffer of %d messages, %d msec",
+        LOG_BENCH_NUM_THREADS, dwNumMsgs, LOG_BENCH_BURST, pMsgBuf->dwNumMsgs, dwMsec);
+    for (dwIdx = 0; dwIdx < LOG_BENCH_NUM_THREADS; dwIdx++)
+    {
+    T_LOG_BENCH_THREAD* pThread = &aThread[dwIdx];
+
+        poLog->LogMsg("  thread %d: avg %5d nsec, max %7d nsec, %6d logged, %6d dropped", dwIdx,
+            (EC_T_DWORD)(pThread->qwSumNsec / EC_MAX(dwNumMsgs, 1)), pThread->dwMaxNsec, pThread->dwNumInserted, pThread->dwNumFull);
+        qwSumNsec     += pThread->qwSumNsec;
+        dwMaxNsec      = EC_MAX(dwMaxNsec, pThread->dwMaxNsec);
+        dwNumInserted += pThread->dwNumInserted;
+        dwNumFull     += pThread->dwNumFull;
+    }
+    poLog->LogMsg("  total:    avg %5d nsec, max %7d nsec, %6d logged, %6d dropped",
+        (EC_T_DWORD)(qwSumNsec / EC_MAX(dwNumTotal, 1)), dwMaxNsec, dwNumInserted, dwNumFull);
+
+    /* throughput: no message dropped, until all of them are in the log file */
+    qwStart = DeadlineTimerGetTime();
+    for (dwIdx = 0; dwIdx < dwNumTotal; dwIdx++)
+    {
+        while (EC_E_NOMEMORY == LogBenchInsert(poLog, pMsgBuf, "throughput message %d", dwIdx))
+        {
+            OsSleep(1);
+        }
+    }
+    while (pMsgBuf->dwNextPrintMsgIndex != pMsgBuf->dwNextEmptyMsgIndex)
+    {
+        OsSleep(1);
+    }
+    /* the log task collects the text and writes it later */
+    poLog->FlushLogBuffer(pMsgBuf);
+    qwNsec = EC_MAX(DeadlineTimerGetTime() - qwStart, 1);
+    poLog->LogMsg("  throughput: %d messages in %d msec, %d messages/sec",
+        dwNumTotal, (EC_T_DWORD)(qwNsec / 1000000), (EC_T_DWORD)(((EC_T_UINT64)dwNumTotal * 1000000000) / qwNsec));
+
+    dwRetVal = EC_E_NOERROR;
+Exit:
+    if (EC_NULL != aThread)
+    {
+        /* every created producer uses its descriptor and the buffer until it is done, even if it started late */
+        bStart = EC_TRUE;
+        for (dwIdx = 0; dwIdx < LOG_BENCH_NUM_THREADS; dwIdx++)
+        {
+            if (EC_NULL == aThread[dwIdx].pvThread)
+            {
+                continue;
+            }
+            while (!aThread[dwIdx].bDone)
+            {
+                OsSleep(10);
+            }
+            OsDeleteThreadHandle(aThread[dwIdx].pvThread);
+        }
+    }
+    poLog->RemoveLogBuffer(pMsgBuf);
+    SafeOsFree(aThread);
+
+    return dwRetVal;
+}
+
+/*-END OF SOURCE FILE--------------------------------------------------------*/
@@ -0,0 +1,27 @@
+/*-----------------------------------------------------------------------------
+ * ecatDemoLogBench.h
+ * Copyright                acontis technologies GmbH, Weingarten, Germany
+ * Response                 Stefan Zintgraf
+ * Description              contention and throughput benchmark of the message logging
+ *---------------------------------------------------------------------------*/
+
+#ifndef __ECATDEMOLOGBENCH_H__
+#define __ECATDEMOLOGBENCH_H__  1
+
+/*-INCLUDES------------------------------------------------------------------*/
+#include "Logging.h"
+
+/*-DEFINES-------------------------------------------------------------------*/
+#define LOG_BENCH_NUM_THREADS       4           /* producer threads logging concurrently */
+#define LOG_BENCH_DEFAULT_MSGS      20000       /* -logbench: default number of messages per thread */
+
+/*-FUNCTION DECLARATION------------------------------------------------------*/
+EC_T_DWORD LogBenchmark(
+    CAtEmLogging* poLog
+   ,EC_T_DWORD    dwNumMsgs             /**< [in]   number of messages per producer thread */
+   ,EC_T_DWORD    dwPrio                /**< [in]   producer thread priority */
+   );
+
+#endif /*__ECATDEMOLOGBENCH_H__*/
+
+/*-END OF SOURCE FILE--------------------------------------------------------*/
@@ -0,0 +1,75 @@
+/*-----------------------------------------------------------------------------
+ * ecatDemoLogBin.h
+ * Copyright                acontis technologies GmbH, Weingarten, Germany
+ * Response                 Stefan Zintgraf
+ * Description              layout of the binary log files
+ *
+ * Written by CAtEmLogging after SetBinaryFormat(), rendered as text or CSV
+ * by ecatDemoLogDecode.c. Plain C without dependency on the EC-Master headers.
+ *---------------------------------------------------------------------------*/
+
+#ifndef __ECATDEMOLOGBIN_H__
+#define __ECATDEMOLOGBIN_H__  1
+
+/*-INCLUDES------------------------------------------------------------------*/
+#include <stdint.h>
+
+/*-DEFINES-------------------------------------------------------------------*/
+#define LOG_BIN_MAGIC               0x4C424345  /* "ECBL", written in the byte order of the writer */
+#define LOG_BIN_VERSION             2
+#define LOG_BIN_FILE_EXT            "bin"       /* replaces "log" and "csv", e.g. ecmaster0.bin */
+#define LOG_BIN_MAX_VARINT_LEN      10          /* bytes of a 64 bit varint */
+
+/* The file header is followed by records. A record starts with one byte of
+ * LOG_BIN_REC_... in the lower bits and LOG_BIN_FLAG_... in the upper bits.
+ * Numbers are LEB128 varints, signed numbers are zigzag encoded first.
+ *
+ * LOG_BIN_REC_FORMAT   id, length, characters of the format
+ * LOG_BIN_REC_MSG      time, msec, [thread], id of the format, arguments
+ * LOG_BIN_REC_TEXT     time, msec, [thread], length, characters of a formatted message
+ * LOG_BIN_REC_SKIP     time, msec, [thread], number of identical messages skipped
+ *
+ * time:      signed nsec since the previous record, the first record of a file
+ *            relative to qwStartNsec
+ * msec:      signed difference of the "%06d" stamp of the text log to the
+ *            previous record, the first record of a file relative to dwStartMsec
+ * thread:    only if LOG_BIN_FLAG_THREAD is set, else the previous thread
+ * arguments: one per '*' and conversion of the format in the order of the
+ *            format. Integers and pointers are signed, doubles are 8 bytes in
+ *            the byte order of dwMagic, strings are length and characters.
+ *
+ * A format id is defined by a LOG_BIN_REC_FORMAT record before its first use
+ * in a file, it may be defined again with a different format later on.
+ */
+#define LOG_BIN_REC_FORMAT          0x01
+#define LOG_BIN_REC_MSG             0x02
+#define LOG_BIN_REC_TEXT            0x03
+#define LOG_BIN_REC_SKIP            0x04
+#define LOG_BIN_REC_MASK            0x0F
+
+#define LOG_BIN_FLAG_TIMESTAMP      0x10        /* text log prints "%06d : " in front of the message */
+#define LOG_BIN_FLAG_CRLF           0x20        /* text log appends a new line */
+#define LOG_BIN_FLAG_THREAD         0x40        /* thread id follows the time */
+
+/*-TYPEDEFS------------------------------------------------------------------*/
+/* start of each file, also after a roll over */
+typedef struct _T_LOG_BIN_FILE_HEADER
+{
+    uint32_t            dwMagic;            /* LOG_BIN_MAGIC */
+    uint32_t            dwVersion;          /* LOG_BIN_VERSION */
+    uint32_t            dwHeaderSize;       /* offset of the first record */
+    uint32_t            dwFileIndex;        /* roll over index, 0 for the first file */
+    uint64_t            qwStartNsec;        /* time base of the records, CLOCK_MONOTONIC in nsec */
+    uint32_t            dwStartMsec;        /* OsQueryMsecCount() at qwStartNsec, base of the msec stamps */
+    uint8_t             byIntSize;          /* sizeof(int) of the writer */
+    uint8_t             byLongSize;         /* sizeof(long) */
+    uint8_t             bySizeSize;         /* sizeof(size_t) */
+    uint8_t             byPtrSize;          /* sizeof(void*) */
+    char                szLogName[16];      /* name of the message buffer, e.g. "Log" */
+    char                szTextExt[8];       /* extension of the text log, e.g. "csv" */
+    uint8_t             abyReserved[8];
+} T_LOG_BIN_FILE_HEADER;
+
+#endif /*__ECATDEMOLOGBIN_H__*/
+
+/*-END OF SOURCE FILE--------------------------------------------------------*/
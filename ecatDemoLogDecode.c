@@ -0,0 +1,573 @@
+/*-----------------------------------------------------------------------------
+ * ecatDemoLogDecode.c
+ * Copyright                acontis technologies GmbH, Weingarten, Germany
+ * Response                 Stefan Zintgraf
+ * Description              renders binary log files as text or CSV
+ *
+ * Standalone tool without dependency on the EC-Master headers, e.g.
+ *   cc -o ecatDemoLogDecode ecatDemoLogDecode.c
+ *   ecatDemoLogDecode ecmaster0.0.bin ecmaster0.1.bin > ecmaster0.log
+ *   ecatDemoLogDecode -csv error0.bin > error0.csv
+ *---------------------------------------------------------------------------*/
+
+/*-INCLUDES------------------------------------------------------------------*/
+#include "ecatDemoLogBin.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*-DEFINES-------------------------------------------------------------------*/
+#define LOG_DECODE_MAX_MSG_LEN      4096        /* formatted message, format and string argument */
+#define LOG_DECODE_MAX_SPEC_LEN     32          /* conversion, see LOG_DEFER_MAX_SPEC_LEN in Logging.cpp */
+#define LOG_DECODE_MAX_FORMATS      0x10000     /* format ids accepted */
+
+/*-MACROS--------------------------------------------------------------------*/
+#define LOG_DECODE_UNZIGZAG(qwVal)  ((int64_t)((qwVal) >> 1) ^ -(int64_t)((qwVal) & 1))
+
+/*-TYPEDEFS------------------------------------------------------------------*/
+/* argument of a conversion, see T_LOG_ARG_TYPE in Logging.cpp */
+typedef enum _T_LOG_DECODE_ARG
+{
+    eLogDecodeArg_None = 0,             /* "%%" */
+    eLogDecodeArg_Int,                  /* d, i, o, u, x, X, c */
+    eLogDecodeArg_Double,               /* f, F, e, E, g, G, a, A */
+    eLogDecodeArg_Ptr,                  /* p */
+    eLogDecodeArg_String                /* s */
+} T_LOG_DECODE_ARG;
+
+typedef struct _T_LOG_DECODE
+{
+    FILE*                   pfIn;
+    const char*             szFileName;
+    T_LOG_BIN_FILE_HEADER   oHeader;
+    char*                   apszFormat[LOG_DECODE_MAX_FORMATS]; /* by format id, NULL if not defined */
+    uint64_t                qwNsec;         /* time of the previous record */
+    uint32_t                dwThreadId;     /* thread of the previous record */
+    uint32_t                dwMsec;         /* msec stamp of the previous record, as in the text log */
+    int                     bCsv;           /* 1: one CSV line per message */
+    char                    achMsg[LOG_DECODE_MAX_MSG_LEN];
+    char                    achArg[LOG_DECODE_MAX_MSG_LEN];
+} T_LOG_DECODE;
+
+/*-FUNCTION-DEFINITIONS------------------------------------------------------*/
+
+/********************************************************************************/
+/** \brief  Read a LEB128 varint.
+*
+* \return  0 on success, -1 at the end of the file.
+*/
+static int LogDecodeVarint(T_LOG_DECODE* pDec, uint64_t* pqwVal)
+{
+uint64_t qwVal  = 0;
+int      nShift = 0;
+int      nByte  = 0;
+
+    for (nShift = 0; nShift < 64; nShift += 7)
+    {
+        nByte = getc(pDec->pfIn);
+        if (EOF == nByte)
+        {
+            return -1;
+        }
+        qwVal |= (uint64_t)(nByte & 0x7F) << nShift;
+        if (0 == (nByte & 0x80))
+        {
+            *pqwVal = qwVal;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/********************************************************************************/
+/** \brief  Read a length and the characters into a zero terminated string.
+*
+* \return  0 on success, -1 at the end of the file or if the string is too long.
+*/
+static int LogDecodeString(T_LOG_DECODE* pDec, char* pchOut)
+{
+uint64_t qwLen = 0;
+
+    if ((0 != LogDecodeVarint(pDec, &qwLen)) || (qwLen >= LOG_DECODE_MAX_MSG_LEN))
+    {
+        return -1;
+    }
+    if ((0 != qwLen) && (1 != fread(pchOut, (size_t)qwLen, 1, pDec->pfIn)))
+    {
+        return -1;
+    }
+    pchOut[qwLen] = '\0';
+    return 0;
+}
+
+/********************************************************************************/
+/** \brief  Parse the conversion at pszSpec[0] == '%' like LogParseConversion() in Logging.cpp.
+*
+* \return  length of the conversion including '%', 0 if not supported.
+*/
+static size_t LogDecodeParseConversion
+    (const char*         pszSpec
+    ,T_LOG_DECODE_ARG*   peType             /**< [out]  type of the argument */
+    ,int*                pnNumStars         /**< [out]  number of width and precision arguments */
+    ,int*                pnBits             /**< [out]  size of an integer argument in bits */
+    ,size_t*             pnLengthOffs)      /**< [out]  offset of the length modifier */
+{
+const char* pch      = &pszSpec[1];
+char        chLength = '\0';
+
+    *peType     = eLogDecodeArg_None;
+    *pnNumStars = 0;
+    *pnBits     = 0;
+    if ('%' == *pch)
+    {
+        *pnLengthOffs = 1;
+        return 2;
+    }
+    while (('-' == *pch) || ('+' == *pch) || (' ' == *pch) || ('#' == *pch) || ('0' == *pch))
+    {
+        pch++;
+    }
+    if ('*' == *pch)
+    {
+        (*pnNumStars)++;
+        pch++;
+    }
+    while (('0' <= *pch) && (*pch <= '9'))
+    {
+        pch++;
+    }
+    if ('.' == *pch)
+    {
+        pch++;
+        if ('*' == *pch)
+        {
+            (*pnNumStars)++;
+            pch++;
+        }
+        while (('0' <= *pch) && (*pch <= '9'))
+        {
+            pch++;
+        }
+    }
+    *pnLengthOffs = (size_t)(pch - pszSpec);
+    if ('h' == *pch)
+    {
+        chLength = 'h';
+        pch++;
+        if ('h' == *pch)
+        {
+            chLength = 'H';
+            pch++;
+        }
+    }
+    else if ('l' == *pch)
+    {
+        chLength = 'l';
+        pch++;
+        if ('l' == *pch)
+        {
+            chLength = 'L';
+            pch++;
+        }
+    }
+    else if ('z' == *pch)
+    {
+        chLength = 'z';
+        pch++;
+    }
+    switch (*pch)
+    {
+    case 'd': case 'i': case 'o': case 'u': case 'x': case 'X': case 'c':
+        *peType = eLogDecodeArg_Int;
+        switch (chLength)
+        {
+        case 'H': *pnBits = 8;  break;
+        case 'h': *pnBits = 16; break;
+        case 'l': *pnBits = -1; break;  /* sizeof(long) of the writer */
+        case 'L': *pnBits = 64; break;
+        case 'z': *pnBits = -2; break;  /* sizeof(size_t) of the writer */
+        default:  *pnBits = 0;  break;  /* sizeof(int) of the writer */
+        }
+        break;
+    case 's':
+        *peType = eLogDecodeArg_String;
+        break;
+    case 'p':
+        *peType = eLogDecodeArg_Ptr;
+        break;
+    case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+        *peType = eLogDecodeArg_Double;
+        break;
+    default:
+        return 0;
+    }
+    if ((size_t)(pch + 1 - pszSpec) >= LOG_DECODE_MAX_SPEC_LEN)
+    {
+        return 0;
+    }
+    return (size_t)(pch + 1 - pszSpec);
+}
+
+/********************************************************************************/
+/** \brief  Read the arguments of a message record and format the message.
+*
+* Integers are printed with the size they had at the writer, the size of
+* long and size_t are taken from the file header.
+*
+* \return  0 on success, -1 if the record is truncated or the format not supported.
+*/
+static int LogDecodeFormat(T_LOG_DECODE* pDec, const char* szFormat)
+{
+const char* pch      = NULL;
+char*       pchOut   = pDec->achMsg;
+size_t      nOutSize = sizeof(pDec->achMsg);
+size_t      nLen     = 0;
+
+    for (pch = szFormat; '\0' != *pch; pch++)
+    {
+    T_LOG_DECODE_ARG eType      = eLogDecodeArg_None;
+    int              nNumStars  = 0;
+    int              nBits      = 0;
+    size_t           nLengthOffs = 0;
+    size_t           nSpecLen   = 0;
+    size_t           nIdx       = 0;
+    size_t           nSpecPos   = 0;
+    size_t           nPos       = 0;
+    int              nRes       = 0;
+    uint64_t         qwVal      = 0;
+    int64_t          nVal       = 0;
+    double           fVal       = 0;
+    char             szSpec[LOG_DECODE_MAX_SPEC_LEN + 48];
+
+        if ('%' != *pch)
+        {
+            if ((nLen + 1) < nOutSize)
+            {
+                pchOut[nLen] = *pch;
+            }
+            nLen++;
+            continue;
+        }
+        nSpecLen = LogDecodeParseConversion(pch, &eType, &nNumStars, &nBits, &nLengthOffs);
+        if (0 == nSpecLen)
+        {
+            return -1;
+        }
+        /* flags, width and precision, the length modifier is replaced */
+        for (nIdx = 0; nIdx < nLengthOffs; nIdx++)
+        {
+            if ('*' == pch[nIdx])
+            {
+                if (0 != LogDecodeVarint(pDec, &qwVal))
+                {
+                    return -1;
+                }
+                nVal = LOG_DECODE_UNZIGZAG(qwVal);
+                if (('.' == pch[nIdx - 1]) && ((int)nVal < 0))
+                {
+                    /* negative precision: as if omitted */
+                    nSpecPos--;
+                }
+                else
+                {
+                    nSpecPos += (size_t)snprintf(&szSpec[nSpecPos], sizeof(szSpec) - nSpecPos, "%d", (int)nVal);
+                }
+            }
+            else
+            {
+                szSpec[nSpecPos++] = pch[nIdx];
+            }
+        }
+        if ((eLogDecodeArg_Int == eType) && ('c' != pch[nSpecLen - 1]))
+        {
+            szSpec[nSpecPos++] = 'l';
+            szSpec[nSpecPos++] = 'l';
+        }
+        szSpec[nSpecPos++] = pch[nSpecLen - 1];
+        szSpec[nSpecPos]   = '\0';
+        pch += nSpecLen - 1;
+
+        nPos = (nLen < nOutSize) ? nLen : (nOutSize - 1);
+        switch (eType)
+        {
+        case eLogDecodeArg_None:
+            nRes = snprintf(&pchOut[nPos], nOutSize - nPos, "%%");
+            break;
+        case eLogDecodeArg_Int:
+            if (0 != LogDecodeVarint(pDec, &qwVal))
+            {
+                return -1;
+            }
+            nVal = LOG_DECODE_UNZIGZAG(qwVal);
+            switch (nBits)
+            {
+            case -1: nBits = 8 * pDec->oHeader.byLongSize; break;
+            case -2: nBits = 8 * pDec->oHeader.bySizeSize; break;
+            case 0:  nBits = 8 * pDec->oHeader.byIntSize;  break;
+            default: break;
+            }
+            /* value as converted by the printf() of the writer */
+            if ((nBits > 0) && (nBits < 64))
+            {
+                qwVal = (uint64_t)nVal & (((uint64_t)1 << nBits) - 1);
+                nVal  = (int64_t)(qwVal ^ ((uint64_t)1 << (nBits - 1))) - (int64_t)((uint64_t)1 << (nBits - 1));
+            }
+            else
+            {
+                qwVal = (uint64_t)nVal;
+            }
+            switch (pch[0])
+            {
+            case 'c':           nRes = snprintf(&pchOut[nPos], nOutSize - nPos, szSpec, (int)nVal);                  break;
+            case 'd': case 'i': nRes = snprintf(&pchOut[nPos], nOutSize - nPos, szSpec, (long long)nVal);            break;
+            default:            nRes = snprintf(&pchOut[nPos], nOutSize - nPos, szSpec, (unsigned long long)qwVal); break;
+            }
+            break;
+        case eLogDecodeArg_Double:
+            if (1 != fread(&fVal, sizeof(fVal), 1, pDec->pfIn))
+            {
+                return -1;
+            }
+            nRes = snprintf(&pchOut[nPos], nOutSize - nPos, szSpec, fVal);
+            break;
+        case eLogDecodeArg_Ptr:
+            if (0 != LogDecodeVarint(pDec, &qwVal))
+            {
+                return -1;
+            }
+            nRes = snprintf(&pchOut[nPos], nOutSize - nPos, szSpec, (void*)(size_t)LOG_DECODE_UNZIGZAG(qwVal));
+            break;
+        case eLogDecodeArg_String:
+            if (0 != LogDecodeString(pDec, pDec->achArg))
+            {
+                return -1;
+            }
+            nRes = snprintf(&pchOut[nPos], nOutSize - nPos, szSpec, pDec->achArg);
+            break;
+        }
+        if (nRes > 0)
+        {
+            nLen += (size_t)nRes;
+        }
+    }
+    pchOut[(nLen < nOutSize) ? nLen : (nOutSize - 1)] = '\0';
+    return 0;
+}
+
+/********************************************************************************/
+/** \brief  Print a message as text like the text log or as CSV line.
+*
+* \return  N/A.
+*/
+static void LogDecodePrint(T_LOG_DECODE* pDec, int nFlags, const char* szMsg)
+{
+const char* pch    = NULL;
+size_t      nLen   = strlen(szMsg);
+uint32_t    dwMsec = pDec->dwMsec;
+
+    if (!pDec->bCsv)
+    {
+        if (nFlags & LOG_BIN_FLAG_TIMESTAMP)
+        {
+            printf("%06d : ", (int)dwMsec);
+        }
+        fputs(szMsg, stdout);
+        if (nFlags & LOG_BIN_FLAG_CRLF)
+        {
+            putchar('\n');
+        }
+        return;
+    }
+    /* nsec,msec,thread,"message" without the new line at the end */
+    while ((nLen > 0) && (('\n' == szMsg[nLen - 1]) || ('\r' == szMsg[nLen - 1])))
+    {
+        nLen--;
+    }
+    printf("%llu,%u,%u,\"", (unsigned long long)pDec->qwNsec, dwMsec, pDec->dwThreadId);
+    for (pch = szMsg; pch < &szMsg[nLen]; pch++)
+    {
+        if ('"' == *pch)
+        {
+            putchar('"');
+        }
+        putchar(*pch);
+    }
+    printf("\"\n");
+}
+
+/********************************************************************************/
+/** \brief  Decode the records of a file.
+*
+* \return  0 on success, -1 on error.
+*/
+static int LogDecodeFile(T_LOG_DECODE* pDec)
+{
+uint64_t    qwVal   = 0;
+uint64_t    qwId    = 0;
+int         nType   = 0;
+char*       pszFormat = NULL;
+
+    if (1 != fread(&pDec->oHeader, sizeof(T_LOG_BIN_FILE_HEADER), 1, pDec->pfIn))
+    {
+        fprintf(stderr, "%s: no binary log file\n", pDec->szFileName);
+        return -1;
+    }
+    if (LOG_BIN_MAGIC != pDec->oHeader.dwMagic)
+    {
+        fprintf(stderr, "%s: no binary log file or written with a different byte order\n", pDec->szFileName);
+        return -1;
+    }
+    if ((LOG_BIN_VERSION != pDec->oHeader.dwVersion) || (pDec->oHeader.dwHeaderSize < sizeof(T_LOG_BIN_FILE_HEADER)))
+    {
+        fprintf(stderr, "%s: unsupported version %u\n", pDec->szFileName, pDec->oHeader.dwVersion);
+        return -1;
+    }
+    fseek(pDec->pfIn, (long)pDec->oHeader.dwHeaderSize, SEEK_SET);
+    pDec->qwNsec     = pDec->oHeader.qwStartNsec;
+    pDec->dwThreadId = 0;
+    pDec->dwMsec     = pDec->oHeader.dwStartMsec;
+
+    for (;;)
+    {
+        nType = getc(pDec->pfIn);
+        if (EOF == nType)
+        {
+            return 0;
+        }
+        if (LOG_BIN_REC_FORMAT == (nType & LOG_BIN_REC_MASK))
+        {
+            if ((0 != LogDecodeVarint(pDec, &qwId)) || (qwId >= LOG_DECODE_MAX_FORMATS) || (0 != LogDecodeString(pDec, pDec->achMsg)))
+            {
+                goto Error;
+            }
+            free(pDec->apszFormat[qwId]);
+            pDec->apszFormat[qwId] = (char*)malloc(strlen(pDec->achMsg) + 1);
+            if (NULL == pDec->apszFormat[qwId])
+            {
+                goto Error;
+            }
+            strcpy(pDec->apszFormat[qwId], pDec->achMsg);
+            continue;
+        }
+        /* message records: time, msec stamp and thread */
+        if (0 != LogDecodeVarint(pDec, &qwVal))
+        {
+            goto Error;
+        }
+        pDec->qwNsec += (uint64_t)LOG_DECODE_UNZIGZAG(qwVal);
+        if (0 != LogDecodeVarint(pDec, &qwVal))
+        {
+            goto Error;
+        }
+        pDec->dwMsec += (uint32_t)LOG_DECODE_UNZIGZAG(qwVal);
+        if (nType & LOG_BIN_FLAG_THREAD)
+        {
+            if (0 != LogDecodeVarint(pDec, &qwVal))
+            {
+                goto Error;
+            }
+            pDec->dwThreadId = (uint32_t)qwVal;
+        }
+        switch (nType & LOG_BIN_REC_MASK)
+        {
+        case LOG_BIN_REC_MSG:
+            if ((0 != LogDecodeVarint(pDec, &qwId)) || (qwId >= LOG_DECODE_MAX_FORMATS))
+            {
+                goto Error;
+            }
+            pszFormat = pDec->apszFormat[qwId];
+            if ((NULL == pszFormat) || (0 != LogDecodeFormat(pDec, pszFormat)))
+            {
+                goto Error;
+            }
+            LogDecodePrint(pDec, nType, pDec->achMsg);
+            break;
+        case LOG_BIN_REC_TEXT:
+            if (0 != LogDecodeString(pDec, pDec->achMsg))
+            {
+                goto Error;
+            }
+            LogDecodePrint(pDec, nType, pDec->achMsg);
+            break;
+        case LOG_BIN_REC_SKIP:
+            if (0 != LogDecodeVarint(pDec, &qwVal))
+            {
+                goto Error;
+            }
+            snprintf(pDec->achMsg, sizeof(pDec->achMsg), "%u identical messages skipped", (unsigned int)qwVal);
+            LogDecodePrint(pDec, nType | LOG_BIN_FLAG_CRLF, pDec->achMsg);
+            break;
+        default:
+            goto Error;
+        }
+    }
+Error:
+    /* e.g. the last record of a file still written or of a crashed application */
+    fprintf(stderr, "%s: truncated or invalid record at offset %ld\n", pDec->szFileName, ftell(pDec->pfIn));
+    return -1;
+}
+
+/********************************************************************************/
+/** \brief  Render binary log files, one after the other, on stdout.
+*
+* \return  0 on success, 1 on error.
+*/
+int main(int nArgc, char* ppArgv[])
+{
+T_LOG_DECODE* pDec     = NULL;
+int           nArg     = 1;
+int           nRes     = 0;
+uint32_t      dwId     = 0;
+
+    pDec = (T_LOG_DECODE*)calloc(1, sizeof(T_LOG_DECODE));
+    if (NULL == pDec)
+    {
+        return 1;
+    }
+    if ((nArg < nArgc) && (0 == strcmp(ppArgv[nArg], "-csv")))
+    {
+        pDec->bCsv = 1;
+        nArg++;
+    }
+    if (nArg >= nArgc)
+    {
+        fprintf(stderr, "Syntax:\n");
+        fprintf(stderr, "ecatDemoLogDecode [-csv] file [file ...]\n");
+        fprintf(stderr, "   -csv              print nsec,msec,thread,\"message\" instead of the text log\n");
+        fprintf(stderr, "   file              binary log file, e.g. ecmaster0.%s, roll over files in order\n", LOG_BIN_FILE_EXT);
+        free(pDec);
+        return 1;
+    }
+    if (pDec->bCsv)
+    {
+        printf("nsec,msec,thread,message\n");
+    }
+    for (; nArg < nArgc; nArg++)
+    {
+        pDec->szFileName = ppArgv[nArg];
+        pDec->pfIn = fopen(pDec->szFileName, "rb");
+        if (NULL == pDec->pfIn)
+        {
+            fprintf(stderr, "%s: cannot open\n", pDec->szFileName);
+            nRes = 1;
+            continue;
+        }
+        if (0 != LogDecodeFile(pDec))
+        {
+            nRes = 1;
+        }
+        fclose(pDec->pfIn);
+
+        /* format ids are defined per file */
+        for (dwId = 0; dwId < LOG_DECODE_MAX_FORMATS; dwId++)
+        {
+            free(pDec->apszFormat[dwId]);
+            pDec->apszFormat[dwId] = NULL;
+        }
+    }
+    free(pDec);
+    return nRes;
+}
+
+/*-END OF SOURCE FILE--------------------------------------------------------*/
@@ -0,0 +1,149 @@
+/*-----------------------------------------------------------------------------
+ * ecatDemoOverrun.cpp
+ * Copyright                acontis technologies GmbH, Weingarten, Germany
+ * Response                 Stefan Zintgraf
+ * Description              deadline miss accounting for the job task
+ *---------------------------------------------------------------------------*/
+
+/*-INCLUDES------------------------------------------------------------------*/
+#include "ecatDemoOverrun.h"
+#include "ecatDemoAtomic.h"
+
+/*-FUNCTION-DEFINITIONS------------------------------------------------------*/
+
+/********************************************************************************/
+/** \brief  Initialize deadline miss accounting.
+*
+* \return  N/A.
+*/
+EC_T_VOID OverrunInit
+    (T_OVERRUN_DESC* pDesc
+    ,EC_T_DWORD      dwCycleTimeUsec)       /**< [in]   period in usec */
+{
+    OsMemset(pDesc, 0, sizeof(T_OVERRUN_DESC));
+    pDesc->dwCycleTimeNsec = (EC_T_DWORD)EC_MIN((EC_T_UINT64)dwCycleTimeUsec * 1000, (EC_T_UINT64)0xFFFFFFFF);
+    LatencyHistoInit(&pDesc->oStats.oLateness, pDesc->dwCycleTimeNsec);
+}
+
+/********************************************************************************/
+/** \brief  Account one job task cycle. Called by the job task only.
+*
+* A cycle misses its deadline if it ends after the next period boundary or if
+* the frames of the previous cycle did not return. The period boundary is
+* derived from the previous wake-up. The miss is classified by its dominant
+* cause. No strings are formatted and nothing is allocated here.
+*
+* \return  N/A.
+*/
+EC_T_VOID OverrunCycleDone
+    (T_OVERRUN_DESC* pDesc
+    ,EC_T_UINT64     qwWake                 /**< [in]   wake-up time of the cycle in nsec */
+    ,EC_T_UINT64     qwEnd                  /**< [in]   end time of the cycle in nsec */
+    ,EC_T_BOOL       bPrevCycProcessed)     /**< [in]   all frames of the previous cycle returned */
+{
+T_OVERRUN_STATS* pStats        = &pDesc->oStats;
+EC_T_UINT64      qwExpected    = pDesc->qwPrevWake + pDesc->dwCycleTimeNsec;
+EC_T_UINT64      qwDeadline    = qwExpected + pDesc->dwCycleTimeNsec;
+EC_T_UINT64      qwWakeLate    = 0;
+EC_T_BOOL        bFirstCycle   = (0 == pDesc->qwPrevWake);
+
+    pDesc->qwPrevWake = qwWake;
+
+    pDesc->dwSequence++;
+    DEMO_MEMORY_BARRIER();
+
+    if (pDesc->bResetRequest)
+    {
+        OsMemset(pStats, 0, sizeof(T_OVERRUN_STATS));
+        LatencyHistoInit(&pStats->oLateness, pDesc->dwCycleTimeNsec);
+        pDesc->bResetRequest = EC_FALSE;
+    }
+    if (!bFirstCycle)
+    {
+        pStats->dwNumCycles++;
+        if (!bPrevCycProcessed || (qwEnd > qwDeadline))
+        {
+            pStats->dwNumMisses++;
+            pStats->dwConsecutiveMisses++;
+            if (pStats->dwConsecutiveMisses > pStats->dwMaxConsecutiveMisses)
+            {
+                pStats->dwMaxConsecutiveMisses = pStats->dwConsecutiveMisses;
+            }
+            if (!bPrevCycProcessed)
+            {
+                pStats->dwNumLostFrames++;
+            }
+            else
+            {
+                qwWakeLate = (qwWake > qwExpected) ? (qwWake - qwExpected) : 0;
+                if (qwWakeLate > (qwEnd - qwWake))
+                {
+                    pStats->dwNumLateWakeUps++;
+                }
+                else
+                {
+                    pStats->dwNumLongApp++;
+                }
+            }
+            LatencyHistoRecord(&pStats->oLateness,
+                (EC_T_DWORD)((qwEnd > qwDeadline) ? EC_MIN(qwEnd - qwDeadline, (EC_T_UINT64)0xFFFFFFFF) : 0));
+        }
+        else
+        {
+            pStats->dwConsecutiveMisses = 0;
+        }
+    }
+
+    DEMO_MEMORY_BARRIER();
+    pDesc->dwSequence++;
+}
+
+/********************************************************************************/
+/** \brief  Get consistent copy of the counters without blocking the writer.
+*
+* \return  N/A.
+*/
+EC_T_VOID OverrunGetSnapshot
+    (T_OVERRUN_DESC*  pDesc
+    ,T_OVERRUN_STATS* pStats)
+{
+EC_T_DWORD dwSequence = 0;
+
+    do
+    {
+        dwSequence = pDesc->dwSequence;
+        DEMO_MEMORY_BARRIER();
+        OsMemcpy(pStats, &pDesc->oStats, sizeof(T_OVERRUN_STATS));
+        DEMO_MEMORY_BARRIER();
+    } while ((0 != (dwSequence & 1)) || (dwSequence != pDesc->dwSequence));
+}
+
+/********************************************************************************/
+/** \brief  Request to clear the counters. They are cleared with the next cycle.
+*
+* \return  N/A.
+*/
+EC_T_VOID OverrunReset(T_OVERRUN_DESC* pDesc)
+{
+    pDesc->bResetRequest = EC_TRUE;
+}
+
+/********************************************************************************/
+/** \brief  Show deadline miss counters.
+*
+* \return  N/A.
+*/
+EC_T_VOID OverrunShow
+    (T_OVERRUN_STATS* pStats
+    ,CAtEmLogging*    poLog)
+{
+    poLog->LogMsg("Deadline misses: %d of %d cycles, max %d consecutive (late wake-up %d, long cycle %d, lost frame %d)",
+        pStats->dwNumMisses, pStats->dwNumCycles, pStats->dwMaxConsecutiveMisses,
+        pStats->dwNumLateWakeUps, pStats->dwNumLongApp, pStats->dwNumLostFrames);
+    if (0 != pStats->dwNumMisses)
+    {
+        LatencyHistoShow(&pStats->oLateness, poLog, "Lateness [usec]       ", 1000);
+    }
+}
+
+/*-END OF SOURCE FILE--------------------------------------------------------*/
@@ -0,0 +1,65 @@
+/*-----------------------------------------------------------------------------
+ * ecatDemoOverrun.h
+ * Copyright                acontis technologies GmbH, Weingarten, Germany
+ * Response                 Stefan Zintgraf
+ * Description              deadline miss accounting for the job task
+ *---------------------------------------------------------------------------*/
+
+#ifndef __ECATDEMOOVERRUN_H__
+#define __ECATDEMOOVERRUN_H__  1
+
+/*-INCLUDES------------------------------------------------------------------*/
+#include "ecatDemoHistogram.h"
+
+/*-DEFINES-------------------------------------------------------------------*/
+#define OVERRUN_OVERLOAD_LIMIT      5       /* consecutive misses reported as system overload */
+
+/*-TYPEDEFS------------------------------------------------------------------*/
+/* counters, read by OverrunGetSnapshot() */
+typedef struct _T_OVERRUN_STATS
+{
+    EC_T_DWORD      dwNumCycles;            /* cycles evaluated */
+    EC_T_DWORD      dwNumMisses;            /* cycles that missed their deadline */
+    EC_T_DWORD      dwConsecutiveMisses;    /* misses in a row up to the last cycle */
+    EC_T_DWORD      dwMaxConsecutiveMisses; /* longest row of misses */
+    EC_T_DWORD      dwNumLateWakeUps;       /* misses caused mainly by a late wake-up */
+    EC_T_DWORD      dwNumLongApp;           /* misses caused mainly by a long cycle (jobs, myAppWorkpd) */
+    EC_T_DWORD      dwNumLostFrames;        /* misses because frames of the previous cycle did not return */
+    T_LATENCY_HISTO oLateness;              /* time past the deadline of missed cycles in nsec */
+} T_OVERRUN_STATS;
+
+typedef struct _T_OVERRUN_DESC
+{
+    volatile EC_T_DWORD dwSequence;         /* odd while the writer updates oStats */
+    volatile EC_T_BOOL  bResetRequest;      /* set by reader, statistics are cleared by the writer */
+    EC_T_DWORD          dwCycleTimeNsec;    /* period in nsec */
+    EC_T_UINT64         qwPrevWake;         /* wake-up time of the previous cycle */
+    T_OVERRUN_STATS     oStats;
+} T_OVERRUN_DESC;
+
+/*-FUNCTION DECLARATION------------------------------------------------------*/
+EC_T_VOID OverrunInit(
+    T_OVERRUN_DESC* pDesc
+   ,EC_T_DWORD    dwCycleTimeUsec       /**< [in]   period in usec */
+   );
+EC_T_VOID OverrunCycleDone(
+    T_OVERRUN_DESC* pDesc
+   ,EC_T_UINT64   qwWake                /**< [in]   wake-up time of the cycle in nsec */
+   ,EC_T_UINT64   qwEnd                 /**< [in]   end time of the cycle in nsec */
+   ,EC_T_BOOL     bPrevCycProcessed     /**< [in]   all frames of the previous cycle returned */
+   );
+EC_T_VOID OverrunGetSnapshot(
+    T_OVERRUN_DESC* pDesc
+   ,T_OVERRUN_STATS* pStats
+   );
+EC_T_VOID OverrunReset(
+    T_OVERRUN_DESC* pDesc
+   );
+EC_T_VOID OverrunShow(
+    T_OVERRUN_STATS* pStats
+   ,CAtEmLogging* poLog
+   );
+
+#endif /*__ECATDEMOOVERRUN_H__*/
+
+/*-END OF SOURCE FILE--------------------------------------------------------*/
@@ -0,0 +1,373 @@
+/*-----------------------------------------------------------------------------
+ * ecatDemoPdForce.cpp
+ * Copyright                acontis technologies GmbH, Weingarten, Germany
+ * Response                 Stefan Zintgraf
+ * Description              forcing of output process data bits for commissioning
+ *---------------------------------------------------------------------------*/
+
+/*-INCLUDES------------------------------------------------------------------*/
+#include "ecatDemoPdForce.h"
+#include "ecatDemoAtomic.h"
+#include "ecatDemoSimd.h"
+
+/*-FUNCTION-DEFINITIONS------------------------------------------------------*/
+
+/********************************************************************************/
+/** \brief  image = (image & pbyAnd) | pbyOr over the complete image.
+*
+* The masks are PD_FORCE_ALIGN aligned and padded, the image may be unaligned.
+*
+* \return  N/A.
+*/
+static EC_T_VOID PdForceKernel(EC_T_BYTE* pbyImage, const EC_T_BYTE* pbyAnd, const EC_T_BYTE* pbyOr, EC_T_DWORD dwSize)
+{
+EC_T_DWORD dwIdx = 0;
+
+#if (defined DEMO_SIMD_AVX2)
+    for (; (dwIdx + 32) <= dwSize; dwIdx += 32)
+    {
+    __m256i oVal = _mm256_loadu_si256((const __m256i*)&pbyImage[dwIdx]);
+
+        oVal = _mm256_and_si256(oVal, _mm256_load_si256((const __m256i*)&pbyAnd[dwIdx]));
+        oVal = _mm256_or_si256(oVal, _mm256_load_si256((const __m256i*)&pbyOr[dwIdx]));
+        _mm256_storeu_si256((__m256i*)&pbyImage[dwIdx], oVal);
+    }
+#endif
+#if (defined DEMO_SIMD_SSE2)
+    for (; (dwIdx + 16) <= dwSize; dwIdx += 16)
+    {
+    __m128i oVal = _mm_loadu_si128((const __m128i*)&pbyImage[dwIdx]);
+
+        oVal = _mm_and_si128(oVal, _mm_load_si128((const __m128i*)&pbyAnd[dwIdx]));
+        oVal = _mm_or_si128(oVal, _mm_load_si128((const __m128i*)&pbyOr[dwIdx]));
+        _mm_storeu_si128((__m128i*)&pbyImage[dwIdx], oVal);
+    }
+#elif (defined DEMO_SIMD_NEON)
+    for (; (dwIdx + 16) <= dwSize; dwIdx += 16)
+    {
+        vst1q_u8(&pbyImage[dwIdx], vorrq_u8(vandq_u8(vld1q_u8(&pbyImage[dwIdx]), vld1q_u8(&pbyAnd[dwIdx])), vld1q_u8(&pbyOr[dwIdx])));
+    }
+#endif
+    for (; dwIdx < dwSize; dwIdx++)
+    {
+        pbyImage[dwIdx] = (EC_T_BYTE)((pbyImage[dwIdx] & pbyAnd[dwIdx]) | pbyOr[dwIdx]);
+    }
+}
+
+/********************************************************************************/
+/** \brief  Count the forced bits of a set.
+*
+* \return  number of cleared bits in the AND mask.
+*/
+static EC_T_DWORD PdForceCountBits(const T_PD_FORCE_SET* pSet, EC_T_DWORD dwSize)
+{
+EC_T_DWORD dwNumBits = 0;
+EC_T_DWORD dwIdx     = 0;
+EC_T_BYTE  byForced  = 0;
+
+    for (dwIdx = 0; dwIdx < dwSize; dwIdx++)
+    {
+        for (byForced = (EC_T_BYTE)~pSet->pbyAnd[dwIdx]; 0 != byForced; byForced = (EC_T_BYTE)(byForced & (byForced - 1)))
+        {
+            dwNumBits++;
+        }
+    }
+    return dwNumBits;
+}
+
+/********************************************************************************/
+/** \brief  Allocate the sets, nothing is forced.
+*
+* \return  EC_E_NOERROR on success, error code otherwise.
+*/
+EC_T_DWORD PdForceInit
+    (T_PD_FORCE*     pDesc
+    ,EC_T_DWORD      dwSize)                /**< [in]   size of the output process image in bytes */
+{
+EC_T_BYTE* pbyMasks = EC_NULL;
+EC_T_DWORD dwSetIdx = 0;
+
+    OsMemset(pDesc, 0, sizeof(T_PD_FORCE));
+    pDesc->dwSize     = dwSize;
+    pDesc->dwMaskSize = (dwSize + PD_FORCE_ALIGN - 1) & ~(PD_FORCE_ALIGN - 1);
+
+    /* AND and OR mask of each set and of the staging set */
+    pDesc->pbyAlloc = (EC_T_BYTE*)OsMalloc(2 * (PD_FORCE_NUM_SETS + 1) * pDesc->dwMaskSize + PD_FORCE_ALIGN);
+    if (EC_NULL == pDesc->pbyAlloc)
+    {
+        return EC_E_NOMEMORY;
+    }
+    pbyMasks = pDesc->pbyAlloc + ((PD_FORCE_ALIGN - ((size_t)pDesc->pbyAlloc & (PD_FORCE_ALIGN - 1))) & (PD_FORCE_ALIGN - 1));
+    for (dwSetIdx = 0; dwSetIdx < PD_FORCE_NUM_SETS; dwSetIdx++)
+    {
+        pDesc->aSet[dwSetIdx].pbyAnd = pbyMasks;
+        pDesc->aSet[dwSetIdx].pbyOr  = pbyMasks + pDesc->dwMaskSize;
+        pbyMasks += 2 * pDesc->dwMaskSize;
+    }
+    pDesc->oStaging.pbyAnd = pbyMasks;
+    pDesc->oStaging.pbyOr  = pbyMasks + pDesc->dwMaskSize;
+    for (dwSetIdx = 0; dwSetIdx < PD_FORCE_NUM_SETS; dwSetIdx++)
+    {
+        OsMemset(pDesc->aSet[dwSetIdx].pbyAnd, 0xFF, pDesc->dwMaskSize);
+        OsMemset(pDesc->aSet[dwSetIdx].pbyOr, 0, pDesc->dwMaskSize);
+    }
+    PdForceReleaseAll(pDesc);
+
+    /* sets must be visible before the job task starts to apply */
+    DEMO_MEMORY_BARRIER();
+    pDesc->bEnabled = EC_TRUE;
+
+    return EC_E_NOERROR;
+}
+
+/********************************************************************************/
+/** \brief  Free the sets. The job task must not run PdForceApply() anymore.
+*
+* \return  N/A.
+*/
+EC_T_VOID PdForceDeinit(T_PD_FORCE* pDesc)
+{
+    pDesc->bEnabled = EC_FALSE;
+    DEMO_MEMORY_BARRIER();
+    SafeOsFree(pDesc->pbyAlloc);
+    OsMemset(pDesc, 0, sizeof(T_PD_FORCE));
+}
+
+/********************************************************************************/
+/** \brief  Force bits in the staging set. Takes effect with PdForceCommit().
+*
+* \return  EC_E_NOERROR on success, EC_E_INVALIDPARM if the bits are outside of the image.
+*/
+EC_T_DWORD PdForceSet
+    (T_PD_FORCE*     pDesc
+    ,EC_T_DWORD      dwBitOffs              /**< [in]   bit offset in the output process image */
+    ,EC_T_DWORD      dwBitSize              /**< [in]   number of bits, 1..32 */
+    ,EC_T_DWORD      dwValue)               /**< [in]   forced value, bit 0 at dwBitOffs */
+{
+EC_T_DWORD dwIdx  = 0;
+EC_T_DWORD dwBit  = 0;
+EC_T_BYTE  byMask = 0;
+
+    if ((0 == dwBitSize) || (dwBitSize > 32) || ((dwBitOffs + dwBitSize) > (pDesc->dwSize * 8)))
+    {
+        return EC_E_INVALIDPARM;
+    }
+    for (dwIdx = 0; dwIdx < dwBitSize; dwIdx++)
+    {
+        dwBit  = dwBitOffs + dwIdx;
+        byMask = (EC_T_BYTE)(1 << (dwBit & 7));
+        pDesc->oStaging.pbyAnd[dwBit / 8] = (EC_T_BYTE)(pDesc->oStaging.pbyAnd[dwBit / 8] & ~byMask);
+        if (0 != ((dwValue >> dwIdx) & 1))
+        {
+            pDesc->oStaging.pbyOr[dwBit / 8] = (EC_T_BYTE)(pDesc->oStaging.pbyOr[dwBit / 8] | byMask);
+        }
+        else
+        {
+            pDesc->oStaging.pbyOr[dwBit / 8] = (EC_T_BYTE)(pDesc->oStaging.pbyOr[dwBit / 8] & ~byMask);
+        }
+    }
+    return EC_E_NOERROR;
+}
+
+/********************************************************************************/
+/** \brief  Release forced bits in the staging set. Takes effect with PdForceCommit().
+*
+* \return  EC_E_NOERROR on success, EC_E_INVALIDPARM if the bits are outside of the image.
+*/
+EC_T_DWORD PdForceRelease
+    (T_PD_FORCE*     pDesc
+    ,EC_T_DWORD      dwBitOffs              /**< [in]   bit offset in the output process image */
+    ,EC_T_DWORD      dwBitSize)             /**< [in]   number of bits */
+{
+EC_T_DWORD dwIdx  = 0;
+EC_T_DWORD dwBit  = 0;
+EC_T_BYTE  byMask = 0;
+
+    if ((dwBitOffs + dwBitSize) > (pDesc->dwSize * 8))
+    {
+        return EC_E_INVALIDPARM;
+    }
+    for (dwIdx = 0; dwIdx < dwBitSize; dwIdx++)
+    {
+        dwBit  = dwBitOffs + dwIdx;
+        byMask = (EC_T_BYTE)(1 << (dwBit & 7));
+        pDesc->oStaging.pbyAnd[dwBit / 8] = (EC_T_BYTE)(pDesc->oStaging.pbyAnd[dwBit / 8] | byMask);
+        pDesc->oStaging.pbyOr[dwBit / 8]  = (EC_T_BYTE)(pDesc->oStaging.pbyOr[dwBit / 8] & ~byMask);
+    }
+    return EC_E_NOERROR;
+}
+
+/********************************************************************************/
+/** \brief  Release all bits in the staging set. Takes effect with PdForceCommit().
+*
+* \return  N/A.
+*/
+EC_T_VOID PdForceReleaseAll(T_PD_FORCE* pDesc)
+{
+    OsMemset(pDesc->oStaging.pbyAnd, 0xFF, pDesc->dwMaskSize);
+    OsMemset(pDesc->oStaging.pbyOr, 0, pDesc->dwMaskSize);
+}
+
+/********************************************************************************/
+/** \brief  Hand the staging set over to the job task. Called by a non real-time thread.
+*
+* The staging set is copied into the set not used by the job task. That set is
+* free as soon as the job task applied the previous commit once, until then the
+* caller waits. The job task never waits.
+*
+* \return  EC_E_NOERROR on success, EC_E_TIMEOUT if the job task did not pick up the previous set.
+*/
+EC_T_DWORD PdForceCommit
+    (T_PD_FORCE*     pDesc
+    ,EC_T_DWORD      dwTimeout)             /**< [in]   wait time for the job task to pick up the previous set in msec */
+{
+T_PD_FORCE_SET* pActive  = EC_NULL;
+T_PD_FORCE_SET* pNext    = EC_NULL;
+EC_T_DWORD      dwCommit = pDesc->dwNumCommits;
+CEcTimer        oTimeout;
+
+    if (!pDesc->bEnabled)
+    {
+        return EC_E_INVALIDSTATE;
+    }
+    /* nothing to do if the staging set is already applied */
+    pActive = &pDesc->aSet[dwCommit % PD_FORCE_NUM_SETS];
+    if ((0 == OsMemcmp(pActive->pbyAnd, pDesc->oStaging.pbyAnd, pDesc->dwSize))
+     && (0 == OsMemcmp(pActive->pbyOr, pDesc->oStaging.pbyOr, pDesc->dwSize)))
+    {
+        return EC_E_NOERROR;
+    }
+    oTimeout.Start(dwTimeout);
+    while (pDesc->dwNumApplied != dwCommit)
+    {
+        if (oTimeout.IsElapsed())
+        {
+            return EC_E_TIMEOUT;
+        }
+        OsSleep(1);
+    }
+    DEMO_MEMORY_BARRIER();
+
+    pNext = &pDesc->aSet[(dwCommit + 1) % PD_FORCE_NUM_SETS];
+    OsMemcpy(pNext->pbyAnd, pDesc->oStaging.pbyAnd, pDesc->dwMaskSize);
+    OsMemcpy(pNext->pbyOr, pDesc->oStaging.pbyOr, pDesc->dwMaskSize);
+    pNext->dwNumForcedBits = PdForceCountBits(pNext, pDesc->dwSize);
+
+    /* the job task switches to the new set in the next cycle */
+    DEMO_MEMORY_BARRIER();
+    pDesc->dwNumCommits = dwCommit + 1;
+
+    return EC_E_NOERROR;
+}
+
+/********************************************************************************/
+/** \brief  Replace the staging set by the content of a force file.
+*
+* One forced value per line: "bitoffset bitsize value", numbers in C notation,
+* empty lines and lines starting with '#' are ignored. A missing file
+* releases all bits.
+*
+* \return  EC_E_NOERROR on success, EC_E_INVALIDPARM on syntax errors.
+*/
+EC_T_DWORD PdForceLoadFile
+    (T_PD_FORCE*     pDesc
+    ,const EC_T_CHAR* szFileName)           /**< [in]   force file, lines of "bitoffset bitsize value" */
+{
+EC_T_DWORD  dwRetVal  = EC_E_NOERROR;
+FILE*       pfFile    = EC_NULL;
+EC_T_CHAR   szLine[128];
+EC_T_CHAR*  pszPos    = EC_NULL;
+EC_T_CHAR*  pszEnd    = EC_NULL;
+EC_T_DWORD  adwVal[3] = { 0 };
+EC_T_DWORD  dwValIdx  = 0;
+EC_T_DWORD  dwLine    = 0;
+
+    PdForceReleaseAll(pDesc);
+    pfFile = OsFopen(szFileName, "r");
+    if (EC_NULL == pfFile)
+    {
+        goto Exit;
+    }
+    while (EC_NULL != fgets(szLine, sizeof(szLine), pfFile))
+    {
+        dwLine++;
+        for (pszPos = szLine; (' ' == *pszPos) || ('\t' == *pszPos); pszPos++)
+        {
+        }
+        if (('#' == *pszPos) || ('\r' == *pszPos) || ('\n' == *pszPos) || ('\0' == *pszPos))
+        {
+            continue;
+        }
+        for (dwValIdx = 0; dwValIdx < 3; dwValIdx++)
+        {
+            adwVal[dwValIdx] = (EC_T_DWORD)OsStrtol(pszPos, &pszEnd, 0);
+            if (pszEnd == pszPos)
+            {
+                break;
+            }
+            pszPos = pszEnd;
+        }
+        if ((dwValIdx < 3) || (EC_E_NOERROR != PdForceSet(pDesc, adwVal[0], adwVal[1], adwVal[2])))
+        {
+            OsDbgMsg("PdForce: %s line %d: expected bitoffset bitsize value inside the output image\n", szFileName, dwLine);
+            dwRetVal = EC_E_INVALIDPARM;
+            break;
+        }
+    }
+    OsFclose(pfFile);
+
+Exit:
+    return dwRetVal;
+}
+
+/********************************************************************************/
+/** \brief  Apply the committed set to the output image. Called by the job task before the cyclic frames are sent.
+*
+* One pass over the complete image, the time does not depend on the number of forced bits.
+*
+* \return  N/A.
+*/
+EC_T_VOID PdForceApply
+    (T_PD_FORCE*     pDesc
+    ,EC_T_BYTE*      pbyPDOut)              /**< [in]   output process image */
+{
+T_PD_FORCE_SET* pSet     = EC_NULL;
+EC_T_DWORD      dwCommit = 0;
+
+    if (!pDesc->bEnabled || (EC_NULL == pbyPDOut))
+    {
+        return;
+    }
+    dwCommit = pDesc->dwNumCommits;
+    DEMO_MEMORY_BARRIER();
+    pSet = &pDesc->aSet[dwCommit % PD_FORCE_NUM_SETS];
+    if (0 != pSet->dwNumForcedBits)
+    {
+        PdForceKernel(pbyPDOut, pSet->pbyAnd, pSet->pbyOr, pDesc->dwSize);
+    }
+    /* the other set may be overwritten by the next commit */
+    DEMO_MEMORY_BARRIER();
+    pDesc->dwNumApplied = dwCommit;
+}
+
+/********************************************************************************/
+/** \brief  Get the set of the last PdForceApply(), e.g. to record it. Called by the job task.
+*
+* The set is not changed before the next PdForceApply() picked up a new commit.
+*
+* \return  applied set, EC_NULL if no bits were forced.
+*/
+const T_PD_FORCE_SET* PdForceGetApplied(T_PD_FORCE* pDesc)
+{
+T_PD_FORCE_SET* pSet = EC_NULL;
+
+    if (!pDesc->bEnabled)
+    {
+        return EC_NULL;
+    }
+    pSet = &pDesc->aSet[pDesc->dwNumApplied % PD_FORCE_NUM_SETS];
+
+    return (0 != pSet->dwNumForcedBits) ? pSet : EC_NULL;
+}
+
+/*-END OF SOURCE FILE--------------------------------------------------------*/
@@ -0,0 +1,83 @@
+/*-----------------------------------------------------------------------------
+ * ecatDemoPdForce.h
+ * Copyright                acontis technologies GmbH, Weingarten, Germany
+ * Response                 Stefan Zintgraf
+ * Description              forcing of output process data bits for commissioning
+ *---------------------------------------------------------------------------*/
+
+#ifndef __ECATDEMOPDFORCE_H__
+#define __ECATDEMOPDFORCE_H__  1
+
+/*-INCLUDES------------------------------------------------------------------*/
+#include "EcOs.h"
+
+/*-DEFINES-------------------------------------------------------------------*/
+#define PD_FORCE_NUM_SETS           2           /* applied set and set prepared by the next commit */
+#define PD_FORCE_ALIGN              64          /* alignment and size granularity of the masks */
+#define PD_FORCE_MAX_FILE_NAME_LEN  256
+#define PD_FORCE_RELOAD_PERIOD      1000        /* force file check interval of the main thread in msec */
+#define PD_FORCE_COMMIT_TIMEOUT     100         /* wait time for the job task to pick up the previous set in msec */
+
+/*-TYPEDEFS------------------------------------------------------------------*/
+/* image = (image & pbyAnd) | pbyOr */
+typedef struct _T_PD_FORCE_SET
+{
+    EC_T_BYTE*          pbyAnd;             /* cleared bits are forced */
+    EC_T_BYTE*          pbyOr;              /* values of the forced bits, 0 elsewhere */
+    EC_T_DWORD          dwNumForcedBits;    /* 0: the set is not applied */
+} T_PD_FORCE_SET;
+
+typedef struct _T_PD_FORCE
+{
+    volatile EC_T_BOOL  bEnabled;           /* set by PdForceInit() */
+    volatile EC_T_DWORD dwNumCommits;       /* aSet[dwNumCommits % PD_FORCE_NUM_SETS] is applied */
+    volatile EC_T_DWORD dwNumApplied;       /* dwNumCommits seen by the last PdForceApply() */
+    EC_T_DWORD          dwSize;             /* size of the output image in bytes */
+    EC_T_DWORD          dwMaskSize;         /* dwSize rounded up to PD_FORCE_ALIGN */
+    T_PD_FORCE_SET      aSet[PD_FORCE_NUM_SETS];
+    T_PD_FORCE_SET      oStaging;           /* changed by PdForceSet(), copied by PdForceCommit() */
+    EC_T_BYTE*          pbyAlloc;
+} T_PD_FORCE;
+
+/*-FUNCTION DECLARATION------------------------------------------------------*/
+EC_T_DWORD PdForceInit(
+    T_PD_FORCE*   pDesc
+   ,EC_T_DWORD    dwSize                /**< [in]   size of the output process image in bytes */
+   );
+EC_T_VOID PdForceDeinit(
+    T_PD_FORCE*   pDesc
+   );
+EC_T_DWORD PdForceSet(
+    T_PD_FORCE*   pDesc
+   ,EC_T_DWORD    dwBitOffs             /**< [in]   bit offset in the output process image */
+   ,EC_T_DWORD    dwBitSize             /**< [in]   number of bits, 1..32 */
+   ,EC_T_DWORD    dwValue               /**< [in]   forced value, bit 0 at dwBitOffs */
+   );
+EC_T_DWORD PdForceRelease(
+    T_PD_FORCE*   pDesc
+   ,EC_T_DWORD    dwBitOffs             /**< [in]   bit offset in the output process image */
+   ,EC_T_DWORD    dwBitSize             /**< [in]   number of bits */
+   );
+EC_T_VOID PdForceReleaseAll(
+    T_PD_FORCE*   pDesc
+   );
+EC_T_DWORD PdForceCommit(
+    T_PD_FORCE*   pDesc
+   ,EC_T_DWORD    dwTimeout             /**< [in]   wait time for the job task to pick up the previous set in msec */
+   );
+EC_T_DWORD PdForceLoadFile(
+    T_PD_FORCE*   pDesc
+   ,const
+    EC_T_CHAR*    szFileName            /**< [in]   force file, lines of "bitoffset bitsize value" */
+   );
+EC_T_VOID PdForceApply(
+    T_PD_FORCE*   pDesc
+   ,EC_T_BYTE*    pbyPDOut              /**< [in]   output process image */
+   );
+const T_PD_FORCE_SET* PdForceGetApplied(
+    T_PD_FORCE*   pDesc
+   );
+
+#endif /*__ECATDEMOPDFORCE_H__*/
+
+/*-END OF SOURCE FILE--------------------------------------------------------*/
@@ -0,0 +1,475 @@
+/*-----------------------------------------------------------------------------
+ * ecatDemoPdRec.cpp
+ * Copyright                acontis technologies GmbH, Weingarten, Germany
+ * Response                 Stefan Zintgraf
+ * Description              cycle by cycle process data recorder into memory mapped ring files
+ *---------------------------------------------------------------------------*/
+
+/*-INCLUDES------------------------------------------------------------------*/
+#include "ecatDemoPdRec.h"
+#include "ecatDemoAtomic.h"
+#include "ecatDemoSimd.h"
+
+#if (defined PD_REC_SUPPORTED)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+/*-LOCAL VARIABLES-----------------------------------------------------------*/
+static volatile EC_T_BOOL               S_bRecEnabled       = EC_FALSE;
+static T_PD_REC_FILE_HEADER* volatile   S_pCurrent          = EC_NULL;  /* written by tEcJobTask */
+static T_PD_REC_FILE_HEADER* volatile   S_pNext             = EC_NULL;  /* prepared by tEcPdRecSync, taken by tEcJobTask */
+static T_PD_REC_FILE_HEADER* volatile   S_pRetired          = EC_NULL;  /* full file, synced and unmapped by tEcPdRecSync */
+static EC_T_DWORD                       S_dwFileSize        = 0;
+static EC_T_DWORD                       S_dwNumFiles        = 0;
+static EC_T_DWORD                       S_dwNextFileIndex   = 0;
+static T_PD_REC_FILE_HEADER             S_oLayout;                      /* header template of all files */
+static T_PD_REC_SLAVE*                  S_aSlave            = EC_NULL;  /* slave table template of all files */
+static EC_T_DWORD                       S_dwMaxSlaves       = 0;
+static EC_T_UINT64                      S_qwCycle           = 0;
+static EC_T_DWORD                       S_dwLastWkcErrors   = 0;
+static volatile EC_T_DWORD              S_dwNumLateRotations = 0;       /* next file was not ready, current file wrapped */
+static EC_T_VOID*                       S_pvSyncEvent       = EC_NULL;
+static EC_T_VOID*                       S_pvSyncThread      = EC_NULL;
+static volatile EC_T_BOOL               S_bSyncShutdown     = EC_FALSE;
+static volatile EC_T_BOOL               S_bSyncThreadRunning = EC_FALSE;
+
+/*-FUNCTION-DEFINITIONS------------------------------------------------------*/
+
+/********************************************************************************/
+/** \brief  Copy without loading the destination into the cache.
+*
+* The destination must be 16 byte aligned. The stores are ordered by the
+* _mm_sfence() in PdRecRecord().
+*
+* \return  N/A.
+*/
+static EC_T_VOID PdRecCopyNt(EC_T_BYTE* pbyDst, const EC_T_BYTE* pbySrc, EC_T_DWORD dwSize)
+{
+#if (defined DEMO_SIMD_SSE2)
+EC_T_DWORD dwIdx = 0;
+
+    for (dwIdx = 0; (dwIdx + 16) <= dwSize; dwIdx += 16)
+    {
+        _mm_stream_si128((__m128i*)&pbyDst[dwIdx], _mm_loadu_si128((const __m128i*)&pbySrc[dwIdx]));
+    }
+    if (dwIdx < dwSize)
+    {
+        OsMemcpy(&pbyDst[dwIdx], &pbySrc[dwIdx], dwSize - dwIdx);
+    }
+#else
+    /* no streaming stores available, e.g. NEON */
+    OsMemcpy(pbyDst, pbySrc, dwSize);
+#endif
+}
+
+/********************************************************************************/
+/** \brief  Get the position of a cycle in a file.
+*
+* \return  byte offset of the record, 0 if the cycle is not stored in the file.
+*/
+EC_T_DWORD PdRecRecordOffset
+    (const T_PD_REC_FILE_HEADER* pHeader
+    ,EC_T_UINT64     qwCycle)               /**< [in]   cycle number */
+{
+EC_T_UINT64 qwEnd = pHeader->qwFirstCycle + pHeader->qwNumWritten;
+
+    if ((qwCycle < pHeader->qwFirstCycle) || (qwCycle >= qwEnd) || ((qwEnd - qwCycle) > pHeader->dwNumRecords))
+    {
+        return 0;
+    }
+    return pHeader->dwHeaderSize + (EC_T_DWORD)((qwCycle - pHeader->qwFirstCycle) % pHeader->dwNumRecords) * pHeader->dwRecordSize;
+}
+
+/********************************************************************************/
+/** \brief  Get an entry of the slave table of a file.
+*
+* \return  slave table entry, EC_NULL if the index is out of range.
+*/
+const T_PD_REC_SLAVE* PdRecGetSlave
+    (const T_PD_REC_FILE_HEADER* pHeader
+    ,EC_T_DWORD      dwSlaveIdx)            /**< [in]   index in the slave table */
+{
+    if ((dwSlaveIdx >= pHeader->dwNumSlaves)
+     || (PD_REC_SLAVE_TABLE_OFFS + ((EC_T_UINT64)dwSlaveIdx + 1) * sizeof(T_PD_REC_SLAVE) > pHeader->dwHeaderSize))
+    {
+        return EC_NULL;
+    }
+    return &((const T_PD_REC_SLAVE*)((const EC_T_BYTE*)pHeader + PD_REC_SLAVE_TABLE_OFFS))[dwSlaveIdx];
+}
+
+#if (defined PD_REC_SUPPORTED)
+/********************************************************************************/
+/** \brief  Create, map and prefault a ring file.
+*
+* \return  header of the mapped file, EC_NULL on error.
+*/
+static T_PD_REC_FILE_HEADER* PdRecMapFile(EC_T_DWORD dwFileIndex)
+{
+EC_T_CHAR              szFileName[32];
+int                    nFd     = -1;
+EC_T_VOID*             pvMap   = MAP_FAILED;
+T_PD_REC_FILE_HEADER*  pHeader = EC_NULL;
+
+    OsSnprintf(szFileName, sizeof(szFileName) - 1, "%s_%d.bin", PD_REC_FILE_NAME, dwFileIndex);
+    nFd = open(szFileName, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (nFd < 0)
+    {
+        OsDbgMsg("PdRec: cannot create '%s'\n", szFileName);
+        goto Exit;
+    }
+    /* reserve the disk blocks, a full disk must not raise SIGBUS in the job task */
+    if (0 != posix_fallocate(nFd, 0, (off_t)S_dwFileSize))
+    {
+        OsDbgMsg("PdRec: cannot allocate %d bytes for '%s'\n", S_dwFileSize, szFileName);
+        goto Exit;
+    }
+    pvMap = mmap(EC_NULL, S_dwFileSize, PROT_READ | PROT_WRITE, MAP_SHARED, nFd, 0);
+    if (MAP_FAILED == pvMap)
+    {
+        goto Exit;
+    }
+    /* touch all pages now, the job task must not page fault */
+    OsMemset(pvMap, 0, S_dwFileSize);
+    pHeader = (T_PD_REC_FILE_HEADER*)pvMap;
+    OsMemcpy(pHeader, &S_oLayout, sizeof(T_PD_REC_FILE_HEADER));
+    OsMemcpy((EC_T_BYTE*)pHeader + PD_REC_SLAVE_TABLE_OFFS, S_aSlave, S_oLayout.dwNumSlaves * sizeof(T_PD_REC_SLAVE));
+    pHeader->dwFileIndex = dwFileIndex;
+
+Exit:
+    if (nFd >= 0)
+    {
+        /* the mapping stays valid without the descriptor */
+        close(nFd);
+    }
+    return pHeader;
+}
+
+/********************************************************************************/
+/** \brief  Write a file back to disk and unmap it.
+*
+* \return  N/A.
+*/
+static EC_T_VOID PdRecUnmapFile(T_PD_REC_FILE_HEADER* pHeader)
+{
+    if (EC_NULL != pHeader)
+    {
+        msync(pHeader, S_dwFileSize, MS_SYNC);
+        munmap(pHeader, S_dwFileSize);
+    }
+}
+
+/********************************************************************************/
+/** \brief  Low priority thread writing the records back to disk and preparing the next file.
+*
+* \return  N/A.
+*/
+static EC_T_VOID tEcPdRecSync(EC_T_VOID* pvParms)
+{
+T_PD_REC_FILE_HEADER* pHeader = EC_NULL;
+
+    EC_UNREFPARM(pvParms);
+
+    S_bSyncThreadRunning = EC_TRUE;
+    while (!S_bSyncShutdown)
+    {
+        OsWaitForEvent(S_pvSyncEvent, PD_REC_SYNC_PERIOD);
+
+        /* file rotated by the job task */
+        pHeader = S_pRetired;
+        if (EC_NULL != pHeader)
+        {
+            PdRecUnmapFile(pHeader);
+            DEMO_MEMORY_BARRIER();
+            S_pRetired = EC_NULL;
+        }
+        /* prepare the next file when the current one is half full, the oldest file is overwritten */
+        pHeader = S_pCurrent;
+        if ((S_dwNumFiles > 1) && (EC_NULL == S_pNext) && (pHeader->qwNumWritten >= (pHeader->dwNumRecords / 2)))
+        {
+            pHeader = PdRecMapFile(S_dwNextFileIndex);
+            if (EC_NULL != pHeader)
+            {
+                S_dwNextFileIndex = (S_dwNextFileIndex + 1) % S_dwNumFiles;
+                DEMO_MEMORY_BARRIER();
+                S_pNext = pHeader;
+            }
+        }
+        msync(S_pCurrent, S_dwFileSize, MS_ASYNC);
+    }
+    S_bSyncThreadRunning = EC_FALSE;
+#if (defined EC_VERSION_RTEMS)
+    rtems_task_delete(RTEMS_SELF);
+#endif
+}
+#endif /* PD_REC_SUPPORTED */
+
+/********************************************************************************/
+/** \brief  Create the first ring file and start the sync thread.
+*
+* \return  EC_E_NOERROR on success, error code otherwise.
+*/
+EC_T_DWORD PdRecInit
+    (EC_T_DWORD      dwFileSizeMb           /**< [in]   size of each ring file in MByte */
+    ,EC_T_DWORD      dwNumFiles             /**< [in]   files used round robin, 1 = single ring file */
+    ,EC_T_DWORD      dwInSize               /**< [in]   recorded size of the input image in bytes */
+    ,EC_T_DWORD      dwOutSize              /**< [in]   recorded size of the output image in bytes */
+    ,EC_T_DWORD      dwCycleTimeUsec        /**< [in]   bus cycle time */
+    ,EC_T_DWORD      dwMaxSlaves            /**< [in]   capacity of the slave table */
+    ,EC_T_BOOL       bForce                 /**< [in]   reserve room for the forced output masks */
+    ,EC_T_DWORD      dwSyncPrio             /**< [in]   priority of the sync thread */
+    ,EC_T_DWORD      dwSyncStackSize)       /**< [in]   stack size of the sync thread */
+{
+#if (defined PD_REC_SUPPORTED)
+EC_T_DWORD  dwRetVal   = EC_E_ERROR;
+EC_T_UINT64 qwFileSize = 0;
+CEcTimer    oTimeout;
+
+    if ((0 == dwFileSizeMb) || (dwFileSizeMb > PD_REC_MAX_FILE_SIZE_MB))
+    {
+        dwRetVal = EC_E_INVALIDPARM;
+        goto Exit;
+    }
+    /* the slave table is stored in front of the records, 0 entries is allowed */
+    S_dwMaxSlaves = dwMaxSlaves;
+    S_aSlave      = (T_PD_REC_SLAVE*)OsMalloc(EC_MAX(dwMaxSlaves, 1) * sizeof(T_PD_REC_SLAVE));
+    if (EC_NULL == S_aSlave)
+    {
+        dwRetVal = EC_E_NOMEMORY;
+        goto Exit;
+    }
+    OsMemset(&S_oLayout, 0, sizeof(T_PD_REC_FILE_HEADER));
+    S_oLayout.dwMagic         = PD_REC_MAGIC;
+    S_oLayout.dwVersion       = PD_REC_VERSION;
+    S_oLayout.dwHeaderSize    = PD_REC_ALIGN(PD_REC_SLAVE_TABLE_OFFS + dwMaxSlaves * sizeof(T_PD_REC_SLAVE), PD_REC_HEADER_SIZE);
+    S_oLayout.dwInSize        = dwInSize;
+    S_oLayout.dwOutSize       = dwOutSize;
+    S_oLayout.dwInOffs        = sizeof(T_PD_REC_RECORD);
+    S_oLayout.dwOutOffs       = S_oLayout.dwInOffs + PD_REC_ALIGN(dwInSize, 16);
+    S_oLayout.dwForceOffs     = bForce ? (S_oLayout.dwOutOffs + PD_REC_ALIGN(dwOutSize, 16)) : 0;
+    S_oLayout.dwRecordSize    = PD_REC_ALIGN(bForce ? (S_oLayout.dwForceOffs + 2 * PD_REC_ALIGN(dwOutSize, 16)) : (S_oLayout.dwOutOffs + dwOutSize), 64);
+    S_oLayout.dwCycleTimeUsec = dwCycleTimeUsec;
+    qwFileSize = EC_MAX((EC_T_UINT64)dwFileSizeMb * 1024 * 1024, S_oLayout.dwHeaderSize + 2 * (EC_T_UINT64)S_oLayout.dwRecordSize);
+    if (qwFileSize > 0xFFFFFFFF)
+    {
+        dwRetVal = EC_E_INVALIDSIZE;
+        goto Exit;
+    }
+    S_dwFileSize = (EC_T_DWORD)qwFileSize;
+    S_oLayout.dwNumRecords    = (S_dwFileSize - S_oLayout.dwHeaderSize) / S_oLayout.dwRecordSize;
+    S_dwNumFiles         = EC_MAX(dwNumFiles, 1);
+    S_dwNextFileIndex    = 1 % S_dwNumFiles;
+    S_qwCycle            = 0;
+    S_dwLastWkcErrors    = 0;
+    S_dwNumLateRotations = 0;
+    S_pNext              = EC_NULL;
+    S_pRetired           = EC_NULL;
+
+    S_pCurrent = PdRecMapFile(0);
+    if (EC_NULL == S_pCurrent)
+    {
+        dwRetVal = EC_E_OPENFAILED;
+        goto Exit;
+    }
+    S_pvSyncEvent = OsCreateEvent();
+    if (EC_NULL == S_pvSyncEvent)
+    {
+        dwRetVal = EC_E_NOMEMORY;
+        goto Exit;
+    }
+    S_bSyncShutdown = EC_FALSE;
+    S_pvSyncThread  = OsCreateThread((EC_T_CHAR*)"tEcPdRecSync", tEcPdRecSync, dwSyncPrio, dwSyncStackSize, EC_NULL);
+
+    /* wait until thread is running */
+    oTimeout.Start(2000);
+    while (!oTimeout.IsElapsed() && !S_bSyncThreadRunning)
+    {
+        OsSleep(10);
+    }
+    if (!S_bSyncThreadRunning)
+    {
+        dwRetVal = EC_E_TIMEOUT;
+        goto Exit;
+    }
+    OsDbgMsg("PdRec: %d files of %d records, %d bytes per record\n", S_dwNumFiles, S_oLayout.dwNumRecords, S_oLayout.dwRecordSize);
+    DEMO_MEMORY_BARRIER();
+    S_bRecEnabled = EC_TRUE;
+    dwRetVal = EC_E_NOERROR;
+
+Exit:
+    if (EC_E_NOERROR != dwRetVal)
+    {
+        PdRecDeinit();
+    }
+    return dwRetVal;
+#else
+    EC_UNREFPARM(dwFileSizeMb);
+    EC_UNREFPARM(dwNumFiles);
+    EC_UNREFPARM(dwInSize);
+    EC_UNREFPARM(dwOutSize);
+    EC_UNREFPARM(dwCycleTimeUsec);
+    EC_UNREFPARM(dwMaxSlaves);
+    EC_UNREFPARM(bForce);
+    EC_UNREFPARM(dwSyncPrio);
+    EC_UNREFPARM(dwSyncStackSize);
+    return EC_E_NOTSUPPORTED;
+#endif
+}
+
+/********************************************************************************/
+/** \brief  Stop the sync thread and write all files back to disk.
+*
+* Must be called after the job task has been stopped.
+*
+* \return  N/A.
+*/
+EC_T_VOID PdRecDeinit(EC_T_VOID)
+{
+#if (defined PD_REC_SUPPORTED)
+CEcTimer oTimeout;
+
+    S_bRecEnabled = EC_FALSE;
+    if (EC_NULL != S_pvSyncThread)
+    {
+        S_bSyncShutdown = EC_TRUE;
+        OsSetEvent(S_pvSyncEvent);
+        oTimeout.Start(2000);
+        while (S_bSyncThreadRunning && !oTimeout.IsElapsed())
+        {
+            OsSleep(10);
+        }
+        OsDeleteThreadHandle(S_pvSyncThread);
+        S_pvSyncThread = EC_NULL;
+    }
+    if (EC_NULL != S_pvSyncEvent)
+    {
+        OsDeleteEvent(S_pvSyncEvent);
+        S_pvSyncEvent = EC_NULL;
+    }
+    if (EC_NULL != S_pCurrent)
+    {
+        OsDbgMsg("PdRec: %d cycles recorded, current file %s_%d.bin, %d late rotations\n",
+            (EC_T_DWORD)S_qwCycle, PD_REC_FILE_NAME, S_pCurrent->dwFileIndex, S_dwNumLateRotations);
+    }
+    PdRecUnmapFile(S_pRetired);
+    PdRecUnmapFile(S_pNext);
+    PdRecUnmapFile(S_pCurrent);
+    S_pRetired = EC_NULL;
+    S_pNext    = EC_NULL;
+    S_pCurrent = EC_NULL;
+    SafeOsFree(S_aSlave);
+    S_dwMaxSlaves = 0;
+#endif
+}
+
+/********************************************************************************/
+/** \brief  Add a slave to the slave table of the files, needed to replay the records.
+*
+* Must be called after PdRecInit() before the first file is full.
+*
+* \return  EC_E_NOERROR on success, EC_E_NOMEMORY if the slave table sized by PdRecInit() is full.
+*/
+EC_T_DWORD PdRecAddSlave
+    (EC_T_CFG_SLAVE_INFO* pCfgSlaveInfo)    /**< [in]   slave information from ecatGetCfgSlaveInfo() */
+{
+T_PD_REC_SLAVE* pSlave = EC_NULL;
+
+    if (EC_NULL == S_pCurrent)
+    {
+        return EC_E_INVALIDSTATE;
+    }
+    if (S_oLayout.dwNumSlaves >= S_dwMaxSlaves)
+    {
+        return EC_E_NOMEMORY;
+    }
+    pSlave = &S_aSlave[S_oLayout.dwNumSlaves];
+    pSlave->dwSlaveId       = pCfgSlaveInfo->dwSlaveId;
+    pSlave->dwVendorId      = pCfgSlaveInfo->dwVendorId;
+    pSlave->dwProductCode   = pCfgSlaveInfo->dwProductCode;
+    pSlave->wStationAddress = pCfgSlaveInfo->wStationAddress;
+    pSlave->wAutoIncAddress = pCfgSlaveInfo->wAutoIncAddress;
+    pSlave->dwPdOffsIn      = pCfgSlaveInfo->dwPdOffsIn;
+    pSlave->dwPdSizeIn      = pCfgSlaveInfo->dwPdSizeIn;
+    pSlave->dwPdOffsOut     = pCfgSlaveInfo->dwPdOffsOut;
+    pSlave->dwPdSizeOut     = pCfgSlaveInfo->dwPdSizeOut;
+    S_oLayout.dwNumSlaves++;
+
+    /* the first file is already mapped, the next files copy the template */
+    OsMemcpy((EC_T_BYTE*)S_pCurrent + PD_REC_SLAVE_TABLE_OFFS, S_aSlave, S_oLayout.dwNumSlaves * sizeof(T_PD_REC_SLAVE));
+    S_pCurrent->dwNumSlaves = S_oLayout.dwNumSlaves;
+
+    return EC_E_NOERROR;
+}
+
+/********************************************************************************/
+/** \brief  Store one cycle. Called by the job task at the end of the cycle.
+*
+* Only memory copies, no system calls. If the current file is full and the
+* next one is not prepared yet, the current file is overwritten from the start.
+* The force masks are only copied in cycles with forced outputs.
+*
+* \return  N/A.
+*/
+EC_T_VOID PdRecRecord
+    (const EC_T_BYTE* pbyPDIn               /**< [in]   input process image */
+    ,const EC_T_BYTE* pbyPDOut              /**< [in]   output process image */
+    ,const EC_T_BYTE* pbyForceAnd           /**< [in]   AND mask of the forced outputs, EC_NULL: nothing forced */
+    ,const EC_T_BYTE* pbyForceOr            /**< [in]   OR mask of the forced outputs */
+    ,EC_T_UINT64     qwTimestamp            /**< [in]   cycle timestamp */
+    ,EC_T_DWORD      dwFlags                /**< [in]   PD_REC_FLAG_NO_RX, PD_REC_FLAG_FRAME_LOSS, PD_REC_FLAG_PIPELINED */
+    ,EC_T_DWORD      dwWkcErrors            /**< [in]   working counter errors notified since start */
+    ,EC_T_DWORD      dwAppTaskCycle)        /**< [in]   cycle of the application task table */
+{
+T_PD_REC_FILE_HEADER* pHeader  = S_pCurrent;
+T_PD_REC_RECORD*      pRecord  = EC_NULL;
+EC_T_BYTE*            pbyRecord = EC_NULL;
+
+    if (!S_bRecEnabled || (EC_NULL == pbyPDIn) || (EC_NULL == pbyPDOut))
+    {
+        return;
+    }
+    /* rotate if the sync thread prepared the next file and retired the previous one */
+    if (pHeader->qwNumWritten >= pHeader->dwNumRecords)
+    {
+        if ((EC_NULL != S_pNext) && (EC_NULL == S_pRetired))
+        {
+            S_pNext->qwFirstCycle = S_qwCycle;
+            S_pRetired = pHeader;
+            DEMO_MEMORY_BARRIER();
+            pHeader    = S_pNext;
+            S_pCurrent = pHeader;
+            S_pNext    = EC_NULL;
+            OsSetEvent(S_pvSyncEvent);
+        }
+        else if ((S_dwNumFiles > 1) && (pHeader->qwNumWritten == pHeader->dwNumRecords))
+        {
+            S_dwNumLateRotations++;
+        }
+    }
+    pbyRecord = ((EC_T_BYTE*)pHeader) + pHeader->dwHeaderSize
+              + (EC_T_DWORD)(pHeader->qwNumWritten % pHeader->dwNumRecords) * pHeader->dwRecordSize;
+    pRecord   = (T_PD_REC_RECORD*)pbyRecord;
+
+    pRecord->qwCycle     = S_qwCycle;
+    pRecord->qwTimestamp = qwTimestamp;
+    pRecord->dwFlags     = dwFlags | ((dwWkcErrors != S_dwLastWkcErrors) ? PD_REC_FLAG_WKC_ERROR : 0);
+    pRecord->dwWkcErrors = dwWkcErrors;
+    pRecord->dwAppTaskCycle = dwAppTaskCycle;
+    PdRecCopyNt(&pbyRecord[pHeader->dwInOffs], pbyPDIn, pHeader->dwInSize);
+    PdRecCopyNt(&pbyRecord[pHeader->dwOutOffs], pbyPDOut, pHeader->dwOutSize);
+    if ((EC_NULL != pbyForceAnd) && (0 != pHeader->dwForceOffs))
+    {
+        pRecord->dwFlags |= PD_REC_FLAG_FORCED;
+        PdRecCopyNt(&pbyRecord[pHeader->dwForceOffs], pbyForceAnd, pHeader->dwOutSize);
+        PdRecCopyNt(&pbyRecord[PD_REC_FORCE_OR_OFFS(pHeader)], pbyForceOr, pHeader->dwOutSize);
+    }
+#if (defined DEMO_SIMD_SSE2)
+    _mm_sfence();
+#endif
+    pHeader->qwNumWritten = pHeader->qwNumWritten + 1;
+    S_dwLastWkcErrors = dwWkcErrors;
+    S_qwCycle++;
+}
+
+/*-END OF SOURCE FILE--------------------------------------------------------*/
@@ -0,0 +1,131 @@
+/*-----------------------------------------------------------------------------
+ * ecatDemoPdRec.h
+ * Copyright                acontis technologies GmbH, Weingarten, Germany
+ * Response                 Stefan Zintgraf
+ * Description              cycle by cycle process data recorder into memory mapped ring files
+ *---------------------------------------------------------------------------*/
+
+#ifndef __ECATDEMOPDREC_H__
+#define __ECATDEMOPDREC_H__  1
+
+/*-INCLUDES------------------------------------------------------------------*/
+#include <AtEthercat.h>
+
+/*-DEFINES-------------------------------------------------------------------*/
+#if (defined LINUX) && !(defined RTAI)
+/* mmap() and msync() are available */
+#define PD_REC_SUPPORTED
+#endif
+
+#define PD_REC_MAGIC                0x43524345  /* "ECRC" */
+#define PD_REC_VERSION              2
+#define PD_REC_HEADER_SIZE          4096        /* minimum file header, the records start page aligned */
+#define PD_REC_FILE_NAME            "pdrec"     /* files are named pdrec_N.bin */
+#define PD_REC_DEFAULT_FILE_SIZE_MB 64
+#define PD_REC_DEFAULT_NUM_FILES    2
+#define PD_REC_MAX_FILE_SIZE_MB     4095        /* file size and offsets are 32 bit */
+#define PD_REC_SYNC_PERIOD          100         /* msync interval of the current file in msec */
+#define PD_REC_SLAVE_TABLE_OFFS     128         /* slave table in the file header */
+
+#define PD_REC_ALIGN(dwSize, dwAlign)   (((dwSize) + (dwAlign) - 1) & ~((dwAlign) - 1))
+#define PD_REC_FORCE_OR_OFFS(pHeader)   ((pHeader)->dwForceOffs + PD_REC_ALIGN((pHeader)->dwOutSize, 16))
+
+/* T_PD_REC_RECORD::dwFlags */
+#define PD_REC_FLAG_NO_RX           0x0001      /* eUsrJob_ProcessAllRxFrames failed, inputs not updated */
+#define PD_REC_FLAG_FRAME_LOSS      0x0002      /* not all frames of the previous cycle were received */
+#define PD_REC_FLAG_WKC_ERROR       0x0004      /* working counter error notified in this cycle */
+#define PD_REC_FLAG_FORCED          0x0008      /* forced output masks stored at dwForceOffs */
+#define PD_REC_FLAG_PIPELINED       0x0010      /* outputs were sent (and forced) before the application */
+
+/*-TYPEDEFS------------------------------------------------------------------*/
+/* start of each file, padded to dwHeaderSize (a multiple of PD_REC_HEADER_SIZE) */
+typedef struct _T_PD_REC_FILE_HEADER
+{
+    EC_T_DWORD          dwMagic;            /* PD_REC_MAGIC */
+    EC_T_DWORD          dwVersion;          /* PD_REC_VERSION */
+    EC_T_DWORD          dwHeaderSize;       /* offset of the first record, sized for the slave table */
+    EC_T_DWORD          dwRecordSize;       /* size of one record including images and padding */
+    EC_T_DWORD          dwInSize;           /* size of the input image in bytes */
+    EC_T_DWORD          dwOutSize;          /* size of the output image in bytes */
+    EC_T_DWORD          dwInOffs;           /* offset of the input image in a record */
+    EC_T_DWORD          dwOutOffs;          /* offset of the output image in a record */
+    EC_T_DWORD          dwNumRecords;       /* ring capacity of the file */
+    EC_T_DWORD          dwCycleTimeUsec;    /* bus cycle time */
+    EC_T_DWORD          dwFileIndex;        /* N of pdrec_N.bin */
+    EC_T_DWORD          dwNumSlaves;        /* entries in the slave table at PD_REC_SLAVE_TABLE_OFFS */
+    EC_T_UINT64         qwFirstCycle;       /* cycle of the first record written into this file */
+    volatile EC_T_UINT64 qwNumWritten;      /* records written since qwFirstCycle, the last dwNumRecords are kept */
+    EC_T_DWORD          dwForceOffs;        /* offset of the AND and OR force masks in a record, 0: no forcing */
+} T_PD_REC_FILE_HEADER;
+
+/* slave table entry, process data offsets and sizes in bits like EC_T_CFG_SLAVE_INFO */
+typedef struct _T_PD_REC_SLAVE
+{
+    EC_T_DWORD          dwSlaveId;
+    EC_T_DWORD          dwVendorId;
+    EC_T_DWORD          dwProductCode;
+    EC_T_WORD           wStationAddress;
+    EC_T_WORD           wAutoIncAddress;
+    EC_T_DWORD          dwPdOffsIn;
+    EC_T_DWORD          dwPdSizeIn;
+    EC_T_DWORD          dwPdOffsOut;
+    EC_T_DWORD          dwPdSizeOut;
+} T_PD_REC_SLAVE;
+
+/* start of each record, followed by the input and output image and the force masks */
+typedef struct _T_PD_REC_RECORD
+{
+    EC_T_UINT64         qwCycle;            /* cycle number since the recorder was started */
+    EC_T_UINT64         qwTimestamp;        /* wake up time of the cycle, CLOCK_MONOTONIC in nsec */
+    EC_T_DWORD          dwFlags;            /* PD_REC_FLAG_... */
+    EC_T_DWORD          dwWkcErrors;        /* working counter errors notified since start */
+    EC_T_DWORD          dwAppTaskCycle;     /* cycle of the application task table, for the replay */
+    EC_T_DWORD          dwReserved;
+} T_PD_REC_RECORD;
+
+/*-FUNCTION DECLARATION------------------------------------------------------*/
+EC_T_DWORD PdRecInit(
+    EC_T_DWORD    dwFileSizeMb          /**< [in]   size of each ring file in MByte */
+   ,EC_T_DWORD    dwNumFiles            /**< [in]   files used round robin, 1 = single ring file */
+   ,EC_T_DWORD    dwInSize              /**< [in]   recorded size of the input image in bytes */
+   ,EC_T_DWORD    dwOutSize             /**< [in]   recorded size of the output image in bytes */
+   ,EC_T_DWORD    dwCycleTimeUsec       /**< [in]   bus cycle time */
+   ,EC_T_DWORD    dwMaxSlaves           /**< [in]   capacity of the slave table */
+   ,EC_T_BOOL     bForce                /**< [in]   reserve room for the forced output masks */
+   ,EC_T_DWORD    dwSyncPrio            /**< [in]   priority of the sync thread */
+   ,EC_T_DWORD    dwSyncStackSize       /**< [in]   stack size of the sync thread */
+   );
+EC_T_VOID PdRecDeinit(
+    EC_T_VOID
+   );
+EC_T_DWORD PdRecAddSlave(
+    EC_T_CFG_SLAVE_INFO* pCfgSlaveInfo  /**< [in]   slave information from ecatGetCfgSlaveInfo() */
+   );
+EC_T_VOID PdRecRecord(
+    const
+    EC_T_BYTE*    pbyPDIn               /**< [in]   input process image */
+   ,const
+    EC_T_BYTE*    pbyPDOut              /**< [in]   output process image */
+   ,const
+    EC_T_BYTE*    pbyForceAnd           /**< [in]   AND mask of the forced outputs, EC_NULL: nothing forced */
+   ,const
+    EC_T_BYTE*    pbyForceOr            /**< [in]   OR mask of the forced outputs */
+   ,EC_T_UINT64   qwTimestamp           /**< [in]   cycle timestamp */
+   ,EC_T_DWORD    dwFlags               /**< [in]   PD_REC_FLAG_NO_RX, PD_REC_FLAG_FRAME_LOSS, PD_REC_FLAG_PIPELINED */
+   ,EC_T_DWORD    dwWkcErrors           /**< [in]   working counter errors notified since start */
+   ,EC_T_DWORD    dwAppTaskCycle        /**< [in]   cycle of the application task table */
+   );
+EC_T_DWORD PdRecRecordOffset(
+    const
+    T_PD_REC_FILE_HEADER* pHeader
+   ,EC_T_UINT64   qwCycle               /**< [in]   cycle number */
+   );
+const T_PD_REC_SLAVE* PdRecGetSlave(
+    const
+    T_PD_REC_FILE_HEADER* pHeader
+   ,EC_T_DWORD    dwSlaveIdx            /**< [in]   index in the slave table */
+   );
+
+#endif /*__ECATDEMOPDREC_H__*/
+
+/*-END OF SOURCE FILE--------------------------------------------------------*/
@@ -0,0 +1,304 @@
+/*-----------------------------------------------------------------------------
+ * ecatDemoPdReplay.cpp
+ * Copyright                acontis technologies GmbH, Weingarten, Germany
+ * Response                 Stefan Zintgraf
+ * Description              offline replay of recorded process data through the application
+ *---------------------------------------------------------------------------*/
+
+/*-INCLUDES------------------------------------------------------------------*/
+#include "ecatDemoPdReplay.h"
+#include "ecatDemoTiming.h"
+#include "ecatDemoHistogram.h"
+
+#if (defined PD_REPLAY_SUPPORTED)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/*-FUNCTION-DEFINITIONS------------------------------------------------------*/
+
+/********************************************************************************/
+/** \brief  Map a recorder file read only and check its layout.
+*
+* \return  EC_E_NOERROR on success, error code otherwise.
+*/
+EC_T_DWORD PdReplayOpen
+    (T_PD_REPLAY*    pDesc
+    ,const EC_T_CHAR* szFileName)           /**< [in]   recorder file, e.g. pdrec_0.bin */
+{
+#if (defined PD_REPLAY_SUPPORTED)
+EC_T_DWORD                  dwRetVal = EC_E_ERROR;
+int                         nFd      = -1;
+struct stat                 oStat;
+EC_T_VOID*                  pvMap    = MAP_FAILED;
+const T_PD_REC_FILE_HEADER* pHeader  = EC_NULL;
+EC_T_UINT64                 qwNumKept = 0;
+
+    OsMemset(pDesc, 0, sizeof(T_PD_REPLAY));
+    nFd = open(szFileName, O_RDONLY);
+    if ((nFd < 0) || (0 != fstat(nFd, &oStat)))
+    {
+        dwRetVal = EC_E_OPENFAILED;
+        goto Exit;
+    }
+    if (oStat.st_size < PD_REC_HEADER_SIZE)
+    {
+        dwRetVal = EC_E_INVALIDSIZE;
+        goto Exit;
+    }
+    pvMap = mmap(EC_NULL, (size_t)oStat.st_size, PROT_READ, MAP_PRIVATE, nFd, 0);
+    if (MAP_FAILED == pvMap)
+    {
+        dwRetVal = EC_E_NOMEMORY;
+        goto Exit;
+    }
+    pDesc->dwFileSize = (EC_T_DWORD)oStat.st_size;
+    pHeader = (const T_PD_REC_FILE_HEADER*)pvMap;
+    if ((PD_REC_MAGIC != pHeader->dwMagic) || (PD_REC_VERSION != pHeader->dwVersion)
+     || (0 == pHeader->dwCycleTimeUsec) || (pHeader->dwCycleTimeUsec > DEADLINE_MAX_CYCLE_TIME_USEC))
+    {
+        dwRetVal = EC_E_INVALIDDATA;
+        goto Exit;
+    }
+    if ((0 == pHeader->dwNumRecords) || (pHeader->dwRecordSize < pHeader->dwOutOffs + pHeader->dwOutSize)
+     || (pHeader->dwInOffs + pHeader->dwInSize > pHeader->dwOutOffs)
+     || (pHeader->dwHeaderSize < PD_REC_HEADER_SIZE)
+     || ((0 != pHeader->dwForceOffs) && ((pHeader->dwForceOffs < pHeader->dwOutOffs + pHeader->dwOutSize)
+                                      || (PD_REC_FORCE_OR_OFFS(pHeader) + pHeader->dwOutSize > pHeader->dwRecordSize)))
+     || (pHeader->dwHeaderSize + (EC_T_UINT64)pHeader->dwNumRecords * pHeader->dwRecordSize > pDesc->dwFileSize))
+    {
+        dwRetVal = EC_E_INVALIDSIZE;
+        goto Exit;
+    }
+    qwNumKept = EC_MIN(pHeader->qwNumWritten, (EC_T_UINT64)pHeader->dwNumRecords);
+    pDesc->qwEndCycle   = pHeader->qwFirstCycle + pHeader->qwNumWritten;
+    pDesc->qwFirstCycle = pDesc->qwEndCycle - qwNumKept;
+
+    /* at least one byte, the application may run without process data */
+    pDesc->pbyPDIn  = (EC_T_BYTE*)OsMalloc(pHeader->dwInSize + 1);
+    pDesc->pbyPDOut = (EC_T_BYTE*)OsMalloc(pHeader->dwOutSize + 1);
+    if ((EC_NULL == pDesc->pbyPDIn) || (EC_NULL == pDesc->pbyPDOut))
+    {
+        dwRetVal = EC_E_NOMEMORY;
+        goto Exit;
+    }
+    OsMemset(pDesc->pbyPDIn, 0, pHeader->dwInSize + 1);
+    OsMemset(pDesc->pbyPDOut, 0, pHeader->dwOutSize + 1);
+    pDesc->pHeader = pHeader;
+
+    dwRetVal = EC_E_NOERROR;
+Exit:
+    if (nFd >= 0)
+    {
+        /* the mapping stays valid without the descriptor */
+        close(nFd);
+    }
+    if (EC_E_NOERROR != dwRetVal)
+    {
+        if (MAP_FAILED != pvMap)
+        {
+            munmap(pvMap, pDesc->dwFileSize);
+        }
+        SafeOsFree(pDesc->pbyPDIn);
+        SafeOsFree(pDesc->pbyPDOut);
+        OsMemset(pDesc, 0, sizeof(T_PD_REPLAY));
+    }
+    return dwRetVal;
+#else
+    EC_UNREFPARM(szFileName);
+    OsMemset(pDesc, 0, sizeof(T_PD_REPLAY));
+    return EC_E_NOTSUPPORTED;
+#endif
+}
+
+/********************************************************************************/
+/** \brief  Unmap the recorder file and free the images.
+*
+* \return  N/A.
+*/
+EC_T_VOID PdReplayClose(T_PD_REPLAY* pDesc)
+{
+#if (defined PD_REPLAY_SUPPORTED)
+    if (EC_NULL != pDesc->pHeader)
+    {
+        munmap((EC_T_VOID*)pDesc->pHeader, pDesc->dwFileSize);
+    }
+#endif
+    SafeOsFree(pDesc->pbyPDIn);
+    SafeOsFree(pDesc->pbyPDOut);
+    pDesc->pHeader = EC_NULL;
+}
+
+/********************************************************************************/
+/** \brief  Get a slave of the recorded configuration, replaces ecatGetCfgSlaveInfo() in the replay.
+*
+* \return  EC_E_NOERROR on success, EC_E_NOTFOUND if the index is out of range.
+*/
+EC_T_DWORD PdReplayGetSlave
+    (T_PD_REPLAY*    pDesc
+    ,EC_T_DWORD      dwSlaveIdx             /**< [in]   index in the recorded slave table */
+    ,EC_T_CFG_SLAVE_INFO* pCfgSlaveInfo)    /**< [out]  recorded slave information, the other members are zero */
+{
+const T_PD_REC_SLAVE* pSlave = EC_NULL;
+
+    if (EC_NULL == pDesc->pHeader)
+    {
+        return EC_E_INVALIDSTATE;
+    }
+    pSlave = PdRecGetSlave(pDesc->pHeader, dwSlaveIdx);
+    if (EC_NULL == pSlave)
+    {
+        return EC_E_NOTFOUND;
+    }
+    OsMemset(pCfgSlaveInfo, 0, sizeof(EC_T_CFG_SLAVE_INFO));
+    pCfgSlaveInfo->dwSlaveId       = pSlave->dwSlaveId;
+    pCfgSlaveInfo->dwVendorId      = pSlave->dwVendorId;
+    pCfgSlaveInfo->dwProductCode   = pSlave->dwProductCode;
+    pCfgSlaveInfo->wStationAddress = pSlave->wStationAddress;
+    pCfgSlaveInfo->wAutoIncAddress = pSlave->wAutoIncAddress;
+    pCfgSlaveInfo->dwPdOffsIn      = pSlave->dwPdOffsIn;
+    pCfgSlaveInfo->dwPdSizeIn      = pSlave->dwPdSizeIn;
+    pCfgSlaveInfo->dwPdOffsOut     = pSlave->dwPdOffsOut;
+    pCfgSlaveInfo->dwPdSizeOut     = pSlave->dwPdSizeOut;
+
+    return EC_E_NOERROR;
+}
+
+/********************************************************************************/
+/** \brief  Apply the force masks of a record to the output image, like PdForceApply().
+*
+* \return  N/A.
+*/
+static EC_T_VOID PdReplayForce(T_PD_REPLAY* pDesc, const EC_T_BYTE* pbyRecord)
+{
+const T_PD_REC_FILE_HEADER* pHeader = pDesc->pHeader;
+const EC_T_BYTE*            pbyAnd  = &pbyRecord[pHeader->dwForceOffs];
+const EC_T_BYTE*            pbyOr   = &pbyRecord[PD_REC_FORCE_OR_OFFS(pHeader)];
+EC_T_DWORD                  dwIdx   = 0;
+
+    for (dwIdx = 0; dwIdx < pHeader->dwOutSize; dwIdx++)
+    {
+        pDesc->pbyPDOut[dwIdx] = (EC_T_BYTE)((pDesc->pbyPDOut[dwIdx] & pbyAnd[dwIdx]) | pbyOr[dwIdx]);
+    }
+}
+
+/********************************************************************************/
+/** \brief  Feed the recorded inputs cycle by cycle into the application and compare the outputs.
+*
+* The outputs of the oldest record are the initial output image. After a
+* difference the recorded outputs are restored, so each difference is reported
+* in the cycle where it happened. Recorded force masks are applied to the outputs
+* before the application (pipelined recording) or after it, like in the job task.
+*
+* \return  EC_E_NOERROR if all outputs match the recording, error code otherwise.
+*/
+EC_T_DWORD PdReplayRun
+    (T_PD_REPLAY*    pDesc
+    ,EC_T_BOOL       bPaced                 /**< [in]   EC_TRUE: one cycle per recorded bus cycle time, EC_FALSE: as fast as possible */
+    ,PF_PD_REPLAY_CYCLE pfnCycle            /**< [in]   application cycle */
+    ,EC_T_VOID*      pvContext              /**< [in]   passed to pfnCycle */
+    ,CAtEmLogging*   poLog)
+{
+EC_T_DWORD                  dwRetVal        = EC_E_ERROR;
+EC_T_DWORD                  dwRes           = EC_E_ERROR;
+const T_PD_REC_FILE_HEADER* pHeader         = pDesc->pHeader;
+const EC_T_BYTE*            pbyRecord       = EC_NULL;
+const EC_T_BYTE*            pbyRecOut       = EC_NULL;
+const T_PD_REC_RECORD*      pRecord         = EC_NULL;
+EC_T_BOOL                   bForce          = EC_FALSE;
+EC_T_UINT64                 qwCycle         = 0;
+EC_T_UINT64                 qwStart         = 0;
+EC_T_UINT64                 qwSumNsec       = 0;
+EC_T_DWORD                  dwNsec          = 0;
+EC_T_DWORD                  dwNumCycles     = 0;
+EC_T_DWORD                  dwNumDiffCycles = 0;
+EC_T_DWORD                  dwOffs          = 0;
+T_DEADLINE_TIMER            oTimer;
+T_LATENCY_HISTO             oHisto;
+
+    if (EC_NULL == pHeader)
+    {
+        return EC_E_INVALIDSTATE;
+    }
+    if ((pDesc->qwEndCycle - pDesc->qwFirstCycle) < 2)
+    {
+        poLog->LogError("Process data replay: less than 2 cycles recorded");
+        return EC_E_NOTFOUND;
+    }
+    /* the oldest record is the initial state */
+    pbyRecord = (const EC_T_BYTE*)pHeader + PdRecRecordOffset(pHeader, pDesc->qwFirstCycle);
+    OsMemcpy(pDesc->pbyPDIn, &pbyRecord[pHeader->dwInOffs], pHeader->dwInSize);
+    OsMemcpy(pDesc->pbyPDOut, &pbyRecord[pHeader->dwOutOffs], pHeader->dwOutSize);
+
+    LatencyHistoInit(&oHisto, (EC_T_DWORD)EC_MIN((EC_T_UINT64)pHeader->dwCycleTimeUsec * 1000, (EC_T_UINT64)0xFFFFFFFF));
+    DeadlineTimerInit(&oTimer, pHeader->dwCycleTimeUsec, 0);
+    for (qwCycle = pDesc->qwFirstCycle + 1; qwCycle < pDesc->qwEndCycle; qwCycle++)
+    {
+        if (bPaced)
+        {
+            DeadlineTimerWait(&oTimer);
+        }
+        if (OsTerminateAppRequest())
+        {
+            break;
+        }
+        pbyRecord = (const EC_T_BYTE*)pHeader + PdRecRecordOffset(pHeader, qwCycle);
+        pbyRecOut = &pbyRecord[pHeader->dwOutOffs];
+        pRecord   = (const T_PD_REC_RECORD*)pbyRecord;
+        bForce    = (0 != pHeader->dwForceOffs) && (0 != (pRecord->dwFlags & PD_REC_FLAG_FORCED));
+        OsMemcpy(pDesc->pbyPDIn, &pbyRecord[pHeader->dwInOffs], pHeader->dwInSize);
+
+        qwStart = DeadlineTimerGetTime();
+        if (bForce && (0 != (pRecord->dwFlags & PD_REC_FLAG_PIPELINED)))
+        {
+            PdReplayForce(pDesc, pbyRecord);
+        }
+        dwRes   = pfnCycle(pvContext, pRecord, pDesc->pbyPDIn, pDesc->pbyPDOut);
+        if (bForce && (0 == (pRecord->dwFlags & PD_REC_FLAG_PIPELINED)))
+        {
+            PdReplayForce(pDesc, pbyRecord);
+        }
+        dwNsec  = (EC_T_DWORD)EC_MIN(DeadlineTimerGetTime() - qwStart, (EC_T_UINT64)0xFFFFFFFF);
+        LatencyHistoRecord(&oHisto, dwNsec);
+        qwSumNsec += dwNsec;
+        dwNumCycles++;
+        if (EC_E_NOERROR != dwRes)
+        {
+            poLog->LogError("Process data replay: cycle %d failed: %s (0x%lx)", (EC_T_DWORD)qwCycle, ecatGetText(dwRes), dwRes);
+            dwRetVal = dwRes;
+            goto Exit;
+        }
+        if (0 != OsMemcmp(pDesc->pbyPDOut, pbyRecOut, pHeader->dwOutSize))
+        {
+            if (dwNumDiffCycles < PD_REPLAY_MAX_REPORTED_DIFFS)
+            {
+                for (dwOffs = 0; pDesc->pbyPDOut[dwOffs] == pbyRecOut[dwOffs]; dwOffs++)
+                {
+                }
+                poLog->LogMsg("Process data replay: cycle %d output byte %d is 0x%02x, recorded 0x%02x",
+                    (EC_T_DWORD)qwCycle, dwOffs, pDesc->pbyPDOut[dwOffs], pbyRecOut[dwOffs]);
+            }
+            dwNumDiffCycles++;
+            OsMemcpy(pDesc->pbyPDOut, pbyRecOut, pHeader->dwOutSize);
+        }
+    }
+    dwRetVal = (0 == dwNumDiffCycles) ? EC_E_NOERROR : EC_E_ERROR;
+
+Exit:
+    poLog->LogMsg("Process data replay: %d of %d cycles %s, %d cycles with different outputs",
+        dwNumCycles, (EC_T_DWORD)(pDesc->qwEndCycle - pDesc->qwFirstCycle - 1), (bPaced ? "paced" : "unpaced"), dwNumDiffCycles);
+    if (0 != dwNumCycles)
+    {
+        poLog->LogMsg("Process data replay: average cycle %d nsec", (EC_T_DWORD)(qwSumNsec / dwNumCycles));
+        LatencyHistoShow(&oHisto, poLog, "Cycle [nsec]          ", 1);
+    }
+    if (bPaced)
+    {
+        DeadlineTimerShow(&oTimer, poLog, "Replay timer          ");
+    }
+    return dwRetVal;
+}
+
+/*-END OF SOURCE FILE--------------------------------------------------------*/
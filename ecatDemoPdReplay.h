@@ -0,0 +1,61 @@
+/*-----------------------------------------------------------------------------
+ * ecatDemoPdReplay.h
+ * Copyright                acontis technologies GmbH, Weingarten, Germany
+ * Response                 Stefan Zintgraf
+ * Description              offline replay of recorded process data through the application
+ *---------------------------------------------------------------------------*/
+
+#ifndef __ECATDEMOPDREPLAY_H__
+#define __ECATDEMOPDREPLAY_H__  1
+
+/*-INCLUDES------------------------------------------------------------------*/
+#include "Logging.h"
+#include "ecatDemoPdRec.h"
+
+/*-DEFINES-------------------------------------------------------------------*/
+#if (defined PD_REC_SUPPORTED)
+#define PD_REPLAY_SUPPORTED
+#endif
+
+#define PD_REPLAY_MAX_REPORTED_DIFFS 10         /* cycles with output differences logged in detail */
+
+/*-TYPEDEFS------------------------------------------------------------------*/
+/* one application cycle: pbyPDIn holds the recorded inputs, pbyPDOut the outputs of the previous cycle */
+typedef EC_T_DWORD (*PF_PD_REPLAY_CYCLE)(EC_T_VOID* pvContext, const T_PD_REC_RECORD* pRecord, EC_T_BYTE* pbyPDIn, EC_T_BYTE* pbyPDOut);
+
+typedef struct _T_PD_REPLAY
+{
+    const
+    T_PD_REC_FILE_HEADER* pHeader;          /* recorder file, mapped read only */
+    EC_T_DWORD          dwFileSize;
+    EC_T_UINT64         qwFirstCycle;       /* oldest record kept in the file */
+    EC_T_UINT64         qwEndCycle;         /* cycle after the newest record */
+    EC_T_BYTE*          pbyPDIn;            /* images passed to the application */
+    EC_T_BYTE*          pbyPDOut;
+} T_PD_REPLAY;
+
+/*-FUNCTION DECLARATION------------------------------------------------------*/
+EC_T_DWORD PdReplayOpen(
+    T_PD_REPLAY*  pDesc
+   ,const
+    EC_T_CHAR*    szFileName            /**< [in]   recorder file, e.g. pdrec_0.bin */
+   );
+EC_T_VOID PdReplayClose(
+    T_PD_REPLAY*  pDesc
+   );
+EC_T_DWORD PdReplayGetSlave(
+    T_PD_REPLAY*  pDesc
+   ,EC_T_DWORD    dwSlaveIdx            /**< [in]   index in the recorded slave table */
+   ,EC_T_CFG_SLAVE_INFO* pCfgSlaveInfo  /**< [out]  recorded slave information, the other members are zero */
+   );
+EC_T_DWORD PdReplayRun(
+    T_PD_REPLAY*  pDesc
+   ,EC_T_BOOL     bPaced                /**< [in]   EC_TRUE: one cycle per recorded bus cycle time, EC_FALSE: as fast as possible */
+   ,PF_PD_REPLAY_CYCLE pfnCycle         /**< [in]   application cycle */
+   ,EC_T_VOID*    pvContext             /**< [in]   passed to pfnCycle */
+   ,CAtEmLogging* poLog
+   );
+
+#endif /*__ECATDEMOPDREPLAY_H__*/
+
+/*-END OF SOURCE FILE--------------------------------------------------------*/
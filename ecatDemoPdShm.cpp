@@ -0,0 +1,239 @@
+/*-----------------------------------------------------------------------------
+ * ecatDemoPdShm.cpp
+ * Copyright                acontis technologies GmbH, Weingarten, Germany
+ * Response                 Stefan Zintgraf
+ * Description              export of the process image to other processes via shared memory
+ *---------------------------------------------------------------------------*/
+
+/*-INCLUDES------------------------------------------------------------------*/
+#include "ecatDemoPdShm.h"
+#include "ecatDemoAtomic.h"
+
+#if (defined PD_SHM_SUPPORTED)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/*-DEFINES-------------------------------------------------------------------*/
+#define PD_SHM_ALIGN(dwSize)        (((dwSize) + PD_SHM_CACHE_LINE - 1) & ~(PD_SHM_CACHE_LINE - 1))
+
+/*-FUNCTION-DEFINITIONS------------------------------------------------------*/
+
+/********************************************************************************/
+/** \brief  Get the buffer written by the next publish.
+*
+* \return  buffer header.
+*/
+static T_PD_SHM_BUFFER* PdShmBuffer(T_PD_SHM_HEADER* pHeader, EC_T_DWORD dwNum)
+{
+    return (T_PD_SHM_BUFFER*)((EC_T_BYTE*)pHeader + pHeader->dwBufferOffs + (dwNum & (PD_SHM_NUM_BUFFERS - 1)) * pHeader->dwBufferStride);
+}
+
+/********************************************************************************/
+/** \brief  Create and map the named shared memory and write the layout.
+*
+* Readers reject the shared memory until PdShmEnable() is called.
+*
+* \return  EC_E_NOERROR on success, error code otherwise.
+*/
+EC_T_DWORD PdShmCreate
+    (T_PD_SHM*       pDesc
+    ,const EC_T_CHAR* szName                /**< [in]   shared memory name, e.g. PD_SHM_DEFAULT_NAME */
+    ,EC_T_DWORD      dwInSize               /**< [in]   exported size of the input image in bytes */
+    ,EC_T_DWORD      dwOutSize              /**< [in]   exported size of the output image in bytes */
+    ,EC_T_DWORD      dwMaxSlaves            /**< [in]   size of the slave table */
+    ,EC_T_DWORD      dwCycleTimeUsec)       /**< [in]   bus cycle time */
+{
+#if (defined PD_SHM_SUPPORTED)
+EC_T_DWORD       dwRetVal        = EC_E_ERROR;
+EC_T_DWORD       dwSlaveTableOffs = PD_SHM_ALIGN(sizeof(T_PD_SHM_HEADER));
+EC_T_DWORD       dwBufferOffs    = dwSlaveTableOffs + PD_SHM_ALIGN(dwMaxSlaves * sizeof(T_PD_SHM_SLAVE));
+EC_T_DWORD       dwOutOffs       = PD_SHM_CACHE_LINE + PD_SHM_ALIGN(dwInSize);
+EC_T_DWORD       dwBufferStride  = dwOutOffs + PD_SHM_ALIGN(dwOutSize);
+EC_T_DWORD       dwMapSize       = dwBufferOffs + PD_SHM_NUM_BUFFERS * dwBufferStride;
+int              nFd             = -1;
+EC_T_VOID*       pvMap           = MAP_FAILED;
+T_PD_SHM_HEADER* pHeader         = EC_NULL;
+
+    OsMemset(pDesc, 0, sizeof(T_PD_SHM));
+    OsSnprintf(pDesc->szName, sizeof(pDesc->szName) - 1, "%s", szName);
+
+    /* a stale segment of a crashed demo is replaced */
+    shm_unlink(pDesc->szName);
+    nFd = shm_open(pDesc->szName, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (nFd < 0)
+    {
+        dwRetVal = EC_E_OPENFAILED;
+        goto Exit;
+    }
+    if (0 != ftruncate(nFd, (off_t)dwMapSize))
+    {
+        dwRetVal = EC_E_NOMEMORY;
+        goto Exit;
+    }
+    pvMap = mmap(EC_NULL, dwMapSize, PROT_READ | PROT_WRITE, MAP_SHARED, nFd, 0);
+    if (MAP_FAILED == pvMap)
+    {
+        dwRetVal = EC_E_NOMEMORY;
+        goto Exit;
+    }
+    /* touch all pages now, the job task must not page fault */
+    OsMemset(pvMap, 0, dwMapSize);
+
+    pHeader = (T_PD_SHM_HEADER*)pvMap;
+    pHeader->dwVersion        = PD_SHM_VERSION;
+    pHeader->dwMapSize        = dwMapSize;
+    pHeader->dwCycleTimeUsec  = dwCycleTimeUsec;
+    pHeader->dwInSize         = dwInSize;
+    pHeader->dwOutSize        = dwOutSize;
+    pHeader->dwNumSlaves      = 0;
+    pHeader->dwSlaveTableOffs = dwSlaveTableOffs;
+    pHeader->dwNumBuffers     = PD_SHM_NUM_BUFFERS;
+    pHeader->dwBufferOffs     = dwBufferOffs;
+    pHeader->dwBufferStride   = dwBufferStride;
+    pHeader->dwOutOffs        = dwOutOffs;
+    pDesc->pHeader     = pHeader;
+    pDesc->dwMaxSlaves = dwMaxSlaves;
+
+    dwRetVal = EC_E_NOERROR;
+Exit:
+    if (nFd >= 0)
+    {
+        /* the mapping stays valid without the descriptor */
+        close(nFd);
+    }
+    if ((EC_E_NOERROR != dwRetVal) && (EC_E_OPENFAILED != dwRetVal))
+    {
+        if (MAP_FAILED != pvMap)
+        {
+            munmap(pvMap, dwMapSize);
+        }
+        shm_unlink(pDesc->szName);
+    }
+    return dwRetVal;
+#else
+    EC_UNREFPARM(szName);
+    EC_UNREFPARM(dwInSize);
+    EC_UNREFPARM(dwOutSize);
+    EC_UNREFPARM(dwMaxSlaves);
+    EC_UNREFPARM(dwCycleTimeUsec);
+    OsMemset(pDesc, 0, sizeof(T_PD_SHM));
+    return EC_E_NOTSUPPORTED;
+#endif
+}
+
+/********************************************************************************/
+/** \brief  Unmap and remove the shared memory. The job task must not run PdShmPublish() anymore.
+*
+* Readers which still have it mapped keep the last published images.
+*
+* \return  N/A.
+*/
+EC_T_VOID PdShmDestroy(T_PD_SHM* pDesc)
+{
+    pDesc->bEnabled = EC_FALSE;
+    DEMO_MEMORY_BARRIER();
+#if (defined PD_SHM_SUPPORTED)
+    if (EC_NULL != pDesc->pHeader)
+    {
+        munmap(pDesc->pHeader, pDesc->pHeader->dwMapSize);
+        shm_unlink(pDesc->szName);
+    }
+#endif
+    pDesc->pHeader = EC_NULL;
+}
+
+/********************************************************************************/
+/** \brief  Add a slave to the slave table.
+*
+* \return  EC_E_NOERROR on success, error code otherwise.
+*/
+EC_T_DWORD PdShmAddSlave
+    (T_PD_SHM*       pDesc
+    ,EC_T_CFG_SLAVE_INFO* pCfgSlaveInfo)    /**< [in]   slave information from ecatGetCfgSlaveInfo() */
+{
+T_PD_SHM_HEADER* pHeader = pDesc->pHeader;
+T_PD_SHM_SLAVE*  pSlave  = EC_NULL;
+
+    if ((EC_NULL == pHeader) || pDesc->bEnabled)
+    {
+        return EC_E_INVALIDSTATE;
+    }
+    if (pHeader->dwNumSlaves >= pDesc->dwMaxSlaves)
+    {
+        return EC_E_NOMEMORY;
+    }
+    pSlave = &((T_PD_SHM_SLAVE*)((EC_T_BYTE*)pHeader + pHeader->dwSlaveTableOffs))[pHeader->dwNumSlaves];
+    pSlave->dwSlaveId       = pCfgSlaveInfo->dwSlaveId;
+    pSlave->dwVendorId      = pCfgSlaveInfo->dwVendorId;
+    pSlave->dwProductCode   = pCfgSlaveInfo->dwProductCode;
+    pSlave->wStationAddress = pCfgSlaveInfo->wStationAddress;
+    pSlave->wAutoIncAddress = pCfgSlaveInfo->wAutoIncAddress;
+    pSlave->dwPdOffsIn      = pCfgSlaveInfo->dwPdOffsIn;
+    pSlave->dwPdSizeIn      = pCfgSlaveInfo->dwPdSizeIn;
+    pSlave->dwPdOffsOut     = pCfgSlaveInfo->dwPdOffsOut;
+    pSlave->dwPdSizeOut     = pCfgSlaveInfo->dwPdSizeOut;
+    OsSnprintf(pSlave->szName, sizeof(pSlave->szName) - 1, "%s", pCfgSlaveInfo->abyDeviceName);
+    pHeader->dwNumSlaves++;
+
+    return EC_E_NOERROR;
+}
+
+/********************************************************************************/
+/** \brief  Mark the layout valid for readers and start publishing.
+*
+* \return  N/A.
+*/
+EC_T_VOID PdShmEnable(T_PD_SHM* pDesc)
+{
+    if (EC_NULL == pDesc->pHeader)
+    {
+        return;
+    }
+    DEMO_MEMORY_BARRIER();
+    pDesc->pHeader->dwMagic = PD_SHM_MAGIC;
+    DEMO_MEMORY_BARRIER();
+    pDesc->bEnabled = EC_TRUE;
+}
+
+/********************************************************************************/
+/** \brief  Copy the images into the next buffer. Called by the job task at the end of the cycle.
+*
+* Same sequence protocol as PdSnapshotPublish(), readers in other processes never block the job task.
+*
+* \return  N/A.
+*/
+EC_T_VOID PdShmPublish
+    (T_PD_SHM*       pDesc
+    ,const EC_T_BYTE* pbyPDIn               /**< [in]   input process image */
+    ,const EC_T_BYTE* pbyPDOut              /**< [in]   output process image */
+    ,EC_T_UINT64     qwTimestamp)           /**< [in]   cycle timestamp */
+{
+T_PD_SHM_HEADER* pHeader = pDesc->pHeader;
+T_PD_SHM_BUFFER* pBuffer = EC_NULL;
+EC_T_DWORD       dwNum   = 0;
+
+    if (!pDesc->bEnabled || (EC_NULL == pbyPDIn) || (EC_NULL == pbyPDOut))
+    {
+        return;
+    }
+    dwNum   = pHeader->dwNumPublished;
+    pBuffer = PdShmBuffer(pHeader, dwNum);
+
+    pBuffer->dwSequence++;
+    DEMO_MEMORY_BARRIER();
+    OsMemcpy((EC_T_BYTE*)pBuffer + PD_SHM_CACHE_LINE, pbyPDIn, pHeader->dwInSize);
+    OsMemcpy((EC_T_BYTE*)pBuffer + pHeader->dwOutOffs, pbyPDOut, pHeader->dwOutSize);
+    pBuffer->dwCycle     = dwNum + 1;
+    pBuffer->qwTimestamp = qwTimestamp;
+    DEMO_MEMORY_BARRIER();
+    pBuffer->dwSequence++;
+
+    /* readers switch to the new buffer */
+    DEMO_MEMORY_BARRIER();
+    pHeader->dwNumPublished = dwNum + 1;
+}
+
+/*-END OF SOURCE FILE--------------------------------------------------------*/
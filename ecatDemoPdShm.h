@@ -0,0 +1,64 @@
+/*-----------------------------------------------------------------------------
+ * ecatDemoPdShm.h
+ * Copyright                acontis technologies GmbH, Weingarten, Germany
+ * Response                 Stefan Zintgraf
+ * Description              export of the process image to other processes via shared memory
+ *---------------------------------------------------------------------------*/
+
+#ifndef __ECATDEMOPDSHM_H__
+#define __ECATDEMOPDSHM_H__  1
+
+/*-INCLUDES------------------------------------------------------------------*/
+#include <AtEthercat.h>
+#include "ecatDemoPdShmReader.h"
+
+/*-DEFINES-------------------------------------------------------------------*/
+#if (defined LINUX) && !(defined RTAI)
+/* shm_open() and mmap() are available */
+#define PD_SHM_SUPPORTED
+#endif
+
+#define PD_SHM_DEFAULT_NAME         "/EcMasterDemoPd"
+#define PD_SHM_MAX_NAME_LEN         64
+
+/*-TYPEDEFS------------------------------------------------------------------*/
+typedef struct _T_PD_SHM
+{
+    volatile EC_T_BOOL  bEnabled;           /* set by PdShmEnable() */
+    EC_T_CHAR           szName[PD_SHM_MAX_NAME_LEN];
+    T_PD_SHM_HEADER*    pHeader;            /* start of the mapped shared memory */
+    EC_T_DWORD          dwMaxSlaves;        /* size of the slave table */
+} T_PD_SHM;
+
+/*-FUNCTION DECLARATION------------------------------------------------------*/
+EC_T_DWORD PdShmCreate(
+    T_PD_SHM*     pDesc
+   ,const
+    EC_T_CHAR*    szName                /**< [in]   shared memory name, e.g. PD_SHM_DEFAULT_NAME */
+   ,EC_T_DWORD    dwInSize              /**< [in]   exported size of the input image in bytes */
+   ,EC_T_DWORD    dwOutSize             /**< [in]   exported size of the output image in bytes */
+   ,EC_T_DWORD    dwMaxSlaves           /**< [in]   size of the slave table */
+   ,EC_T_DWORD    dwCycleTimeUsec       /**< [in]   bus cycle time */
+   );
+EC_T_VOID PdShmDestroy(
+    T_PD_SHM*     pDesc
+   );
+EC_T_DWORD PdShmAddSlave(
+    T_PD_SHM*     pDesc
+   ,EC_T_CFG_SLAVE_INFO* pCfgSlaveInfo  /**< [in]   slave information from ecatGetCfgSlaveInfo() */
+   );
+EC_T_VOID PdShmEnable(
+    T_PD_SHM*     pDesc
+   );
+EC_T_VOID PdShmPublish(
+    T_PD_SHM*     pDesc
+   ,const
+    EC_T_BYTE*    pbyPDIn               /**< [in]   input process image */
+   ,const
+    EC_T_BYTE*    pbyPDOut              /**< [in]   output process image */
+   ,EC_T_UINT64   qwTimestamp           /**< [in]   cycle timestamp */
+   );
+
+#endif /*__ECATDEMOPDSHM_H__*/
+
+/*-END OF SOURCE FILE--------------------------------------------------------*/
@@ -0,0 +1,234 @@
+/*-----------------------------------------------------------------------------
+ * ecatDemoPdShmReader.c
+ * Copyright                acontis technologies GmbH, Weingarten, Germany
+ * Response                 Stefan Zintgraf
+ * Description              reader library for the process data shared memory
+ *---------------------------------------------------------------------------*/
+
+/*-INCLUDES------------------------------------------------------------------*/
+#include "ecatDemoPdShmReader.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*-MACROS--------------------------------------------------------------------*/
+#define PD_SHM_READ_BARRIER()   __sync_synchronize()
+
+/*-FUNCTION-DEFINITIONS------------------------------------------------------*/
+
+/********************************************************************************/
+/** \brief  Map the shared memory of a running demo read-only.
+*
+* \return  0 on success, -1 if the shared memory does not exist or has an unknown layout.
+*/
+int PdShmReaderOpen
+    (T_PD_SHM_READER*    pReader
+    ,const char*         szName)            /**< [in]   shared memory name, e.g. "/EcMasterDemoPd" */
+{
+struct stat            oStat;
+void*                  pvMap   = MAP_FAILED;
+const T_PD_SHM_HEADER* pHeader = NULL;
+
+    memset(pReader, 0, sizeof(T_PD_SHM_READER));
+    pReader->nFd = shm_open(szName, O_RDONLY, 0);
+    if (pReader->nFd < 0)
+    {
+        goto Error;
+    }
+    if ((0 != fstat(pReader->nFd, &oStat)) || ((size_t)oStat.st_size < sizeof(T_PD_SHM_HEADER)))
+    {
+        goto Error;
+    }
+    pvMap = mmap(NULL, (size_t)oStat.st_size, PROT_READ, MAP_SHARED, pReader->nFd, 0);
+    if (MAP_FAILED == pvMap)
+    {
+        goto Error;
+    }
+    pReader->nMapSize = (size_t)oStat.st_size;
+
+    /* the writer sets the magic after the layout is complete */
+    pHeader = (const T_PD_SHM_HEADER*)pvMap;
+    if ((PD_SHM_MAGIC != pHeader->dwMagic) || (PD_SHM_VERSION != pHeader->dwVersion) || (pHeader->dwMapSize > pReader->nMapSize))
+    {
+        munmap(pvMap, pReader->nMapSize);
+        goto Error;
+    }
+    PD_SHM_READ_BARRIER();
+    pReader->pHeader = pHeader;
+
+    return 0;
+Error:
+    if (pReader->nFd >= 0)
+    {
+        close(pReader->nFd);
+    }
+    memset(pReader, 0, sizeof(T_PD_SHM_READER));
+    pReader->nFd = -1;
+    return -1;
+}
+
+/********************************************************************************/
+/** \brief  Unmap the shared memory.
+*
+* \return  N/A.
+*/
+void PdShmReaderClose(T_PD_SHM_READER* pReader)
+{
+    if (NULL != pReader->pHeader)
+    {
+        munmap((void*)pReader->pHeader, pReader->nMapSize);
+    }
+    if (pReader->nFd >= 0)
+    {
+        close(pReader->nFd);
+    }
+    memset(pReader, 0, sizeof(T_PD_SHM_READER));
+    pReader->nFd = -1;
+}
+
+/********************************************************************************/
+/** \brief  Get the process data location of a slave.
+*
+* \return  slave entry, NULL if the index is out of range.
+*/
+const T_PD_SHM_SLAVE* PdShmReaderGetSlave
+    (const T_PD_SHM_READER* pReader
+    ,uint32_t            dwIdx)             /**< [in]   slave index, 0 .. pHeader->dwNumSlaves - 1 */
+{
+    if (dwIdx >= pReader->pHeader->dwNumSlaves)
+    {
+        return NULL;
+    }
+    return &((const T_PD_SHM_SLAVE*)((const uint8_t*)pReader->pHeader + pReader->pHeader->dwSlaveTableOffs))[dwIdx];
+}
+
+/********************************************************************************/
+/** \brief  Start a zero-copy access to the latest published images.
+*
+* The images can be read in place with PdShmReaderInputs()/PdShmReaderOutputs().
+* Values read are only valid if PdShmReaderEnd() succeeds afterwards.
+*
+* \return  buffer of the latest images, NULL if nothing was published yet or the job task writes it right now.
+*/
+const T_PD_SHM_BUFFER* PdShmReaderBegin
+    (const T_PD_SHM_READER* pReader
+    ,uint32_t*           pdwSequence)       /**< [out]  sequence to pass to PdShmReaderEnd() */
+{
+const T_PD_SHM_HEADER* pHeader  = pReader->pHeader;
+const T_PD_SHM_BUFFER* pBuffer  = NULL;
+uint32_t               dwNum    = pHeader->dwNumPublished;
+
+    if (0 == dwNum)
+    {
+        return NULL;
+    }
+    PD_SHM_READ_BARRIER();
+    pBuffer = (const T_PD_SHM_BUFFER*)((const uint8_t*)pHeader + pHeader->dwBufferOffs
+                                      + ((dwNum - 1) & (pHeader->dwNumBuffers - 1)) * pHeader->dwBufferStride);
+    *pdwSequence = pBuffer->dwSequence;
+    if (*pdwSequence & 1)
+    {
+        return NULL;
+    }
+    PD_SHM_READ_BARRIER();
+
+    return pBuffer;
+}
+
+/********************************************************************************/
+/** \brief  Finish a zero-copy access.
+*
+* \return  1 if the values read since PdShmReaderBegin() are consistent, 0 if the buffer was overwritten.
+*/
+int PdShmReaderEnd
+    (const T_PD_SHM_BUFFER* pBuffer
+    ,uint32_t            dwSequence)        /**< [in]   sequence returned by PdShmReaderBegin() */
+{
+    PD_SHM_READ_BARRIER();
+    return (dwSequence == pBuffer->dwSequence);
+}
+
+/********************************************************************************/
+/** \brief  Get the input image of a buffer.
+*
+* \return  input image, pHeader->dwInSize bytes.
+*/
+const uint8_t* PdShmReaderInputs
+    (const T_PD_SHM_READER* pReader
+    ,const T_PD_SHM_BUFFER* pBuffer)
+{
+    (void)pReader;
+    return (const uint8_t*)pBuffer + PD_SHM_CACHE_LINE;
+}
+
+/********************************************************************************/
+/** \brief  Get the output image of a buffer.
+*
+* \return  output image, pHeader->dwOutSize bytes.
+*/
+const uint8_t* PdShmReaderOutputs
+    (const T_PD_SHM_READER* pReader
+    ,const T_PD_SHM_BUFFER* pBuffer)
+{
+    return (const uint8_t*)pBuffer + pReader->pHeader->dwOutOffs;
+}
+
+/********************************************************************************/
+/** \brief  Copy the latest consistent images.
+*
+* \return  0 on success, -1 if nothing was published yet or no consistent copy could be taken.
+*/
+int PdShmReaderRead
+    (const T_PD_SHM_READER* pReader
+    ,uint8_t*            pbyIn              /**< [out]  input image, pHeader->dwInSize bytes, may be NULL */
+    ,uint8_t*            pbyOut             /**< [out]  output image, pHeader->dwOutSize bytes, may be NULL */
+    ,uint32_t*           pdwCycle           /**< [out]  publish counter, may be NULL */
+    ,uint64_t*           pqwTimestamp)      /**< [out]  cycle timestamp, may be NULL */
+{
+const T_PD_SHM_BUFFER* pBuffer     = NULL;
+uint32_t               dwSequence  = 0;
+uint32_t               dwCycle     = 0;
+uint64_t               qwTimestamp = 0;
+int                    nRetry      = 0;
+
+    for (nRetry = 0; nRetry < PD_SHM_MAX_RETRIES; nRetry++)
+    {
+        if (0 == pReader->pHeader->dwNumPublished)
+        {
+            return -1;
+        }
+        pBuffer = PdShmReaderBegin(pReader, &dwSequence);
+        if (NULL == pBuffer)
+        {
+            continue;
+        }
+        if (NULL != pbyIn)
+        {
+            memcpy(pbyIn, PdShmReaderInputs(pReader, pBuffer), pReader->pHeader->dwInSize);
+        }
+        if (NULL != pbyOut)
+        {
+            memcpy(pbyOut, PdShmReaderOutputs(pReader, pBuffer), pReader->pHeader->dwOutSize);
+        }
+        dwCycle     = pBuffer->dwCycle;
+        qwTimestamp = pBuffer->qwTimestamp;
+        if (PdShmReaderEnd(pBuffer, dwSequence))
+        {
+            if (NULL != pdwCycle)
+            {
+                *pdwCycle = dwCycle;
+            }
+            if (NULL != pqwTimestamp)
+            {
+                *pqwTimestamp = qwTimestamp;
+            }
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/*-END OF SOURCE FILE--------------------------------------------------------*/
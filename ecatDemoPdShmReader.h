@@ -0,0 +1,123 @@
+/*-----------------------------------------------------------------------------
+ * ecatDemoPdShmReader.h
+ * Copyright                acontis technologies GmbH, Weingarten, Germany
+ * Response                 Stefan Zintgraf
+ * Description              layout of the process data shared memory and reader library
+ *
+ * The reader library is plain C and has no dependency on the EC-Master headers,
+ * it can be built into HMI or data logging processes running next to the demo.
+ *---------------------------------------------------------------------------*/
+
+#ifndef __ECATDEMOPDSHMREADER_H__
+#define __ECATDEMOPDSHMREADER_H__  1
+
+/*-INCLUDES------------------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*-DEFINES-------------------------------------------------------------------*/
+#define PD_SHM_MAGIC            0x44504345  /* "ECPD" */
+#define PD_SHM_VERSION          1
+#define PD_SHM_NUM_BUFFERS      2           /* written round robin, must be power of 2 */
+#define PD_SHM_CACHE_LINE       64          /* alignment of header, slave table and buffers */
+#define PD_SHM_SLAVE_NAME_LEN   64          /* including terminating zero */
+#define PD_SHM_MAX_RETRIES      100         /* PdShmReaderRead() gives up after this number of torn copies */
+
+/*-TYPEDEFS------------------------------------------------------------------*/
+/* start of the shared memory, written once before dwMagic is set */
+typedef struct _T_PD_SHM_HEADER
+{
+    volatile uint32_t   dwMagic;            /* PD_SHM_MAGIC when the layout is valid */
+    uint32_t            dwVersion;          /* PD_SHM_VERSION */
+    uint32_t            dwMapSize;          /* size of the shared memory in bytes */
+    uint32_t            dwCycleTimeUsec;    /* bus cycle time */
+    uint32_t            dwInSize;           /* size of the input image in bytes */
+    uint32_t            dwOutSize;          /* size of the output image in bytes */
+    uint32_t            dwNumSlaves;        /* entries in the slave table */
+    uint32_t            dwSlaveTableOffs;   /* offset of the T_PD_SHM_SLAVE table */
+    uint32_t            dwNumBuffers;       /* PD_SHM_NUM_BUFFERS */
+    uint32_t            dwBufferOffs;       /* offset of the first buffer */
+    uint32_t            dwBufferStride;     /* distance between two buffers */
+    uint32_t            dwOutOffs;          /* offset of the output image within a buffer */
+    uint8_t             abyReserved[PD_SHM_CACHE_LINE - 12 * sizeof(uint32_t)];
+    volatile uint32_t   dwNumPublished;     /* latest snapshot is in buffer (dwNumPublished - 1) */
+    uint8_t             abyReserved2[PD_SHM_CACHE_LINE - sizeof(uint32_t)];
+} T_PD_SHM_HEADER;
+
+/* process data location of a slave, from ecatGetCfgSlaveInfo() */
+typedef struct _T_PD_SHM_SLAVE
+{
+    uint32_t            dwSlaveId;
+    uint32_t            dwVendorId;
+    uint32_t            dwProductCode;
+    uint16_t            wStationAddress;
+    uint16_t            wAutoIncAddress;
+    uint32_t            dwPdOffsIn;         /* bit offset in the input image, 0xFFFFFFFF if none */
+    uint32_t            dwPdSizeIn;         /* size in bits */
+    uint32_t            dwPdOffsOut;        /* bit offset in the output image, 0xFFFFFFFF if none */
+    uint32_t            dwPdSizeOut;        /* size in bits */
+    char                szName[PD_SHM_SLAVE_NAME_LEN];
+} T_PD_SHM_SLAVE;
+
+/* header of each buffer, the input image follows in the next cache line */
+typedef struct _T_PD_SHM_BUFFER
+{
+    volatile uint32_t   dwSequence;         /* odd while the job task writes the buffer */
+    uint32_t            dwCycle;            /* publish counter of the stored images */
+    uint64_t            qwTimestamp;        /* wake up time of the cycle, CLOCK_MONOTONIC in nsec */
+} T_PD_SHM_BUFFER;
+
+typedef struct _T_PD_SHM_READER
+{
+    int                     nFd;
+    size_t                  nMapSize;
+    const T_PD_SHM_HEADER*  pHeader;        /* NULL if not open */
+} T_PD_SHM_READER;
+
+/*-FUNCTION DECLARATION------------------------------------------------------*/
+int PdShmReaderOpen(
+    T_PD_SHM_READER*    pReader
+   ,const char*         szName              /**< [in]   shared memory name, e.g. "/EcMasterDemoPd" */
+   );
+void PdShmReaderClose(
+    T_PD_SHM_READER*    pReader
+   );
+const T_PD_SHM_SLAVE* PdShmReaderGetSlave(
+    const T_PD_SHM_READER* pReader
+   ,uint32_t            dwIdx               /**< [in]   slave index, 0 .. pHeader->dwNumSlaves - 1 */
+   );
+const T_PD_SHM_BUFFER* PdShmReaderBegin(
+    const T_PD_SHM_READER* pReader
+   ,uint32_t*           pdwSequence         /**< [out]  sequence to pass to PdShmReaderEnd() */
+   );
+int PdShmReaderEnd(
+    const T_PD_SHM_BUFFER* pBuffer
+   ,uint32_t            dwSequence          /**< [in]   sequence returned by PdShmReaderBegin() */
+   );
+const uint8_t* PdShmReaderInputs(
+    const T_PD_SHM_READER* pReader
+   ,const T_PD_SHM_BUFFER* pBuffer
+   );
+const uint8_t* PdShmReaderOutputs(
+    const T_PD_SHM_READER* pReader
+   ,const T_PD_SHM_BUFFER* pBuffer
+   );
+int PdShmReaderRead(
+    const T_PD_SHM_READER* pReader
+   ,uint8_t*            pbyIn               /**< [out]  input image, pHeader->dwInSize bytes, may be NULL */
+   ,uint8_t*            pbyOut              /**< [out]  output image, pHeader->dwOutSize bytes, may be NULL */
+   ,uint32_t*           pdwCycle            /**< [out]  publish counter, may be NULL */
+   ,uint64_t*           pqwTimestamp        /**< [out]  cycle timestamp, may be NULL */
+   );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__ECATDEMOPDSHMREADER_H__*/
+
+/*-END OF SOURCE FILE--------------------------------------------------------*/
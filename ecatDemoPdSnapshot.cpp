@@ -0,0 +1,247 @@
+/*-----------------------------------------------------------------------------
+ * ecatDemoPdSnapshot.cpp
+ * Copyright                acontis technologies GmbH, Weingarten, Germany
+ * Response                 Stefan Zintgraf
+ * Description              consistent process image snapshots for non real-time readers
+ *---------------------------------------------------------------------------*/
+
+/*-INCLUDES------------------------------------------------------------------*/
+#include "ecatDemoPdSnapshot.h"
+#include "ecatDemoAtomic.h"
+
+/*-FUNCTION-DEFINITIONS------------------------------------------------------*/
+
+/********************************************************************************/
+/** \brief  Get the header of a snapshot buffer.
+*
+* \return  buffer header, the snapshot data follow after PD_SNAPSHOT_CACHE_LINE bytes.
+*/
+static T_PD_SNAPSHOT_BUFFER* PdSnapshotBuffer(T_PD_SNAPSHOT* pDesc, EC_T_DWORD dwNum)
+{
+    return (T_PD_SNAPSHOT_BUFFER*)(pDesc->pbyBuffers + (dwNum & (PD_SNAPSHOT_NUM_BUFFERS - 1)) * pDesc->dwBufferStride);
+}
+
+/********************************************************************************/
+/** \brief  Initialize an empty snapshot without ranges.
+*
+* \return  N/A.
+*/
+EC_T_VOID PdSnapshotInit(T_PD_SNAPSHOT* pDesc)
+{
+    OsMemset(pDesc, 0, sizeof(T_PD_SNAPSHOT));
+}
+
+/********************************************************************************/
+/** \brief  Free the buffers. The job task must not run PdSnapshotPublish() anymore.
+*
+* \return  N/A.
+*/
+EC_T_VOID PdSnapshotDeinit(T_PD_SNAPSHOT* pDesc)
+{
+    pDesc->bEnabled = EC_FALSE;
+    DEMO_MEMORY_BARRIER();
+    SafeOsFree(pDesc->pbyAlloc);
+    pDesc->pbyBuffers     = EC_NULL;
+    pDesc->dwNumRanges    = 0;
+    pDesc->dwSize         = 0;
+    pDesc->dwNumPublished = 0;
+}
+
+/********************************************************************************/
+/** \brief  Subscribe a range of the input or output image, rounded to full bytes.
+*
+* Ranges can only be added before PdSnapshotStart().
+*
+* \return  EC_E_NOERROR on success, error code otherwise.
+*/
+EC_T_DWORD PdSnapshotAddRange
+    (T_PD_SNAPSHOT*  pDesc
+    ,EC_T_BOOL       bOutput                /**< [in]   range of the output image */
+    ,EC_T_DWORD      dwPdOffs               /**< [in]   bit offset, EC_T_CFG_SLAVE_INFO::dwPdOffsIn/Out */
+    ,EC_T_DWORD      dwPdSize               /**< [in]   size in bits, EC_T_CFG_SLAVE_INFO::dwPdSizeIn/Out */
+    ,EC_T_DWORD*     pdwRangeIdx)           /**< [out]  range index for PdSnapshotRangeOffset() */
+{
+T_PD_SNAPSHOT_RANGE* pRange = EC_NULL;
+
+    if ((0 == dwPdSize) || (((EC_T_DWORD)-1) == dwPdOffs) || pDesc->bEnabled)
+    {
+        return EC_E_INVALIDPARM;
+    }
+    if (pDesc->dwNumRanges >= PD_SNAPSHOT_MAX_RANGES)
+    {
+        return EC_E_NOMEMORY;
+    }
+    pRange = &pDesc->aRange[pDesc->dwNumRanges];
+    pRange->bOutput        = bOutput;
+    pRange->dwImageOffs    = dwPdOffs / 8;
+    pRange->dwSize         = (dwPdOffs + dwPdSize + 7) / 8 - pRange->dwImageOffs;
+    pRange->dwSnapshotOffs = pDesc->dwSize;
+    pDesc->dwSize += pRange->dwSize;
+    *pdwRangeIdx = pDesc->dwNumRanges;
+    pDesc->dwNumRanges++;
+
+    return EC_E_NOERROR;
+}
+
+/********************************************************************************/
+/** \brief  Allocate the cache line aligned buffers and enable publishing.
+*
+* \return  EC_E_NOERROR on success, error code otherwise.
+*/
+EC_T_DWORD PdSnapshotStart(T_PD_SNAPSHOT* pDesc)
+{
+EC_T_DWORD dwDataSize = 0;
+
+    if (pDesc->bEnabled)
+    {
+        return EC_E_INVALIDSTATE;
+    }
+    /* header and data in separate cache lines, buffers do not share cache lines */
+    dwDataSize = (pDesc->dwSize + PD_SNAPSHOT_CACHE_LINE - 1) & ~(PD_SNAPSHOT_CACHE_LINE - 1);
+    pDesc->dwBufferStride = PD_SNAPSHOT_CACHE_LINE + dwDataSize;
+    pDesc->pbyAlloc = (EC_T_BYTE*)OsMalloc(PD_SNAPSHOT_NUM_BUFFERS * pDesc->dwBufferStride + PD_SNAPSHOT_CACHE_LINE);
+    if (EC_NULL == pDesc->pbyAlloc)
+    {
+        return EC_E_NOMEMORY;
+    }
+    OsMemset(pDesc->pbyAlloc, 0, PD_SNAPSHOT_NUM_BUFFERS * pDesc->dwBufferStride + PD_SNAPSHOT_CACHE_LINE);
+    pDesc->pbyBuffers = pDesc->pbyAlloc + ((PD_SNAPSHOT_CACHE_LINE - ((size_t)pDesc->pbyAlloc & (PD_SNAPSHOT_CACHE_LINE - 1))) & (PD_SNAPSHOT_CACHE_LINE - 1));
+    pDesc->dwNumPublished = 0;
+
+    /* buffers must be visible before the job task starts to publish */
+    DEMO_MEMORY_BARRIER();
+    pDesc->bEnabled = EC_TRUE;
+
+    return EC_E_NOERROR;
+}
+
+/********************************************************************************/
+/** \brief  Copy the subscribed ranges into the next buffer. Called by the job task at the end of the cycle.
+*
+* The writer never waits for readers. The buffer written is not the one of the latest
+* snapshot, so readers are only disturbed if they need longer than one cycle for the copy.
+*
+* \return  N/A.
+*/
+EC_T_VOID PdSnapshotPublish
+    (T_PD_SNAPSHOT*  pDesc
+    ,const EC_T_BYTE* pbyPDIn               /**< [in]   input process image */
+    ,const EC_T_BYTE* pbyPDOut              /**< [in]   output process image */
+    ,EC_T_UINT64     qwTimestamp)           /**< [in]   cycle timestamp */
+{
+EC_T_DWORD            dwNum    = 0;
+EC_T_DWORD            dwIdx    = 0;
+EC_T_BYTE*            pbyData  = EC_NULL;
+T_PD_SNAPSHOT_BUFFER* pBuffer  = EC_NULL;
+T_PD_SNAPSHOT_RANGE*  pRange   = EC_NULL;
+
+    if (!pDesc->bEnabled || (EC_NULL == pbyPDIn) || (EC_NULL == pbyPDOut))
+    {
+        return;
+    }
+    dwNum   = pDesc->dwNumPublished;
+    pBuffer = PdSnapshotBuffer(pDesc, dwNum);
+    pbyData = ((EC_T_BYTE*)pBuffer) + PD_SNAPSHOT_CACHE_LINE;
+
+    pBuffer->dwSequence++;
+    DEMO_MEMORY_BARRIER();
+    for (dwIdx = 0; dwIdx < pDesc->dwNumRanges; dwIdx++)
+    {
+        pRange = &pDesc->aRange[dwIdx];
+        OsMemcpy(&pbyData[pRange->dwSnapshotOffs], &(pRange->bOutput ? pbyPDOut : pbyPDIn)[pRange->dwImageOffs], pRange->dwSize);
+    }
+    pBuffer->dwCycle     = dwNum + 1;
+    pBuffer->qwTimestamp = qwTimestamp;
+    DEMO_MEMORY_BARRIER();
+    pBuffer->dwSequence++;
+
+    /* readers switch to the new buffer */
+    DEMO_MEMORY_BARRIER();
+    pDesc->dwNumPublished = dwNum + 1;
+}
+
+/********************************************************************************/
+/** \brief  Copy the latest snapshot. Can be called by any number of threads concurrently.
+*
+* The copy is retried if the job task overwrote the buffer in the meantime.
+*
+* \return  EC_E_NOERROR on success, EC_E_INVALIDSTATE if nothing was published yet,
+*          EC_E_BUSY if no consistent copy could be taken.
+*/
+EC_T_DWORD PdSnapshotRead
+    (T_PD_SNAPSHOT*  pDesc
+    ,EC_T_BYTE*      pbyDst                 /**< [out]  snapshot, PdSnapshotGetSize() bytes */
+    ,EC_T_DWORD      dwDstSize              /**< [in]   size of pbyDst in bytes */
+    ,EC_T_DWORD*     pdwCycle               /**< [out]  publish counter of the snapshot, may be EC_NULL */
+    ,EC_T_UINT64*    pqwTimestamp)          /**< [out]  cycle timestamp of the snapshot, may be EC_NULL */
+{
+EC_T_DWORD            dwNum       = 0;
+EC_T_DWORD            dwSequence  = 0;
+EC_T_DWORD            dwCycle     = 0;
+EC_T_UINT64           qwTimestamp = 0;
+EC_T_DWORD            dwRetry     = 0;
+T_PD_SNAPSHOT_BUFFER* pBuffer     = EC_NULL;
+
+    if (dwDstSize < pDesc->dwSize)
+    {
+        return EC_E_INVALIDSIZE;
+    }
+    for (dwRetry = 0; dwRetry < PD_SNAPSHOT_MAX_RETRIES; dwRetry++)
+    {
+        dwNum = pDesc->dwNumPublished;
+        if (!pDesc->bEnabled || (0 == dwNum))
+        {
+            return EC_E_INVALIDSTATE;
+        }
+        DEMO_MEMORY_BARRIER();
+        pBuffer    = PdSnapshotBuffer(pDesc, dwNum - 1);
+        dwSequence = pBuffer->dwSequence;
+        if (dwSequence & 1)
+        {
+            /* job task already overwrites it, take the next one */
+            continue;
+        }
+        DEMO_MEMORY_BARRIER();
+        OsMemcpy(pbyDst, ((EC_T_BYTE*)pBuffer) + PD_SNAPSHOT_CACHE_LINE, pDesc->dwSize);
+        dwCycle     = pBuffer->dwCycle;
+        qwTimestamp = pBuffer->qwTimestamp;
+        DEMO_MEMORY_BARRIER();
+        if (dwSequence == pBuffer->dwSequence)
+        {
+            if (EC_NULL != pdwCycle)
+            {
+                *pdwCycle = dwCycle;
+            }
+            if (EC_NULL != pqwTimestamp)
+            {
+                *pqwTimestamp = qwTimestamp;
+            }
+            return EC_E_NOERROR;
+        }
+    }
+    return EC_E_BUSY;
+}
+
+/********************************************************************************/
+/** \brief  Get the size of one snapshot.
+*
+* \return  size in bytes.
+*/
+EC_T_DWORD PdSnapshotGetSize(T_PD_SNAPSHOT* pDesc)
+{
+    return pDesc->dwSize;
+}
+
+/********************************************************************************/
+/** \brief  Get the position of a subscribed range in the snapshot.
+*
+* \return  byte offset in the snapshot.
+*/
+EC_T_DWORD PdSnapshotRangeOffset
+    (T_PD_SNAPSHOT*  pDesc
+    ,EC_T_DWORD      dwRangeIdx)            /**< [in]   index returned by PdSnapshotAddRange() */
+{
+    return pDesc->aRange[dwRangeIdx].dwSnapshotOffs;
+}
+
+/*-END OF SOURCE FILE--------------------------------------------------------*/
@@ -0,0 +1,94 @@
+/*-----------------------------------------------------------------------------
+ * ecatDemoPdSnapshot.h
+ * Copyright                acontis technologies GmbH, Weingarten, Germany
+ * Response                 Stefan Zintgraf
+ * Description              consistent process image snapshots for non real-time readers
+ *---------------------------------------------------------------------------*/
+
+#ifndef __ECATDEMOPDSNAPSHOT_H__
+#define __ECATDEMOPDSNAPSHOT_H__  1
+
+/*-INCLUDES------------------------------------------------------------------*/
+#ifndef INC_ECOS
+#include "EcOs.h"
+#endif
+
+/*-DEFINES-------------------------------------------------------------------*/
+#define PD_SNAPSHOT_MAX_RANGES      64      /* subscribed ranges of the input and output image */
+#define PD_SNAPSHOT_NUM_BUFFERS     2       /* written round robin, must be power of 2 */
+#define PD_SNAPSHOT_CACHE_LINE      64      /* alignment of the buffers */
+#define PD_SNAPSHOT_MAX_RETRIES     100     /* reader gives up after this number of torn copies */
+
+/*-TYPEDEFS------------------------------------------------------------------*/
+/* subscribed byte range of the input or output process image */
+typedef struct _T_PD_SNAPSHOT_RANGE
+{
+    EC_T_BOOL           bOutput;            /* range of the output image */
+    EC_T_DWORD          dwImageOffs;        /* byte offset in the process image */
+    EC_T_DWORD          dwSize;             /* size in bytes */
+    EC_T_DWORD          dwSnapshotOffs;     /* byte offset in the snapshot */
+} T_PD_SNAPSHOT_RANGE;
+
+/* header of each buffer, the ranges follow in the next cache line */
+typedef struct _T_PD_SNAPSHOT_BUFFER
+{
+    volatile EC_T_DWORD dwSequence;         /* odd while the job task writes the buffer */
+    EC_T_DWORD          dwCycle;            /* publish counter of the stored snapshot */
+    EC_T_UINT64         qwTimestamp;        /* cycle timestamp passed to PdSnapshotPublish() */
+} T_PD_SNAPSHOT_BUFFER;
+
+typedef struct _T_PD_SNAPSHOT
+{
+    volatile EC_T_BOOL  bEnabled;           /* set by PdSnapshotStart() */
+    volatile EC_T_DWORD dwNumPublished;     /* latest snapshot is in buffer (dwNumPublished - 1) */
+    T_PD_SNAPSHOT_RANGE aRange[PD_SNAPSHOT_MAX_RANGES];
+    EC_T_DWORD          dwNumRanges;
+    EC_T_DWORD          dwSize;             /* size of one snapshot in bytes */
+    EC_T_DWORD          dwBufferStride;     /* distance between two buffers in bytes */
+    EC_T_BYTE*          pbyAlloc;
+    EC_T_BYTE*          pbyBuffers;         /* pbyAlloc aligned to PD_SNAPSHOT_CACHE_LINE */
+} T_PD_SNAPSHOT;
+
+/*-FUNCTION DECLARATION------------------------------------------------------*/
+EC_T_VOID PdSnapshotInit(
+    T_PD_SNAPSHOT* pDesc
+   );
+EC_T_VOID PdSnapshotDeinit(
+    T_PD_SNAPSHOT* pDesc
+   );
+EC_T_DWORD PdSnapshotAddRange(
+    T_PD_SNAPSHOT* pDesc
+   ,EC_T_BOOL     bOutput               /**< [in]   range of the output image */
+   ,EC_T_DWORD    dwPdOffs              /**< [in]   bit offset, EC_T_CFG_SLAVE_INFO::dwPdOffsIn/Out */
+   ,EC_T_DWORD    dwPdSize              /**< [in]   size in bits, EC_T_CFG_SLAVE_INFO::dwPdSizeIn/Out */
+   ,EC_T_DWORD*   pdwRangeIdx           /**< [out]  range index for PdSnapshotRangeOffset() */
+   );
+EC_T_DWORD PdSnapshotStart(
+    T_PD_SNAPSHOT* pDesc
+   );
+EC_T_VOID PdSnapshotPublish(
+    T_PD_SNAPSHOT* pDesc
+   ,const
+    EC_T_BYTE*    pbyPDIn               /**< [in]   input process image */
+   ,const
+    EC_T_BYTE*    pbyPDOut              /**< [in]   output process image */
+   ,EC_T_UINT64   qwTimestamp           /**< [in]   cycle timestamp */
+   );
+EC_T_DWORD PdSnapshotRead(
+    T_PD_SNAPSHOT* pDesc
+   ,EC_T_BYTE*    pbyDst                /**< [out]  snapshot, PdSnapshotGetSize() bytes */
+   ,EC_T_DWORD    dwDstSize             /**< [in]   size of pbyDst in bytes */
+   ,EC_T_DWORD*   pdwCycle              /**< [out]  publish counter of the snapshot, may be EC_NULL */
+   ,EC_T_UINT64*  pqwTimestamp          /**< [out]  cycle timestamp of the snapshot, may be EC_NULL */
+   );
+EC_T_DWORD PdSnapshotGetSize(
+    T_PD_SNAPSHOT* pDesc
+   );
+EC_T_DWORD PdSnapshotRangeOffset(
+    T_PD_SNAPSHOT* pDesc
+   ,EC_T_DWORD    dwRangeIdx            /**< [in]   index returned by PdSnapshotAddRange() */
+   );
+
+#endif /*__ECATDEMOPDSNAPSHOT_H__*/
+
+/*-END OF SOURCE FILE--------------------------------------------------------*/
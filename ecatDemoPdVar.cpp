@@ -0,0 +1,66 @@
+/*-----------------------------------------------------------------------------
+ * ecatDemoPdVar.cpp
+ * Copyright                acontis technologies GmbH, Weingarten, Germany
+ * Response                 Stefan Zintgraf
+ * Description              pre-resolved, typed process data variables
+ *---------------------------------------------------------------------------*/
+
+/*-INCLUDES------------------------------------------------------------------*/
+#include "ecatDemoPdVar.h"
+
+/*-LOCAL VARIABLES-----------------------------------------------------------*/
+/* accessed by unbound variables, large enough for the biggest value type */
+static EC_T_BYTE S_abyUnboundStorage[8];
+
+/*-FUNCTION-DEFINITIONS------------------------------------------------------*/
+
+/********************************************************************************/
+/** \brief  Resolve the location of a slave variable in the process image.
+*
+* Call this once after the master is configured, e.g. in myAppPrepare().
+*
+* \return  EC_E_NOERROR on success, EC_E_NOTFOUND if the slave has no process data
+*          (ENI generated with GenPreopENI), EC_E_INVALIDPARM if the variable is
+*          outside of the slave process data.
+*/
+EC_T_DWORD PdVarLocate
+    (EC_T_BYTE*         pbyImage            /**< [in]   process image (input or output) */
+    ,EC_T_DWORD         dwSlavePdOffs       /**< [in]   slave offset in bits, EC_T_CFG_SLAVE_INFO::dwPdOffsIn/Out */
+    ,EC_T_DWORD         dwSlavePdSize       /**< [in]   slave size in bits, EC_T_CFG_SLAVE_INFO::dwPdSizeIn/Out */
+    ,EC_T_DWORD         dwBitOffs           /**< [in]   variable offset in bits relative to the slave */
+    ,EC_T_DWORD         dwBitSize           /**< [in]   variable size in bits */
+    ,T_PD_VAR_LOCATION* pLocation)          /**< [out]  location of the variable */
+{
+EC_T_DWORD dwRetVal = EC_E_ERROR;
+
+    OsMemset(pLocation, 0, sizeof(T_PD_VAR_LOCATION));
+    if ((EC_NULL == pbyImage) || (((EC_T_DWORD)-1) == dwSlavePdOffs))
+    {
+        dwRetVal = EC_E_NOTFOUND;
+        goto Exit;
+    }
+    if ((0 == dwBitSize) || ((dwBitOffs + dwBitSize) > dwSlavePdSize))
+    {
+        dwRetVal = EC_E_INVALIDPARM;
+        goto Exit;
+    }
+    pLocation->pbyByte    = &pbyImage[(dwSlavePdOffs + dwBitOffs) / 8];
+    pLocation->dwBitShift = (dwSlavePdOffs + dwBitOffs) % 8;
+    pLocation->dwBitSize  = dwBitSize;
+
+    dwRetVal = EC_E_NOERROR;
+Exit:
+    return dwRetVal;
+}
+
+/********************************************************************************/
+/** \brief  Get scratch buffer accessed by unbound variables.
+*
+* \return  scratch buffer.
+*/
+EC_T_BYTE* PdVarUnboundStorage(EC_T_VOID)
+{
+    return S_abyUnboundStorage;
+}
+
+/*-END OF SOURCE FILE--------------------------------------------------------*/
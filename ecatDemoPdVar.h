@@ -0,0 +1,172 @@
+/*-----------------------------------------------------------------------------
+ * ecatDemoPdVar.h
+ * Copyright                acontis technologies GmbH, Weingarten, Germany
+ * Response                 Stefan Zintgraf
+ * Description              pre-resolved, typed process data variables
+ *---------------------------------------------------------------------------*/
+
+#ifndef __ECATDEMOPDVAR_H__
+#define __ECATDEMOPDVAR_H__  1
+
+/*-INCLUDES------------------------------------------------------------------*/
+#include <AtEthercat.h>
+
+/*-TYPEDEFS------------------------------------------------------------------*/
+/* layout of a process data variable in the process image */
+typedef enum _T_PD_VAR_LAYOUT
+{
+    ePdVarLayout_Byte = 0,              /* byte aligned, size of the value type */
+    ePdVarLayout_Bit  = 1               /* bit packed, inside one or two bytes (digital channels) */
+} T_PD_VAR_LAYOUT;
+
+/* location of a variable in the process image, resolved once by PdVarLocate() */
+typedef struct _T_PD_VAR_LOCATION
+{
+    EC_T_BYTE*          pbyByte;            /* first byte of the variable in the process image */
+    EC_T_DWORD          dwBitShift;         /* bit offset inside the first byte */
+    EC_T_DWORD          dwBitSize;          /* size in bits */
+} T_PD_VAR_LOCATION;
+
+/*-FUNCTION DECLARATION------------------------------------------------------*/
+EC_T_DWORD PdVarLocate(
+    EC_T_BYTE*    pbyImage              /**< [in]   process image (input or output) */
+   ,EC_T_DWORD    dwSlavePdOffs         /**< [in]   slave offset in bits, EC_T_CFG_SLAVE_INFO::dwPdOffsIn/Out */
+   ,EC_T_DWORD    dwSlavePdSize         /**< [in]   slave size in bits, EC_T_CFG_SLAVE_INFO::dwPdSizeIn/Out */
+   ,EC_T_DWORD    dwBitOffs             /**< [in]   variable offset in bits relative to the slave */
+   ,EC_T_DWORD    dwBitSize             /**< [in]   variable size in bits */
+   ,T_PD_VAR_LOCATION* pLocation        /**< [out]  location of the variable */
+   );
+EC_T_BYTE* PdVarUnboundStorage(
+    EC_T_VOID
+   );
+
+/*-CLASS---------------------------------------------------------------------*/
+/* read/write values in process data byte order (little endian) */
+template <EC_T_DWORD dwSize> struct CPdVarFrm;
+template <> struct CPdVarFrm<1>
+{
+    typedef EC_T_BYTE T_RAW;
+    static T_RAW Get(const EC_T_BYTE* pbyVal)          { return *pbyVal; }
+    static EC_T_VOID Set(EC_T_BYTE* pbyVal, T_RAW byRaw) { *pbyVal = byRaw; }
+};
+template <> struct CPdVarFrm<2>
+{
+    typedef EC_T_WORD T_RAW;
+    static T_RAW Get(const EC_T_BYTE* pbyVal)          { return EC_GET_FRM_WORD(pbyVal); }
+    static EC_T_VOID Set(EC_T_BYTE* pbyVal, T_RAW wRaw)  { EC_SET_FRM_WORD(pbyVal, wRaw); }
+};
+template <> struct CPdVarFrm<4>
+{
+    typedef EC_T_DWORD T_RAW;
+    static T_RAW Get(const EC_T_BYTE* pbyVal)          { return EC_GET_FRM_DWORD(pbyVal); }
+    static EC_T_VOID Set(EC_T_BYTE* pbyVal, T_RAW dwRaw) { EC_SET_FRM_DWORD(pbyVal, dwRaw); }
+};
+
+/* typed process data variable.
+ * Bind() checks layout and size once, Get()/Set() do not check anything.
+ * An unbound variable accesses a scratch buffer instead of the process image,
+ * so Get()/Set() can be called without checking IsBound() each cycle.
+ */
+template <typename T, T_PD_VAR_LAYOUT eLayout> class CPdVar;
+
+/* byte aligned: one load or store, swapped on big endian systems only */
+template <typename T> class CPdVar<T, ePdVarLayout_Byte>
+{
+public:
+    CPdVar() { Unbind(); }
+
+    EC_T_DWORD Bind(const T_PD_VAR_LOCATION* pLocation)
+    {
+        Unbind();
+        if ((0 != pLocation->dwBitShift) || ((sizeof(T) * 8) != pLocation->dwBitSize))
+        {
+            return EC_E_INVALIDPARM;
+        }
+        m_pbyVal = pLocation->pbyByte;
+        return EC_E_NOERROR;
+    }
+    EC_T_VOID Unbind(EC_T_VOID)                 { m_pbyVal = PdVarUnboundStorage(); }
+    EC_T_BOOL IsBound(EC_T_VOID) const          { return (m_pbyVal != PdVarUnboundStorage()); }
+
+    T Get(EC_T_VOID) const
+    {
+    typename CPdVarFrm<sizeof(T)>::T_RAW oRaw = CPdVarFrm<sizeof(T)>::Get(m_pbyVal);
+    T oVal;
+
+        OsMemcpy(&oVal, &oRaw, sizeof(T));
+        return oVal;
+    }
+    EC_T_VOID Set(T oVal)
+    {
+    typename CPdVarFrm<sizeof(T)>::T_RAW oRaw;
+
+        OsMemcpy(&oRaw, &oVal, sizeof(T));
+        CPdVarFrm<sizeof(T)>::Set(m_pbyVal, oRaw);
+    }
+
+private:
+    EC_T_BYTE*  m_pbyVal;
+};
+
+/* bit packed inside one or two bytes: one 8 or 16 bit load (and store) with shift and mask.
+ * The second byte is only accessed if the variable spans it, e.g. an 8 bit slave
+ * behind a 4 bit slave, so a variable at the end of the process image is safe.
+ */
+template <typename T> class CPdVar<T, ePdVarLayout_Bit>
+{
+public:
+    CPdVar() { Unbind(); }
+
+    EC_T_DWORD Bind(const T_PD_VAR_LOCATION* pLocation)
+    {
+        Unbind();
+        if ((0 == pLocation->dwBitSize) || ((pLocation->dwBitShift + pLocation->dwBitSize) > 16) || (pLocation->dwBitSize > (sizeof(T) * 8)))
+        {
+            return EC_E_INVALIDPARM;
+        }
+        m_pbyVal  = pLocation->pbyByte;
+        m_byShift = (EC_T_BYTE)pLocation->dwBitShift;
+        m_wMask   = (EC_T_WORD)(0xFFFF >> (16 - pLocation->dwBitSize));
+        m_bSpan   = ((pLocation->dwBitShift + pLocation->dwBitSize) > 8) ? EC_TRUE : EC_FALSE;
+        return EC_E_NOERROR;
+    }
+    EC_T_VOID Unbind(EC_T_VOID)
+    {
+        m_pbyVal  = PdVarUnboundStorage();
+        m_byShift = 0;
+        m_wMask   = 0xFF;
+        m_bSpan   = EC_FALSE;
+    }
+    EC_T_BOOL IsBound(EC_T_VOID) const          { return (m_pbyVal != PdVarUnboundStorage()); }
+
+    T Get(EC_T_VOID) const
+    {
+    EC_T_WORD wRaw = m_bSpan ? EC_GET_FRM_WORD(m_pbyVal) : (EC_T_WORD)*m_pbyVal;
+
+        return (T)((wRaw >> m_byShift) & m_wMask);
+    }
+    EC_T_VOID Set(T oVal)
+    {
+    EC_T_WORD wMask = (EC_T_WORD)(m_wMask << m_byShift);
+    EC_T_WORD wBits = (EC_T_WORD)(((EC_T_WORD)oVal & m_wMask) << m_byShift);
+
+        if (m_bSpan)
+        {
+            EC_SET_FRM_WORD(m_pbyVal, (EC_T_WORD)((EC_GET_FRM_WORD(m_pbyVal) & ~wMask) | wBits));
+        }
+        else
+        {
+            *m_pbyVal = (EC_T_BYTE)((*m_pbyVal & ~wMask) | wBits);
+        }
+    }
+
+private:
+    EC_T_BYTE*  m_pbyVal;
+    EC_T_BYTE   m_byShift;
+    EC_T_WORD   m_wMask;
+    EC_T_BOOL   m_bSpan;                    /* variable spans two bytes */
+};
+
+#endif /*__ECATDEMOPDVAR_H__*/
+
+/*-END OF SOURCE FILE--------------------------------------------------------*/
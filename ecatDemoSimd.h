@@ -0,0 +1,39 @@
+/*-----------------------------------------------------------------------------
+ * ecatDemoSimd.h
+ * Copyright                acontis technologies GmbH, Weingarten, Germany
+ * Response                 Stefan Zintgraf
+ * Description              selection of the SIMD instruction set for the demo kernels
+ *---------------------------------------------------------------------------*/
+
+#ifndef __ECATDEMOSIMD_H__
+#define __ECATDEMOSIMD_H__  1
+
+/*-DEFINES-------------------------------------------------------------------*/
+/* the kernels are selected at compile time by the target instruction set,
+ * define DEMO_SIMD_DISABLE to use the scalar code only */
+#if (defined DEMO_SIMD_DISABLE)
+#elif (defined __AVX2__)
+#define DEMO_SIMD_AVX2
+#define DEMO_SIMD_SSE2
+#include <immintrin.h>
+#elif (defined __SSE2__) || (defined _M_X64) || ((defined _M_IX86_FP) && (_M_IX86_FP >= 2))
+#define DEMO_SIMD_SSE2
+#include <emmintrin.h>
+#elif (defined __aarch64__) && (defined __ARM_NEON)
+#define DEMO_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+#if (defined DEMO_SIMD_AVX2)
+#define DEMO_SIMD_NAME  "AVX2"
+#elif (defined DEMO_SIMD_SSE2)
+#define DEMO_SIMD_NAME  "SSE2"
+#elif (defined DEMO_SIMD_NEON)
+#define DEMO_SIMD_NAME  "NEON"
+#else
+#define DEMO_SIMD_NAME  "scalar"
+#endif
+
+#endif /*__ECATDEMOSIMD_H__*/
+
+/*-END OF SOURCE FILE--------------------------------------------------------*/
@@ -0,0 +1,241 @@
+/*-----------------------------------------------------------------------------
+ * ecatDemoSlaveRegistry.cpp
+ * Copyright                acontis technologies GmbH, Weingarten, Germany
+ * Response                 Stefan Zintgraf
+ * Description              registry of all configured slaves, structure of arrays
+ *---------------------------------------------------------------------------*/
+
+/*-INCLUDES------------------------------------------------------------------*/
+#include "ecatDemoSlaveRegistry.h"
+
+/*-DEFINES-------------------------------------------------------------------*/
+#define SLAVE_REGISTRY_MIN_HASH_SIZE    16
+
+/*-FUNCTION-DEFINITIONS------------------------------------------------------*/
+
+/********************************************************************************/
+/** \brief  Hash of a station address.
+*
+* \return  start position in the hash table.
+*/
+static EC_T_DWORD SlaveRegistryHashStation(T_SLAVE_REGISTRY* pDesc, EC_T_WORD wStationAddress)
+{
+    return (((EC_T_DWORD)wStationAddress * 0x9E3779B1) >> 16) & pDesc->dwHashMask;
+}
+
+/********************************************************************************/
+/** \brief  Hash of vendor, product and instance.
+*
+* \return  start position in the hash table.
+*/
+static EC_T_DWORD SlaveRegistryHashType(T_SLAVE_REGISTRY* pDesc, EC_T_DWORD dwVendorId, EC_T_DWORD dwProductCode, EC_T_DWORD dwInstance)
+{
+EC_T_DWORD dwHash = (dwVendorId * 0x9E3779B1) ^ (dwProductCode * 0x85EBCA77) ^ (dwInstance * 0xC2B2AE3D);
+
+    dwHash ^= dwHash >> 15;
+    dwHash *= 0x2C1B3C6D;
+    dwHash ^= dwHash >> 16;
+    return dwHash & pDesc->dwHashMask;
+}
+
+/********************************************************************************/
+/** \brief  Allocate the arrays for dwMaxSlaves slaves.
+*
+* \return  EC_E_NOERROR on success, error code otherwise.
+*/
+EC_T_DWORD SlaveRegistryInit
+    (T_SLAVE_REGISTRY* pDesc
+    ,EC_T_DWORD      dwMaxSlaves)           /**< [in]   maximum number of slaves */
+{
+EC_T_DWORD dwRetVal   = EC_E_ERROR;
+EC_T_DWORD dwHashSize = SLAVE_REGISTRY_MIN_HASH_SIZE;
+
+    OsMemset(pDesc, 0, sizeof(T_SLAVE_REGISTRY));
+    pDesc->dwMaxSlaves = dwMaxSlaves;
+
+    /* at most half of the hash entries are used, probe sequences stay short */
+    while (dwHashSize < (2 * dwMaxSlaves))
+    {
+        dwHashSize *= 2;
+    }
+    pDesc->dwHashMask = dwHashSize - 1;
+
+    pDesc->pdwPdOffsIn      = (EC_T_DWORD*)OsMalloc(dwMaxSlaves * sizeof(EC_T_DWORD) + 1);
+    pDesc->pdwPdSizeIn      = (EC_T_DWORD*)OsMalloc(dwMaxSlaves * sizeof(EC_T_DWORD) + 1);
+    pDesc->pdwPdOffsOut     = (EC_T_DWORD*)OsMalloc(dwMaxSlaves * sizeof(EC_T_DWORD) + 1);
+    pDesc->pdwPdSizeOut     = (EC_T_DWORD*)OsMalloc(dwMaxSlaves * sizeof(EC_T_DWORD) + 1);
+    pDesc->pwStationAddress = (EC_T_WORD*)OsMalloc(dwMaxSlaves * sizeof(EC_T_WORD) + 1);
+    pDesc->pdwVendorId      = (EC_T_DWORD*)OsMalloc(dwMaxSlaves * sizeof(EC_T_DWORD) + 1);
+    pDesc->pdwProductCode   = (EC_T_DWORD*)OsMalloc(dwMaxSlaves * sizeof(EC_T_DWORD) + 1);
+    pDesc->pdwInstance      = (EC_T_DWORD*)OsMalloc(dwMaxSlaves * sizeof(EC_T_DWORD) + 1);
+    pDesc->pCfgSlaveInfo    = (EC_T_CFG_SLAVE_INFO*)OsMalloc(dwMaxSlaves * sizeof(EC_T_CFG_SLAVE_INFO) + 1);
+    pDesc->pdwStationHash   = (EC_T_DWORD*)OsMalloc(dwHashSize * sizeof(EC_T_DWORD));
+    pDesc->pdwTypeHash      = (EC_T_DWORD*)OsMalloc(dwHashSize * sizeof(EC_T_DWORD));
+    if ((EC_NULL == pDesc->pdwPdOffsIn) || (EC_NULL == pDesc->pdwPdSizeIn) || (EC_NULL == pDesc->pdwPdOffsOut)
+     || (EC_NULL == pDesc->pdwPdSizeOut) || (EC_NULL == pDesc->pwStationAddress) || (EC_NULL == pDesc->pdwVendorId)
+     || (EC_NULL == pDesc->pdwProductCode) || (EC_NULL == pDesc->pdwInstance) || (EC_NULL == pDesc->pCfgSlaveInfo)
+     || (EC_NULL == pDesc->pdwStationHash) || (EC_NULL == pDesc->pdwTypeHash))
+    {
+        SlaveRegistryDeinit(pDesc);
+        dwRetVal = EC_E_NOMEMORY;
+        goto Exit;
+    }
+    OsMemset(pDesc->pdwStationHash, 0, dwHashSize * sizeof(EC_T_DWORD));
+    OsMemset(pDesc->pdwTypeHash, 0, dwHashSize * sizeof(EC_T_DWORD));
+
+    dwRetVal = EC_E_NOERROR;
+Exit:
+    return dwRetVal;
+}
+
+/********************************************************************************/
+/** \brief  Free the arrays.
+*
+* \return  N/A.
+*/
+EC_T_VOID SlaveRegistryDeinit(T_SLAVE_REGISTRY* pDesc)
+{
+    SafeOsFree(pDesc->pdwPdOffsIn);
+    SafeOsFree(pDesc->pdwPdSizeIn);
+    SafeOsFree(pDesc->pdwPdOffsOut);
+    SafeOsFree(pDesc->pdwPdSizeOut);
+    SafeOsFree(pDesc->pwStationAddress);
+    SafeOsFree(pDesc->pdwVendorId);
+    SafeOsFree(pDesc->pdwProductCode);
+    SafeOsFree(pDesc->pdwInstance);
+    SafeOsFree(pDesc->pCfgSlaveInfo);
+    SafeOsFree(pDesc->pdwStationHash);
+    SafeOsFree(pDesc->pdwTypeHash);
+    pDesc->dwNumSlaves = 0;
+    pDesc->dwMaxSlaves = 0;
+}
+
+/********************************************************************************/
+/** \brief  Add a configured slave. Slaves are added in configuration order.
+*
+* \return  EC_E_NOERROR on success, EC_E_NOMEMORY if the registry is full, EC_E_INVALIDPARM on duplicate station addresses.
+*/
+EC_T_DWORD SlaveRegistryAdd
+    (T_SLAVE_REGISTRY* pDesc
+    ,const EC_T_CFG_SLAVE_INFO* pCfgSlaveInfo /**< [in]   configured slave */
+    ,EC_T_DWORD*     pdwSlaveIdx)           /**< [out]  index in the registry arrays */
+{
+EC_T_DWORD dwSlaveIdx = pDesc->dwNumSlaves;
+EC_T_DWORD dwInstance = 0;
+EC_T_DWORD dwPos      = 0;
+
+    if (dwSlaveIdx >= pDesc->dwMaxSlaves)
+    {
+        return EC_E_NOMEMORY;
+    }
+    if (SLAVE_REGISTRY_NOT_FOUND != SlaveRegistryFindByStation(pDesc, pCfgSlaveInfo->wStationAddress))
+    {
+        return EC_E_INVALIDPARM;
+    }
+    /* next free instance number of this type, only done while the registry is built */
+    while (SLAVE_REGISTRY_NOT_FOUND != SlaveRegistryFindByType(pDesc, pCfgSlaveInfo->dwVendorId, pCfgSlaveInfo->dwProductCode, dwInstance))
+    {
+        dwInstance++;
+    }
+    pDesc->pdwPdOffsIn[dwSlaveIdx]      = pCfgSlaveInfo->dwPdOffsIn;
+    pDesc->pdwPdSizeIn[dwSlaveIdx]      = pCfgSlaveInfo->dwPdSizeIn;
+    pDesc->pdwPdOffsOut[dwSlaveIdx]     = pCfgSlaveInfo->dwPdOffsOut;
+    pDesc->pdwPdSizeOut[dwSlaveIdx]     = pCfgSlaveInfo->dwPdSizeOut;
+    pDesc->pwStationAddress[dwSlaveIdx] = pCfgSlaveInfo->wStationAddress;
+    pDesc->pdwVendorId[dwSlaveIdx]      = pCfgSlaveInfo->dwVendorId;
+    pDesc->pdwProductCode[dwSlaveIdx]   = pCfgSlaveInfo->dwProductCode;
+    pDesc->pdwInstance[dwSlaveIdx]      = dwInstance;
+    OsMemcpy(&pDesc->pCfgSlaveInfo[dwSlaveIdx], pCfgSlaveInfo, sizeof(EC_T_CFG_SLAVE_INFO));
+
+    /* linear probing, the tables are never full */
+    for (dwPos = SlaveRegistryHashStation(pDesc, pCfgSlaveInfo->wStationAddress); 0 != pDesc->pdwStationHash[dwPos]; dwPos = (dwPos + 1) & pDesc->dwHashMask)
+    {
+    }
+    pDesc->pdwStationHash[dwPos] = dwSlaveIdx + 1;
+    for (dwPos = SlaveRegistryHashType(pDesc, pCfgSlaveInfo->dwVendorId, pCfgSlaveInfo->dwProductCode, dwInstance); 0 != pDesc->pdwTypeHash[dwPos]; dwPos = (dwPos + 1) & pDesc->dwHashMask)
+    {
+    }
+    pDesc->pdwTypeHash[dwPos] = dwSlaveIdx + 1;
+
+    pDesc->dwNumSlaves++;
+    if (EC_NULL != pdwSlaveIdx)
+    {
+        *pdwSlaveIdx = dwSlaveIdx;
+    }
+    return EC_E_NOERROR;
+}
+
+/********************************************************************************/
+/** \brief  Find a slave by its station address.
+*
+* \return  index in the registry arrays, SLAVE_REGISTRY_NOT_FOUND if not configured.
+*/
+EC_T_DWORD SlaveRegistryFindByStation
+    (T_SLAVE_REGISTRY* pDesc
+    ,EC_T_WORD       wStationAddress)       /**< [in]   station address */
+{
+EC_T_DWORD dwPos      = 0;
+EC_T_DWORD dwSlaveIdx = 0;
+
+    if (EC_NULL == pDesc->pdwStationHash)
+    {
+        return SLAVE_REGISTRY_NOT_FOUND;
+    }
+    for (dwPos = SlaveRegistryHashStation(pDesc, wStationAddress); 0 != pDesc->pdwStationHash[dwPos]; dwPos = (dwPos + 1) & pDesc->dwHashMask)
+    {
+        dwSlaveIdx = pDesc->pdwStationHash[dwPos] - 1;
+        if (wStationAddress == pDesc->pwStationAddress[dwSlaveIdx])
+        {
+            return dwSlaveIdx;
+        }
+    }
+    return SLAVE_REGISTRY_NOT_FOUND;
+}
+
+/********************************************************************************/
+/** \brief  Find a slave by vendor id, product code and instance number.
+*
+* \return  index in the registry arrays, SLAVE_REGISTRY_NOT_FOUND if not configured.
+*/
+EC_T_DWORD SlaveRegistryFindByType
+    (T_SLAVE_REGISTRY* pDesc
+    ,EC_T_DWORD      dwVendorId             /**< [in]   vendor id */
+    ,EC_T_DWORD      dwProductCode          /**< [in]   product code */
+    ,EC_T_DWORD      dwInstance)            /**< [in]   0: first slave of this type in the configuration, 1: second, ... */
+{
+EC_T_DWORD dwPos      = 0;
+EC_T_DWORD dwSlaveIdx = 0;
+
+    if (EC_NULL == pDesc->pdwTypeHash)
+    {
+        return SLAVE_REGISTRY_NOT_FOUND;
+    }
+    for (dwPos = SlaveRegistryHashType(pDesc, dwVendorId, dwProductCode, dwInstance); 0 != pDesc->pdwTypeHash[dwPos]; dwPos = (dwPos + 1) & pDesc->dwHashMask)
+    {
+        dwSlaveIdx = pDesc->pdwTypeHash[dwPos] - 1;
+        if ((dwVendorId == pDesc->pdwVendorId[dwSlaveIdx]) && (dwProductCode == pDesc->pdwProductCode[dwSlaveIdx])
+         && (dwInstance == pDesc->pdwInstance[dwSlaveIdx]))
+        {
+            return dwSlaveIdx;
+        }
+    }
+    return SLAVE_REGISTRY_NOT_FOUND;
+}
+
+/********************************************************************************/
+/** \brief  Get the complete configuration of a slave.
+*
+* \return  slave information, EC_NULL if the index is out of range.
+*/
+const EC_T_CFG_SLAVE_INFO* SlaveRegistryGetCfgSlaveInfo
+    (T_SLAVE_REGISTRY* pDesc
+    ,EC_T_DWORD      dwSlaveIdx)            /**< [in]   index in the registry arrays */
+{
+    if (dwSlaveIdx >= pDesc->dwNumSlaves)
+    {
+        return EC_NULL;
+    }
+    return &pDesc->pCfgSlaveInfo[dwSlaveIdx];
+}
+
+/*-END OF SOURCE FILE--------------------------------------------------------*/
@@ -0,0 +1,68 @@
+/*-----------------------------------------------------------------------------
+ * ecatDemoSlaveRegistry.h
+ * Copyright                acontis technologies GmbH, Weingarten, Germany
+ * Response                 Stefan Zintgraf
+ * Description              registry of all configured slaves, structure of arrays
+ *---------------------------------------------------------------------------*/
+
+#ifndef __ECATDEMOSLAVEREGISTRY_H__
+#define __ECATDEMOSLAVEREGISTRY_H__  1
+
+/*-INCLUDES------------------------------------------------------------------*/
+#include <AtEthercat.h>
+
+/*-DEFINES-------------------------------------------------------------------*/
+#define SLAVE_REGISTRY_NOT_FOUND    ((EC_T_DWORD)0xFFFFFFFF)
+
+/*-TYPEDEFS------------------------------------------------------------------*/
+/* one entry per slave in each array, index = position in the configuration */
+typedef struct _T_SLAVE_REGISTRY
+{
+    EC_T_DWORD          dwMaxSlaves;
+    EC_T_DWORD          dwNumSlaves;
+    EC_T_DWORD*         pdwPdOffsIn;        /* bit offset in the input image, EC_T_CFG_SLAVE_INFO::dwPdOffsIn */
+    EC_T_DWORD*         pdwPdSizeIn;        /* size in bits */
+    EC_T_DWORD*         pdwPdOffsOut;       /* bit offset in the output image */
+    EC_T_DWORD*         pdwPdSizeOut;
+    EC_T_WORD*          pwStationAddress;
+    EC_T_DWORD*         pdwVendorId;
+    EC_T_DWORD*         pdwProductCode;
+    EC_T_DWORD*         pdwInstance;        /* 0: first slave of this vendor and product, 1: second, ... */
+    EC_T_CFG_SLAVE_INFO* pCfgSlaveInfo;     /* complete information, not needed cyclically */
+    EC_T_DWORD          dwHashMask;         /* number of hash entries - 1 */
+    EC_T_DWORD*         pdwStationHash;     /* slave index + 1 by station address, 0 = empty */
+    EC_T_DWORD*         pdwTypeHash;        /* slave index + 1 by vendor, product and instance, 0 = empty */
+} T_SLAVE_REGISTRY;
+
+/*-FUNCTION DECLARATION------------------------------------------------------*/
+EC_T_DWORD SlaveRegistryInit(
+    T_SLAVE_REGISTRY* pDesc
+   ,EC_T_DWORD    dwMaxSlaves           /**< [in]   maximum number of slaves */
+   );
+EC_T_VOID SlaveRegistryDeinit(
+    T_SLAVE_REGISTRY* pDesc
+   );
+EC_T_DWORD SlaveRegistryAdd(
+    T_SLAVE_REGISTRY* pDesc
+   ,const
+    EC_T_CFG_SLAVE_INFO* pCfgSlaveInfo  /**< [in]   configured slave */
+   ,EC_T_DWORD*   pdwSlaveIdx           /**< [out]  index in the registry arrays */
+   );
+EC_T_DWORD SlaveRegistryFindByStation(
+    T_SLAVE_REGISTRY* pDesc
+   ,EC_T_WORD     wStationAddress       /**< [in]   station address */
+   );
+EC_T_DWORD SlaveRegistryFindByType(
+    T_SLAVE_REGISTRY* pDesc
+   ,EC_T_DWORD    dwVendorId            /**< [in]   vendor id */
+   ,EC_T_DWORD    dwProductCode         /**< [in]   product code */
+   ,EC_T_DWORD    dwInstance            /**< [in]   0: first slave of this type in the configuration, 1: second, ... */
+   );
+const EC_T_CFG_SLAVE_INFO* SlaveRegistryGetCfgSlaveInfo(
+    T_SLAVE_REGISTRY* pDesc
+   ,EC_T_DWORD    dwSlaveIdx            /**< [in]   index in the registry arrays */
+   );
+
+#endif /*__ECATDEMOSLAVEREGISTRY_H__*/
+
+/*-END OF SOURCE FILE--------------------------------------------------------*/
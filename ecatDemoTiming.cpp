@@ -0,0 +1,241 @@
+/*-----------------------------------------------------------------------------
+ * ecatDemoTiming.cpp
+ * Copyright                acontis technologies GmbH, Weingarten, Germany
+ * Response                 Stefan Zintgraf
+ * Description              absolute deadline cycle timing for the demos
+ *---------------------------------------------------------------------------*/
+
+/*-INCLUDES------------------------------------------------------------------*/
+#include "ecatDemoTiming.h"
+
+#if (defined DEADLINE_TIMER_SUPPORTED)
+#include <time.h>
+#include <errno.h>
+#endif
+
+/*-DEFINES-------------------------------------------------------------------*/
+#define NSEC_PER_SEC    ((EC_T_UINT64)1000000000)
+#define NSEC_PER_MSEC   ((EC_T_UINT64)1000000)
+
+/*-FUNCTION-DEFINITIONS------------------------------------------------------*/
+
+/********************************************************************************/
+/** \brief  Get the current monotonic time.
+*
+* \return  time in nsec.
+*/
+EC_T_UINT64 DeadlineTimerGetTime(EC_T_VOID)
+{
+#if (defined DEADLINE_TIMER_SUPPORTED)
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((EC_T_UINT64)ts.tv_sec * NSEC_PER_SEC) + (EC_T_UINT64)ts.tv_nsec;
+#else
+    EC_T_UINT64 qwTime = 0;
+
+    OsSystemTimeGet(&qwTime);
+    return qwTime;
+#endif
+}
+
+/********************************************************************************/
+/** \brief  Initialize deadline timer. The first deadline is one period from now.
+*
+* \return  N/A.
+*/
+EC_T_VOID DeadlineTimerInit
+    (T_DEADLINE_TIMER* pTimer
+    ,EC_T_DWORD        dwCycleTimeUsec      /**< [in]   period in usec */
+    ,EC_T_DWORD        dwWakeAheadUsec)     /**< [in]   wake up offset before the period boundary in usec */
+{
+    OsMemset(pTimer, 0, sizeof(T_DEADLINE_TIMER));
+
+    pTimer->dwCycleTimeNsec = dwCycleTimeUsec * 1000;
+    pTimer->dwWakeAheadNsec = EC_MIN(dwWakeAheadUsec, dwCycleTimeUsec) * 1000;
+    pTimer->dwMinLatenessNsec = 0xFFFFFFFF;
+    pTimer->qwNextDeadline  = DeadlineTimerGetTime() + pTimer->dwCycleTimeNsec;
+}
+
+/********************************************************************************/
+/** \brief  Sleep until the given absolute time.
+*
+* \return  N/A.
+*/
+static EC_T_VOID DeadlineSleepUntil(EC_T_UINT64 qwTime)
+{
+#if (defined DEADLINE_TIMER_SUPPORTED)
+struct timespec ts;
+
+    ts.tv_sec  = (time_t)(qwTime / NSEC_PER_SEC);
+    ts.tv_nsec = (long)(qwTime % NSEC_PER_SEC);
+    while (EINTR == clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, EC_NULL))
+    {
+        /* interrupted by signal, sleep again until the same deadline */
+    }
+#else
+EC_T_UINT64 qwNow = DeadlineTimerGetTime();
+
+    if (qwTime > qwNow)
+    {
+        /* no cycle below 1ms */
+        OsSleep((EC_T_DWORD)EC_MAX((qwTime - qwNow) / NSEC_PER_MSEC, 1));
+    }
+#endif
+}
+
+/********************************************************************************/
+/** \brief  Busy-poll the clock until the given absolute time.
+*
+* On Linux/x86 CLOCK_MONOTONIC is read from the TSC without a system call.
+*
+* \return  N/A.
+*/
+static EC_T_VOID DeadlineSpinUntil(EC_T_UINT64 qwTime)
+{
+    while (DeadlineTimerGetTime() < qwTime)
+    {
+#if ((defined __GNUC__) && ((defined __i386__) || (defined __x86_64__)))
+        __builtin_ia32_pause();
+#endif
+    }
+}
+
+/********************************************************************************/
+/** \brief  Select how DeadlineTimerWait() waits for the deadline.
+*
+* \return  N/A.
+*/
+EC_T_VOID DeadlineTimerSetWaitPolicy
+    (T_DEADLINE_TIMER*      pTimer
+    ,T_DEADLINE_WAIT_POLICY eWaitPolicy     /**< [in]   sleep, hybrid or spin */
+    ,EC_T_DWORD             dwSpinUsec)     /**< [in]   hybrid wait: busy-poll time before the deadline in usec */
+{
+    pTimer->eWaitPolicy = eWaitPolicy;
+    pTimer->dwSpinNsec  = (EC_T_DWORD)EC_MIN((EC_T_UINT64)dwSpinUsec * 1000, (EC_T_UINT64)pTimer->dwCycleTimeNsec);
+}
+
+/********************************************************************************/
+/** \brief  Wait until the next period boundary (minus wake-ahead offset).
+*
+* The deadline is advanced by exactly one period per call, so the wake-up latency
+* does not accumulate. If a wake-up comes later than one period, the missed
+* periods are skipped instead of being caught up in a burst.
+*
+* \return  N/A.
+*/
+EC_T_VOID DeadlineTimerWait(T_DEADLINE_TIMER* pTimer)
+{
+EC_T_UINT64 qwWakeUp = pTimer->qwNextDeadline - pTimer->dwWakeAheadNsec;
+EC_T_UINT64 qwNow    = 0;
+
+    switch (pTimer->eWaitPolicy)
+    {
+    case eDeadlineWait_Hybrid:
+        DeadlineSleepUntil(qwWakeUp - pTimer->dwSpinNsec);
+        DeadlineSpinUntil(qwWakeUp);
+        break;
+    case eDeadlineWait_Spin:
+        DeadlineSpinUntil(qwWakeUp);
+        break;
+    case eDeadlineWait_Sleep:
+    default:
+        DeadlineSleepUntil(qwWakeUp);
+        break;
+    }
+    qwNow = DeadlineTimerGetTime();
+    pTimer->qwLastWakeUp = qwWakeUp;
+
+    /* statistics */
+    pTimer->dwNumCycles++;
+    if (qwNow >= qwWakeUp)
+    {
+    EC_T_DWORD dwLateness = (EC_T_DWORD)EC_MIN(qwNow - qwWakeUp, (EC_T_UINT64)0x7FFFFFFF);
+
+        pTimer->nLastErrorNsec = (EC_T_INT)dwLateness;
+        pTimer->qwSumLatenessNsec += dwLateness;
+        if (dwLateness > pTimer->dwMaxOvershootNsec)
+        {
+            pTimer->dwMaxOvershootNsec = dwLateness;
+        }
+        if (dwLateness < pTimer->dwMinLatenessNsec)
+        {
+            pTimer->dwMinLatenessNsec = dwLateness;
+        }
+    }
+    else
+    {
+        pTimer->nLastErrorNsec = -(EC_T_INT)(qwWakeUp - qwNow);
+        pTimer->dwMinLatenessNsec = 0;
+        pTimer->dwNumEarlyWakeUps++;
+    }
+    /* a relative sleep would have shifted the whole schedule by this sum */
+    pTimer->nSumDriftNsec += pTimer->nLastErrorNsec;
+
+    /* advance to the next period boundary */
+    pTimer->qwNextDeadline += pTimer->dwCycleTimeNsec;
+    if (qwNow >= pTimer->qwNextDeadline - pTimer->dwWakeAheadNsec)
+    {
+    EC_T_DWORD dwNumSkipped = (EC_T_DWORD)((qwNow - (pTimer->qwNextDeadline - pTimer->dwWakeAheadNsec)) / pTimer->dwCycleTimeNsec) + 1;
+
+        pTimer->qwNextDeadline     += (EC_T_UINT64)dwNumSkipped * pTimer->dwCycleTimeNsec;
+        pTimer->dwNumSkippedCycles += dwNumSkipped;
+    }
+}
+
+/********************************************************************************/
+/** \brief  Clear the wake-up statistics, e.g. after the startup phase.
+*
+* \return  N/A.
+*/
+EC_T_VOID DeadlineTimerResetStats(T_DEADLINE_TIMER* pTimer)
+{
+    pTimer->dwNumCycles        = 0;
+    pTimer->dwNumSkippedCycles = 0;
+    pTimer->nLastErrorNsec     = 0;
+    pTimer->nSumDriftNsec      = 0;
+    pTimer->qwSumLatenessNsec  = 0;
+    pTimer->dwMaxOvershootNsec = 0;
+    pTimer->dwMinLatenessNsec  = 0xFFFFFFFF;
+    pTimer->dwNumEarlyWakeUps  = 0;
+}
+
+/********************************************************************************/
+/** \brief  Get the name of a wait policy.
+*
+* \return  policy name.
+*/
+const EC_T_CHAR* DeadlineWaitPolicyText(T_DEADLINE_WAIT_POLICY eWaitPolicy)
+{
+    switch (eWaitPolicy)
+    {
+    case eDeadlineWait_Sleep:  return "sleep";
+    case eDeadlineWait_Hybrid: return "hybrid";
+    case eDeadlineWait_Spin:   return "spin";
+    default:                   return "unknown";
+    }
+}
+
+/********************************************************************************/
+/** \brief  Show deadline timer statistics.
+*
+* \return  N/A.
+*/
+EC_T_VOID DeadlineTimerShow
+    (T_DEADLINE_TIMER* pTimer
+    ,CAtEmLogging*     poLog
+    ,const EC_T_CHAR*  szName)              /**< [in]   name printed in front of the statistics */
+{
+EC_T_DWORD dwAvgLatenessNsec = 0;
+
+    if (0 != pTimer->dwNumCycles)
+    {
+        dwAvgLatenessNsec = (EC_T_DWORD)(pTimer->qwSumLatenessNsec / pTimer->dwNumCycles);
+    }
+    poLog->LogMsg("%s: %d cycles, %d skipped, %d early, wait %s, accumulated drift %lld nsec (last %d), wake-up error min/avg/max %d/%d/%d nsec",
+        szName, pTimer->dwNumCycles, pTimer->dwNumSkippedCycles, pTimer->dwNumEarlyWakeUps,
+        DeadlineWaitPolicyText(pTimer->eWaitPolicy), (long long)pTimer->nSumDriftNsec, pTimer->nLastErrorNsec,
+        ((0 == pTimer->dwNumCycles) ? 0 : pTimer->dwMinLatenessNsec), dwAvgLatenessNsec, pTimer->dwMaxOvershootNsec);
+}
+
+/*-END OF SOURCE FILE--------------------------------------------------------*/
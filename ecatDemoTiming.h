@@ -0,0 +1,83 @@
+/*-----------------------------------------------------------------------------
+ * ecatDemoTiming.h
+ * Copyright                acontis technologies GmbH, Weingarten, Germany
+ * Response                 Stefan Zintgraf
+ * Description              absolute deadline cycle timing for the demos
+ *---------------------------------------------------------------------------*/
+
+#ifndef __ECATDEMOTIMING_H__
+#define __ECATDEMOTIMING_H__  1
+
+/*-INCLUDES------------------------------------------------------------------*/
+#include "Logging.h"
+
+/*-DEFINES-------------------------------------------------------------------*/
+#if (defined LINUX) && !(defined RTAI)
+/* clock_nanosleep(TIMER_ABSTIME) on CLOCK_MONOTONIC is available */
+#define DEADLINE_TIMER_SUPPORTED
+#endif
+
+#define DEADLINE_DEFAULT_SPIN_USEC  50      /* hybrid wait: default busy-poll time before the deadline */
+#define DEADLINE_MAX_CYCLE_TIME_USEC 4000000 /* periods are kept as 32 bit nsec */
+
+/*-TYPEDEFS------------------------------------------------------------------*/
+typedef enum _T_DEADLINE_WAIT_POLICY
+{
+    eDeadlineWait_Sleep  = 0,           /* sleep until the deadline */
+    eDeadlineWait_Hybrid = 1,           /* sleep until shortly before the deadline, then busy-poll */
+    eDeadlineWait_Spin   = 2            /* busy-poll until the deadline (isolated core only) */
+} T_DEADLINE_WAIT_POLICY;
+
+typedef struct _T_DEADLINE_TIMER
+{
+    EC_T_DWORD  dwCycleTimeNsec;        /* period in nsec */
+    EC_T_DWORD  dwWakeAheadNsec;        /* wake up this time before the period boundary */
+    EC_T_UINT64 qwNextDeadline;         /* absolute time of the next period boundary in nsec */
+    T_DEADLINE_WAIT_POLICY eWaitPolicy; /* how to wait for the deadline */
+    EC_T_DWORD  dwSpinNsec;             /* hybrid wait: busy-poll this time before the deadline */
+    EC_T_UINT64 qwLastWakeUp;           /* scheduled time of the last wake-up, for the wake-up error of a triggered thread */
+
+    /* statistics */
+    EC_T_DWORD  dwNumCycles;            /* number of wake-ups */
+    EC_T_DWORD  dwNumSkippedCycles;     /* periods skipped because the wake-up was too late */
+    EC_T_INT    nLastErrorNsec;         /* offset of the last wake-up to its deadline */
+    EC_T_INT64  nSumDriftNsec;          /* accumulated offset of all wake-ups to their deadlines */
+    EC_T_UINT64 qwSumLatenessNsec;      /* accumulated lateness of all wake-ups */
+    EC_T_DWORD  dwMaxOvershootNsec;     /* worst lateness of a wake-up */
+    EC_T_DWORD  dwMinLatenessNsec;      /* best lateness of a wake-up */
+    EC_T_DWORD  dwNumEarlyWakeUps;      /* wake-ups before the deadline */
+} T_DEADLINE_TIMER;
+
+/*-FUNCTION DECLARATION------------------------------------------------------*/
+EC_T_UINT64 DeadlineTimerGetTime(
+    EC_T_VOID
+   );
+EC_T_VOID DeadlineTimerInit(
+    T_DEADLINE_TIMER* pTimer
+   ,EC_T_DWORD    dwCycleTimeUsec       /**< [in]   period in usec */
+   ,EC_T_DWORD    dwWakeAheadUsec       /**< [in]   wake up offset before the period boundary in usec */
+   );
+EC_T_VOID DeadlineTimerSetWaitPolicy(
+    T_DEADLINE_TIMER* pTimer
+   ,T_DEADLINE_WAIT_POLICY eWaitPolicy  /**< [in]   sleep, hybrid or spin */
+   ,EC_T_DWORD    dwSpinUsec            /**< [in]   hybrid wait: busy-poll time before the deadline in usec */
+   );
+EC_T_VOID DeadlineTimerWait(
+    T_DEADLINE_TIMER* pTimer
+   );
+EC_T_VOID DeadlineTimerResetStats(
+    T_DEADLINE_TIMER* pTimer
+   );
+const EC_T_CHAR* DeadlineWaitPolicyText(
+    T_DEADLINE_WAIT_POLICY eWaitPolicy
+   );
+EC_T_VOID DeadlineTimerShow(
+    T_DEADLINE_TIMER* pTimer
+   ,CAtEmLogging* poLog
+   ,const
+    EC_T_CHAR*    szName                /**< [in]   name printed in front of the statistics */
+   );
+
+#endif /*__ECATDEMOTIMING_H__*/
+
+/*-END OF SOURCE FILE--------------------------------------------------------*/
@@ -0,0 +1,442 @@
+/*-----------------------------------------------------------------------------
+ * ecatDemoTrace.cpp
+ * Copyright                acontis technologies GmbH, Weingarten, Germany
+ * Response                 Stefan Zintgraf
+ * Description              per cycle timeline trace with Chrome trace export
+ *---------------------------------------------------------------------------*/
+
+/*-INCLUDES------------------------------------------------------------------*/
+#include "ecatDemoTrace.h"
+#include "ecatDemoTiming.h"
+#include "ecatDemoAtomic.h"
+
+/*-DEFINES-------------------------------------------------------------------*/
+#define TRACE_FILE_NAME             "ectrace"
+#define TRACE_PID                   1
+#define TRACE_TID_JOBTASK           1
+#define TRACE_TID_TRACK(eTrack)     (2 + (EC_T_DWORD)(eTrack))
+
+/*-TYPEDEFS------------------------------------------------------------------*/
+typedef struct _T_TRACE_SPAN
+{
+    EC_T_UINT64         qwStart;        /* start time in nsec */
+    EC_T_UINT64         qwEnd;          /* end time in nsec */
+    const EC_T_CHAR*    szName;         /* static span name */
+} T_TRACE_SPAN;
+
+/*-LOCAL VARIABLES-----------------------------------------------------------*/
+static volatile EC_T_BOOL   S_bTraceEnabled      = EC_FALSE;
+static T_TRACE_CYCLE*       S_paCycle            = EC_NULL;     /* cycle ring, written by tEcJobTask */
+static T_TRACE_CYCLE*       S_paCycleSnapshot    = EC_NULL;     /* copy of the cycle ring for the dump */
+static EC_T_DWORD           S_dwNumCycles        = 0;
+static volatile EC_T_DWORD  S_dwCycleWriteCnt    = 0;           /* number of cycles written */
+
+/* spans are kept in static memory, so late writers never access freed memory */
+static T_TRACE_SPAN         S_aaSpan[eTraceTrack_Count][TRACE_SPAN_RING_SIZE];
+static T_TRACE_SPAN         S_aaSpanSnapshot[eTraceTrack_Count][TRACE_SPAN_RING_SIZE];
+static volatile EC_T_DWORD  S_adwSpanWriteCnt[eTraceTrack_Count];
+static const EC_T_CHAR*     S_aszTrackName[eTraceTrack_Count] =
+{
+    "tAtEmLog",
+    "Notification"
+};
+
+static EC_T_VOID*           S_pvDumpEvent        = EC_NULL;
+static EC_T_VOID*           S_pvDumpThread       = EC_NULL;
+static volatile EC_T_BOOL   S_bDumpRequest       = EC_FALSE;
+static volatile EC_T_BOOL   S_bDumpShutdown      = EC_FALSE;
+static volatile EC_T_BOOL   S_bDumpThreadRunning = EC_FALSE;
+static EC_T_DWORD           S_dwDumpIndex        = 0;
+static EC_T_CHAR            S_szLine[512];
+
+/*-FUNCTION-DEFINITIONS------------------------------------------------------*/
+
+/********************************************************************************/
+/** \brief  Get first valid ring entry after copying a ring.
+*
+* The entry the writer is working on while copying may be torn, all entries
+* overwritten during the copy are dropped.
+*
+* \return  number of the first valid entry.
+*/
+static EC_T_DWORD TraceFirstValid(EC_T_DWORD dwFirst, EC_T_DWORD dwWriteCntAfterCopy, EC_T_DWORD dwRingSize)
+{
+    if (dwWriteCntAfterCopy >= dwRingSize)
+    {
+        return EC_MAX(dwFirst, dwWriteCntAfterCopy - dwRingSize + 1);
+    }
+    return dwFirst;
+}
+
+/********************************************************************************/
+/** \brief  Write a complete event ("ph":"X") to the trace file.
+*
+* \return  N/A.
+*/
+static EC_T_VOID TraceWriteSpan(FILE* pfFile, EC_T_UINT64 qwBase, EC_T_DWORD dwTid, const EC_T_CHAR* szName,
+    EC_T_UINT64 qwStart, EC_T_UINT64 qwEnd, EC_T_DWORD dwCycle, EC_T_DWORD dwConsecutiveMisses, EC_T_BOOL bPrevCycProcessed)
+{
+EC_T_UINT64 qwStartNsec = qwStart - qwBase;
+EC_T_DWORD  dwDurNsec   = (EC_T_DWORD)((qwEnd > qwStart) ? EC_MIN(qwEnd - qwStart, (EC_T_UINT64)0xFFFFFFFF) : 0);
+
+    /* don't use fprintf, some platforms don't support it! */
+    if (TRACE_TID_JOBTASK == dwTid)
+    {
+        OsSnprintf(S_szLine, sizeof(S_szLine) - 1,
+            ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%llu.%03d,\"dur\":%u.%03d,\"args\":{\"cycle\":%d,\"consecutiveMisses\":%d,\"prevCycProcessed\":%d}}",
+            szName, TRACE_PID, dwTid, (unsigned long long)(qwStartNsec / 1000), (EC_T_INT)(qwStartNsec % 1000), dwDurNsec / 1000, dwDurNsec % 1000,
+            dwCycle, dwConsecutiveMisses, (bPrevCycProcessed ? 1 : 0));
+    }
+    else
+    {
+        OsSnprintf(S_szLine, sizeof(S_szLine) - 1,
+            ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%llu.%03d,\"dur\":%u.%03d}",
+            szName, TRACE_PID, dwTid, (unsigned long long)(qwStartNsec / 1000), (EC_T_INT)(qwStartNsec % 1000), dwDurNsec / 1000, dwDurNsec % 1000);
+    }
+    OsFwrite(S_szLine, OsStrlen(S_szLine), 1, pfFile);
+}
+
+/********************************************************************************/
+/** \brief  Write an instant event ("ph":"i") of the job task to the trace file.
+*
+* \return  N/A.
+*/
+static EC_T_VOID TraceWriteInstant(FILE* pfFile, EC_T_UINT64 qwBase, const EC_T_CHAR* szName, EC_T_UINT64 qwTime)
+{
+EC_T_UINT64 qwTsNsec = qwTime - qwBase;
+
+    OsSnprintf(S_szLine, sizeof(S_szLine) - 1,
+        ",\n{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":%d,\"tid\":%d,\"ts\":%llu.%03d}",
+        szName, TRACE_PID, TRACE_TID_JOBTASK, (unsigned long long)(qwTsNsec / 1000), (EC_T_INT)(qwTsNsec % 1000));
+    OsFwrite(S_szLine, OsStrlen(S_szLine), 1, pfFile);
+}
+
+/********************************************************************************/
+/** \brief  Write the current trace rings to a Chrome trace event JSON file.
+*
+* The file can be loaded by chrome://tracing or https://ui.perfetto.dev.
+*
+* \return  N/A.
+*/
+static EC_T_VOID TraceDump(EC_T_VOID)
+{
+FILE*       pfFile  = EC_NULL;
+EC_T_CHAR   szFileName[64];
+EC_T_DWORD  dwFirst = 0;
+EC_T_DWORD  dwEnd   = 0;
+EC_T_DWORD  dwIdx   = 0;
+EC_T_DWORD  adwSpanFirst[eTraceTrack_Count];
+EC_T_DWORD  adwSpanEnd[eTraceTrack_Count];
+EC_T_UINT64 qwBase  = (EC_T_UINT64)-1;
+EC_T_INT    nTrack  = 0;
+
+    /* copy cycle ring */
+    dwEnd = S_dwCycleWriteCnt;
+    DEMO_MEMORY_BARRIER();
+    dwFirst = (dwEnd > S_dwNumCycles) ? (dwEnd - S_dwNumCycles) : 0;
+    for (dwIdx = dwFirst; dwIdx != dwEnd; dwIdx++)
+    {
+        S_paCycleSnapshot[dwIdx % S_dwNumCycles] = S_paCycle[dwIdx % S_dwNumCycles];
+    }
+    DEMO_MEMORY_BARRIER();
+    dwFirst = TraceFirstValid(dwFirst, S_dwCycleWriteCnt, S_dwNumCycles);
+
+    /* copy span rings */
+    for (nTrack = 0; nTrack < eTraceTrack_Count; nTrack++)
+    {
+        adwSpanEnd[nTrack] = S_adwSpanWriteCnt[nTrack];
+        DEMO_MEMORY_BARRIER();
+        adwSpanFirst[nTrack] = (adwSpanEnd[nTrack] > TRACE_SPAN_RING_SIZE) ? (adwSpanEnd[nTrack] - TRACE_SPAN_RING_SIZE) : 0;
+        for (dwIdx = adwSpanFirst[nTrack]; dwIdx != adwSpanEnd[nTrack]; dwIdx++)
+        {
+            S_aaSpanSnapshot[nTrack][dwIdx % TRACE_SPAN_RING_SIZE] = S_aaSpan[nTrack][dwIdx % TRACE_SPAN_RING_SIZE];
+        }
+        DEMO_MEMORY_BARRIER();
+        adwSpanFirst[nTrack] = TraceFirstValid(adwSpanFirst[nTrack], S_adwSpanWriteCnt[nTrack], TRACE_SPAN_RING_SIZE);
+    }
+
+    /* timestamps in the file are relative to the oldest entry */
+    if (dwFirst != dwEnd)
+    {
+        qwBase = S_paCycleSnapshot[dwFirst % S_dwNumCycles].qwWake;
+    }
+    for (nTrack = 0; nTrack < eTraceTrack_Count; nTrack++)
+    {
+        if (adwSpanFirst[nTrack] != adwSpanEnd[nTrack])
+        {
+            qwBase = EC_MIN(qwBase, S_aaSpanSnapshot[nTrack][adwSpanFirst[nTrack] % TRACE_SPAN_RING_SIZE].qwStart);
+        }
+    }
+    if ((EC_T_UINT64)-1 == qwBase)
+    {
+        /* nothing recorded */
+        return;
+    }
+
+    OsSnprintf(szFileName, sizeof(szFileName) - 1, "%s_%d.json", TRACE_FILE_NAME, S_dwDumpIndex++);
+    pfFile = OsFopen(szFileName, "w+");
+    if (EC_NULL == pfFile)
+    {
+        OsDbgMsg("Trace: cannot create '%s'\n", szFileName);
+        return;
+    }
+    OsSnprintf(S_szLine, sizeof(S_szLine) - 1,
+        "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"tEcJobTask\"}}",
+        TRACE_PID, TRACE_TID_JOBTASK);
+    OsFwrite(S_szLine, OsStrlen(S_szLine), 1, pfFile);
+    for (nTrack = 0; nTrack < eTraceTrack_Count; nTrack++)
+    {
+        OsSnprintf(S_szLine, sizeof(S_szLine) - 1,
+            ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+            TRACE_PID, TRACE_TID_TRACK(nTrack), S_aszTrackName[nTrack]);
+        OsFwrite(S_szLine, OsStrlen(S_szLine), 1, pfFile);
+    }
+
+    /* one span per job task phase */
+    for (dwIdx = dwFirst; dwIdx != dwEnd; dwIdx++)
+    {
+    T_TRACE_CYCLE* pCycle = &S_paCycleSnapshot[dwIdx % S_dwNumCycles];
+
+        TraceWriteSpan(pfFile, qwBase, TRACE_TID_JOBTASK, "ProcessAllRxFrames", pCycle->qwWake, pCycle->qwRxDone,
+            dwIdx, pCycle->dwConsecutiveMisses, pCycle->bPrevCycProcessed);
+        if (pCycle->bPipelined)
+        {
+            TraceWriteSpan(pfFile, qwBase, TRACE_TID_JOBTASK, "SendAllCycFrames", pCycle->qwRxDone, pCycle->qwTxDone,
+                dwIdx, pCycle->dwConsecutiveMisses, pCycle->bPrevCycProcessed);
+            TraceWriteSpan(pfFile, qwBase, TRACE_TID_JOBTASK, "myAppWorkpd", pCycle->qwTxDone, pCycle->qwAppDone,
+                dwIdx, pCycle->dwConsecutiveMisses, pCycle->bPrevCycProcessed);
+            TraceWriteSpan(pfFile, qwBase, TRACE_TID_JOBTASK, "MasterTimer", pCycle->qwAppDone, pCycle->qwTimerDone,
+                dwIdx, pCycle->dwConsecutiveMisses, pCycle->bPrevCycProcessed);
+        }
+        else
+        {
+            TraceWriteSpan(pfFile, qwBase, TRACE_TID_JOBTASK, "myAppWorkpd", pCycle->qwRxDone, pCycle->qwAppDone,
+                dwIdx, pCycle->dwConsecutiveMisses, pCycle->bPrevCycProcessed);
+            TraceWriteSpan(pfFile, qwBase, TRACE_TID_JOBTASK, "SendAllCycFrames", pCycle->qwAppDone, pCycle->qwTxDone,
+                dwIdx, pCycle->dwConsecutiveMisses, pCycle->bPrevCycProcessed);
+            TraceWriteSpan(pfFile, qwBase, TRACE_TID_JOBTASK, "MasterTimer", pCycle->qwTxDone, pCycle->qwTimerDone,
+                dwIdx, pCycle->dwConsecutiveMisses, pCycle->bPrevCycProcessed);
+        }
+        TraceWriteSpan(pfFile, qwBase, TRACE_TID_JOBTASK, "SendAcycFrames", pCycle->qwTimerDone, pCycle->qwAcycDone,
+            dwIdx, pCycle->dwConsecutiveMisses, pCycle->bPrevCycProcessed);
+        if (!pCycle->bPrevCycProcessed)
+        {
+            TraceWriteInstant(pfFile, qwBase, "frame loss", pCycle->qwRxDone);
+        }
+        else if (0 != pCycle->dwConsecutiveMisses)
+        {
+            TraceWriteInstant(pfFile, qwBase, "deadline miss", pCycle->qwAcycDone);
+        }
+    }
+    for (nTrack = 0; nTrack < eTraceTrack_Count; nTrack++)
+    {
+        for (dwIdx = adwSpanFirst[nTrack]; dwIdx != adwSpanEnd[nTrack]; dwIdx++)
+        {
+        T_TRACE_SPAN* pSpan = &S_aaSpanSnapshot[nTrack][dwIdx % TRACE_SPAN_RING_SIZE];
+
+            if (pSpan->qwStart >= qwBase)
+            {
+                TraceWriteSpan(pfFile, qwBase, TRACE_TID_TRACK(nTrack), pSpan->szName, pSpan->qwStart, pSpan->qwEnd, 0, 0, EC_TRUE);
+            }
+        }
+    }
+    OsSnprintf(S_szLine, sizeof(S_szLine) - 1, "\n]}\n");
+    OsFwrite(S_szLine, OsStrlen(S_szLine), 1, pfFile);
+    OsFclose(pfFile);
+
+    OsDbgMsg("Trace: %d cycles written to '%s'\n", dwEnd - dwFirst, szFileName);
+}
+
+/********************************************************************************/
+/** \brief  Low priority thread writing the trace on request.
+*
+* \return  N/A.
+*/
+static EC_T_VOID tEcTraceDump(EC_T_VOID* pvParms)
+{
+CEcTimer oHoldOff;
+
+    EC_UNREFPARM(pvParms);
+
+    S_bDumpThreadRunning = EC_TRUE;
+    while (!S_bDumpShutdown)
+    {
+        OsWaitForEvent(S_pvDumpEvent, 100);
+        if (S_bDumpRequest && !S_bDumpShutdown && (!oHoldOff.IsStarted() || oHoldOff.IsElapsed()))
+        {
+            S_bDumpRequest = EC_FALSE;
+            TraceDump();
+            oHoldOff.Start(TRACE_DUMP_HOLDOFF);
+        }
+    }
+    S_bDumpThreadRunning = EC_FALSE;
+#if (defined EC_VERSION_RTEMS)
+    rtems_task_delete(RTEMS_SELF);
+#endif
+}
+
+/********************************************************************************/
+/** \brief  Allocate trace rings and start the dump thread.
+*
+* \return  EC_TRUE on success.
+*/
+EC_T_BOOL TraceInit
+    (EC_T_DWORD dwNumCycles                 /**< [in]   cycles kept in the trace ring */
+    ,EC_T_DWORD dwDumpPrio                  /**< [in]   priority of the dump thread */
+    ,EC_T_DWORD dwDumpStackSize)            /**< [in]   stack size of the dump thread */
+{
+CEcTimer  oTimeout;
+EC_T_BOOL bOk = EC_FALSE;
+
+    S_dwNumCycles     = (0 == dwNumCycles) ? TRACE_DEFAULT_NUM_CYCLES : dwNumCycles;
+    S_dwCycleWriteCnt = 0;
+    S_paCycle         = (T_TRACE_CYCLE*)OsMalloc(S_dwNumCycles * sizeof(T_TRACE_CYCLE));
+    S_paCycleSnapshot = (T_TRACE_CYCLE*)OsMalloc(S_dwNumCycles * sizeof(T_TRACE_CYCLE));
+    if ((EC_NULL == S_paCycle) || (EC_NULL == S_paCycleSnapshot))
+    {
+        goto Exit;
+    }
+    OsMemset(S_paCycle, 0, S_dwNumCycles * sizeof(T_TRACE_CYCLE));
+    OsMemset((EC_T_VOID*)S_adwSpanWriteCnt, 0, sizeof(S_adwSpanWriteCnt));
+
+    S_pvDumpEvent = OsCreateEvent();
+    if (EC_NULL == S_pvDumpEvent)
+    {
+        goto Exit;
+    }
+    S_bDumpRequest  = EC_FALSE;
+    S_bDumpShutdown = EC_FALSE;
+    S_pvDumpThread  = OsCreateThread((EC_T_CHAR*)"tEcTraceDump", tEcTraceDump, dwDumpPrio, dwDumpStackSize, EC_NULL);
+
+    /* wait until thread is running */
+    oTimeout.Start(2000);
+    while (!oTimeout.IsElapsed() && !S_bDumpThreadRunning)
+    {
+        OsSleep(10);
+    }
+    if (!S_bDumpThreadRunning)
+    {
+        goto Exit;
+    }
+    S_bTraceEnabled = EC_TRUE;
+    bOk = EC_TRUE;
+
+Exit:
+    if (!bOk)
+    {
+        TraceDeinit(EC_FALSE);
+    }
+    return bOk;
+}
+
+/********************************************************************************/
+/** \brief  Stop the dump thread and free the trace rings.
+*
+* Must be called after the job task has been stopped.
+*
+* \return  N/A.
+*/
+EC_T_VOID TraceDeinit
+    (EC_T_BOOL bDump)                       /**< [in]   write the trace before freeing it */
+{
+CEcTimer oTimeout;
+
+    if (EC_NULL != S_pvDumpThread)
+    {
+        S_bDumpShutdown = EC_TRUE;
+        OsSetEvent(S_pvDumpEvent);
+        oTimeout.Start(2000);
+        while (S_bDumpThreadRunning && !oTimeout.IsElapsed())
+        {
+            OsSleep(10);
+        }
+        OsDeleteThreadHandle(S_pvDumpThread);
+        S_pvDumpThread = EC_NULL;
+    }
+    if (bDump && S_bTraceEnabled)
+    {
+        TraceDump();
+    }
+    S_bTraceEnabled = EC_FALSE;
+    if (EC_NULL != S_pvDumpEvent)
+    {
+        OsDeleteEvent(S_pvDumpEvent);
+        S_pvDumpEvent = EC_NULL;
+    }
+    SafeOsFree(S_paCycle);
+    SafeOsFree(S_paCycleSnapshot);
+}
+
+/********************************************************************************/
+/** \brief  Get trace timestamp.
+*
+* \return  time in nsec, 0 if tracing is disabled.
+*/
+EC_T_UINT64 TraceGetTime(EC_T_VOID)
+{
+    if (!S_bTraceEnabled)
+    {
+        return 0;
+    }
+    return DeadlineTimerGetTime();
+}
+
+/********************************************************************************/
+/** \brief  Add a cycle to the cycle ring. Called by tEcJobTask only.
+*
+* \return  N/A.
+*/
+EC_T_VOID TraceCycleAdd(T_TRACE_CYCLE* pCycle)
+{
+EC_T_DWORD dwWriteCnt = S_dwCycleWriteCnt;
+
+    if (!S_bTraceEnabled)
+    {
+        return;
+    }
+    S_paCycle[dwWriteCnt % S_dwNumCycles] = *pCycle;
+    DEMO_MEMORY_BARRIER();
+    S_dwCycleWriteCnt = dwWriteCnt + 1;
+}
+
+/********************************************************************************/
+/** \brief  Add a span to a track. Only one thread may write to a track.
+*
+* \return  N/A.
+*/
+EC_T_VOID TraceSpanAdd
+    (T_TRACE_TRACK    eTrack
+    ,const EC_T_CHAR* szName                /**< [in]   span name, must be a static string */
+    ,EC_T_UINT64      qwStart)              /**< [in]   start time from TraceGetTime() */
+{
+EC_T_DWORD    dwWriteCnt = 0;
+T_TRACE_SPAN* pSpan      = EC_NULL;
+
+    if (!S_bTraceEnabled || (0 == qwStart))
+    {
+        return;
+    }
+    dwWriteCnt     = S_adwSpanWriteCnt[eTrack];
+    pSpan          = &S_aaSpan[eTrack][dwWriteCnt % TRACE_SPAN_RING_SIZE];
+    pSpan->qwStart = qwStart;
+    pSpan->qwEnd   = DeadlineTimerGetTime();
+    pSpan->szName  = szName;
+    DEMO_MEMORY_BARRIER();
+    S_adwSpanWriteCnt[eTrack] = dwWriteCnt + 1;
+}
+
+/********************************************************************************/
+/** \brief  Request the dump thread to write the trace, e.g. on frame loss or deadline miss.
+*
+* \return  N/A.
+*/
+EC_T_VOID TraceRequestDump(EC_T_VOID)
+{
+    if (S_bTraceEnabled && !S_bDumpRequest)
+    {
+        S_bDumpRequest = EC_TRUE;
+        OsSetEvent(S_pvDumpEvent);
+    }
+}
+
+/*-END OF SOURCE FILE--------------------------------------------------------*/
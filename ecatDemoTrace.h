@@ -0,0 +1,71 @@
+/*-----------------------------------------------------------------------------
+ * ecatDemoTrace.h
+ * Copyright                acontis technologies GmbH, Weingarten, Germany
+ * Response                 Stefan Zintgraf
+ * Description              per cycle timeline trace with Chrome trace export
+ *---------------------------------------------------------------------------*/
+
+#ifndef __ECATDEMOTRACE_H__
+#define __ECATDEMOTRACE_H__  1
+
+/*-INCLUDES------------------------------------------------------------------*/
+#ifndef INC_ECOS
+#include "EcOs.h"
+#endif
+
+/*-DEFINES-------------------------------------------------------------------*/
+#define TRACE_DEFAULT_NUM_CYCLES    10000   /* cycles kept in the trace ring */
+#define TRACE_SPAN_RING_SIZE        4096    /* spans kept per track, must be power of 2 */
+#define TRACE_DUMP_HOLDOFF          1000    /* minimum time between two dumps in msec */
+
+/*-TYPEDEFS------------------------------------------------------------------*/
+/* timestamps of one tEcJobTask cycle in nsec */
+typedef struct _T_TRACE_CYCLE
+{
+    EC_T_UINT64 qwWake;                 /* job task woke up */
+    EC_T_UINT64 qwRxDone;               /* eUsrJob_ProcessAllRxFrames done */
+    EC_T_UINT64 qwAppDone;              /* myAppWorkpd done */
+    EC_T_UINT64 qwTxDone;               /* eUsrJob_SendAllCycFrames done */
+    EC_T_UINT64 qwTimerDone;            /* eUsrJob_MasterTimer done */
+    EC_T_UINT64 qwAcycDone;             /* eUsrJob_SendAcycFrames done */
+    EC_T_DWORD  dwConsecutiveMisses;    /* deadline misses in a row at the end of the cycle */
+    EC_T_BOOL   bPrevCycProcessed;      /* all frames of the previous cycle received */
+    EC_T_BOOL   bPipelined;             /* frames were sent before myAppWorkpd */
+} T_TRACE_CYCLE;
+
+/* threads adding spans to the trace, one writer per track */
+typedef enum _T_TRACE_TRACK
+{
+    eTraceTrack_Log    = 0,             /* tAtEmLog */
+    eTraceTrack_Notify = 1,             /* notification job processing */
+    eTraceTrack_Count
+} T_TRACE_TRACK;
+
+/*-FUNCTION DECLARATION------------------------------------------------------*/
+EC_T_BOOL TraceInit(
+    EC_T_DWORD    dwNumCycles           /**< [in]   cycles kept in the trace ring */
+   ,EC_T_DWORD    dwDumpPrio            /**< [in]   priority of the dump thread */
+   ,EC_T_DWORD    dwDumpStackSize       /**< [in]   stack size of the dump thread */
+   );
+EC_T_VOID TraceDeinit(
+    EC_T_BOOL     bDump                 /**< [in]   write the trace before freeing it */
+   );
+EC_T_UINT64 TraceGetTime(
+    EC_T_VOID
+   );
+EC_T_VOID TraceCycleAdd(
+    T_TRACE_CYCLE* pCycle
+   );
+EC_T_VOID TraceSpanAdd(
+    T_TRACE_TRACK eTrack
+   ,const
+    EC_T_CHAR*    szName                /**< [in]   span name, must be a static string */
+   ,EC_T_UINT64   qwStart               /**< [in]   start time from TraceGetTime() */
+   );
+EC_T_VOID TraceRequestDump(
+    EC_T_VOID
+   );
+
+#endif /*__ECATDEMOTRACE_H__*/
+
+/*-END OF SOURCE FILE--------------------------------------------------------*/
@@ -9,6 +9,7 @@
 #include <EcOs.h>
 #include "ecatNotification.h"
 #include "ecatDemoCommon.h"
+#include "ecatDemoTrace.h"
 
 #ifndef EXCLUDE_RAS
 #include <AtEmRasError.h>
@@ -111,6 +112,7 @@ EC_T_DWORD CEmNotification::ecatNotify(
         {
             /* Scanbus did finish it's processing when this Notification is called */
             dwRes = pNotificationDesc->desc.ScanBusNtfyDesc.dwResultCode;
+            InvalidateBusSlaveSnapshot();
 
             if (bVerbose && (EC_E_NOERROR == dwRes))
             {
@@ -225,6 +227,7 @@ EC_T_DWORD CEmNotification::ecatNotify(
         } break;
     case EC_NOTIFY_SLAVE_PRESENCE:      /* GEN|101 */
         {
+            InvalidateBusSlaveSnapshot();
             if (pNotificationDesc->desc.SlavePresenceDesc.bPresent)
             {
                 LogMsg(ecatGetText(EC_TXT_SLAVE_PRESENT), pNotificationDesc->desc.SlavePresenceDesc.wStationAddress);
@@ -237,6 +240,7 @@ EC_T_DWORD CEmNotification::ecatNotify(
     case EC_NOTIFY_SLAVES_PRESENCE:     /* GEN|102 */
         {
             EC_T_DWORD dwSlaveIdx = 0;
+            InvalidateBusSlaveSnapshot();
             for (dwSlaveIdx = 0; dwSlaveIdx < pNotificationDesc->desc.SlavesPresenceDesc.wCount; dwSlaveIdx++)
             {
                 if (pNotificationDesc->desc.SlavesPresenceDesc.SlavePresence[dwSlaveIdx].bPresent)
@@ -969,6 +973,7 @@ EC_T_DWORD CEmNotification::ecatNotify(
 #endif /* INCLUDE_HOTCONNECT */
     case EC_NOTIFY_HC_TOPOCHGDONE:          /* HC| 4:  HC Topology Change done */
         {
+            InvalidateBusSlaveSnapshot();
             if (bVerbose)
             {
                 LogMsg( ecatGetText(EC_TXT_HC_TOPOCHGDONE), ecatGetText(pNotificationDesc->desc.StatusCode), pNotificationDesc->desc.StatusCode);
@@ -1004,6 +1009,7 @@ EC_T_BOOL CEmNotification::ProcessNotificationJobs(EC_T_VOID)
 {
     T_SLAVEJOBS TmpJob     = {0};
     EC_T_BOOL   bProcessed = EC_FALSE;
+    EC_T_UINT64 qwTraceStart = TraceGetTime();
 
     /* process all jobs */
     while (DequeueJob(&TmpJob))
@@ -1112,6 +1118,10 @@ EC_T_BOOL CEmNotification::ProcessNotificationJobs(EC_T_VOID)
 #if (defined NO_OS)
     m_pcLogging->ProcessAllMsgs();
 #endif
+    if (bProcessed)
+    {
+        TraceSpanAdd(eTraceTrack_Notify, "ProcessNotificationJobs", qwTraceStart);
+    }
 
     return bProcessed;
 }
@@ -84,6 +84,8 @@ public:
                                                                                                         
                                                                                                         
     EC_T_VOID   ResetErrorCounters(         EC_T_VOID                                                   );
+    EC_T_DWORD  ErrorCounter(               EC_T_DWORD                      dwCode                      )
+                    { return m_adwErrorCounter[dwCode & 0xFFFF]; }
     EC_T_VOID   SetProcessNotificationHook( EC_T_PVOID                      pInstance,
                                             PF_PROCESS_NOTIFICATION_HOOK    pfProcessNotificationHook   );
     EC_T_VOID   Verbose(                    EC_T_INT                        nVal                        )